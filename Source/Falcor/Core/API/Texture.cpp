@@ -38,6 +38,7 @@
 #include "Utils/Threading.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Image/ImageIO.h"
+#include "Utils/Image/StreamingImageReader.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Scripting/ndarray.h"
 #include "Core/Pass/FullScreenPass.h"
@@ -390,7 +391,11 @@ ref<Texture> Texture::createFromFile(
     }
     else
     {
-        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
+        // Stream HDR images, which can be very large, instead of decoding them to a full-size bitmap first.
+        if (StreamingImageReader::isSupported(path))
+            pTex = ImageIO::loadTextureStreaming(pDevice, path, generateMipLevels, 0, bindFlags, importFlags);
+
+        Bitmap::UniqueConstPtr pBitmap = pTex ? nullptr : Bitmap::createFromFile(path, kTopDown, importFlags);
         if (pBitmap)
         {
             ResourceFormat texFormat = pBitmap->getFormat();
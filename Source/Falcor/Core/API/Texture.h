@@ -315,6 +315,11 @@ public:
      */
     Bitmap::ImportFlags getImportFlags() const { return mImportFlags; }
 
+    /**
+     * In case the texture was loaded from a file, use this to set the import flags used.
+     */
+    void setImportFlags(Bitmap::ImportFlags importFlags) { mImportFlags = importFlags; }
+
     /**
      * Returns the total number of texels across all mip levels and array slices.
      */
@@ -128,6 +128,16 @@
 #define FALCOR_FORCEINLINE __attribute__((always_inline))
 #endif
 
+/**
+ * Enable AVX2 and F16C instructions in a function, for kernels that are only called if the CPU supports them
+ * (see PixelConversion::getIsa()). MSVC allows these intrinsics in any function.
+ */
+#if FALCOR_MSVC
+#define FALCOR_TARGET_AVX2
+#elif FALCOR_CLANG | FALCOR_GCC
+#define FALCOR_TARGET_AVX2 __attribute__((target("avx2,f16c")))
+#endif
+
 /**
  * Preprocessor stringification.
  */
@@ -69,6 +69,8 @@ struct SampleAppConfig
     bool pauseTime = false; ///< Control whether or not to start the clock when the sample start running.
     bool showUI = true;     ///< Show the UI.
 
+    uint32_t threadCount = 0; ///< Number of CPU worker threads, 0 to use the logical thread count.
+
     bool generateShaderDebugInfo = false;
     bool shaderPreciseFloat = false;
 };
@@ -291,7 +291,7 @@ void Testbed::handleDroppedFile(const std::filesystem::path& path) {}
 void Testbed::internalInit(const Options& options)
 {
     OSServices::start();
-    Threading::start();
+    Threading::start(options.threadCount);
 
     // Setup asset search paths.
     AssetResolver& resolver = AssetResolver::getDefaultResolver();
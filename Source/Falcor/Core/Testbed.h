@@ -67,6 +67,8 @@ public:
         ResourceFormat colorFormat = ResourceFormat::BGRA8UnormSrgb;
         /// Depth buffer format of the frame buffer.
         ResourceFormat depthFormat = ResourceFormat::D32Float;
+        /// Number of CPU worker threads, 0 to use the logical thread count.
+        uint32_t threadCount = 0;
     };
 
     static ref<Testbed> create(const Options& options) { return make_ref<Testbed>(options); }
@@ -117,6 +117,14 @@ namespace Falcor
         */
         bool isValid() const { return mIsValid; }
 
+        /** Returns the packed BVH nodes, reading them back from the GPU if they have been refit.
+        */
+        const std::vector<PackedNode>& getNodes() const { syncDataToCPU(); return mNodes; }
+
+        /** Returns the buffer of triangle indices sorted by leaf node.
+        */
+        const ref<Buffer>& getTriangleIndicesBuffer() const { return mpTriangleIndicesBuffer; }
+
         /** Render the UI. This default implementation just shows the stats.
         */
         void renderUI(Gui::Widgets& widget);
@@ -30,7 +30,9 @@
 #include "Utils/Logger.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Math/MathConstants.slangh"
+#include "Utils/Threading.h"
 #include <algorithm>
+#include <emmintrin.h>
 
 namespace
 {
@@ -215,12 +217,169 @@ namespace
         const float3 dims = max(float3(epsilon), bb.extent());
         return dims.x * dims.y * dims.z;
     }
+
+    // Subtrees with at least this many triangles on both sides of a split are built by separate tasks.
+    const uint32_t kMinParallelSubtreeTriangleCount = 4096;
+
+    // Nodes with more triangles than this are binned in parallel, one task per chunk of this many triangles.
+    // The chunk size is fixed so that the floating-point sums, and thus the BVH, do not depend on the thread count.
+    const uint32_t kBinningChunkSize = 16384;
+
+    /** Axis-aligned bounding box in SSE registers. The fourth lane is unused.
+    */
+    struct SimdAABB
+    {
+        __m128 minPoint = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 maxPoint = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+
+        void include(__m128 pMin, __m128 pMax)
+        {
+            minPoint = _mm_min_ps(minPoint, pMin);
+            maxPoint = _mm_max_ps(maxPoint, pMax);
+        }
+
+        void include(const SimdAABB& other) { include(other.minPoint, other.maxPoint); }
+
+        AABB toAABB() const
+        {
+            alignas(16) float minValues[4];
+            alignas(16) float maxValues[4];
+            _mm_store_ps(minValues, minPoint);
+            _mm_store_ps(maxValues, maxPoint);
+            return AABB(float3(minValues[0], minValues[1], minValues[2]), float3(maxValues[0], maxValues[1], maxValues[2]));
+        }
+    };
+
+    static_assert(sizeof(AABB) == 6 * sizeof(float), "AABB is expected to be two packed float3");
+
+    /** Loads the corners of a bounding box into SSE registers without reading past the box.
+    */
+    inline void loadAABB(const AABB& bounds, __m128& pMin, __m128& pMax)
+    {
+        pMin = _mm_loadu_ps(&bounds.minPoint.x); // min.x, min.y, min.z, max.x
+        pMax = _mm_loadu_ps(&bounds.minPoint.z); // min.z, max.x, max.y, max.z
+        pMax = _mm_shuffle_ps(pMax, pMax, _MM_SHUFFLE(3, 3, 2, 1));
+    }
+
+    /** Maps the bounding box centers to bins along the three axes at once.
+        This is the same mapping as the scalar one: bin = min((center - nodeMin) * binCount / nodeExtent, binCount - 1).
+    */
+    struct BinMapping
+    {
+        __m128 origin;
+        __m128 scale;
+        __m128 maxBinId;
+
+        BinMapping(const AABB& nodeBounds, uint32_t binCount)
+        {
+            const float3 extent = nodeBounds.extent();
+            float scales[3];
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                // The node bounds can be zero if all primitives are axis-aligned and coplanar.
+                FALCOR_ASSERT(extent[axis] >= 0.f);
+                scales[axis] = extent[axis] > FLT_MIN ? (float)binCount / extent[axis] : 0.f;
+            }
+            origin = _mm_setr_ps(nodeBounds.minPoint.x, nodeBounds.minPoint.y, nodeBounds.minPoint.z, 0.f);
+            scale = _mm_setr_ps(scales[0], scales[1], scales[2], 0.f);
+            maxBinId = _mm_set1_ps((float)(binCount - 1));
+        }
+
+        /** Returns the bin ids of the box center along x, y and z in the first three lanes.
+        */
+        __m128i getBinIds(__m128 pMin, __m128 pMax) const
+        {
+            const __m128 center = _mm_mul_ps(_mm_add_ps(pMin, pMax), _mm_set1_ps(0.5f));
+            const __m128 t = _mm_mul_ps(_mm_sub_ps(center, origin), scale);
+            return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), maxBinId));
+        }
+    };
+
+    /** Aggregated data of the triangles in a bin.
+    */
+    struct SimdBin
+    {
+        SimdAABB bounds;
+        __m128 coneDirection = _mm_setzero_ps(); ///< Sum of the triangle normals (SAOH only).
+        float flux = 0.f;                        ///< Sum of the triangle flux (SAOH only).
+        uint32_t triangleCount = 0;
+
+        void merge(const SimdBin& other)
+        {
+            bounds.include(other.bounds);
+            coneDirection = _mm_add_ps(coneDirection, other.coneDirection);
+            flux += other.flux;
+            triangleCount += other.triangleCount;
+        }
+    };
+
+    float3 toFloat3(__m128 v)
+    {
+        alignas(16) float values[4];
+        _mm_store_ps(values, v);
+        return float3(values[0], values[1], values[2]);
+    }
+
+    /** Fills bins with the triangles of a range. Ranges longer than kBinningChunkSize are split into chunks that
+        are binned in parallel into private copies of the bins, which are then merged in order.
+        \param[in] parallel Bin the chunks in parallel. Otherwise they are binned one after the other, with the same result.
+        \param[in] begin First triangle.
+        \param[in] end One past the last triangle.
+        \param[in,out] bins Bins to fill. The initial values are used for every chunk.
+        \param[in] binTriangles Function binning the triangles [begin, end) into the bins pointed to.
+        \param[in] mergeBins Function merging the second bin into the first.
+    */
+    template<typename Bin, typename BinFunction, typename MergeFunction>
+    void fillBins(bool parallel, uint32_t begin, uint32_t end, std::vector<Bin>& bins, const BinFunction& binTriangles, const MergeFunction& mergeBins)
+    {
+        const uint32_t chunkCount = (end - begin + kBinningChunkSize - 1) / kBinningChunkSize;
+        if (chunkCount <= 1)
+        {
+            binTriangles(bins.data(), begin, end);
+            return;
+        }
+
+        const size_t binCount = bins.size();
+        std::vector<Bin> chunkBins(chunkCount * binCount);
+        auto binChunk = [&](uint32_t chunk)
+        {
+            Bin* pBins = chunkBins.data() + chunk * binCount;
+            std::copy(bins.begin(), bins.end(), pBins);
+            const uint32_t chunkBegin = begin + chunk * kBinningChunkSize;
+            binTriangles(pBins, chunkBegin, std::min(chunkBegin + kBinningChunkSize, end));
+        };
+        if (parallel) Threading::parallelFor(0u, chunkCount, binChunk, 1);
+        else for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) binChunk(chunk);
+
+        std::copy(chunkBins.begin(), chunkBins.begin() + binCount, bins.begin());
+        for (uint32_t chunk = 1; chunk < chunkCount; ++chunk)
+        {
+            for (size_t i = 0; i < binCount; ++i) mergeBins(bins[i], chunkBins[chunk * binCount + i]);
+        }
+    }
+
+    /** Returns the axis along which the box is the largest.
+    */
+    uint32_t getLargestDimension(const float3& dimensions)
+    {
+        return dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
+            2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
+    }
 }
 
 namespace Falcor
 {
     static_assert(sizeof(PackedNode) % 16 == 0, "PackedNode size should be a multiple of 16");
 
+    struct LightBVHBuilder::BuildScratch
+    {
+        std::vector<SimdBin> bins;              ///< Bins along the three axes, binCount per axis.
+        std::vector<float3> binConeDirections;  ///< Normalized lighting cone direction of each bin (SAOH only).
+        std::vector<float> binCosConeAngles;    ///< Lighting cone angle of each bin (SAOH only).
+        std::vector<uint32_t> triangleBinIds;   ///< Bin ids of each triangle of the node along the three axes (SAOH only).
+        std::vector<float> costs;               ///< Split costs along one axis.
+    };
+
     LightBVHBuilder::LightBVHBuilder(const Options& options) : mOptions(options)
     {
     }
@@ -287,7 +446,9 @@ namespace Falcor
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        BuildOutput output{ data.nodes, data.triangleIndices };
+        BuildScratch scratch;
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, output, scratch);
         FALCOR_ASSERT(!data.nodes.empty());
 
         size_t numValid = 0;
@@ -349,24 +510,29 @@ namespace Falcor
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, BuildOutput& output, BuildScratch& scratch)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
-        float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        std::vector<SimdBin>& nodeSums = scratch.bins;
+        nodeSums.assign(1, SimdBin());
+        fillBins(options.parallelBuild, triangleRange.begin, triangleRange.end, nodeSums, [&](SimdBin* pSums, uint32_t begin, uint32_t end)
         {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+            for (uint32_t dataIndex = begin; dataIndex < end; ++dataIndex)
+            {
+                __m128 pMin, pMax;
+                loadAABB(data.trianglesData[dataIndex].bounds, pMin, pMax);
+                pSums->bounds.include(pMin, pMax);
+                pSums->flux += data.trianglesData[dataIndex].flux;
+            }
+        }, [](SimdBin& dst, const SimdBin& src) { dst.merge(src); });
+        const float nodeFlux = nodeSums[0].flux;
+        const AABB nodeBounds = nodeSums[0].bounds.toAABB();
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options, scratch) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -378,9 +544,9 @@ namespace Falcor
             std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(output.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)output.nodes.size();
+            output.nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -394,13 +560,54 @@ namespace Falcor
                 FALCOR_THROW("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftIndex, rightIndex;
+            if (options.parallelBuild && std::min(leftRange.length(), rightRange.length()) >= kMinParallelSubtreeTriangleCount)
+            {
+                // Build the right subtree in a separate task while this task builds the left one, then append it.
+                // The subtrees work on disjoint triangle ranges and write the bitmasks of disjoint triangles.
+                std::vector<PackedNode> rightNodes;
+                std::vector<uint32_t> rightTriangleIndices;
+                TaskGroup rightTask;
+                rightTask.run([&]()
+                {
+                    BuildOutput rightOutput{ rightNodes, rightTriangleIndices };
+                    BuildScratch rightScratch;
+                    buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, rightOutput, rightScratch);
+                });
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, output, scratch);
+                rightTask.wait();
+
+                // Offset the node indices and triangle offsets of the right subtree.
+                // Both live in the low bits of the first dword; patching it directly avoids requantizing the packed attributes.
+                rightIndex = (uint32_t)output.nodes.size();
+                const uint32_t triangleOffset = (uint32_t)output.triangleIndices.size();
+                for (PackedNode& rightNode : rightNodes)
+                {
+                    if (rightNode.isLeaf())
+                    {
+                        FALCOR_ASSERT(rightNode.getLeafNode().triangleOffset + triangleOffset < kMaxLeafTriangleOffset);
+                        rightNode.data[0].x += triangleOffset;
+                    }
+                    else
+                    {
+                        rightNode.data[0].x += rightIndex;
+                    }
+                }
+                output.nodes.insert(output.nodes.end(), rightNodes.begin(), rightNodes.end());
+                output.triangleIndices.insert(output.triangleIndices.end(), rightTriangleIndices.begin(), rightTriangleIndices.end());
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, output, scratch);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, output, scratch);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            output.nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -408,9 +615,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(output.nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)output.nodes.size();
+            output.nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -420,19 +627,19 @@ namespace Falcor
             node.attribs.cosConeAngle = cosTheta;
 
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = (uint32_t)output.triangleIndices.size();
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
             for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
+                output.triangleIndices.push_back(globalTriangleIndex);
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
+            FALCOR_ASSERT(output.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            output.nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
@@ -497,7 +704,7 @@ namespace Falcor
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/, BuildScratch& /*scratch*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -524,79 +731,71 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& parameters, BuildScratch& scratch)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
 
-        struct Bin
-        {
-            AABB bounds;
-            uint32_t triangleCount = 0;
+        FALCOR_ASSERT(parameters.binCount > 1);
+        const uint32_t binCount = parameters.binCount;
 
-            Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1) {}
-            Bin& operator|= (const Bin& rhs)
+        // Only bin along the dimensions that are evaluated.
+        const uint32_t firstDimension = parameters.splitAlongLargest ? getLargestDimension(nodeBounds.extent()) : 0;
+        const uint32_t lastDimension = parameters.splitAlongLargest ? firstDimension : 2;
+
+        // Bin the triangles along all dimensions in a single pass, storing only the aggregate parameters (triangle count and bounds).
+        const BinMapping binMapping(nodeBounds, binCount);
+        std::vector<SimdBin>& bins = scratch.bins;
+        bins.assign(3 * binCount, SimdBin());
+        fillBins(parameters.parallelBuild, triangleRange.begin, triangleRange.end, bins, [&](SimdBin* pBins, uint32_t begin, uint32_t end)
+        {
+            alignas(16) int32_t binIds[4];
+            for (uint32_t i = begin; i < end; ++i)
             {
-                bounds |= rhs.bounds;
-                triangleCount += rhs.triangleCount;
-                return *this;
+                __m128 pMin, pMax;
+                loadAABB(data.trianglesData[i].bounds, pMin, pMax);
+                _mm_store_si128(reinterpret_cast<__m128i*>(binIds), binMapping.getBinIds(pMin, pMax));
+                for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
+                {
+                    SimdBin& bin = pBins[dimension * binCount + binIds[dimension]];
+                    bin.bounds.include(pMin, pMax);
+                    ++bin.triangleCount;
+                }
             }
-        };
+        }, [](SimdBin& dst, const SimdBin& src) { dst.merge(src); });
 
-        FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        std::vector<float>& costs = scratch.costs;
+        costs.resize(binCount - 1);
 
         /** Helper function that computes the best split along the given dimension using the SAH metric.
-            The triangles are binned to n bins, storing only the aggregate parameters (triangle count and bounds).
-            Then the cost metric is evaluated for each of the n-1 potential splits.
+            The cost metric is evaluated for each of the n-1 potential splits between the n bins.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds](uint32_t dimension)
+        const auto evalAlongDimension = [&](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
-            {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                FALCOR_ASSERT(bmin < bmax);
-                float scale = (float)parameters.binCount / (bmax - bmin);
-                float p = td.bounds.center()[dimension];
-                FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
-
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
-            // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            const SimdBin* pBins = bins.data() + dimension * binCount;
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
-            Bin total = Bin();
+            SimdBin total;
             for (std::size_t i = 0; i < costs.size(); ++i)
             {
-                total |= bins[i];
-                costs[i] = evalSAH(total.bounds, total.triangleCount, parameters);
+                total.merge(pBins[i]);
+                costs[i] = evalSAH(total.bounds.toAABB(), total.triangleCount, parameters);
             }
 
             // Then, compute A_j(R) * N_j(R) by sweeping over the bins from right to left.
-            total = Bin();
+            total = SimdBin();
             for (std::size_t i = costs.size(); i > 0; --i)
             {
-                total |= bins[i];
-                costs[i - 1] += evalSAH(total.bounds, total.triangleCount, parameters);
+                total.merge(pBins[i]);
+                costs[i - 1] += evalSAH(total.bounds.toAABB(), total.triangleCount, parameters);
             }
 
             // Compute the cheapest split along the current dimension.
             std::pair<float, SplitResult> axisBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult{ dimension, 0 });
             for (uint32_t i = 0, triIdx = triangleRange.begin; i < costs.size(); ++i)
             {
-                triIdx += bins[i].triangleCount;
+                triIdx += pBins[i].triangleCount;
                 if (costs[i] < axisBestSplit.first)
                 {
                     axisBestSplit = std::make_pair(costs[i], SplitResult{ dimension, triIdx });
@@ -615,21 +814,9 @@ namespace Falcor
             }
         };
 
-        if (parameters.splitAlongLargest)
+        for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
         {
-            // Find the largest dimension.
-            float3 dimensions = nodeBounds.extent();
-            uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
-                2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
-
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
+            evalAlongDimension(dimension);
         }
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
@@ -637,7 +824,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, 0.f, parameters, scratch);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -679,136 +866,155 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters, BuildScratch& scratch)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
 
         // Find the largest dimension.
-        float3 dimensions = nodeBounds.extent();
-        uint32_t largestDimension = dimensions[2] >= dimensions[0] && dimensions[2] >= dimensions[1] ?
-            2 : (dimensions[1] >= dimensions[0] && dimensions[1] >= dimensions[2] ? 1 : 0);
+        const float3 dimensions = nodeBounds.extent();
+        const uint32_t largestDimension = getLargestDimension(dimensions);
 
-        struct Bin
+        FALCOR_ASSERT(parameters.binCount > 1);
+        const uint32_t binCount = parameters.binCount;
+
+        // Only bin along the dimensions that are evaluated.
+        const uint32_t firstDimension = parameters.splitAlongLargest ? largestDimension : 0;
+        const uint32_t lastDimension = parameters.splitAlongLargest ? largestDimension : 2;
+
+        // Bin the triangles along all dimensions in a single pass, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
+        // The bin ids are kept for computing the bin cone angles in a second pass.
+        const BinMapping binMapping(nodeBounds, binCount);
+        std::vector<SimdBin>& bins = scratch.bins;
+        bins.assign(3 * binCount, SimdBin());
+        std::vector<uint32_t>& triangleBinIds = scratch.triangleBinIds;
+        triangleBinIds.resize(3 * (size_t)triangleRange.length());
+        fillBins(parameters.parallelBuild, triangleRange.begin, triangleRange.end, bins, [&](SimdBin* pBins, uint32_t begin, uint32_t end)
         {
-            AABB bounds;
-            uint32_t triangleCount = 0;
-            float flux = 0.0f;
-            float3 coneDirection = float3(0.0f);
-            float cosConeAngle = 1.0f;
-
-            Bin() = default;
-            Bin(const TriangleSortData& tri) : bounds(tri.bounds), triangleCount(1), flux(tri.flux), coneDirection(tri.coneDirection), cosConeAngle(tri.cosConeAngle) {}
-            Bin& operator|= (const Bin& rhs)
+            alignas(16) int32_t binIds[4];
+            for (uint32_t i = begin; i < end; ++i)
             {
-                bounds |= rhs.bounds;
-                triangleCount += rhs.triangleCount;
-                flux += rhs.flux;
-                coneDirection += rhs.coneDirection;
-                // Note: cosConeAngle should be computed separately after the final cone direction is known
-                return *this;
+                const TriangleSortData& td = data.trianglesData[i];
+                __m128 pMin, pMax;
+                loadAABB(td.bounds, pMin, pMax);
+                // The fourth lane holds cosConeAngle and is ignored.
+                const __m128 coneDirection = _mm_loadu_ps(&td.coneDirection.x);
+                _mm_store_si128(reinterpret_cast<__m128i*>(binIds), binMapping.getBinIds(pMin, pMax));
+
+                uint32_t* pTriangleBinIds = &triangleBinIds[3 * (size_t)(i - triangleRange.begin)];
+                for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
+                {
+                    SimdBin& bin = pBins[dimension * binCount + binIds[dimension]];
+                    bin.bounds.include(pMin, pMax);
+                    bin.coneDirection = _mm_add_ps(bin.coneDirection, coneDirection);
+                    bin.flux += td.flux;
+                    ++bin.triangleCount;
+                    pTriangleBinIds[dimension] = binIds[dimension];
+                }
             }
-        };
+        }, [](SimdBin& dst, const SimdBin& src) { dst.merge(src); });
+
+        // Compute the lighting cones for each bin.
+        // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
+        // If the vector is zero length (no lights or if all directions cancelled out), the cone is marked as invalid.
+        // TODO: Switch to a more sophisticated algorithm to get narrower cones.
+        std::vector<float3>& binConeDirections = scratch.binConeDirections;
+        std::vector<float>& binCosConeAngles = scratch.binCosConeAngles;
+        binConeDirections.resize(3 * binCount);
+        binCosConeAngles.resize(3 * binCount);
+        for (uint32_t binIndex = 0; binIndex < 3 * binCount; ++binIndex)
+        {
+            const float3 coneDirection = toFloat3(bins[binIndex].coneDirection);
+            binCosConeAngles[binIndex] = length(coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
+            binConeDirections[binIndex] = normalize(coneDirection);
+        }
+        fillBins(parameters.parallelBuild, triangleRange.begin, triangleRange.end, binCosConeAngles, [&](float* pCosConeAngles, uint32_t begin, uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const TriangleSortData& td = data.trianglesData[i];
+                const uint32_t* pTriangleBinIds = &triangleBinIds[3 * (size_t)(i - triangleRange.begin)];
+                for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
+                {
+                    const uint32_t binIndex = dimension * binCount + pTriangleBinIds[dimension];
+                    pCosConeAngles[binIndex] = computeCosConeAngle(binConeDirections[binIndex], pCosConeAngles[binIndex], td.coneDirection, td.cosConeAngle);
+                }
+            }
+        }, [](float& dst, float src)
+        {
+            // Growing a cone takes the minimum cosine, and an invalid cone stays invalid.
+            dst = dst == kInvalidCosConeAngle || src == kInvalidCosConeAngle ? kInvalidCosConeAngle : std::min(dst, src);
+        });
 
-        FALCOR_ASSERT(parameters.binCount > 1);
-        std::vector<Bin> bins(parameters.binCount);
-        std::vector<float> costs(parameters.binCount - 1);
+        std::vector<float>& costs = scratch.costs;
+        costs.resize(binCount - 1);
 
         /** Helper function that computes the best split along the given dimension using the SAOH metric.
-            The triangles are binned to n bins, storing only the aggregate parameters (triangle count, bounds, flux, and cone direction).
-            Then the cost metric is evaluated for each of the n-1 potential splits.
+            The cost metric is evaluated for each of the n-1 potential splits between the n bins.
             Note that while the bounds and flux are accurately represented by the aggregated parameters,
             the bounding cones are approximates based on the bins' bounding cones. This is less expensive,
             but also less precise than computing them directly from the triangles.
         */
-        const auto binAlongDimension = [&bins, &costs, &triangleRange, &data, &parameters, &overallBestSplit, &nodeBounds, largestDimension, dimensions](uint32_t dimension)
+        const auto evalAlongDimension = [&](uint32_t dimension)
         {
-            // Helper to compute the bin id for a given triangle.
-            auto getBinId = [&](const TriangleSortData& td)
-            {
-                float bmin = nodeBounds.minPoint[dimension], bmax = nodeBounds.maxPoint[dimension];
-                float w = bmax - bmin;
-                FALCOR_ASSERT(w >= 0.f); // The node bounds can be zero if all primitives are axis-aligned and coplanar
-                float scale = w > FLT_MIN ? (float)parameters.binCount / w : 0.f;
-                float p = td.bounds.center()[dimension];
-                FALCOR_ASSERT(bmin <= p && p <= bmax);
-                return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
-            };
-
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
-            // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
-
-            // Compute the lighting cones for each bin.
-            // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
-            // If the vector is zero length (no lights or if all directions cancelled out), the cone is marked as invalid.
-            // TODO: Switch to a more sophisticated algorithm to get narrower cones.
-            for (Bin& bin : bins)
-            {
-                bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
-                bin.coneDirection = normalize(bin.coneDirection);
-            }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
-            }
+            const uint32_t binOffset = dimension * binCount;
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
-            Bin total = Bin();
-            for (std::size_t i = 0; i < costs.size(); ++i)
+            SimdAABB totalBounds;
+            float totalFlux = 0.f;
+            float3 totalConeDirection = float3(0.f);
+            for (uint32_t i = 0; i < costs.size(); ++i)
             {
-                total |= bins[i];
+                totalBounds.include(bins[binOffset + i].bounds);
+                totalFlux += bins[binOffset + i].flux;
+                totalConeDirection += binConeDirections[binOffset + i];
 
                 // Compute the bounding cone angle for the union of bins 0..i.
                 float cosTheta = kInvalidCosConeAngle;
-                if (length(total.coneDirection) >= FLT_MIN)
+                if (length(totalConeDirection) >= FLT_MIN)
                 {
                     cosTheta = 1.f;
-                    float3 coneDir = normalize(total.coneDirection);
-                    for (std::size_t j = 0; j <= i; ++j)
+                    float3 coneDir = normalize(totalConeDirection);
+                    for (uint32_t j = 0; j <= i; ++j)
                     {
-                        cosTheta = computeCosConeAngle(coneDir, cosTheta, bins[j].coneDirection, bins[j].cosConeAngle);
+                        cosTheta = computeCosConeAngle(coneDir, cosTheta, binConeDirections[binOffset + j], binCosConeAngles[binOffset + j]);
                     }
                 }
 
-                costs[i] = evalSAOH(total.bounds, total.flux, cosTheta, parameters);
+                costs[i] = evalSAOH(totalBounds.toAABB(), totalFlux, cosTheta, parameters);
             }
 
             // Then, compute A_j(R) * N_j(R) by sweeping over the bins from right to left.
-            total = Bin();
-            for (std::size_t i = costs.size(); i > 0; --i)
+            totalBounds = SimdAABB();
+            totalFlux = 0.f;
+            totalConeDirection = float3(0.f);
+            for (uint32_t i = (uint32_t)costs.size(); i > 0; --i)
             {
-                total |= bins[i];
+                totalBounds.include(bins[binOffset + i].bounds);
+                totalFlux += bins[binOffset + i].flux;
+                totalConeDirection += binConeDirections[binOffset + i];
 
                 // Compute the bounding cone angle for the union of bins i..n-1.
                 float cosTheta = kInvalidCosConeAngle;
-                if (length(total.coneDirection) >= FLT_MIN)
+                if (length(totalConeDirection) >= FLT_MIN)
                 {
                     cosTheta = 1.f;
-                    float3 coneDir = normalize(total.coneDirection);
-                    for (std::size_t j = i; j <= costs.size(); ++j)
+                    float3 coneDir = normalize(totalConeDirection);
+                    for (uint32_t j = i; j <= costs.size(); ++j)
                     {
-                        cosTheta = computeCosConeAngle(coneDir, cosTheta, bins[j].coneDirection, bins[j].cosConeAngle);
+                        cosTheta = computeCosConeAngle(coneDir, cosTheta, binConeDirections[binOffset + j], binCosConeAngles[binOffset + j]);
                     }
                 }
 
-                costs[i - 1] += evalSAOH(total.bounds, total.flux, cosTheta, parameters);
+                costs[i - 1] += evalSAOH(totalBounds.toAABB(), totalFlux, cosTheta, parameters);
             }
 
             // Compute the cheapest split along the current dimension.
             std::pair<float, SplitResult> axisBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult{ dimension, 0 });
             for (uint32_t i = 0, triIdx = triangleRange.begin; i < costs.size(); ++i)
             {
-                triIdx += bins[i].triangleCount;
+                triIdx += bins[binOffset + i].triangleCount;
                 if (costs[i] < axisBestSplit.first)
                 {
                     axisBestSplit = std::make_pair(costs[i], SplitResult{ dimension, triIdx });
@@ -831,16 +1037,9 @@ namespace Falcor
         };
 
         // Compute the best split.
-        if (parameters.splitAlongLargest)
+        for (uint32_t dimension = firstDimension; dimension <= lastDimension; ++dimension)
         {
-            binAlongDimension(largestDimension);
-        }
-        else
-        {
-            for (uint32_t dimension = 0; dimension < 3; ++dimension)
-            {
-                binAlongDimension(dimension);
-            }
+            evalAlongDimension(dimension);
         }
 
         // If we couldn't find a valid split, create leaf node immediately if possible or revert to equal splitting.
@@ -848,7 +1047,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters, scratch);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -858,7 +1057,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
@@ -31,6 +31,7 @@
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Scene/Transform.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -159,19 +160,7 @@ namespace Falcor
     {
         FALCOR_ASSERT(!mKeyframes.empty());
 
-        // Validate cached frame index.
-        size_t frameIndex = std::clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
-
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
-        {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
-        }
-
-        // Cache frame index;
-        mCachedFrameIndex = frameIndex;
+        const size_t frameIndex = findFrameIndex(time);
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
@@ -218,6 +207,32 @@ namespace Falcor
         }
     }
 
+    // Returns the index of the last keyframe at or before the given time, or 0 if the time is before the first keyframe.
+    size_t Animation::findFrameIndex(double time) const
+    {
+        FALCOR_ASSERT(!mKeyframes.empty());
+        const size_t lastIndex = mKeyframes.size() - 1;
+        auto isInSegment = [&](size_t i) { return mKeyframes[i].time <= time && (i == lastIndex || time < mKeyframes[i + 1].time); };
+
+        // Check the cached segment and the next one first, as the time usually moves forward by less than a segment per frame.
+        size_t frameIndex = std::min(mCachedFrameIndex, lastIndex);
+        if (!isInSegment(frameIndex))
+        {
+            if (frameIndex < lastIndex && isInSegment(frameIndex + 1))
+            {
+                frameIndex++;
+            }
+            else
+            {
+                auto it = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), time, [](double t, const Keyframe& k) { return t < k.time; });
+                frameIndex = it == mKeyframes.begin() ? 0 : size_t(it - mKeyframes.begin()) - 1;
+            }
+        }
+
+        mCachedFrameIndex = frameIndex;
+        return frameIndex;
+    }
+
     // Calculates the sample time within the keyframe range if the current time lies outside and
     // the animation does not behave linearly. If the animation behaves linearly, then the
     // current time is returned. This function should not be used if the current time lies
@@ -257,59 +272,41 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
-        {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
-        }
-        else if (mKeyframes.back().time < keyframe.time)
+        auto it = std::lower_bound(mKeyframes.begin(), mKeyframes.end(), keyframe.time, [](const Keyframe& k, double t) { return k.time < t; });
+
+        // If we already have a key-frame at the same time, replace it.
+        if (it != mKeyframes.end() && it->time == keyframe.time) *it = keyframe;
+        else mKeyframes.insert(it, keyframe);
+    }
+
+    void Animation::setKeyframes(std::vector<Keyframe> keyframes)
+    {
+        // Keep the last of the keyframes with the same time, like successive calls to addKeyframe().
+        std::stable_sort(keyframes.begin(), keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+
+        mKeyframes.clear();
+        mKeyframes.reserve(keyframes.size());
+        for (const auto& keyframe : keyframes)
         {
-            mKeyframes.push_back(keyframe);
+            FALCOR_ASSERT(keyframe.time <= mDuration);
+            if (!mKeyframes.empty() && mKeyframes.back().time == keyframe.time) mKeyframes.back() = keyframe;
+            else mKeyframes.push_back(keyframe);
         }
-        else
-        {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
-
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
 
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
-        }
+        mCachedFrameIndex = 0;
     }
 
     const Animation::Keyframe& Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
-        FALCOR_THROW("'time' ({}) does not refer to an existing keyframe", time);
+        auto it = std::lower_bound(mKeyframes.begin(), mKeyframes.end(), time, [](const Keyframe& k, double t) { return k.time < t; });
+        if (it == mKeyframes.end() || it->time != time) FALCOR_THROW("'time' ({}) does not refer to an existing keyframe", time);
+        return *it;
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        auto it = std::lower_bound(mKeyframes.begin(), mKeyframes.end(), time, [](const Keyframe& k, double t) { return k.time < t; });
+        return it != mKeyframes.end() && it->time == time;
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
@@ -348,5 +345,14 @@ namespace Falcor
             Animation::Keyframe keyframe{ time, transform.getTranslation(), transform.getScaling(), transform.getRotation() };
             pAnimation->addKeyframe(keyframe);
         });
+        animation.def("setKeyframes", [] (Animation* pAnimation, const std::vector<double>& times, const std::vector<Transform>& transforms) {
+            FALCOR_CHECK(times.size() == transforms.size(), "'times' and 'transforms' must have the same size.");
+            std::vector<Animation::Keyframe> keyframes(times.size());
+            for (size_t i = 0; i < times.size(); i++)
+            {
+                keyframes[i] = { times[i], transforms[i].getTranslation(), transforms[i].getScaling(), transforms[i].getRotation() };
+            }
+            pAnimation->setKeyframes(std::move(keyframes));
+        }, "times"_a, "transforms"_a);
     }
 }
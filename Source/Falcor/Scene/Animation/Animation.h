@@ -131,6 +131,13 @@ namespace Falcor
         */
         void addKeyframe(const Keyframe& keyframe);
 
+        /** Replace all the keyframes.
+            The keyframes don't need to be sorted. If several keyframes have the same time, the last one is kept, as with addKeyframe().
+            This sorts the keyframes once, so it should be preferred over addKeyframe() for long animations.
+            \param[in] keyframes Keyframes.
+        */
+        void setKeyframes(std::vector<Keyframe> keyframes);
+
         /** Get the keyframe at the specified time.
             If the keyframe doesn't exists, the function will throw an exception. If you don't want to handle exceptions, call doesKeyframeExist() first.
             \param[in] time Time of the keyframe.
@@ -161,6 +168,7 @@ namespace Falcor
 
     private:
         Keyframe interpolate(InterpolationMode mode, double time) const;
+        size_t findFrameIndex(double time) const;
         double calcSampleTime(double currentTime);
 
         std::string mName;
@@ -173,8 +181,8 @@ namespace Falcor
         InterpolationMode mInterpolationMode = InterpolationMode::Linear;
         bool mEnableWarping = false;
 
-        std::vector<Keyframe> mKeyframes;
-        mutable size_t mCachedFrameIndex = 0;
+        std::vector<Keyframe> mKeyframes; // Sorted by time.
+        mutable size_t mCachedFrameIndex = 0; // Segment found by the last lookup, checked first on the next one.
 
         friend class SceneCache;
     };
@@ -27,8 +27,11 @@
  **************************************************************************/
 #include "AnimationController.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Math/MatrixBatch.h"
 #include "Utils/Timing/Profiler.h"
+#include "Utils/Threading.h"
 #include "Scene/Scene.h"
+#include <algorithm>
 #include <fstream>
 
 namespace Falcor
@@ -39,6 +42,9 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        const size_t kUpdateGrainSize = 1024;   ///< Minimum number of nodes updated per task.
+        const size_t kMaxUploadGap = 16;        ///< Maximum number of unchanged matrices uploaded to merge two ranges of changed matrices.
     }
 
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
@@ -85,6 +91,7 @@ namespace Falcor
         }
 
         createSkinningPass(skinningVertexData);
+        initSceneGraphLevels();
 
         // Determine length of global animation loop.
         for (const auto& pAnimation : mAnimations)
@@ -192,6 +199,44 @@ namespace Falcor
         }
     }
 
+    void AnimationController::initSceneGraphLevels()
+    {
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const uint32_t nodeCount = (uint32_t)sceneGraph.size();
+
+        // Parents are stored before their children, so the levels are known in a single pass.
+        uint32_t levelCount = 0;
+        mNodeLevels.resize(nodeCount);
+        mChildOffsets.assign(nodeCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            const NodeID parentID = sceneGraph[i].parent;
+            FALCOR_CHECK(parentID == NodeID::Invalid() || parentID.get() < i, "Scene graph node {} is stored before its parent.", i);
+
+            mNodeLevels[i] = parentID != NodeID::Invalid() ? mNodeLevels[parentID.get()] + 1 : 0;
+            levelCount = std::max(levelCount, mNodeLevels[i] + 1);
+            if (parentID != NodeID::Invalid()) mChildOffsets[parentID.get() + 1]++;
+        }
+
+        // Group the children by parent and the nodes by level with a counting sort.
+        mLevelOffsets.assign(levelCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; i++) mLevelOffsets[mNodeLevels[i] + 1]++;
+        for (uint32_t level = 0; level < levelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+        for (uint32_t i = 0; i < nodeCount; i++) mChildOffsets[i + 1] += mChildOffsets[i];
+
+        mLevelNodes.resize(nodeCount);
+        mChildren.resize(mChildOffsets[nodeCount]);
+        std::vector<uint32_t> levelFill(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        std::vector<uint32_t> childFill(mChildOffsets.begin(), mChildOffsets.end() - 1);
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            mLevelNodes[levelFill[mNodeLevels[i]]++] = i;
+            if (sceneGraph[i].parent != NodeID::Invalid()) mChildren[childFill[sceneGraph[i].parent.get()]++] = i;
+        }
+
+        mDirtyLevelNodes.resize(levelCount);
+    }
+
     bool AnimationController::animate(RenderContext* pRenderContext, double currentTime)
     {
         FALCOR_PROFILE(pRenderContext, "animate");
@@ -200,17 +245,14 @@ namespace Falcor
 
         // Check for edited scene nodes and update local matrices.
         const auto& sceneGraph = mpScene->mSceneGraph;
-        bool edited = false;
-        for (size_t i = 0; i < sceneGraph.size(); ++i)
+        bool edited = !mEditedNodes.empty();
+        for (uint32_t nodeID : mEditedNodes)
         {
-            if (mNodesEdited[i])
-            {
-                mLocalMatrices[i] = sceneGraph[i].transform;
-                mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
-                edited = true;
-            }
+            mLocalMatrices[nodeID] = sceneGraph[nodeID].transform;
+            mNodesEdited[nodeID] = false;
+            mChangedNodes.push_back(nodeID);
         }
+        mEditedNodes.clear();
 
         bool changed = false;
         double time = mLoopAnimations ? std::fmod(currentTime, mGlobalAnimationLength) : currentTime;
@@ -296,39 +338,109 @@ namespace Falcor
             NodeID nodeID = pAnimation->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
             mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
-            mMatricesChanged[nodeID.get()] = true;
+            mChangedNodes.push_back(nodeID.get());
         }
     }
 
     void AnimationController::updateWorldMatrices(bool updateAll)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
-
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        if (updateAll)
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            // The caller flags all matrices as changed.
+            for (size_t level = 0; level + 1 < mLevelOffsets.size(); level++)
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
+                updateNodeMatrices(&mLevelNodes[mLevelOffsets[level]], mLevelOffsets[level + 1] - mLevelOffsets[level]);
             }
+            mChangedNodes.clear();
+            return;
+        }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+        // Update the changed nodes and their descendants only. The descendants are collected one level at a time.
+        mUpdatedNodes.clear();
+        for (uint32_t nodeID : mChangedNodes)
+        {
+            if (mMatricesChanged[nodeID]) continue;
+            mMatricesChanged[nodeID] = true;
+            mDirtyLevelNodes[mNodeLevels[nodeID]].push_back(nodeID);
+        }
+        mChangedNodes.clear();
 
-            mGlobalMatrices[i] = mLocalMatrices[i];
+        for (size_t level = 0; level < mDirtyLevelNodes.size(); level++)
+        {
+            auto& nodes = mDirtyLevelNodes[level];
+            if (nodes.empty()) continue;
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
+            for (uint32_t nodeID : nodes)
             {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
+                for (uint32_t i = mChildOffsets[nodeID]; i < mChildOffsets[nodeID + 1]; i++)
+                {
+                    const uint32_t childID = mChildren[i];
+                    if (mMatricesChanged[childID]) continue;
+                    mMatricesChanged[childID] = true;
+                    mDirtyLevelNodes[level + 1].push_back(childID);
+                }
             }
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+            updateNodeMatrices(nodes.data(), nodes.size());
+            mUpdatedNodes.insert(mUpdatedNodes.end(), nodes.begin(), nodes.end());
+            nodes.clear();
+        }
+
+        std::sort(mUpdatedNodes.begin(), mUpdatedNodes.end());
+    }
+
+    void AnimationController::updateNodeMatrices(const uint32_t* nodes, size_t count)
+    {
+        // The nodes all belong to the same level, so their parents are up to date and they don't depend on each other.
+        // The matrices are gathered through pointers and computed in SIMD batches.
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const bool updateSkinning = mpSkinningPass != nullptr;
+        static const float4x4 kIdentity = float4x4::identity();
 
-            if (mpSkinningPass)
+        auto updateRange = [&](size_t begin, size_t end)
+        {
+            const size_t kBatchSize = 64;
+            const float4x4* parentMatrices[kBatchSize];
+            const float4x4* localMatrices[kBatchSize];
+            const float4x4* localToBindMatrices[kBatchSize];
+            float4x4* globalMatrices[kBatchSize];
+            float4x4* invTransposeGlobalMatrices[kBatchSize];
+            float4x4* skinningMatrices[kBatchSize];
+            float4x4* invTransposeSkinningMatrices[kBatchSize];
+
+            for (size_t batchBegin = begin; batchBegin < end; batchBegin += kBatchSize)
             {
-                mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
+                const size_t batchCount = std::min(end - batchBegin, kBatchSize);
+                for (size_t i = 0; i < batchCount; i++)
+                {
+                    const uint32_t nodeID = nodes[batchBegin + i];
+                    const NodeID parentID = sceneGraph[nodeID].parent;
+
+                    // Root nodes are multiplied by the identity, which leaves their local matrix unchanged.
+                    parentMatrices[i] = parentID != NodeID::Invalid() ? &mGlobalMatrices[parentID.get()] : &kIdentity;
+                    localMatrices[i] = &mLocalMatrices[nodeID];
+                    globalMatrices[i] = &mGlobalMatrices[nodeID];
+                    invTransposeGlobalMatrices[i] = &mInvTransposeGlobalMatrices[nodeID];
+
+                    if (updateSkinning)
+                    {
+                        localToBindMatrices[i] = &sceneGraph[nodeID].localToBindSpace;
+                        skinningMatrices[i] = &mSkinningMatrices[nodeID];
+                        invTransposeSkinningMatrices[i] = &mInvTransposeSkinningMatrices[nodeID];
+                    }
+                }
+
+                math::mulBatch(batchCount, parentMatrices, localMatrices, globalMatrices);
+                math::inverseTransposeAffineBatch(batchCount, globalMatrices, invTransposeGlobalMatrices);
+
+                if (updateSkinning)
+                {
+                    math::mulBatch(batchCount, globalMatrices, localToBindMatrices, skinningMatrices);
+                    math::inverseTransposeAffineBatch(batchCount, skinningMatrices, invTransposeSkinningMatrices);
+                }
             }
-        }
+        };
+        Threading::parallelForRange(0, count, updateRange, kUpdateGrainSize);
     }
 
     void AnimationController::uploadWorldMatrices(bool uploadAll)
@@ -343,25 +455,31 @@ namespace Falcor
             // Upload all matrices.
             mpWorldMatricesBuffer->setBlob(mGlobalMatrices.data(), 0, mpWorldMatricesBuffer->getSize());
             mpInvTransposeWorldMatricesBuffer->setBlob(mInvTransposeGlobalMatrices.data(), 0, mpInvTransposeWorldMatricesBuffer->getSize());
+            mUpdatedNodes.clear();
+            mPrevUpdatedNodes.clear();
         }
         else
         {
-            // Upload changed matrices only.
-            for (size_t i = 0; i < mGlobalMatrices.size();)
-            {
-                // Detect ranges of consecutive matrices that have all changed or not.
-                size_t offset = i;
-                bool changed = mMatricesChanged[i];
-                while (i < mGlobalMatrices.size() && mMatricesChanged[i] == changed) ++i;
+            // Upload changed matrices only. The current and previous buffers are swapped every frame, so the matrices that
+            // changed in the previous frame are also stale in the buffer that now holds the current frame.
+            std::vector<uint32_t> dirtyNodes;
+            dirtyNodes.reserve(mUpdatedNodes.size() + mPrevUpdatedNodes.size());
+            std::set_union(mUpdatedNodes.begin(), mUpdatedNodes.end(), mPrevUpdatedNodes.begin(), mPrevUpdatedNodes.end(), std::back_inserter(dirtyNodes));
 
-                // Upload range of changed matrices.
-                if (changed)
-                {
-                    size_t count = i - offset;
-                    mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                    mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                }
+            for (size_t i = 0; i < dirtyNodes.size();)
+            {
+                // Detect ranges of changed matrices. Small gaps are uploaded too, to reduce the number of copies.
+                const size_t offset = dirtyNodes[i];
+                size_t last = offset;
+                while (i < dirtyNodes.size() && dirtyNodes[i] <= last + kMaxUploadGap + 1) last = dirtyNodes[i++];
+
+                const size_t count = last + 1 - offset;
+                mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
+                mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
             }
+
+            std::swap(mPrevUpdatedNodes, mUpdatedNodes);
+            mUpdatedNodes.clear();
         }
     }
 
@@ -101,7 +101,12 @@ namespace Falcor
         /** Mark a scene node as being edited externally.
             Ensures that all global matrices depending on this scene node are updated.
         */
-        void setNodeEdited(size_t nodeID) { mNodesEdited[nodeID] = true; }
+        void setNodeEdited(size_t nodeID)
+        {
+            if (mNodesEdited[nodeID]) return;
+            mNodesEdited[nodeID] = true;
+            mEditedNodes.push_back((uint32_t)nodeID);
+        }
 
         /** Run the animation system.
             \return true if a change occurred, otherwise false.
@@ -149,8 +154,10 @@ namespace Falcor
         friend class Scene;
 
         void initLocalMatrices();
+        void initSceneGraphLevels();
         void updateLocalMatrices(double time);
         void updateWorldMatrices(bool updateAll = false);
+        void updateNodeMatrices(const uint32_t* nodes, size_t count);
         void uploadWorldMatrices(bool uploadAll = false);
 
         void bindBuffers();
@@ -163,11 +170,24 @@ namespace Falcor
         // Animation
         std::vector<ref<Animation>> mAnimations;
         std::vector<bool> mNodesEdited;
+        std::vector<uint32_t> mEditedNodes;         ///< Nodes flagged in mNodesEdited.
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
         std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
 
+        // Scene graph traversal. The world matrices are updated one level (depth in the scene graph) at a time,
+        // so that the nodes of a level are independent and can be processed in parallel batches.
+        std::vector<uint32_t> mNodeLevels;          ///< Level of each node.
+        std::vector<uint32_t> mLevelOffsets;        ///< Range of each level in mLevelNodes, with an extra entry for the end.
+        std::vector<uint32_t> mLevelNodes;          ///< Node indices sorted by level.
+        std::vector<uint32_t> mChildOffsets;        ///< Range of the children of each node in mChildren, with an extra entry for the end.
+        std::vector<uint32_t> mChildren;            ///< Child node indices grouped by parent.
+        std::vector<uint32_t> mChangedNodes;        ///< Nodes whose local matrix changed since the last update of the world matrices.
+        std::vector<std::vector<uint32_t>> mDirtyLevelNodes; ///< Nodes to update in each level, i.e., the changed nodes and their descendants.
+        std::vector<uint32_t> mUpdatedNodes;        ///< Nodes updated by the last incremental update, sorted.
+        std::vector<uint32_t> mPrevUpdatedNodes;    ///< Nodes updated by the incremental update before, sorted.
+
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
         bool mPrevEnabled = false;      ///< True if animations were enabled in previous frame.
@@ -0,0 +1,103 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "BlasGroupPlanner.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Falcor
+{
+    BlasGroupPlanner::Plan BlasGroupPlanner::plan(const std::vector<BlasSizes>& blases, uint64_t memoryBudget)
+    {
+        Plan plan;
+        plan.blasGroupIndices.resize(blases.size());
+        plan.resultByteOffsets.resize(blases.size());
+        plan.scratchByteOffsets.resize(blases.size());
+
+        // Place the largest BLASes first, as small ones are easier to fit in the remaining space.
+        std::vector<uint32_t> order(blases.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto totalSize = [&](uint32_t i) { return blases[i].resultByteSize + blases[i].scratchByteSize; };
+        std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return totalSize(a) > totalSize(b); });
+
+        for (uint32_t blasId : order)
+        {
+            const BlasSizes& blas = blases[blasId];
+
+            // Peak memory if the BLAS is added to a group with the given sizes. Zero sizes stand for a new group.
+            auto getPeak = [&](uint64_t groupResultSize, uint64_t groupScratchSize)
+            {
+                return std::max(plan.resultByteSize, groupResultSize + blas.resultByteSize) + std::max(plan.scratchByteSize, groupScratchSize + blas.scratchByteSize);
+            };
+
+            // Use the first group where the BLAS fits within the budget, or the peak reached so far if it's already above.
+            // If there is none, open a new group, unless adding to an existing group gives a lower peak.
+            const uint64_t limit = std::max(memoryBudget, plan.getPeakMemoryInBytes());
+            size_t groupIndex = plan.groups.size();
+            uint64_t bestPeak = getPeak(0, 0);
+            for (size_t i = 0; i < plan.groups.size(); i++)
+            {
+                uint64_t peak = getPeak(plan.groups[i].resultByteSize, plan.groups[i].scratchByteSize);
+                if (peak <= limit || (bestPeak > limit && peak < bestPeak))
+                {
+                    groupIndex = i;
+                    bestPeak = peak;
+                    if (peak <= limit) break;
+                }
+            }
+
+            if (groupIndex == plan.groups.size()) plan.groups.push_back({});
+            Group& group = plan.groups[groupIndex];
+            group.blasIndices.push_back(blasId);
+            group.resultByteSize += blas.resultByteSize;
+            group.scratchByteSize += blas.scratchByteSize;
+            plan.blasGroupIndices[blasId] = (uint32_t)groupIndex;
+            plan.resultByteSize = std::max(plan.resultByteSize, group.resultByteSize);
+            plan.scratchByteSize = std::max(plan.scratchByteSize, group.scratchByteSize);
+        }
+
+        // Lay out the BLASes of each group in index order.
+        for (Group& group : plan.groups)
+        {
+            std::sort(group.blasIndices.begin(), group.blasIndices.end());
+
+            uint64_t resultByteOffset = 0;
+            uint64_t scratchByteOffset = 0;
+            for (uint32_t blasId : group.blasIndices)
+            {
+                plan.resultByteOffsets[blasId] = resultByteOffset;
+                plan.scratchByteOffsets[blasId] = scratchByteOffset;
+                resultByteOffset += blases[blasId].resultByteSize;
+                scratchByteOffset += blases[blasId].scratchByteSize;
+            }
+            FALCOR_ASSERT(resultByteOffset == group.resultByteSize && scratchByteOffset == group.scratchByteSize);
+        }
+
+        return plan;
+    }
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Packing of BLASes into groups that are built one after the other to limit the memory used by the BLAS build.
+        All groups share one result buffer and one scratch buffer, each allocated for the largest group, so the peak memory
+        is the sum of the largest group result size and the largest group scratch size. The planner bin-packs the BLASes,
+        largest first, into the first group where they fit without raising that peak above the memory budget.
+        This class has no GPU dependency, so the packing can be tested and tuned with synthetic sizes.
+    */
+    class FALCOR_API BlasGroupPlanner
+    {
+    public:
+        /// Default memory budget for the intermediate buffers of the BLAS build (0.5GB).
+        static constexpr uint64_t kDefaultMemoryBudget = 1ull << 29;
+
+        /** Build memory requirements of one BLAS, including padding.
+        */
+        struct BlasSizes
+        {
+            uint64_t resultByteSize = 0;
+            uint64_t scratchByteSize = 0;
+        };
+
+        /** Describes a group of BLASes.
+        */
+        struct Group
+        {
+            std::vector<uint32_t> blasIndices;  ///< Indices of the BLASes in the group, in increasing order.
+            uint64_t resultByteSize = 0;        ///< Total result data size of the BLASes in the group.
+            uint64_t scratchByteSize = 0;       ///< Total scratch data size of the BLASes in the group.
+        };
+
+        /** Result of the planning.
+        */
+        struct Plan
+        {
+            std::vector<Group> groups;
+            std::vector<uint32_t> blasGroupIndices;     ///< Index of the group containing each BLAS.
+            std::vector<uint64_t> resultByteOffsets;    ///< Offset of each BLAS into the result buffer.
+            std::vector<uint64_t> scratchByteOffsets;   ///< Offset of each BLAS into the scratch buffer.
+            uint64_t resultByteSize = 0;                ///< Size of the result buffer shared by all groups.
+            uint64_t scratchByteSize = 0;               ///< Size of the scratch buffer shared by all groups.
+
+            /** Get the peak memory used by the intermediate buffers during the build.
+            */
+            uint64_t getPeakMemoryInBytes() const { return resultByteSize + scratchByteSize; }
+        };
+
+        /** Pack BLASes into groups.
+            The peak memory exceeds the budget only if a BLAS doesn't fit on its own, or if the result and scratch sizes of
+            two groups are unbalanced in opposite directions. Later groups are then filled up to that peak.
+            \param[in] blases Build memory requirements of each BLAS.
+            \param[in] memoryBudget Target peak memory in bytes. Smaller budgets give more groups, i.e. more build passes.
+            \return The groups and the buffer offsets of each BLAS.
+        */
+        static Plan plan(const std::vector<BlasSizes>& blases, uint64_t memoryBudget = kDefaultMemoryBudget);
+    };
+}
@@ -28,6 +28,8 @@
 #include "EnvMap.h"
 #include "Core/API/Device.h"
 #include "Core/Program/ShaderVar.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Image/StreamingImageReader.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
 
@@ -38,10 +40,14 @@ namespace Falcor
         return ref<EnvMap>(new EnvMap(pDevice, pTexture));
     }
 
-    ref<EnvMap> EnvMap::createFromFile(ref<Device> pDevice, const std::filesystem::path& path)
+    ref<EnvMap> EnvMap::createFromFile(ref<Device> pDevice, const std::filesystem::path& path, uint32_t maxResolution)
     {
         // Load environment map from file. Set it to generate mips and use linear color.
-        auto pTexture = Texture::createFromFile(pDevice, path, true, false);
+        // Large HDR maps are streamed, dropping the levels above the maximum resolution.
+        ref<Texture> pTexture;
+        if (maxResolution > 0 && StreamingImageReader::isSupported(path))
+            pTexture = ImageIO::loadTextureStreaming(pDevice, path, true, maxResolution);
+        if (!pTexture) pTexture = Texture::createFromFile(pDevice, path, true, false);
         if (!pTexture) return nullptr;
         return create(pDevice, pTexture);
     }
@@ -141,14 +147,14 @@ namespace Falcor
         using namespace pybind11::literals;
 
         pybind11::class_<EnvMap, ref<EnvMap>> envMap(m, "EnvMap");
-        auto createFromFile = [](const std::filesystem::path &path) {
-            ref<EnvMap> envMap = EnvMap::createFromFile(accessActivePythonSceneBuilder().getDevice(), getActiveAssetResolver().resolvePath(path));
+        auto createFromFile = [](const std::filesystem::path &path, uint32_t maxResolution) {
+            ref<EnvMap> envMap = EnvMap::createFromFile(accessActivePythonSceneBuilder().getDevice(), getActiveAssetResolver().resolvePath(path), maxResolution);
             if (!envMap)
                 FALCOR_THROW("Failed to load environment map from '{}'.", path);
             return envMap;
         };
-        envMap.def(pybind11::init(createFromFile), "path"_a); // PYTHONDEPRECATED
-        envMap.def_static("createFromFile", createFromFile, "path"_a);
+        envMap.def(pybind11::init(createFromFile), "path"_a, "maxResolution"_a = 0); // PYTHONDEPRECATED
+        envMap.def_static("createFromFile", createFromFile, "path"_a, "maxResolution"_a = 0);
         envMap.def_property_readonly("path", &EnvMap::getPath);
         envMap.def_property("rotation", &EnvMap::getRotation, &EnvMap::setRotation);
         envMap.def_property("intensity", &EnvMap::getIntensity, &EnvMap::setIntensity);
@@ -58,9 +58,10 @@ namespace Falcor
         /** Create a new environment map from file.
             \param[in] pDevice GPU device.
             \param[in] path The environment map texture file path (absolute or relative to working directory).
+            \param[in] maxResolution If non-zero, the top mip levels of OpenEXR and Radiance HDR maps are dropped until the width and height are at most this size.
             \return A new object, or nullptr if the environment map failed to load.
         */
-        static ref<EnvMap> createFromFile(ref<Device> pDevice, const std::filesystem::path& path);
+        static ref<EnvMap> createFromFile(ref<Device> pDevice, const std::filesystem::path& path, uint32_t maxResolution = 0);
 
         /** Render the GUI.
         */
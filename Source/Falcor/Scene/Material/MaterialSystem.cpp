@@ -401,34 +401,58 @@ namespace Falcor
 
         if (textures.empty()) return;
 
-        // Analyze the textures.
-        logInfo("Analyzing {} material textures.", textures.size());
-
-        RenderContext* pRenderContext = mpDevice->getRenderContext();
-
-        TextureAnalyzer analyzer(mpDevice);
-        auto pResults = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        analyzer.analyze(pRenderContext, textures, pResults);
-
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = mpDevice->createBuffer(textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
-        pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
-        pRenderContext->submit(false);
-        pRenderContext->signal(mpFence.get());
-
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->wait();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
-        Material::TextureOptimizationStats stats = {};
+        // Use the analysis computed while decoding where available, and analyze the remaining textures on the GPU.
+        std::vector<TextureAnalyzer::Result> results(textures.size());
+        std::vector<ref<Texture>> gpuTextures;
+        std::vector<size_t> gpuTextureIndices;
 
         for (size_t i = 0; i < textures.size(); i++)
         {
-            materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
+            if (auto analysis = mpTextureManager->getTextureAnalysis(textures[i].get()))
+            {
+                results[i] = *analysis;
+            }
+            else
+            {
+                gpuTextures.push_back(textures[i]);
+                gpuTextureIndices.push_back(i);
+            }
         }
 
-        pResultsStaging->unmap();
+        logInfo("Analyzing {} material textures ({} analyzed while loading).", textures.size(), textures.size() - gpuTextures.size());
+
+        if (!gpuTextures.empty())
+        {
+            RenderContext* pRenderContext = mpDevice->getRenderContext();
+
+            TextureAnalyzer analyzer(mpDevice);
+            auto pResults = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            analyzer.analyze(pRenderContext, gpuTextures, pResults);
+
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = mpDevice->createBuffer(gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, MemoryType::ReadBack);
+            pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
+            pRenderContext->submit(false);
+            pRenderContext->signal(mpFence.get());
+
+            // Wait for results to become available.
+            mpFence->wait();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map());
+            for (size_t i = 0; i < gpuTextures.size(); i++)
+            {
+                results[gpuTextureIndices[i]] = gpuResults[i];
+            }
+            pResultsStaging->unmap();
+        }
+
+        // Optimize the materials.
+        Material::TextureOptimizationStats stats = {};
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
+        }
 
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
@@ -0,0 +1,199 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MaterialTextureCache.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include <nlohmann/json.hpp>
+#include <fstream>
+
+namespace Falcor
+{
+    namespace
+    {
+        const std::string kDirectory = "NVIDIA/Falcor/TextureCache";
+
+        const std::string kIndexFilename = "index.json";
+
+        // Increment when the content of the cached textures changes, to invalidate existing caches.
+        const uint32_t kVersion = 1;
+
+        using json = nlohmann::json;
+
+        std::string getIndexKey(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo)
+        {
+            // Don't resolve links, so that this doesn't access the file system.
+            std::error_code ec;
+            std::filesystem::path path = std::filesystem::absolute(sourcePath, ec);
+            if (ec) path = sourcePath;
+            return fmt::format("{}:{}:{}", (uint32_t)slot, (uint32_t)slotInfo.mask, path.lexically_normal().generic_string());
+        }
+
+        bool getFileStamp(const std::filesystem::path& path, uint64_t& fileSize, int64_t& fileTime)
+        {
+            std::error_code ec;
+            fileSize = std::filesystem::file_size(path, ec);
+            if (ec) return false;
+            fileTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+            return !ec;
+        }
+    }
+
+    MaterialTextureCache::Index MaterialTextureCache::Index::load()
+    {
+        Index index;
+        const auto path = getDirectory() / kIndexFilename;
+        std::ifstream ifs(path);
+        if (!ifs) return index;
+
+        try
+        {
+            json j = json::parse(ifs);
+            if (j.at("version").get<uint32_t>() != kVersion) return index;
+
+            for (const auto& entry : j.at("entries"))
+            {
+                index.mEntries[entry.at("key").get<std::string>()] = Entry{
+                    entry.at("size").get<uint64_t>(),
+                    entry.at("time").get<int64_t>(),
+                    entry.at("cache").get<std::string>()
+                };
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Ignoring invalid texture cache index '{}': {}", path, e.what());
+            index.mEntries.clear();
+        }
+        return index;
+    }
+
+    void MaterialTextureCache::Index::save() const
+    {
+        json entries = json::array();
+        for (const auto& [key, entry] : mEntries)
+        {
+            entries.push_back({ {"key", key}, {"size", entry.fileSize}, {"time", entry.fileTime}, {"cache", entry.cacheName} });
+        }
+        json j = { {"version", kVersion}, {"entries", std::move(entries)} };
+
+        // Write to a temporary file and rename it afterwards, so that the loader never sees a partially written index.
+        const auto path = getDirectory() / kIndexFilename;
+        auto tempPath = path;
+        tempPath += ".tmp";
+        {
+            std::ofstream ofs(tempPath);
+            if (!ofs) FALCOR_THROW("Failed to write texture cache index '{}'.", tempPath);
+            ofs << j.dump(1);
+        }
+        std::filesystem::rename(tempPath, path);
+    }
+
+    std::filesystem::path MaterialTextureCache::Index::find(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo) const
+    {
+        auto it = mEntries.find(getIndexKey(sourcePath, slot, slotInfo));
+        if (it == mEntries.end()) return {};
+
+        uint64_t fileSize;
+        int64_t fileTime;
+        if (!getFileStamp(sourcePath, fileSize, fileTime) || fileSize != it->second.fileSize || fileTime != it->second.fileTime) return {};
+
+        auto cachePath = getDirectory() / it->second.cacheName;
+        std::error_code ec;
+        return std::filesystem::is_regular_file(cachePath, ec) ? cachePath : std::filesystem::path();
+    }
+
+    void MaterialTextureCache::Index::add(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo, const std::filesystem::path& cachePath)
+    {
+        Entry entry;
+        if (!getFileStamp(sourcePath, entry.fileSize, entry.fileTime)) return;
+        entry.cacheName = cachePath.filename().string();
+        mEntries[getIndexKey(sourcePath, slot, slotInfo)] = std::move(entry);
+    }
+
+    std::filesystem::path MaterialTextureCache::getDirectory()
+    {
+        return getAppDataDirectory() / kDirectory;
+    }
+
+    bool MaterialTextureCache::isAvailable()
+    {
+        std::error_code ec;
+        return std::filesystem::is_directory(getDirectory(), ec);
+    }
+
+    std::filesystem::path MaterialTextureCache::getCachePath(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo)
+    {
+        MemoryMappedFile file(sourcePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) return {};
+
+        SHA1 sha1;
+        sha1.update(kVersion);
+        sha1.update((uint32_t)slot);
+        sha1.update((uint32_t)slotInfo.mask);
+        sha1.update(file.getData(), file.getSize());
+
+        return getDirectory() / (SHA1::toString(sha1.finalize()) + ".dds");
+    }
+
+    bool MaterialTextureCache::isSlotCacheable(Material::TextureSlot slot)
+    {
+        // Indices can't be interpolated.
+        return slot != Material::TextureSlot::Index;
+    }
+
+    ImageIO::CompressionMode MaterialTextureCache::getCompressionMode(Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo, ResourceFormat format)
+    {
+        // Don't recompress textures that are already compressed.
+        if (!isSlotCacheable(slot) || isCompressedFormat(format)) return ImageIO::CompressionMode::None;
+
+        const FormatType type = getFormatType(format);
+        const bool isUnorm = type == FormatType::Unorm || type == FormatType::UnormSrgb;
+
+        switch (slot)
+        {
+        case Material::TextureSlot::Normal:
+            return isUnorm ? ImageIO::CompressionMode::BC5 : ImageIO::CompressionMode::None;
+        case Material::TextureSlot::Displacement:
+            // Only the first channel is used. Float displacement maps are not cached, as BC4 would clamp them to [0,1].
+            return isUnorm ? ImageIO::CompressionMode::BC4 : ImageIO::CompressionMode::None;
+        default:
+            break;
+        }
+
+        if (type == FormatType::Float)
+        {
+            // BC6 has no alpha channel.
+            return slotInfo.hasChannel(TextureChannelFlags::Alpha) ? ImageIO::CompressionMode::None : ImageIO::CompressionMode::BC6;
+        }
+        if (!isUnorm) return ImageIO::CompressionMode::None;
+
+        return slotInfo.mask == TextureChannelFlags::Red ? ImageIO::CompressionMode::BC4 : ImageIO::CompressionMode::BC7;
+    }
+}
@@ -0,0 +1,127 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Material.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Utils/Image/ImageIO.h"
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace Falcor
+{
+    /** Cache of block-compressed material textures.
+
+        The cache holds DDS files with full mip chains, written offline by the TextureCache tool.
+        Cached textures are named after a hash of the source file content and of the texture slot,
+        so that identical textures share a cached file. The tool also writes an index of the cached
+        textures, which MaterialTextureLoader uses to load the cached texture instead of the source
+        file without reading the source file.
+    */
+    class FALCOR_API MaterialTextureCache
+    {
+    public:
+        /** Get the directory holding the cached textures.
+        */
+        static std::filesystem::path getDirectory();
+
+        /** Check if the cache directory exists. This is the case once the TextureCache tool was run.
+        */
+        static bool isAvailable();
+
+        /** Index of the cached textures, stored in the cache directory.
+            It maps the source files, identified by their path, size and modification time, and their
+            texture slots to the cached textures. Looking up a texture only checks the source file's size and time.
+        */
+        class FALCOR_API Index
+        {
+        public:
+            /** Load the index from the cache directory.
+                \return The index, which is empty if there is no valid index file.
+            */
+            static Index load();
+
+            /** Write the index to the cache directory.
+            */
+            void save() const;
+
+            /** Find the cached texture of a material texture.
+                \param[in] sourcePath Path of the source texture file.
+                \param[in] slot Texture slot the texture is loaded into.
+                \param[in] slotInfo Info of the texture slot.
+                \return Path of the cached texture, or an empty path if it is not cached or the source file changed since it was.
+            */
+            std::filesystem::path find(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo) const;
+
+            /** Add or replace the cached texture of a material texture.
+                \param[in] sourcePath Path of the source texture file.
+                \param[in] slot Texture slot the texture is loaded into.
+                \param[in] slotInfo Info of the texture slot.
+                \param[in] cachePath Path of the cached texture, as returned by getCachePath().
+            */
+            void add(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo, const std::filesystem::path& cachePath);
+
+            /** Get the number of cached textures in the index.
+            */
+            size_t getSize() const { return mEntries.size(); }
+
+        private:
+            struct Entry
+            {
+                uint64_t fileSize = 0;  ///< Size of the source file.
+                int64_t fileTime = 0;   ///< Last write time of the source file.
+                std::string cacheName;  ///< File name of the cached texture in the cache directory.
+            };
+
+            std::map<std::string, Entry> mEntries; ///< Entries keyed by texture slot, channel mask and source path.
+        };
+
+        /** Check if textures in a slot can be cached. Textures in other slots are always loaded from their source files.
+        */
+        static bool isSlotCacheable(Material::TextureSlot slot);
+
+        /** Get the path of the cached texture for a material texture.
+            This hashes the source file, so it reads the whole file. Use Index::find() to look up cached textures at load time.
+            \param[in] sourcePath Path of the source texture file.
+            \param[in] slot Texture slot the texture is loaded into.
+            \param[in] slotInfo Info of the texture slot.
+            \return Path of the cached texture, which may not exist, or an empty path if the source file can't be read.
+        */
+        static std::filesystem::path getCachePath(const std::filesystem::path& sourcePath, Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo);
+
+        /** Select the block compression mode of a material texture.
+            Color textures use BC7 (BC6 if they are HDR), normal maps use BC5 and scalar textures use BC4.
+            \param[in] slot Texture slot the texture is loaded into.
+            \param[in] slotInfo Info of the texture slot.
+            \param[in] format Format of the source texture.
+            \return Compression mode, or CompressionMode::None if the texture should not be cached.
+        */
+        static ImageIO::CompressionMode getCompressionMode(Material::TextureSlot slot, const Material::TextureSlotInfo& slotInfo, ResourceFormat format);
+    };
+}
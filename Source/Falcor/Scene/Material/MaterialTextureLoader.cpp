@@ -32,6 +32,7 @@ namespace Falcor
 {
     MaterialTextureLoader::MaterialTextureLoader(TextureManager& textureManager, bool useSrgb)
         : mUseSrgb(useSrgb)
+        , mTextureCacheIndex(MaterialTextureCache::Index::load())
         , mTextureManager(textureManager)
     {
     }
@@ -50,12 +51,27 @@ namespace Falcor
             return;
         }
 
-        bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
+        const auto& slotInfo = pMaterial->getTextureSlotInfo(slot);
+        bool srgb = mUseSrgb && slotInfo.srgb;
+
+        // Use the cached texture if there is one. It already has a full mip chain.
+        std::filesystem::path loadPath = path;
+        std::filesystem::path sourcePath;
+        if (mTextureCacheIndex.getSize() > 0 && MaterialTextureCache::isSlotCacheable(slot))
+        {
+            auto cachePath = mTextureCacheIndex.find(path, slot, slotInfo);
+            if (!cachePath.empty())
+            {
+                logDebug("MaterialTextureLoader::loadTexture() - Loading '{}' from texture cache '{}'.", path, cachePath);
+                loadPath = cachePath;
+                sourcePath = path;
+            }
+        }
 
         // Request texture to be loaded.
         auto handle = mTextureManager.loadTexture(
-            path,
-            true /*mips*/,
+            loadPath,
+            sourcePath.empty() /*mips*/,
             srgb,
             ResourceBindFlags::ShaderResource,
             true /*async*/,
@@ -66,7 +82,7 @@ namespace Falcor
         );
 
         // Store assignment to material for later.
-        mTextureAssignments.emplace_back(TextureAssignment{ pMaterial, slot, handle });
+        mTextureAssignments.emplace_back(TextureAssignment{ pMaterial, slot, handle, std::move(sourcePath) });
     }
 
     void MaterialTextureLoader::assignTextures()
@@ -77,6 +93,7 @@ namespace Falcor
         for (const auto& assignment : mTextureAssignments)
         {
             auto pTexture = mTextureManager.getTexture(assignment.handle);
+            if (pTexture && !assignment.sourcePath.empty()) pTexture->setSourcePath(assignment.sourcePath);
             assignment.pMaterial->setTexture(assignment.textureSlot, pTexture);
         }
         mTextureAssignments.clear();
@@ -28,6 +28,7 @@
 #pragma once
 #include "Core/Macros.h"
 #include "Scene/Material/Material.h"
+#include "Scene/Material/MaterialTextureCache.h"
 #include "Utils/Image/TextureManager.h"
 #include <filesystem>
 #include <vector>
@@ -41,6 +42,9 @@ namespace Falcor
         material assignment is stored. When the client destroys the instance of the
         `MaterialTextureLoader`, it blocks until all textures are loaded and assigns
         them to the materials.
+
+        Textures found in the MaterialTextureCache index are loaded from the cache instead of
+        the source files. Their source path is still set to the source file.
     */
     class FALCOR_API MaterialTextureLoader
     {
@@ -67,9 +71,11 @@ namespace Falcor
             ref<Material> pMaterial;
             Material::TextureSlot textureSlot;
             TextureManager::CpuTextureHandle handle;
+            std::filesystem::path sourcePath; ///< Source file path if the texture is loaded from the cache, empty otherwise.
         };
 
         bool mUseSrgb;
+        MaterialTextureCache::Index mTextureCacheIndex; ///< Index of the texture cache, loaded once as the lookups must not read the source files.
         std::vector<TextureAssignment> mTextureAssignments;
         TextureManager& mTextureManager;
     };
@@ -0,0 +1,219 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeshOptimizer.h"
+#include "Core/Error.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    namespace
+    {
+        // Parameters of the scoring function, as suggested by Forsyth.
+        // The simulated LRU cache is larger than the hardware FIFO, as vertices slightly out of the cache are still good candidates.
+        const uint32_t kScoreCacheSize = 32;
+        const uint32_t kMaxValence = 32;
+        const float kCacheDecayPower = 1.5f;
+        const float kLastTriangleScore = 0.75f;
+        const float kValenceBoostScale = 2.f;
+        const float kValenceBoostPower = 0.5f;
+
+        struct ScoreTables
+        {
+            float cache[kScoreCacheSize];
+            float valence[kMaxValence + 1];
+
+            ScoreTables()
+            {
+                // The 3 vertices of the last triangle get a fixed score so that the next triangle does not favor any of its edges.
+                for (uint32_t i = 0; i < kScoreCacheSize; i++)
+                {
+                    if (i < 3) cache[i] = kLastTriangleScore;
+                    else cache[i] = std::pow(1.f - float(i - 3) / float(kScoreCacheSize - 3), kCacheDecayPower);
+                }
+
+                // Boost the vertices with few remaining triangles, to avoid leaving lone triangles behind.
+                valence[0] = 0.f;
+                for (uint32_t i = 1; i <= kMaxValence; i++) valence[i] = kValenceBoostScale * std::pow(float(i), -kValenceBoostPower);
+            }
+
+            float getVertexScore(int32_t cachePosition, uint32_t remainingTriangles) const
+            {
+                // Vertices without remaining triangles don't contribute, whatever their cache position.
+                if (remainingTriangles == 0) return -1.f;
+
+                float score = valence[std::min(remainingTriangles, kMaxValence)];
+                if (cachePosition >= 0) score += cache[cachePosition];
+                return score;
+            }
+        };
+
+        const ScoreTables kScoreTables;
+    }
+
+    void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        FALCOR_ASSERT(indices.size() % 3 == 0);
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount <= 1) return;
+
+        // Build the vertex to triangle adjacency. The remaining triangles of each vertex are kept at the front of its list.
+        std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+        for (uint32_t index : indices)
+        {
+            FALCOR_ASSERT(index < vertexCount);
+            remainingTriangles[index]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        for (uint32_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+
+        std::vector<uint32_t> adjacency(indices.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+        }
+
+        std::vector<float> vertexScores(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) vertexScores[v] = kScoreTables.getVertexScore(-1, remainingTriangles[v]);
+
+        std::vector<float> triangleScores(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            triangleScores[t] = vertexScores[indices[3 * t]] + vertexScores[indices[3 * t + 1]] + vertexScores[indices[3 * t + 2]];
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> optimizedIndices;
+        optimizedIndices.reserve(indices.size());
+
+        uint32_t cache[kScoreCacheSize];
+        uint32_t cacheEntries = 0;
+
+        // Start with the triangle with the highest score, the one with the most isolated vertices.
+        size_t nextUnemittedTriangle = 0;
+        uint32_t bestTriangle = uint32_t(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+        bool hasBestTriangle = true;
+
+        for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+        {
+            // If no triangle in the cache has remaining triangles, continue with the first triangle not emitted yet.
+            if (!hasBestTriangle)
+            {
+                while (emitted[nextUnemittedTriangle]) nextUnemittedTriangle++;
+                bestTriangle = uint32_t(nextUnemittedTriangle);
+            }
+
+            FALCOR_ASSERT(!emitted[bestTriangle]);
+            emitted[bestTriangle] = true;
+
+            // The new cache holds 3 extra entries for the vertices pushed out by the triangle, so that their scores get updated.
+            const uint32_t* triangle = &indices[3 * bestTriangle];
+            uint32_t newCache[kScoreCacheSize + 3];
+            uint32_t newCacheEntries = 0;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const uint32_t v = triangle[i];
+                optimizedIndices.push_back(v);
+                newCache[newCacheEntries++] = v;
+
+                // Remove the triangle from the remaining triangles of the vertex.
+                uint32_t* pBegin = &adjacency[adjacencyOffsets[v]];
+                uint32_t* pEnd = pBegin + remainingTriangles[v];
+                uint32_t* pFound = std::find(pBegin, pEnd, bestTriangle);
+                FALCOR_ASSERT(pFound != pEnd);
+                std::swap(*pFound, *(pEnd - 1));
+                remainingTriangles[v]--;
+            }
+
+            // Move the vertices of the triangle to the front of the LRU cache.
+            for (uint32_t i = 0; i < cacheEntries; i++)
+            {
+                const uint32_t v = cache[i];
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCacheEntries++] = v;
+            }
+
+            // Update the scores of the vertices in the cache and of their remaining triangles.
+            // The vertices pushed out of the cache lose their cache score.
+            for (uint32_t i = 0; i < newCacheEntries; i++)
+            {
+                const uint32_t v = newCache[i];
+                const int32_t cachePosition = i < kScoreCacheSize ? int32_t(i) : -1;
+                const float score = kScoreTables.getVertexScore(cachePosition, remainingTriangles[v]);
+                const float scoreDelta = score - vertexScores[v];
+                vertexScores[v] = score;
+
+                for (uint32_t j = 0; j < remainingTriangles[v]; j++) triangleScores[adjacency[adjacencyOffsets[v] + j]] += scoreDelta;
+            }
+
+            // Pick the next triangle among the remaining triangles of the vertices in the cache.
+            hasBestTriangle = false;
+            float bestScore = 0.f;
+            cacheEntries = std::min(newCacheEntries, kScoreCacheSize);
+            for (uint32_t i = 0; i < cacheEntries; i++)
+            {
+                const uint32_t v = newCache[i];
+                cache[i] = v;
+                for (uint32_t j = 0; j < remainingTriangles[v]; j++)
+                {
+                    const uint32_t t = adjacency[adjacencyOffsets[v] + j];
+                    if (!hasBestTriangle || triangleScores[t] > bestScore)
+                    {
+                        bestTriangle = t;
+                        bestScore = triangleScores[t];
+                        hasBestTriangle = true;
+                    }
+                }
+            }
+        }
+
+        indices = std::move(optimizedIndices);
+    }
+
+    std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount)
+    {
+        const uint32_t kUnassigned = uint32_t(-1);
+        std::vector<uint32_t> remap(vertexCount, kUnassigned);
+
+        uint32_t nextVertex = 0;
+        for (uint32_t& index : indices)
+        {
+            FALCOR_ASSERT(index < vertexCount);
+            if (remap[index] == kUnassigned) remap[index] = nextVertex++;
+            index = remap[index];
+        }
+
+        for (uint32_t& newIndex : remap)
+        {
+            if (newIndex == kUnassigned) newIndex = nextVertex++;
+        }
+
+        FALCOR_ASSERT(nextVertex == vertexCount);
+        return remap;
+    }
+}
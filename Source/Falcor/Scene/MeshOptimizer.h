@@ -0,0 +1,102 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+    /** Reordering of triangles and vertices of indexed triangle meshes to improve the locality of the vertex accesses.
+        The triangle order is optimized for the post-transform vertex cache of the rasterizer, and the vertex order for
+        the vertex fetches of both the rasterizer and the ray tracing hit shaders.
+    */
+    class FALCOR_API MeshOptimizer
+    {
+    public:
+        /// Size of the FIFO cache used to measure the post-transform cache efficiency.
+        static constexpr uint32_t kVertexCacheSize = 32;
+
+        /** Reorder the triangles to maximize the post-transform vertex cache hits.
+            This implements the "Linear-Speed Vertex Cache Optimisation" of Tom Forsyth, a greedy algorithm that emits
+            the triangle with the highest score next, where the score favors the vertices recently emitted and the vertices
+            with few remaining triangles. The vertex indices in each triangle are kept, so the winding is unchanged.
+            \param[in,out] indices Triangle list indices, reordered in place.
+            \param[in] vertexCount Number of vertices. All indices must be smaller.
+        */
+        static void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Renumber the vertices in the order of their first use by the triangles.
+            Vertices that are not referenced by any triangle are moved to the end in their original order.
+            \param[in,out] indices Triangle list indices, rewritten in place.
+            \param[in] vertexCount Number of vertices. All indices must be smaller.
+            \return Table mapping each original vertex index to its new index.
+        */
+        static std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, uint32_t vertexCount);
+
+        /** Reorder vertex data to match the table returned by optimizeVertexFetch().
+            \param[in] remap Table mapping each original vertex index to its new index.
+            \param[in,out] vertices Vertex data, reordered in place. It must have one element per entry in remap.
+        */
+        template<typename T>
+        static void remapVertices(const std::vector<uint32_t>& remap, std::vector<T>& vertices)
+        {
+            std::vector<T> remapped(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++) remapped[remap[i]] = std::move(vertices[i]);
+            vertices = std::move(remapped);
+        }
+
+        /** Count the post-transform cache misses of a triangle list, with a FIFO cache.
+            The average cache miss ratio (ACMR) is this count divided by the triangle count (between 0.5 and 3.0), and the
+            average transform to vertex ratio (ATVR) is this count divided by the vertex count (1.0 is optimal).
+            \param[in] indices Triangle list indices, 16 or 32 bits.
+            \param[in] indexCount Number of indices.
+            \param[in] vertexCount Number of vertices. All indices must be smaller.
+            \param[in] cacheSize Number of entries in the simulated cache.
+            \return Number of cache misses.
+        */
+        template<typename IndexT>
+        static uint64_t countVertexCacheMisses(const IndexT* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kVertexCacheSize)
+        {
+            // With a FIFO, a vertex is still in the cache if fewer than cacheSize misses happened since it was inserted.
+            std::vector<uint64_t> insertedAt(vertexCount, 0);
+            uint64_t missCount = 0;
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                uint64_t& timestamp = insertedAt[indices[i]];
+                if (timestamp == 0 || missCount - timestamp >= cacheSize)
+                {
+                    missCount++;
+                    timestamp = missCount;
+                }
+            }
+            return missCount;
+        }
+    };
+}
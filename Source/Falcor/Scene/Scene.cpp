@@ -29,6 +29,7 @@
 #include "SceneDefines.slangh"
 #include "SceneBuilder.h"
 #include "Importer.h"
+#include "MeshOptimizer.h"
 #include "Scene/Material/SerializedMaterialParams.h"
 #include "Curves/CurveConfig.h"
 #include "SDFs/SDFGrid.h"
@@ -47,26 +48,23 @@
 #include "Utils/Timing/Profiler.h"
 #include "Utils/UI/InputTypes.h"
 #include "Utils/Scripting/ScriptWriter.h"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 
 #include <fstream>
 #include <numeric>
 #include <sstream>
 #include <algorithm>
-#include <execution>
+#include <atomic>
 
 namespace Falcor
 {
     static_assert(sizeof(MeshDesc) % 16 == 0, "MeshDesc size should be a multiple of 16");
     static_assert(sizeof(GeometryInstanceData) == 32, "GeometryInstanceData size should be 32");
     static_assert(sizeof(PackedStaticVertexData) % 16 == 0, "PackedStaticVertexData size should be a multiple of 16");
+    static_assert(sizeof(PackedCompactVertexData) == 16, "PackedCompactVertexData size should be 16");
 
     namespace
     {
-        // Large scenes are split into multiple BLAS groups in order to reduce build memory usage.
-        // The target is max 0.5GB intermediate memory per BLAS group. Note that this is not a strict limit.
-        const size_t kMaxBLASBuildMemory = 1ull << 29;
-
         const std::string kParameterBlockName = "gScene";
         const std::string kGeometryInstanceBufferName = "geometryInstances";
         const std::string kMeshBufferName = "meshes";
@@ -95,6 +93,7 @@ namespace Falcor
         const std::string kLights = "lights";
         const std::string kAnimated = "animated";
         const std::string kRenderSettings = "renderSettings";
+        const std::string kBlasBuildMemoryBudget = "blasBuildMemoryBudget";
         const std::string kEnvMap = "envMap";
         const std::string kMaterials = "materials";
         const std::string kGridVolumes = "gridVolumes";
@@ -192,6 +191,9 @@ namespace Falcor
         mMeshGroups = std::move(sceneData.meshGroups);
 
         mUseCompressedHitInfo = sceneData.useCompressedHitInfo;
+        mUseCompactVertices = sceneData.useCompactVertices;
+        mSceneStats.meshCacheHitCount = sceneData.meshCacheHitCount;
+        mSceneStats.meshCacheMissCount = sceneData.meshCacheMissCount;
         mHas16BitIndices = sceneData.has16BitIndices;
         mHas32BitIndices = sceneData.has32BitIndices;
 
@@ -209,11 +211,16 @@ namespace Falcor
 
         mMeshIndexData = std::move(sceneData.meshIndexData);
         mMeshStaticData = std::move(sceneData.meshStaticData);
+        mMeshCompactData = std::move(sceneData.meshCompactData);
 
         mMeshIndexData.setBufferCountDefinePrefix("SCENE_INDEX");
         mMeshIndexData.createGpuBuffers(mpDevice, ResourceBindFlags::Index | ResourceBindFlags::ShaderResource);
         mMeshStaticData.setBufferCountDefinePrefix("SCENE_VERTEX");
-        mMeshStaticData.createGpuBuffers(mpDevice, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex);
+        mMeshCompactData.setBufferCountDefinePrefix("SCENE_VERTEX");
+        if (mUseCompactVertices)
+            mMeshCompactData.createGpuBuffers(mpDevice, ResourceBindFlags::ShaderResource | ResourceBindFlags::Vertex);
+        else
+            mMeshStaticData.createGpuBuffers(mpDevice, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess | ResourceBindFlags::Vertex);
 
         // Setup additional resources.
         mFrontClockwiseRS[RasterizerState::CullMode::None] = RasterizerState::create(RasterizerState::Desc().setFrontCounterCW(false).setCullMode(RasterizerState::CullMode::None));
@@ -289,7 +296,11 @@ namespace Falcor
         defines.add("SCENE_HAS_16BIT_INDICES", mHas16BitIndices ? "1" : "0");
         defines.add("SCENE_HAS_32BIT_INDICES", mHas32BitIndices ? "1" : "0");
         mMeshIndexData.getShaderDefines(defines);
-        mMeshStaticData.getShaderDefines(defines);
+        if (mUseCompactVertices)
+            mMeshCompactData.getShaderDefines(defines);
+        else
+            mMeshStaticData.getShaderDefines(defines);
+        defines.add("SCENE_USE_COMPACT_VERTICES", mUseCompactVertices ? "1" : "0");
 
         defines.add(mHitInfo.getDefines());
         defines.add(getSceneSDFGridDefines());
@@ -434,7 +445,8 @@ namespace Falcor
     void Scene::createMeshVao(uint32_t drawCount, const std::vector<SkinningVertexData>& skinningData)
     {
         if (drawCount == 0) return;
-        if (mMeshIndexData.getBufferCount() > 1 || mMeshStaticData.getBufferCount() > 1)
+        const size_t vertexBufferCount = mUseCompactVertices ? mMeshCompactData.getBufferCount() : mMeshStaticData.getBufferCount();
+        if (mMeshIndexData.getBufferCount() > 1 || vertexBufferCount > 1)
         {
             logWarning("MeshVao cannot be created, rasterization will not be available.");
             return;
@@ -444,7 +456,7 @@ namespace Falcor
         if (!mMeshIndexData.empty())
             pIB = mMeshIndexData.getGpuBuffer(0);
 
-        ref<Buffer> pStaticBuffer = mMeshStaticData.getGpuBuffer(0);
+        ref<Buffer> pStaticBuffer = mUseCompactVertices ? mMeshCompactData.getGpuBuffer(0) : mMeshStaticData.getGpuBuffer(0);
 
         Vao::BufferVec pVBs(kVertexBufferCount);
         pVBs[kStaticDataBufferIndex] = pStaticBuffer;
@@ -477,10 +489,20 @@ namespace Falcor
         ref<VertexLayout> pLayout = VertexLayout::create();
 
         // Add the packed static vertex data layout.
+        // Compact vertices are passed as raw bits and decoded in the vertex shader, see VSIn in Raster.slang.
         ref<VertexBufferLayout> pStaticLayout = VertexBufferLayout::create();
-        pStaticLayout->addElement(VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
-        pStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius), ResourceFormat::RGB32Float, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
-        pStaticLayout->addElement(VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC);
+        if (mUseCompactVertices)
+        {
+            pStaticLayout->addElement(VERTEX_POSITION_NAME, offsetof(PackedCompactVertexData, packedPositionTangentSignCurveRadius), ResourceFormat::RG32Uint, 1, VERTEX_POSITION_LOC);
+            pStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, offsetof(PackedCompactVertexData, packedNormalTangent), ResourceFormat::R32Uint, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
+            pStaticLayout->addElement(VERTEX_TEXCOORD_NAME, offsetof(PackedCompactVertexData, packedTexCrd), ResourceFormat::R32Uint, 1, VERTEX_TEXCOORD_LOC);
+        }
+        else
+        {
+            pStaticLayout->addElement(VERTEX_POSITION_NAME, offsetof(PackedStaticVertexData, position), ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC);
+            pStaticLayout->addElement(VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_NAME, offsetof(PackedStaticVertexData, packedNormalTangentCurveRadius), ResourceFormat::RGB32Float, 1, VERTEX_PACKED_NORMAL_TANGENT_CURVE_RADIUS_LOC);
+            pStaticLayout->addElement(VERTEX_TEXCOORD_NAME, offsetof(PackedStaticVertexData, texCrd), ResourceFormat::RG32Float, 1, VERTEX_TEXCOORD_LOC);
+        }
         pLayout->addBufferLayout(kStaticDataBufferIndex, pStaticLayout);
 
         // Add the draw ID layout.
@@ -597,9 +619,13 @@ namespace Falcor
                 // Load vertices from global vertex buffer.
                 // Note that the mesh local vbOffset is added to address into the global vertex buffer.
                 StaticVertexData vertices[3];
-                vertices[0] = mMeshStaticData[(size_t)desc.vbOffset + vidx[0]].unpack();
-                vertices[1] = mMeshStaticData[(size_t)desc.vbOffset + vidx[1]].unpack();
-                vertices[2] = mMeshStaticData[(size_t)desc.vbOffset + vidx[2]].unpack();
+                for (uint32_t j = 0; j < 3; ++j)
+                {
+                    if (mUseCompactVertices)
+                        vertices[j] = mMeshCompactData[(size_t)desc.vbOffset + vidx[j]].unpack(desc.positionCenter, desc.positionHalfExtent);
+                    else
+                        vertices[j] = mMeshStaticData[(size_t)desc.vbOffset + vidx[j]].unpack();
+                }
 
                 int2 v0 = int2(std::floor(vertices[0].texCrd[0]), std::floor(vertices[0].texCrd[1]));
                 int2 v1 = int2(std::floor(vertices[1].texCrd[0]), std::floor(vertices[1].texCrd[1]));
@@ -628,8 +654,7 @@ namespace Falcor
                 result.push_back(largeTriangleTile);
         };
 
-        auto range = NumericRange<size_t>(0, meshDescs.size());
-        std::for_each(std::execution::par_unseq, range.begin(), range.end(), processMeshTile);
+        Threading::parallelFor(size_t(0), meshDescs.size(), processMeshTile);
     }
 
     void Scene::setSDFGridConfig()
@@ -825,7 +850,10 @@ namespace Falcor
 
         if (hasIndexBuffer())
             mMeshIndexData.bindShaderData(var[kIndexBufferName]);
-        mMeshStaticData.bindShaderData(var[kVertexBufferName]);
+        if (mUseCompactVertices)
+            mMeshCompactData.bindShaderData(var[kVertexBufferName]);
+        else
+            mMeshStaticData.bindShaderData(var[kVertexBufferName]);
         var[kPrevVertexBufferName] = mpAnimationController->getPrevVertexData();
 
         if (mpCurveVao != nullptr)
@@ -1369,6 +1397,30 @@ namespace Falcor
             s.uniqueTriangleCount += mesh.getTriangleCount();
         }
 
+        // Simulate the post-transform vertex cache on the index buffers. Non-indexed meshes transform every vertex.
+        std::atomic<uint64_t> vertexCacheMissCount{ 0 };
+        if (mMeshIndexData.hasCpuData())
+        {
+            auto countMeshMisses = [&](size_t meshIndex)
+            {
+                const MeshDesc& mesh = mMeshDesc[meshIndex];
+                if (!mesh.useVertexIndices())
+                {
+                    vertexCacheMissCount += mesh.vertexCount;
+                    return;
+                }
+
+                const void* pIndices = &mMeshIndexData[mesh.ibOffset];
+                vertexCacheMissCount += mesh.use16BitIndices()
+                    ? MeshOptimizer::countVertexCacheMisses(reinterpret_cast<const uint16_t*>(pIndices), mesh.indexCount, mesh.vertexCount)
+                    : MeshOptimizer::countVertexCacheMisses(reinterpret_cast<const uint32_t*>(pIndices), mesh.indexCount, mesh.vertexCount);
+            };
+            Threading::parallelFor(size_t(0), mMeshDesc.size(), countMeshMisses, 1);
+        }
+        s.vertexCacheMissCount = vertexCacheMissCount;
+        s.vertexCacheACMR = s.uniqueTriangleCount > 0 ? double(s.vertexCacheMissCount) / s.uniqueTriangleCount : 0.0;
+        s.vertexCacheATVR = s.uniqueVertexCount > 0 ? double(s.vertexCacheMissCount) / s.uniqueVertexCount : 0.0;
+
         for (CurveID curveID{ 0 }; curveID.get() < getCurveCount(); ++curveID)
         {
             const auto& curve = getCurve(curveID);
@@ -1384,6 +1436,7 @@ namespace Falcor
 
         s.indexMemoryInBytes += mMeshIndexData.getByteSize();
         s.vertexMemoryInBytes += mMeshStaticData.getByteSize();
+        s.vertexMemoryInBytes += mMeshCompactData.getByteSize();
 
         if (mpMeshVao)
         {
@@ -1443,6 +1496,15 @@ namespace Falcor
         s.blasMemoryInBytes = 0;
         s.blasScratchMemoryInBytes = 0;
 
+        uint64_t resultByteSize = 0;
+        uint64_t scratchByteSize = 0;
+        for (const auto& group : mBlasGroups)
+        {
+            resultByteSize = std::max(resultByteSize, group.resultByteSize);
+            scratchByteSize = std::max(scratchByteSize, group.scratchByteSize);
+        }
+        s.blasBuildPeakMemoryInBytes = resultByteSize + scratchByteSize;
+
         for (const auto& blas : mBlasData)
         {
             if (blas.useCompaction) s.blasCompactedCount++;
@@ -1462,6 +1524,7 @@ namespace Falcor
 
         if (mpBlasScratch) s.blasScratchMemoryInBytes += mpBlasScratch->getSize();
         if (mpBlasStaticWorldMatrices) s.blasScratchMemoryInBytes += mpBlasStaticWorldMatrices->getSize();
+        if (mpBlasCompactVertexMatrices) s.blasScratchMemoryInBytes += mpBlasCompactVertexMatrices->getSize();
     }
 
     void Scene::updateRaytracingTLASStats()
@@ -2163,8 +2226,10 @@ namespace Falcor
                 << "  Unique vertex count: " << s.uniqueVertexCount << std::endl
                 << "  Instanced triangle count: " << s.instancedTriangleCount << std::endl
                 << "  Instanced vertex count: " << s.instancedVertexCount << std::endl
+                << "  Vertex cache ACMR: " << s.vertexCacheACMR << std::endl
+                << "  Vertex cache ATVR: " << s.vertexCacheATVR << std::endl
                 << "  Index  buffer memory: " << formatByteSize(s.indexMemoryInBytes) << std::endl
-                << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << std::endl
+                << "  Vertex buffer memory: " << formatByteSize(s.vertexMemoryInBytes) << (mUseCompactVertices ? " (compact)" : "") << std::endl
                 << "  Geometry data memory: " << formatByteSize(s.geometryMemoryInBytes) << std::endl
                 << "  Animation data memory: " << formatByteSize(s.animationMemoryInBytes) << std::endl
                 << "  Curve count: " << s.curveCount << std::endl
@@ -2182,6 +2247,12 @@ namespace Falcor
                 << "  Custom primitive count: " << s.customPrimitiveCount << std::endl
                 << std::endl;
 
+            // Mesh cache stats.
+            oss << "Mesh cache stats:" << std::endl
+                << "  Hits: " << s.meshCacheHitCount << std::endl
+                << "  Misses: " << s.meshCacheMissCount << std::endl
+                << std::endl;
+
             // Raytracing stats.
             oss << "Raytracing stats:" << std::endl
                 << "  BLAS groups: " << s.blasGroupCount << std::endl
@@ -2194,6 +2265,7 @@ namespace Falcor
                 << "  BLAS geometries (non-opaque): " << (s.blasGeometryCount - s.blasOpaqueGeometryCount) << std::endl
                 << "  BLAS memory (final): " << formatByteSize(s.blasMemoryInBytes) << std::endl
                 << "  BLAS memory (scratch): " << formatByteSize(s.blasScratchMemoryInBytes) << std::endl
+                << "  BLAS build peak memory: " << formatByteSize(s.blasBuildPeakMemoryInBytes) << std::endl
                 << "  TLAS count: " << s.tlasCount << std::endl
                 << "  TLAS memory (final): " << formatByteSize(s.tlasMemoryInBytes) << std::endl
                 << "  TLAS memory (scratch): " << formatByteSize(s.tlasScratchMemoryInBytes) << std::endl
@@ -2689,6 +2761,12 @@ namespace Falcor
         mBlasUpdateMode = mode;
     }
 
+    void Scene::setBlasBuildMemoryBudget(uint64_t bytes)
+    {
+        if (bytes != mBlasBuildMemoryBudget) mRebuildBlas = true;
+        mBlasBuildMemoryBudget = bytes;
+    }
+
     void Scene::createDrawList()
     {
         if (!mpMeshVao)
@@ -2818,6 +2896,38 @@ namespace Falcor
                 return mpBlasStaticWorldMatrices;
             };
 
+            // Compact vertices store their positions relative to the mesh bounding box. The BLAS build dequantizes them with a per-mesh transform,
+            // which for static meshes also includes the object-to-world transform normally stored in mpBlasStaticWorldMatrices.
+            auto getCompactVertexMatricesBuffer = [&]()
+            {
+                if (!mpBlasCompactVertexMatrices)
+                {
+                    std::vector<float4x4> transposedMatrices(mMeshDesc.size(), float4x4::identity());
+                    for (const auto& meshGroup : mMeshGroups)
+                    {
+                        for (const MeshID meshID : meshGroup.meshList)
+                        {
+                            const MeshDesc& mesh = mMeshDesc[meshID.get()];
+                            float4x4 m = mul(math::matrixFromTranslation(mesh.positionCenter), math::matrixFromScaling(mesh.positionHalfExtent));
+                            if (meshGroup.isStatic)
+                            {
+                                uint32_t instanceID = mMeshIdToInstanceIds[meshID.get()][0];
+                                m = mul(globalMatrices[mGeometryInstanceData[instanceID].globalMatrixID], m);
+                            }
+                            transposedMatrices[meshID.get()] = transpose(m);
+                        }
+                    }
+
+                    uint32_t float4Count = (uint32_t)transposedMatrices.size() * 4;
+                    mpBlasCompactVertexMatrices = mpDevice->createStructuredBuffer(sizeof(float4), float4Count, ResourceBindFlags::ShaderResource, MemoryType::DeviceLocal, transposedMatrices.data(), false);
+                    mpBlasCompactVertexMatrices->setName("Scene::mpBlasCompactVertexMatrices");
+
+                    // Transition the resource to non-pixel shader state as expected by DXR.
+                    pRenderContext->resourceBarrier(mpBlasCompactVertexMatrices.get(), Resource::State::NonPixelShader);
+                }
+                return mpBlasCompactVertexMatrices;
+            };
+
             // Iterate over the mesh groups. One BLAS will be created for each group.
             // Each BLAS may contain multiple geometries.
             for (size_t i = 0; i < mMeshGroups.size(); i++)
@@ -2873,10 +2983,21 @@ namespace Falcor
                         desc.flags = pMaterial->isOpaque() ? RtGeometryFlags::Opaque : RtGeometryFlags::None;
 
                         // Set the position data
-                        desc.content.triangles.vertexData = mMeshStaticData.getGpuAddress(mesh.vbOffset);
-                        desc.content.triangles.vertexStride = sizeof(PackedStaticVertexData);
+                        if (mUseCompactVertices)
+                        {
+                            // The fourth snorm holds the low bits of the next dword and is ignored by the BLAS build.
+                            desc.content.triangles.transform3x4 = getCompactVertexMatricesBuffer()->getGpuAddress() + meshID.get() * 64ull;
+                            desc.content.triangles.vertexData = mMeshCompactData.getGpuAddress(mesh.vbOffset);
+                            desc.content.triangles.vertexStride = sizeof(PackedCompactVertexData);
+                            desc.content.triangles.vertexFormat = ResourceFormat::RGBA16Snorm;
+                        }
+                        else
+                        {
+                            desc.content.triangles.vertexData = mMeshStaticData.getGpuAddress(mesh.vbOffset);
+                            desc.content.triangles.vertexStride = sizeof(PackedStaticVertexData);
+                            desc.content.triangles.vertexFormat = ResourceFormat::RGB32Float;
+                        }
                         desc.content.triangles.vertexCount = mesh.vertexCount;
-                        desc.content.triangles.vertexFormat = ResourceFormat::RGB32Float;
 
                         // Set index data
                         if (!mMeshIndexData.empty())
@@ -3105,34 +3226,30 @@ namespace Falcor
 
     void Scene::computeBlasGroups()
     {
-        mBlasGroups.clear();
-        uint64_t groupSize = 0;
-
-        for (uint32_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        std::vector<BlasGroupPlanner::BlasSizes> blasSizes(mBlasData.size());
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
         {
-            auto& blas = mBlasData[blasId];
-            size_t blasSize = blas.resultByteSize + blas.scratchByteSize;
-
-            // Start new BLAS group on first iteration or if group size would exceed the target.
-            if (groupSize == 0 || groupSize + blasSize > kMaxBLASBuildMemory)
-            {
-                mBlasGroups.push_back({});
-                groupSize = 0;
-            }
+            blasSizes[blasId] = { mBlasData[blasId].resultByteSize, mBlasData[blasId].scratchByteSize };
+        }
 
-            // Add BLAS to current group.
-            FALCOR_ASSERT(mBlasGroups.size() > 0);
-            auto& group = mBlasGroups.back();
-            group.blasIndices.push_back(blasId);
-            blas.blasGroupIndex = (uint32_t)mBlasGroups.size() - 1;
+        BlasGroupPlanner::Plan plan = BlasGroupPlanner::plan(blasSizes, mBlasBuildMemoryBudget);
 
-            // Update data offsets and sizes.
-            blas.resultByteOffset = group.resultByteSize;
-            blas.scratchByteOffset = group.scratchByteSize;
-            group.resultByteSize += blas.resultByteSize;
-            group.scratchByteSize += blas.scratchByteSize;
+        mBlasGroups.clear();
+        mBlasGroups.resize(plan.groups.size());
+        for (size_t blasGroupIndex = 0; blasGroupIndex < plan.groups.size(); blasGroupIndex++)
+        {
+            auto& group = mBlasGroups[blasGroupIndex];
+            group.blasIndices = std::move(plan.groups[blasGroupIndex].blasIndices);
+            group.resultByteSize = plan.groups[blasGroupIndex].resultByteSize;
+            group.scratchByteSize = plan.groups[blasGroupIndex].scratchByteSize;
+        }
 
-            groupSize += blasSize;
+        for (size_t blasId = 0; blasId < mBlasData.size(); blasId++)
+        {
+            auto& blas = mBlasData[blasId];
+            blas.blasGroupIndex = plan.blasGroupIndices[blasId];
+            blas.resultByteOffset = plan.resultByteOffsets[blasId];
+            blas.scratchByteOffset = plan.scratchByteOffsets[blasId];
         }
 
         // Validation that all offsets and sizes are correct.
@@ -3185,9 +3302,10 @@ namespace Falcor
         }
 
         // Add barriers for the VB and IB which will be accessed by the build.
-        for (size_t i = 0; i < mMeshStaticData.getBufferCount(); ++i)
+        const size_t vertexBufferCount = mUseCompactVertices ? mMeshCompactData.getBufferCount() : mMeshStaticData.getBufferCount();
+        for (size_t i = 0; i < vertexBufferCount; ++i)
         {
-            ref<Buffer> pVb = mMeshStaticData.getGpuBuffer(i);
+            ref<Buffer> pVb = mUseCompactVertices ? mMeshCompactData.getGpuBuffer(i) : mMeshStaticData.getGpuBuffer(i);
             if (pVb)
                 pRenderContext->resourceBarrier(pVb.get(), Resource::State::NonPixelShader);
         }
@@ -3258,7 +3376,7 @@ namespace Falcor
                 preparePrebuildInfo(pRenderContext);
                 computeBlasGroups();
 
-                logInfo("BLAS build split into {} groups", mBlasGroups.size());
+                logInfo("BLAS build split into {} groups (memory budget: {})", mBlasGroups.size(), formatByteSize(mBlasBuildMemoryBudget));
 
                 // Compute the required maximum size of the result and scratch buffers.
                 uint64_t resultByteSize = 0;
@@ -3275,6 +3393,7 @@ namespace Falcor
 
                 logInfo("BLAS build result buffer size: {}", formatByteSize(resultByteSize));
                 logInfo("BLAS build scratch buffer size: {}", formatByteSize(scratchByteSize));
+                logInfo("BLAS build peak memory: {}", formatByteSize(resultByteSize + scratchByteSize));
 
                 // Allocate result and scratch buffers.
                 // The scratch buffer we'll retain because it's needed for subsequent rebuilds and updates.
@@ -4063,6 +4182,7 @@ namespace Falcor
 
         // Bind variables.
         auto var = mpLoadMeshPass->getRootVar()["meshLoader"];
+        var["meshID"] = meshID.get();
         var["vertexCount"] = meshDesc.vertexCount;
         var["vbOffset"] = meshDesc.vbOffset;
         var["triangleCount"] = meshDesc.getTriangleCount();
@@ -4080,6 +4200,7 @@ namespace Falcor
 
     void Scene::setMeshVertices(MeshID meshID, const std::map<std::string, ref<Buffer>>& buffers)
     {
+        FALCOR_CHECK(!mUseCompactVertices, "Cannot set mesh vertices when the scene uses compact vertices.");
         if (!mpUpdateMeshPass)
             mpUpdateMeshPass = ComputePass::create(mpDevice, kMeshIOShaderFilename, "setMeshVertices", getSceneDefines());
         const auto& meshDesc = getMesh(meshID);
@@ -4114,6 +4235,9 @@ namespace Falcor
         d["uniqueVertexCount"] = stats.uniqueVertexCount;
         d["instancedTriangleCount"] = stats.instancedTriangleCount;
         d["instancedVertexCount"] = stats.instancedVertexCount;
+        d["vertexCacheMissCount"] = stats.vertexCacheMissCount;
+        d["vertexCacheACMR"] = stats.vertexCacheACMR;
+        d["vertexCacheATVR"] = stats.vertexCacheATVR;
         d["indexMemoryInBytes"] = stats.indexMemoryInBytes;
         d["vertexMemoryInBytes"] = stats.vertexMemoryInBytes;
         d["geometryMemoryInBytes"] = stats.geometryMemoryInBytes;
@@ -4157,6 +4281,7 @@ namespace Falcor
         d["blasOpaqueGeometryCount"] = stats.blasOpaqueGeometryCount;
         d["blasMemoryInBytes"] = stats.blasMemoryInBytes;
         d["blasScratchMemoryInBytes"] = stats.blasScratchMemoryInBytes;
+        d["blasBuildPeakMemoryInBytes"] = stats.blasBuildPeakMemoryInBytes;
         d["tlasCount"] = stats.tlasCount;
         d["tlasMemoryInBytes"] = stats.tlasMemoryInBytes;
         d["tlasScratchMemoryInBytes"] = stats.tlasScratchMemoryInBytes;
@@ -4183,6 +4308,10 @@ namespace Falcor
         d["gridVoxelCount"] = stats.gridVoxelCount;
         d["gridMemoryInBytes"] = stats.gridMemoryInBytes;
 
+        // Mesh cache stats
+        d["meshCacheHitCount"] = stats.meshCacheHitCount;
+        d["meshCacheMissCount"] = stats.meshCacheMissCount;
+
         return d;
     }
 
@@ -4329,6 +4458,7 @@ namespace Falcor
         scene.def_property(kCameraSpeed.c_str(), &Scene::getCameraSpeed, &Scene::setCameraSpeed);
         scene.def_property(kAnimated.c_str(), &Scene::isAnimated, &Scene::setIsAnimated);
         scene.def_property(kLoopAnimations.c_str(), &Scene::isLooped, &Scene::setIsLooped);
+        scene.def_property(kBlasBuildMemoryBudget.c_str(), &Scene::getBlasBuildMemoryBudget, &Scene::setBlasBuildMemoryBudget);
         scene.def_property(kRenderSettings.c_str(), pybind11::overload_cast<>(&Scene::getRenderSettings, pybind11::const_), &Scene::setRenderSettings);
 
         scene.def(kSetEnvMap.c_str(), &Scene::loadEnvMap, "path"_a);
@@ -29,6 +29,7 @@
 #include "SceneIDs.h"
 #include "SceneTypes.slang"
 #include "HitInfo.h"
+#include "BlasGroupPlanner.h"
 #include "IScene.h"
 #include "Animation/Animation.h"
 #include "Animation/AnimationController.h"
@@ -121,6 +122,7 @@ namespace Falcor
         using UpDirection = CameraController::UpDirection;
 
         using SplitVertexBuffer = SplitBuffer<PackedStaticVertexData, false>;
+        using SplitCompactVertexBuffer = SplitBuffer<PackedCompactVertexData, false>;
         using SplitIndexBuffer = SplitBuffer<uint32_t, true>;
 
         static constexpr uint32_t kMaxBonesPerVertex = 4;
@@ -269,14 +271,19 @@ namespace Falcor
             uint32_t prevVertexCount = 0;                           ///< Number of vertices that the AnimationController needs to allocate to store previous frame vertices.
 
             bool useCompressedHitInfo = false;                      ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
+            bool useCompactVertices = false;                        ///< True if the vertex attributes are stored in meshCompactData instead of meshStaticData.
             bool has16BitIndices = false;                           ///< True if 16-bit mesh indices are used.
             bool has32BitIndices = false;                           ///< True if 32-bit mesh indices are used.
             uint32_t meshDrawCount = 0;                             ///< Number of meshes to draw.
+            uint64_t meshCacheHitCount = 0;                         ///< Number of meshes reused from the mesh cache during import. Not stored in the scene cache.
+            uint64_t meshCacheMissCount = 0;                        ///< Number of meshes processed and written to the mesh cache during import. Not stored in the scene cache.
 
             /// Vertex indices for all meshes in either 32-bit or 16-bit format packed tightly, decided per mesh.
             SplitIndexBuffer meshIndexData;
             /// Vertex attributes for all meshes in packed format.
             SplitVertexBuffer meshStaticData;
+            /// Vertex attributes for all meshes in quantized format. Used instead of meshStaticData if useCompactVertices is set.
+            SplitCompactVertexBuffer meshCompactData;
             /// Additional vertex attributes for skinned meshes.
             std::vector<SkinningVertexData> meshSkinningData;
 
@@ -313,6 +320,9 @@ namespace Falcor
             uint64_t uniqueVertexCount = 0;             ///< Number of unique vertices. A vertex can be referenced by multiple triangles/instances.
             uint64_t instancedTriangleCount = 0;        ///< Number of instanced triangles. This is the total number of rendered triangles.
             uint64_t instancedVertexCount = 0;          ///< Number of instanced vertices. This is the total number of vertices in the rendered triangles.
+            uint64_t vertexCacheMissCount = 0;          ///< Number of post-transform cache misses when drawing each unique mesh once, simulated with a FIFO of MeshOptimizer::kVertexCacheSize vertices.
+            double vertexCacheACMR = 0.0;               ///< Average cache miss ratio, the number of vertex cache misses per unique triangle (from 0.5 to 3.0, lower is better).
+            double vertexCacheATVR = 0.0;               ///< Average transform to vertex ratio, the number of vertex cache misses per unique vertex (1.0 is optimal).
             uint64_t indexMemoryInBytes = 0;            ///< Total memory in bytes used by the index buffer.
             uint64_t vertexMemoryInBytes = 0;           ///< Total memory in bytes used by the vertex buffer.
             uint64_t geometryMemoryInBytes = 0;         ///< Total memory in bytes used by the geometry data (meshes, curves, custom primitives, instances etc.).
@@ -349,6 +359,7 @@ namespace Falcor
             uint64_t blasOpaqueGeometryCount = 0;       ///< Number of geometries that are opaque.
             uint64_t blasMemoryInBytes = 0;             ///< Total memory in bytes used by the BLASes.
             uint64_t blasScratchMemoryInBytes = 0;      ///< Additional memory in bytes kept around for BLAS updates etc.
+            uint64_t blasBuildPeakMemoryInBytes = 0;    ///< Peak memory in bytes of the intermediate buffers used by the BLAS build.
             uint64_t tlasCount = 0;                     ///< Number of TLASes.
             uint64_t tlasMemoryInBytes = 0;             ///< Total memory in bytes used by the TLASes.
             uint64_t tlasScratchMemoryInBytes = 0;      ///< Additional memory in bytes kept around for TLAS updates etc.
@@ -375,6 +386,10 @@ namespace Falcor
             uint64_t gridVoxelCount = 0;                ///< Total number of voxels in all grids.
             uint64_t gridMemoryInBytes = 0;             ///< Total memory in bytes used by the grids.
 
+            // Mesh cache stats
+            uint64_t meshCacheHitCount = 0;             ///< Number of meshes reused from the mesh cache during import.
+            uint64_t meshCacheMissCount = 0;            ///< Number of meshes processed and written to the mesh cache during import.
+
             /** Get the total memory usage in bytes.
             */
             uint64_t getTotalMemory() const
@@ -895,6 +910,15 @@ namespace Falcor
         */
         UpdateMode getBlasUpdateMode() { return mBlasUpdateMode; }
 
+        /** Set the target peak memory of the intermediate buffers used by the BLAS build.
+            The BLASes are split into groups built one after the other to stay within this budget. Smaller budgets give more build passes.
+        */
+        void setBlasBuildMemoryBudget(uint64_t bytes);
+
+        /** Get the target peak memory of the intermediate buffers used by the BLAS build.
+        */
+        uint64_t getBlasBuildMemoryBudget() const { return mBlasBuildMemoryBudget; }
+
         /** Update the scene. Call this once per frame to update the camera location, animations, etc.
             \param[in] pRenderContext The render context.
             \param[in] currentTime The current time in seconds.
@@ -1183,6 +1207,10 @@ namespace Falcor
         */
         bool hasIndexBuffer() const { return !mMeshIndexData.empty(); }
 
+        /** Check whether the mesh vertices are stored in the quantized format, see SceneBuilder::Flags::UseCompactVertices.
+        */
+        bool useCompactVertices() const { return mUseCompactVertices; }
+
         /** Initialize all cameras in the scene through the animation controller using their corresponding scene graph nodes.
         */
         void initializeCameras();
@@ -1240,6 +1268,7 @@ namespace Falcor
         std::vector<GeometryInstanceData> mGeometryInstanceData;    ///< Geometry instance data (for all types of geometry).
 
         bool mUseCompressedHitInfo = false;                         ///< True if scene should used compressed HitInfo (on scenes with triangles meshes only).
+        bool mUseCompactVertices = false;                           ///< True if the vertex attributes are stored in mMeshCompactData instead of mMeshStaticData.
         bool mHas16BitIndices = false;                              ///< True if any meshes use 16-bit indices.
         bool mHas32BitIndices = false;                              ///< True if any meshes use 32-bit indices.
 
@@ -1364,6 +1393,7 @@ namespace Falcor
         // Raytracing data
         UpdateMode mTlasUpdateMode = UpdateMode::Rebuild;   ///< How the TLAS should be updated when there are changes in the scene.
         UpdateMode mBlasUpdateMode = UpdateMode::Refit;     ///< How the BLAS should be updated when there are changes to meshes.
+        uint64_t mBlasBuildMemoryBudget = BlasGroupPlanner::kDefaultMemoryBudget; ///< Target peak memory of the intermediate buffers used by the BLAS build.
 
         std::vector<RtInstanceDesc> mInstanceDescs;         ///< Shared between TLAS builds to avoid reallocating CPU memory.
 
@@ -1429,6 +1459,7 @@ namespace Falcor
         std::vector<BlasGroup> mBlasGroups;                 ///< BLAS group data.
         ref<Buffer> mpBlasScratch;                          ///< Scratch buffer used for BLAS builds.
         ref<Buffer> mpBlasStaticWorldMatrices;              ///< Object-to-world transform matrices in row-major format. Only valid for static meshes.
+        ref<Buffer> mpBlasCompactVertexMatrices;            ///< Per-mesh transforms in row-major format dequantizing compact vertices. Includes the object-to-world transform for static meshes.
         bool mBlasDataValid = false;                        ///< Flag to indicate if the BLAS data is valid. This will be reset when geometry is changed.
         bool mRebuildBlas = true;                           ///< Flag to indicate BLASes need to be rebuilt.
 
@@ -1439,6 +1470,7 @@ namespace Falcor
         /// Used for very large scenes
         SplitIndexBuffer mMeshIndexData;
         SplitVertexBuffer mMeshStaticData;
+        SplitCompactVertexBuffer mMeshCompactData;
 
         UpdateFlagsSignal mUpdateFlagsSignal;
     public:
@@ -28,6 +28,7 @@
 #include "SceneBuilder.h"
 #include "SceneCache.h"
 #include "Importer.h"
+#include "MeshOptimizer.h"
 #include "Curves/CurveConfig.h"
 #include "Material/StandardMaterial.h"
 #include "Utils/Logger.h"
@@ -37,16 +38,20 @@
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/ObjectIDPython.h"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include <mikktspace.h>
 #include <filesystem>
 #include <cmath>
-#include <execution>
 
 namespace Falcor
 {
     namespace
     {
+        /** Specifies the version of the mesh processing in processMesh().
+            This needs to be incremented every time the processed mesh data changes, so that stale meshes in the mesh cache are not reused!
+        */
+        const uint32_t kMeshProcessingVersion = 1;
+
         // Large mesh groups are split in order to reduce the size of the largest BLAS.
         // The target is max 16M triangles per BLAS (= approx 0.5GB post-compaction). Note that this is not a strict limit.
         const size_t kMaxTrianglesPerBLAS = 1ull << 24;
@@ -361,6 +366,7 @@ namespace Falcor
         calculateMeshBoundingBoxes();
         createMeshGroups();
         optimizeGeometry();
+        optimizeVertexOrder();
         sortMeshes();
         createGlobalBuffers();
         createCurveGlobalBuffers();
@@ -398,6 +404,15 @@ namespace Falcor
             timeReport.measure("Writing cache");
         }
 
+        // Mesh cache stats are reported by the scene but not written to the scene cache.
+        mSceneData.meshCacheHitCount = mMeshCacheHitCount;
+        mSceneData.meshCacheMissCount = mMeshCacheMissCount;
+        if (mMeshCacheHitCount + mMeshCacheMissCount > 0)
+        {
+            logInfo("Mesh cache: {} hits, {} misses.", mMeshCacheHitCount.load(), mMeshCacheMissCount.load());
+        }
+        if (mMeshCacheMissCount > 0) SceneCache::pruneMeshCache();
+
         // Create the scene object.
         mpScene = Scene::create(mpDevice, std::move(mSceneData));
         mSceneData = {};
@@ -415,7 +430,37 @@ namespace Falcor
         return addProcessedMesh(processMesh(mesh));
     }
 
+    std::vector<MeshID> SceneBuilder::addMeshes(const std::vector<Mesh>& meshes)
+    {
+        std::vector<ProcessedMesh> processedMeshes = processMeshes(meshes);
+
+        // Add the meshes sequentially to retain a deterministic order of the meshes in the global scene buffers.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (const auto& processedMesh : processedMeshes) meshIDs.push_back(addProcessedMesh(processedMesh));
+        return meshIDs;
+    }
+
     MeshID SceneBuilder::addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated)
+    {
+        return addProcessedMesh(processTriangleMesh(pTriangleMesh, pMaterial, isAnimated));
+    }
+
+    std::vector<MeshID> SceneBuilder::addTriangleMeshes(const std::vector<ref<TriangleMesh>>& triangleMeshes, const std::vector<ref<Material>>& materials)
+    {
+        FALCOR_CHECK(triangleMeshes.size() == materials.size(), "'triangleMeshes' and 'materials' must have the same size");
+
+        std::vector<ProcessedMesh> processedMeshes(triangleMeshes.size());
+        Threading::parallelFor(size_t(0), triangleMeshes.size(), [&](size_t i) { processedMeshes[i] = processTriangleMesh(triangleMeshes[i], materials[i], false); }, 1);
+
+        // Add the meshes sequentially to retain a deterministic order of the meshes in the global scene buffers.
+        std::vector<MeshID> meshIDs;
+        meshIDs.reserve(processedMeshes.size());
+        for (const auto& processedMesh : processedMeshes) meshIDs.push_back(addProcessedMesh(processedMesh));
+        return meshIDs;
+    }
+
+    SceneBuilder::ProcessedMesh SceneBuilder::processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated) const
     {
         FALCOR_CHECK(pTriangleMesh != nullptr, "'pTriangleMesh' is missing");
         FALCOR_CHECK(pMaterial != nullptr, "'pMaterial' is missing");
@@ -446,7 +491,7 @@ namespace Falcor
         mesh.normals = { normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
         mesh.texCrds = { texCoords.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex };
 
-        return addMesh(mesh);
+        return processMesh(mesh);
     }
 
     SceneBuilder::ProcessedMesh SceneBuilder::processMesh(const Mesh& mesh_, MeshAttributeIndices* pAttributeIndices, std::vector<float4>* pTangents) const
@@ -499,6 +544,21 @@ namespace Falcor
             if (mesh.boneWeights.pData == nullptr) throw_on_missing_element("bone weights");
         }
 
+        // Reuse the processed data if the same mesh was processed before with the same settings, possibly while importing another scene.
+        // The cache is bypassed if the caller asks for the attribute indices or tangents, as these are not stored.
+        const bool useMeshCache = (is_set(mFlags, Flags::UseCache) || is_set(mFlags, Flags::RebuildCache)) && !pAttributeIndices && !pTangents;
+        SceneCache::Key meshCacheKey;
+        if (useMeshCache)
+        {
+            meshCacheKey = SceneCache::computeMeshCacheKey(mesh, mFlags, kMeshProcessingVersion);
+            if (!is_set(mFlags, Flags::RebuildCache) && SceneCache::readProcessedMesh(meshCacheKey, processedMesh))
+            {
+                mMeshCacheHitCount++;
+                return processedMesh;
+            }
+            mMeshCacheMissCount++;
+        }
+
         // Generate tangent space if that's required.
         std::vector<float4> localTangents;
         if (!pTangents)
@@ -694,9 +754,18 @@ namespace Falcor
             }
         }
 
+        if (useMeshCache) SceneCache::writeProcessedMesh(meshCacheKey, processedMesh);
+
         return processedMesh;
     }
 
+    std::vector<SceneBuilder::ProcessedMesh> SceneBuilder::processMeshes(const std::vector<Mesh>& meshes) const
+    {
+        std::vector<ProcessedMesh> processedMeshes(meshes.size());
+        Threading::parallelFor(size_t(0), meshes.size(), [&](size_t i) { processedMeshes[i] = processMesh(meshes[i]); }, 1);
+        return processedMeshes;
+    }
+
     void SceneBuilder::generateTangents(Mesh& mesh, std::vector<float4>& tangents)
     {
         tangents = MikkTSpaceWrapper::generateTangents(mesh);
@@ -712,8 +781,7 @@ namespace Falcor
             if (mesh.tangents.pData)
             {
                 FALCOR_ASSERT(mesh.tangents.frequency == Mesh::AttributeFrequency::FaceVarying);
-                NumericRange<uint32_t> range(0, mesh.indexCount);
-                std::for_each(std::execution::par_unseq, range.begin(), range.end(), [&](uint32_t fvIndex)
+                Threading::parallelFor(0u, mesh.indexCount, [&](uint32_t fvIndex)
                 {
                     if (!any(isnan(mesh.tangents.pData[fvIndex])))
                         return;
@@ -2369,6 +2437,61 @@ namespace Falcor
         mMeshGroups = std::move(optimizedGroups);
     }
 
+    void SceneBuilder::optimizeVertexOrder()
+    {
+        if (!is_set(mFlags, Flags::OptimizeVertexOrder)) return;
+
+        // The vertices of tessellated curves are rewritten in tessellation order by the curve vertex caches, so we leave them as is.
+        std::vector<bool> isCurveMesh(mMeshes.size(), false);
+        for (const auto& cache : mSceneData.cachedCurves)
+        {
+            if (cache.tessellationMode != CurveTessellationMode::LinearSweptSphere) isCurveMesh[cache.geometryID.get()] = true;
+        }
+
+        // The vertex caches store the animated vertices in the mesh vertex order, so they are remapped along with the mesh.
+        std::vector<std::vector<CachedMesh*>> meshVertexCaches(mMeshes.size());
+        for (auto& cache : mSceneData.cachedMeshes) meshVertexCaches[cache.meshID.get()].push_back(&cache);
+
+        std::atomic<uint64_t> triangleCount{ 0 };
+        std::atomic<uint64_t> missCountBefore{ 0 };
+        std::atomic<uint64_t> missCountAfter{ 0 };
+
+        auto optimizeMesh = [&](size_t meshIndex)
+        {
+            auto& mesh = mMeshes[meshIndex];
+            if (mesh.topology != Vao::Topology::TriangleList || mesh.indexCount == 0 || isCurveMesh[meshIndex]) return;
+
+            FALCOR_ASSERT(mesh.staticData.size() == mesh.vertexCount);
+            std::vector<uint32_t> indices(mesh.indexCount);
+            for (uint32_t i = 0; i < mesh.indexCount; i++) indices[i] = mesh.getIndex(i);
+
+            missCountBefore += MeshOptimizer::countVertexCacheMisses(indices.data(), indices.size(), mesh.vertexCount);
+            MeshOptimizer::optimizeVertexCache(indices, mesh.vertexCount);
+            const std::vector<uint32_t> remap = MeshOptimizer::optimizeVertexFetch(indices, mesh.vertexCount);
+            missCountAfter += MeshOptimizer::countVertexCacheMisses(indices.data(), indices.size(), mesh.vertexCount);
+            triangleCount += mesh.getTriangleCount();
+
+            MeshOptimizer::remapVertices(remap, mesh.staticData);
+            if (mesh.hasSkinningData) MeshOptimizer::remapVertices(remap, mesh.skinningData);
+            for (CachedMesh* pCache : meshVertexCaches[meshIndex])
+            {
+                for (auto& keyframe : pCache->vertexData)
+                {
+                    FALCOR_CHECK(keyframe.size() == mesh.vertexCount, "Vertex cache of mesh '{}' has {} vertices, expected {}.", mesh.name, keyframe.size(), mesh.vertexCount);
+                    MeshOptimizer::remapVertices(remap, keyframe);
+                }
+            }
+
+            mesh.indexData = mesh.use16BitIndices ? compact16BitIndices(indices) : std::move(indices);
+        };
+        Threading::parallelFor(size_t(0), mMeshes.size(), optimizeMesh, 1);
+
+        if (triangleCount > 0)
+        {
+            logInfo("Optimized vertex order of scene meshes: ACMR {:.3f} -> {:.3f}.", double(missCountBefore.load()) / triangleCount.load(), double(missCountAfter.load()) / triangleCount.load());
+        }
+    }
+
     void SceneBuilder::sortMeshes()
     {
         // This function sorts meshes by the order they are used in the mesh groups.
@@ -2438,6 +2561,15 @@ namespace Falcor
 
         mSceneData.meshIndexData.setName("mMeshIndexData");
         mSceneData.meshStaticData.setName("meshStaticData");
+        mSceneData.meshCompactData.setName("meshCompactData");
+
+        // Compact vertices are quantized once here, so they can't be used for meshes that are updated at runtime.
+        mSceneData.useCompactVertices = is_set(mFlags, Flags::UseCompactVertices);
+        if (mSceneData.useCompactVertices && std::any_of(mMeshes.begin(), mMeshes.end(), [](const auto& mesh) { return mesh.isDynamic(); }))
+        {
+            logWarning("Scene has dynamic meshes. Ignoring SceneBuilder::Flags::UseCompactVertices.");
+            mSceneData.useCompactVertices = false;
+        }
 
         mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
 
@@ -2449,7 +2581,19 @@ namespace Falcor
 
             // Insert the static vertex data in the global array.
             // The vertices are automatically converted to their packed format in this step.
-            mesh.staticVertexOffset = mSceneData.meshStaticData.insert(mesh.staticData.begin(), mesh.staticData.end());
+            if (mSceneData.useCompactVertices)
+            {
+                // Positions are quantized relative to the mesh bounding box, see createMeshData().
+                const float3 center = mesh.boundingBox.center();
+                const float3 halfExtent = mesh.boundingBox.extent() * 0.5f;
+                std::vector<PackedCompactVertexData> compactData(mesh.staticData.size());
+                Threading::parallelFor(size_t(0), mesh.staticData.size(), [&](size_t i) { compactData[i].pack(mesh.staticData[i], center, halfExtent); }, 4096);
+                mesh.staticVertexOffset = mSceneData.meshCompactData.insert(compactData.begin(), compactData.end());
+            }
+            else
+            {
+                mesh.staticVertexOffset = mSceneData.meshStaticData.insert(mesh.staticData.begin(), mesh.staticData.end());
+            }
 
             if (isIndexed)
             {
@@ -2593,6 +2737,9 @@ namespace Falcor
         // Match texture coordinate quantization for textured emissives to format of PackedEmissiveTriangle.
         // This is to avoid mismatch when sampling and evaluating emissive triangles.
         // Note that non-emissive meshes are unmodified and use full precision texcoords.
+        // Compact vertices always store fp16 texcoords, so there is nothing to do for them.
+        if (mSceneData.useCompactVertices) return;
+
         for (auto& mesh : mMeshes)
         {
             const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
@@ -2692,6 +2839,11 @@ namespace Falcor
             meshData[meshID].indexCount = mesh.indexCount;
             meshData[meshID].skinningVbOffset = mesh.hasSkinningData ? mesh.skinningVertexOffset : 0;
             meshData[meshID].prevVbOffset = mesh.isDynamic() ? mesh.prevVertexOffset : 0;
+            if (mesh.boundingBox.valid())
+            {
+                meshData[meshID].positionCenter = mesh.boundingBox.center();
+                meshData[meshID].positionHalfExtent = mesh.boundingBox.extent() * 0.5f;
+            }
             FALCOR_ASSERT(mesh.skinningVertexCount == 0 || mesh.skinningVertexCount == mesh.staticVertexCount);
 
             mSceneData.meshNames.push_back(mesh.name);
@@ -2962,6 +3114,8 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("UseCompactVertices", SceneBuilder::Flags::UseCompactVertices);
+        flags.value("OptimizeVertexOrder", SceneBuilder::Flags::OptimizeVertexOrder);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
         ScriptBindings::addEnumBinaryOperators(flags);
@@ -27,7 +27,6 @@
  **************************************************************************/
 #pragma once
 #include "Scene.h"
-#include "SceneCache.h"
 #include "SceneIDs.h"
 #include "Transform.h"
 #include "TriangleMesh.h"
@@ -38,6 +37,7 @@
 #include "Core/Macros.h"
 #include "Core/AssetResolver.h"
 #include "Core/API/VAO.h"
+#include "Utils/CryptoUtils.h"
 #include "Utils/Math/AABB.h"
 #include "Utils/Math/Vector.h"
 #include "Utils/Math/Matrix.h"
@@ -45,6 +45,7 @@
 
 #include <pybind11/pytypes.h>
 
+#include <atomic>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -77,6 +78,8 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            UseCompactVertices              = 0x20000,  ///< Store mesh vertices quantized in 16B instead of 32B (positions relative to the mesh bounds, octahedral normal/tangent and fp16 texture coordinates). Ignored if the scene has dynamic meshes.
+            OptimizeVertexOrder             = 0x40000,  ///< Reorder the triangles of indexed meshes for the post-transform vertex cache, then their vertices in order of first use for fetch locality. The vertex and triangle order of the imported meshes is not preserved.
 
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
@@ -169,7 +172,7 @@ namespace Falcor
             }
 
             template<typename T>
-            size_t getAttributeCount(const Attribute<T>& attribute)
+            size_t getAttributeCount(const Attribute<T>& attribute) const
             {
                 switch (attribute.frequency)
                 {
@@ -415,6 +418,14 @@ namespace Falcor
         */
         MeshID addMesh(const Mesh& mesh);
 
+        /** Add a batch of meshes.
+            The meshes are processed in parallel and then added in order, so the mesh IDs are the same as when adding them one by one with addMesh().
+            Throws an exception if something went wrong.
+            \param meshes The meshes to add.
+            \return The IDs of the meshes in the scene, in the same order as the input meshes.
+        */
+        std::vector<MeshID> addMeshes(const std::vector<Mesh>& meshes);
+
         /** Add a triangle mesh.
             \param The triangle mesh to add.
             \param pMaterial The material to use for the mesh.
@@ -423,6 +434,14 @@ namespace Falcor
         */
         MeshID addTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated = false);
 
+        /** Add a batch of triangle meshes.
+            The meshes are processed in parallel and then added in order, so the mesh IDs are the same as when adding them one by one with addTriangleMesh().
+            \param triangleMeshes The triangle meshes to add.
+            \param materials The material to use for each triangle mesh.
+            \return The IDs of the meshes in the scene, in the same order as the input meshes.
+        */
+        std::vector<MeshID> addTriangleMeshes(const std::vector<ref<TriangleMesh>>& triangleMeshes, const std::vector<ref<Material>>& materials);
+
         /** Pre-process a mesh into the data format that is used in the global scene buffers.
             Throws an exception if something went wrong.
             \param mesh The mesh to pre-process.
@@ -432,6 +451,13 @@ namespace Falcor
         */
         ProcessedMesh processMesh(const Mesh& mesh, MeshAttributeIndices* pAttributeIndices = nullptr, std::vector<float4>* pTangents = nullptr) const;
 
+        /** Pre-process a batch of meshes in parallel.
+            Throws an exception if something went wrong with any of the meshes.
+            \param meshes The meshes to pre-process.
+            \return The pre-processed meshes, in the same order as the input meshes.
+        */
+        std::vector<ProcessedMesh> processMeshes(const std::vector<Mesh>& meshes) const;
+
         /** Generate tangents for a mesh.
             \param mesh The mesh to generate tangents for. If successful, the tangent attribute on the mesh will be set to the output vector.
             \param tangents Output for generated tangents.
@@ -775,8 +801,10 @@ namespace Falcor
 
         Scene::SceneData mSceneData;
         ref<Scene> mpScene;
-        SceneCache::Key mSceneCacheKey;
+        SHA1::MD mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        mutable std::atomic<uint64_t> mMeshCacheHitCount{ 0 };   ///< Number of meshes reused from the mesh cache. Updated by processMesh().
+        mutable std::atomic<uint64_t> mMeshCacheMissCount{ 0 };  ///< Number of meshes processed and written to the mesh cache. Updated by processMesh().
 
         SceneGraph mSceneGraph;
 
@@ -788,6 +816,7 @@ namespace Falcor
         std::unique_ptr<MaterialTextureLoader> mpMaterialTextureLoader;
 
         // Helpers
+        ProcessedMesh processTriangleMesh(const ref<TriangleMesh>& pTriangleMesh, const ref<Material>& pMaterial, bool isAnimated) const;
         bool doesNodeHaveAnimation(NodeID nodeID) const;
         void updateLinkedObjects(NodeID oldNodeID, NodeID newNodeID);
         bool collapseNodes(NodeID parentNodeID, NodeID childNodeID);
@@ -823,6 +852,7 @@ namespace Falcor
         void calculateMeshBoundingBoxes();
         void createMeshGroups();
         void optimizeGeometry();
+        void optimizeVertexOrder();
         void sortMeshes();
         void createGlobalBuffers();
         void createCurveGlobalBuffers();
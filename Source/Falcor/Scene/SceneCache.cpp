@@ -30,11 +30,15 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
-#include <lz4_stream/lz4_stream.h>
+#include <lz4.h>
 
+#include <algorithm>
 #include <fstream>
+#include <thread>
 
 namespace Falcor
 {
@@ -43,37 +47,260 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 28;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
+        /** Mesh cache directory (subdirectory in the scene cache directory).
+            Processed meshes are stored here by the hash of their source data, independently of the scene they were imported from.
+        */
+        const std::string kMeshDirectory = "Meshes";
+
+        /** Maximum total size of the mesh cache in bytes. The least recently used meshes are removed beyond this size.
+        */
+        const uintmax_t kMaxMeshCacheSize = 4ull * 1024 * 1024 * 1024;
+
+        /** Sections are compressed in independent chunks of this size, so that large sections are also decompressed in parallel.
+        */
+        const size_t kChunkSize = 4 * 1024 * 1024;
+
+        /** Trivially copyable arrays of at least this many bytes are stored in their own section instead of inline in the scene description.
+        */
+        const size_t kMinSectionSize = 64 * 1024;
+
+        template<typename T>
+        void hashMeshAttribute(SHA1& sha1, const SceneBuilder::Mesh& mesh, const SceneBuilder::Mesh::Attribute<T>& attribute)
+        {
+            uint64_t count = attribute.pData ? mesh.getAttributeCount(attribute) : 0;
+            sha1.update(attribute.frequency);
+            sha1.update(count);
+            if (count > 0) sha1.update(attribute.pData, count * sizeof(T));
+        }
 
         const char* kMagic = "FalcorS$";
         struct Header
         {
             uint8_t magic[8]{};
             uint32_t version{};
+            uint32_t sectionCount{};    ///< Number of entries in the section table following the header.
+            uint32_t chunkCount{};      ///< Number of entries in the chunk table following the section table.
 
             bool isValid() const
             {
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        /** Entry of the section table.
+            Section 0 holds the serialized scene description, the other sections hold the large arrays it refers to.
+        */
+        struct SectionDesc
+        {
+            uint64_t size = 0;          ///< Uncompressed size in bytes.
+            uint32_t firstChunk = 0;    ///< Index of the first chunk of the section in the chunk table.
+            uint32_t chunkCount = 0;    ///< Number of chunks of the section.
+        };
+
+        /** Entry of the chunk table.
+            Chunks that LZ4 does not make smaller are stored uncompressed (storedSize == size).
+        */
+        struct ChunkDesc
+        {
+            uint64_t offset = 0;        ///< Offset from the start of the file in bytes.
+            uint32_t storedSize = 0;    ///< Size in the file in bytes.
+            uint32_t size = 0;          ///< Uncompressed size in bytes.
+        };
+
+        struct SectionData
+        {
+            const uint8_t* pData = nullptr;
+            size_t size = 0;
+        };
+
+        /** Compresses the sections and writes them with the section and chunk tables.
+            All the chunks are compressed in parallel.
+        */
+        void writeSections(std::ostream& fs, const std::vector<SectionData>& sections)
+        {
+            std::vector<SectionDesc> sectionDescs(sections.size());
+            std::vector<ChunkDesc> chunkDescs;
+            std::vector<const uint8_t*> chunkData;
+            for (size_t sectionIndex = 0; sectionIndex < sections.size(); ++sectionIndex)
+            {
+                const SectionData& section = sections[sectionIndex];
+                SectionDesc& sectionDesc = sectionDescs[sectionIndex];
+                sectionDesc.size = section.size;
+                sectionDesc.firstChunk = (uint32_t)chunkDescs.size();
+                for (size_t offset = 0; offset < section.size; offset += kChunkSize)
+                {
+                    ChunkDesc chunkDesc;
+                    chunkDesc.size = (uint32_t)std::min(kChunkSize, section.size - offset);
+                    chunkDescs.push_back(chunkDesc);
+                    chunkData.push_back(section.pData + offset);
+                }
+                sectionDesc.chunkCount = (uint32_t)chunkDescs.size() - sectionDesc.firstChunk;
+            }
+
+            // Compress the chunks. An empty buffer means that the chunk is stored uncompressed.
+            std::vector<std::vector<uint8_t>> compressedChunks(chunkDescs.size());
+            Threading::parallelFor(size_t(0), chunkDescs.size(), [&](size_t chunkIndex)
+            {
+                ChunkDesc& chunkDesc = chunkDescs[chunkIndex];
+                std::vector<uint8_t>& compressed = compressedChunks[chunkIndex];
+                compressed.resize(LZ4_compressBound((int)chunkDesc.size));
+                int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(chunkData[chunkIndex]), reinterpret_cast<char*>(compressed.data()), (int)chunkDesc.size, (int)compressed.size());
+                if (compressedSize > 0 && (uint32_t)compressedSize < chunkDesc.size)
+                {
+                    compressed.resize(compressedSize);
+                    compressed.shrink_to_fit();
+                }
+                else
+                {
+                    compressed = {};
+                }
+                chunkDesc.storedSize = compressed.empty() ? chunkDesc.size : (uint32_t)compressed.size();
+            }, 1);
+
+            uint64_t offset = sizeof(Header) + sectionDescs.size() * sizeof(SectionDesc) + chunkDescs.size() * sizeof(ChunkDesc);
+            for (ChunkDesc& chunkDesc : chunkDescs)
+            {
+                chunkDesc.offset = offset;
+                offset += chunkDesc.storedSize;
+            }
+
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            header.sectionCount = (uint32_t)sectionDescs.size();
+            header.chunkCount = (uint32_t)chunkDescs.size();
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            fs.write(reinterpret_cast<const char*>(sectionDescs.data()), sectionDescs.size() * sizeof(SectionDesc));
+            fs.write(reinterpret_cast<const char*>(chunkDescs.data()), chunkDescs.size() * sizeof(ChunkDesc));
+            for (size_t chunkIndex = 0; chunkIndex < chunkDescs.size(); ++chunkIndex)
+            {
+                const uint8_t* pData = compressedChunks[chunkIndex].empty() ? chunkData[chunkIndex] : compressedChunks[chunkIndex].data();
+                fs.write(reinterpret_cast<const char*>(pData), chunkDescs[chunkIndex].storedSize);
+            }
+        }
+
+        /** Read access to the sections of a memory-mapped cache file.
+        */
+        class SectionReader
+        {
+        public:
+            struct Read
+            {
+                uint32_t section;
+                void* pDst;
+            };
+
+            SectionReader(const std::filesystem::path& path) : mFile(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan)
+            {
+                if (!mFile.isOpen()) FALCOR_THROW("Failed to open scene cache file '{}'.", path);
+                const uint8_t* pFileData = getFileData();
+
+                Header header;
+                if (mFile.getSize() < sizeof(header)) FALCOR_THROW("Invalid header in scene cache file '{}'.", path);
+                std::memcpy(&header, pFileData, sizeof(header));
+                if (!header.isValid()) FALCOR_THROW("Invalid header in scene cache file '{}'.", path);
+
+                size_t tableSize = header.sectionCount * sizeof(SectionDesc) + header.chunkCount * sizeof(ChunkDesc);
+                if (header.sectionCount == 0 || mFile.getSize() < sizeof(header) + tableSize) FALCOR_THROW("Invalid section table in scene cache file '{}'.", path);
+                mSections.resize(header.sectionCount);
+                mChunks.resize(header.chunkCount);
+                std::memcpy(mSections.data(), pFileData + sizeof(header), mSections.size() * sizeof(SectionDesc));
+                std::memcpy(mChunks.data(), pFileData + sizeof(header) + mSections.size() * sizeof(SectionDesc), mChunks.size() * sizeof(ChunkDesc));
+
+                for (const SectionDesc& section : mSections)
+                {
+                    uint64_t size = 0;
+                    bool valid = (uint64_t)section.firstChunk + section.chunkCount <= mChunks.size();
+                    for (uint32_t chunkIndex = section.firstChunk; valid && chunkIndex < section.firstChunk + section.chunkCount; ++chunkIndex)
+                    {
+                        const ChunkDesc& chunk = mChunks[chunkIndex];
+                        valid = chunk.offset + chunk.storedSize <= mFile.getSize() && chunk.storedSize <= chunk.size && chunk.size <= kChunkSize;
+                        size += chunk.size;
+                    }
+                    if (!valid || size != section.size) FALCOR_THROW("Invalid section table in scene cache file '{}'.", path);
+                }
+            }
+
+            uint32_t getSectionCount() const { return (uint32_t)mSections.size(); }
+
+            size_t getSectionSize(uint32_t section) const { return mSections[section].size; }
+
+            /** Returns the data of a section in place if it is stored in a single uncompressed chunk, nullptr otherwise.
+            */
+            const uint8_t* getMappedData(uint32_t section) const
+            {
+                const SectionDesc& sectionDesc = mSections[section];
+                if (sectionDesc.chunkCount != 1) return nullptr;
+                const ChunkDesc& chunk = mChunks[sectionDesc.firstChunk];
+                return chunk.storedSize == chunk.size ? getFileData() + chunk.offset : nullptr;
+            }
+
+            /** Decompresses sections into their destinations. All the chunks are decompressed in parallel.
+                Uncompressed chunks are copied from the mapped file.
+            */
+            void readSections(const std::vector<Read>& reads) const
+            {
+                std::vector<std::pair<uint32_t, uint8_t*>> chunks;
+                for (const Read& read : reads)
+                {
+                    const SectionDesc& section = mSections[read.section];
+                    for (uint32_t i = 0; i < section.chunkCount; ++i)
+                    {
+                        chunks.emplace_back(section.firstChunk + i, reinterpret_cast<uint8_t*>(read.pDst) + i * kChunkSize);
+                    }
+                }
+
+                Threading::parallelFor(size_t(0), chunks.size(), [&](size_t i)
+                {
+                    const ChunkDesc& chunk = mChunks[chunks[i].first];
+                    const uint8_t* pSrc = getFileData() + chunk.offset;
+                    uint8_t* pDst = chunks[i].second;
+                    if (chunk.storedSize == chunk.size)
+                    {
+                        std::memcpy(pDst, pSrc, chunk.size);
+                    }
+                    else if (LZ4_decompress_safe(reinterpret_cast<const char*>(pSrc), reinterpret_cast<char*>(pDst), (int)chunk.storedSize, (int)chunk.size) != (int)chunk.size)
+                    {
+                        FALCOR_THROW("Failed to decompress scene cache chunk.");
+                    }
+                }, 1);
+            }
+
+        private:
+            const uint8_t* getFileData() const { return reinterpret_cast<const uint8_t*>(mFile.getData()); }
+
+            MemoryMappedFile mFile;
+            std::vector<SectionDesc> mSections;
+            std::vector<ChunkDesc> mChunks;
+        };
     }
 
-    /** Wrapper around std::ostream to ease serialization of basic types.
+    /** Helper to ease serialization of basic types into the scene description.
+        Large trivially copyable arrays are referenced from the description and stored in their own section.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
-
         void write(const void* data, size_t len)
         {
-            mStream.write(reinterpret_cast<const char*>(data), len);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+            mDescription.insert(mDescription.end(), bytes, bytes + len);
+        }
+
+        /** Write a block of bytes, in a separate section if it is large.
+            The data is not copied and must stay valid until the cache is written.
+        */
+        void writeBlock(const void* data, size_t len)
+        {
+            if (len < kMinSectionSize) return write(data, len);
+            write((uint32_t)mSections.size());
+            mSections.push_back({ reinterpret_cast<const uint8_t*>(data), len });
         }
 
         template<typename T>
@@ -99,9 +326,9 @@ namespace Falcor
         {
             uint64_t len = vec.size();
             write(len);
-            if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
+            if constexpr (std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value)
             {
-                write(vec.data(), len * sizeof(T));
+                writeBlock(vec.data(), len * sizeof(T));
             }
             else
             {
@@ -128,26 +355,69 @@ namespace Falcor
             }
         }
 
+        /** Returns all the sections, starting with the scene description.
+        */
+        std::vector<SectionData> getSections() const
+        {
+            std::vector<SectionData> sections = mSections;
+            sections[0] = { mDescription.data(), mDescription.size() };
+            return sections;
+        }
+
     private:
-        std::ostream& mStream;
+        std::vector<uint8_t> mDescription;
+        std::vector<SectionData> mSections = std::vector<SectionData>(1); ///< Section 0 is the description.
     };
 
-    /** Wrapper around std::istream to ease serialization of basic types.
+    /** Helper to ease deserialization of basic types from the scene description.
+        The description is parsed in place from the mapped file when it is stored uncompressed.
     */
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(const SectionReader& reader) : mReader(reader)
+        {
+            mpData = reader.getMappedData(0);
+            mSize = reader.getSectionSize(0);
+            if (!mpData)
+            {
+                mDescription.resize(mSize);
+                reader.readSections({ { 0, mDescription.data() } });
+                mpData = mDescription.data();
+            }
+        }
 
         void read(void* data, size_t len)
         {
-            mStream.read(reinterpret_cast<char*>(data), len);
+            if (len > mSize - mOffset) FALCOR_THROW("Unexpected end of scene cache.");
+            std::memcpy(data, mpData + mOffset, len);
+            mOffset += len;
         }
 
-        template<typename T>
-        void read(T& value)
+        /** Read a block of bytes written with OutputStream::writeBlock().
+            Blocks stored in their own section are read immediately unless deferLargeReads() was called.
+        */
+        void readBlock(void* data, size_t len)
         {
-            read(&value, sizeof(T));
+            if (len < kMinSectionSize) return read(data, len);
+            uint32_t section = read<uint32_t>();
+            if (section == 0 || section >= mReader.getSectionCount() || mReader.getSectionSize(section) != len) FALCOR_THROW("Invalid section in scene cache.");
+            mPendingReads.push_back({ section, data });
+            if (!mDeferLargeReads) finishDeferredReads();
+        }
+
+        /** Defer the reads of blocks stored in their own section until finishDeferredReads() is called,
+            so that they are all decompressed in parallel. The destinations must not be used or moved until then.
+        */
+        void deferLargeReads() { mDeferLargeReads = true; }
+
+        /** Read all the deferred blocks.
+        */
+        void finishDeferredReads()
+        {
+            mReader.readSections(mPendingReads);
+            mPendingReads.clear();
+            mDeferLargeReads = false;
         }
 
         void read(std::string& value)
@@ -172,14 +442,20 @@ namespace Falcor
             return value;
         }
 
+        template<typename T>
+        void read(T& value)
+        {
+            read(&value, sizeof(T));
+        }
+
         template<typename T>
         void read(std::vector<T>& vec)
         {
             uint64_t len = read<uint64_t>();
             vec.resize(len);
-            if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
+            if constexpr (std::is_trivially_copyable<T>::value && !std::is_same<T, bool>::value)
             {
-                read(vec.data(), len * sizeof(T));
+                readBlock(vec.data(), len * sizeof(T));
             }
             else
             {
@@ -193,9 +469,8 @@ namespace Falcor
             bool hasValue = read<bool>();
             if (hasValue)
             {
-                T value;
-                read(value);
-                opt = value;
+                // Read in place, deferred reads must target the final storage.
+                read(opt.emplace());
             }
         }
 
@@ -206,13 +481,18 @@ namespace Falcor
             for (uint32_t i = 0; i < count; ++i)
             {
                 K k = read<K>();
-                V v = read<V>();
-                map.emplace(k, v);
+                read(map[k]);
             }
         }
 
     private:
-        std::istream& mStream;
+        const SectionReader& mReader;
+        const uint8_t* mpData = nullptr;
+        size_t mSize = 0;
+        size_t mOffset = 0;
+        std::vector<uint8_t> mDescription;  ///< Decompressed description, if it is not parsed in place.
+        std::vector<SectionReader::Read> mPendingReads;
+        bool mDeferLargeReads = false;
     };
 
     bool SceneCache::hasValidCache(const Key& key)
@@ -243,16 +523,10 @@ namespace Falcor
         std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
         if (fs.bad()) FALCOR_THROW("Failed to create scene cache file '{}'.", cachePath);
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
-
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
+        // Serialize the scene, then write the header, the tables and the compressed sections.
+        OutputStream stream;
         writeSceneData(stream, sceneData);
+        writeSections(fs, stream.getSections());
         if (fs.bad()) FALCOR_THROW("Failed to write scene cache file to '{}'.", cachePath);
     }
 
@@ -262,21 +536,174 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) FALCOR_THROW("Failed to open scene cache file '{}'.", cachePath);
+        // Map the file and read the header and tables.
+        SectionReader reader(cachePath);
+        InputStream stream(reader);
+        return readSceneData(stream, pDevice);
+    }
 
-        // Read header (uncompressed).
-        Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        if (!header.isValid()) FALCOR_THROW("Invalid header in scene cache file '{}'.", cachePath);
+    SceneCache::Key SceneCache::computeMeshCacheKey(const SceneBuilder::Mesh& mesh, SceneBuilder::Flags buildFlags, uint32_t processingVersion)
+    {
+        SceneBuilder::Flags meshFlags = buildFlags & (SceneBuilder::Flags::UseOriginalTangentSpace | SceneBuilder::Flags::NonIndexedVertices | SceneBuilder::Flags::Force32BitIndices);
+        const float4x4 texCoordTransform = mesh.pMaterial ? mesh.pMaterial->getTextureTransform().getMatrix() : float4x4::identity();
+
+        SHA1 sha1;
+        sha1.update(processingVersion);
+        sha1.update(meshFlags);
+        sha1.update(texCoordTransform);
+        sha1.update(mesh.topology);
+        sha1.update(mesh.useOriginalTangentSpace);
+        sha1.update(mesh.mergeDuplicateVertices);
+        sha1.update(mesh.faceCount);
+        sha1.update(mesh.vertexCount);
+        sha1.update(mesh.indexCount);
+        sha1.update(mesh.pIndices, mesh.indexCount * sizeof(uint32_t));
+        hashMeshAttribute(sha1, mesh, mesh.positions);
+        hashMeshAttribute(sha1, mesh, mesh.normals);
+        hashMeshAttribute(sha1, mesh, mesh.tangents);
+        hashMeshAttribute(sha1, mesh, mesh.texCrds);
+        hashMeshAttribute(sha1, mesh, mesh.curveRadii);
+        hashMeshAttribute(sha1, mesh, mesh.boneIDs);
+        hashMeshAttribute(sha1, mesh, mesh.boneWeights);
+        return sha1.finalize();
+    }
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) FALCOR_THROW("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+    bool SceneCache::readProcessedMesh(const Key& key, SceneBuilder::ProcessedMesh& mesh)
+    {
+        auto cachePath = getMeshCachePath(key);
+        if (!std::filesystem::exists(cachePath)) return false;
+
+        // Read into a temporary so that the mesh is left unchanged if the cache file is invalid.
+        SceneBuilder::ProcessedMesh cachedMesh;
+        try
+        {
+            SectionReader reader(cachePath);
+            InputStream stream(reader);
+            readMarker(stream, "ProcessedMesh");
+            stream.read(cachedMesh.indexCount);
+            stream.read(cachedMesh.use16BitIndices);
+            stream.read(cachedMesh.indexData);
+            stream.read(cachedMesh.staticData);
+            stream.read(cachedMesh.skinningData);
+            readMarker(stream, "End");
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Ignoring invalid mesh cache file '{}': {}", cachePath, e.what());
+            return false;
+        }
+
+        // Update the modification time so that pruneMeshCache() removes the least recently used meshes first.
+        std::error_code ec;
+        std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), ec);
+
+        mesh.indexCount = cachedMesh.indexCount;
+        mesh.use16BitIndices = cachedMesh.use16BitIndices;
+        mesh.indexData = std::move(cachedMesh.indexData);
+        mesh.staticData = std::move(cachedMesh.staticData);
+        mesh.skinningData = std::move(cachedMesh.skinningData);
+        return true;
+    }
+
+    void SceneCache::writeProcessedMesh(const Key& key, const SceneBuilder::ProcessedMesh& mesh)
+    {
+        // The mesh cache only speeds up later imports, so failing to write it is not an error.
+        auto cachePath = getMeshCachePath(key);
+
+        // Create directories if not existing.
+        std::error_code ec;
+        std::filesystem::create_directories(cachePath.parent_path(), ec);
+        if (ec)
+        {
+            logWarning("Failed to create mesh cache directory '{}': {}", cachePath.parent_path(), ec.message());
+            return;
+        }
+
+        // Meshes are processed in parallel and identical meshes share the same key. Write to a file unique to this thread
+        // and rename it afterwards, so that readers never see a partially written file.
+        auto tempPath = cachePath;
+        tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        bool written = false;
+        {
+            std::ofstream fs(tempPath.c_str(), std::ios_base::binary);
+            if (fs)
+            {
+                OutputStream stream;
+                writeMarker(stream, "ProcessedMesh");
+                stream.write(mesh.indexCount);
+                stream.write(mesh.use16BitIndices);
+                stream.write(mesh.indexData);
+                stream.write(mesh.staticData);
+                stream.write(mesh.skinningData);
+                writeMarker(stream, "End");
+                writeSections(fs, stream.getSections());
+                fs.flush();
+                written = fs.good();
+            }
+        }
+
+        if (!written)
+        {
+            logWarning("Failed to write mesh cache file '{}'.", tempPath);
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            logWarning("Failed to write mesh cache file '{}': {}", cachePath, ec.message());
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
+    void SceneCache::pruneMeshCache()
+    {
+        pruneMeshCache(getAppDataDirectory() / kDirectory / kMeshDirectory, kMaxMeshCacheSize);
+    }
+
+    void SceneCache::pruneMeshCache(const std::filesystem::path& meshDirectory, uintmax_t maxSize)
+    {
+        struct Entry
+        {
+            std::filesystem::path path;
+            uintmax_t size;
+            std::filesystem::file_time_type time;
+        };
+
+        // Temporary files left in the directory are from interrupted writes and are removed.
+        std::error_code ec;
+        std::vector<Entry> entries;
+        uintmax_t totalSize = 0;
+        for (const auto& it : std::filesystem::directory_iterator(meshDirectory, ec))
+        {
+            if (!it.is_regular_file(ec)) continue;
+            if (it.path().extension() == ".tmp")
+            {
+                std::filesystem::remove(it.path(), ec);
+                continue;
+            }
+            Entry entry{it.path(), it.file_size(ec), it.last_write_time(ec)};
+            if (ec) continue;
+            totalSize += entry.size;
+            entries.push_back(std::move(entry));
+        }
+        if (totalSize <= maxSize) return;
+
+        // Remove the least recently used meshes until the cache fits.
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+        size_t removedCount = 0;
+        for (const auto& entry : entries)
+        {
+            if (totalSize <= maxSize) break;
+            if (std::filesystem::remove(entry.path, ec))
+            {
+                totalSize -= entry.size;
+                removedCount++;
+            }
+        }
+        logInfo("Pruned {} meshes from the mesh cache in '{}'.", removedCount, meshDirectory);
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -284,6 +711,11 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
+    std::filesystem::path SceneCache::getMeshCachePath(const Key& key)
+    {
+        return getAppDataDirectory() / kDirectory / kMeshDirectory / SHA1::toString(key);
+    }
+
     // SceneData
 
     void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
@@ -372,11 +804,13 @@ namespace Falcor
             for (const auto& data : cachedMesh.vertexData) stream.write(data);
         }
         stream.write(sceneData.useCompressedHitInfo);
+        stream.write(sceneData.useCompactVertices);
         stream.write(sceneData.has16BitIndices);
         stream.write(sceneData.has32BitIndices);
         stream.write(sceneData.meshDrawCount);
         writeSplitBuffer(stream, sceneData.meshIndexData);
         writeSplitBuffer(stream, sceneData.meshStaticData);
+        writeSplitBuffer(stream, sceneData.meshCompactData);
         stream.write(sceneData.meshSkinningData);
 
         writeMarker(stream, "Curves");
@@ -465,6 +899,10 @@ namespace Falcor
             stream.read(node.localToBindSpace);
         }
 
+        // The large arrays from here on are only used once the scene is created,
+        // so they are all decompressed in parallel before returning.
+        stream.deferLargeReads();
+
         readMarker(stream, "Animations");
         sceneData.animations.resize(stream.read<uint32_t>());
         for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
@@ -498,11 +936,13 @@ namespace Falcor
             for (auto& data : cachedMesh.vertexData) stream.read(data);
         }
         stream.read(sceneData.useCompressedHitInfo);
+        stream.read(sceneData.useCompactVertices);
         stream.read(sceneData.has16BitIndices);
         stream.read(sceneData.has32BitIndices);
         stream.read(sceneData.meshDrawCount);
         readSplitBuffer(stream, sceneData.meshIndexData);
         readSplitBuffer(stream, sceneData.meshStaticData);
+        readSplitBuffer(stream, sceneData.meshCompactData);
         stream.read(sceneData.meshSkinningData);
 
         readMarker(stream, "Curves");
@@ -529,6 +969,8 @@ namespace Falcor
 
         readMarker(stream, "End");
 
+        stream.finishDeferredReads();
+
         pMaterialTextureLoader.reset();
 
         return sceneData;
@@ -891,14 +1333,14 @@ namespace Falcor
     {
         const nanovdb::HostBuffer& buffer = pGrid->mGridHandle.buffer();
         stream.write((uint64_t)buffer.size());
-        stream.write(buffer.data(), buffer.size());
+        stream.writeBlock(buffer.data(), buffer.size());
     }
 
     ref<Grid> SceneCache::readGrid(InputStream& stream, ref<Device> pDevice)
     {
         uint64_t size = stream.read<uint64_t>();
         auto buffer = nanovdb::HostBuffer::create(size);
-        stream.read(buffer.data(), buffer.size());
+        stream.readBlock(buffer.data(), buffer.size());
         return ref<Grid>(new Grid(pDevice, nanovdb::GridHandle<nanovdb::HostBuffer>(std::move(buffer))));
     }
 
@@ -906,8 +1348,10 @@ namespace Falcor
 
     void SceneCache::writeEnvMap(OutputStream& stream, const ref<EnvMap>& pEnvMap)
     {
-        auto path = pEnvMap->getEnvMap()->getSourcePath();
-        stream.write(path);
+        const auto& pTexture = pEnvMap->getEnvMap();
+        stream.write(pTexture->getSourcePath());
+        // Reloading with the loaded size as maximum resolution drops the same mip levels as the original load.
+        stream.write(std::max(pTexture->getWidth(), pTexture->getHeight()));
         stream.write(pEnvMap->mData);
         stream.write(pEnvMap->mRotation);
     }
@@ -915,7 +1359,8 @@ namespace Falcor
     ref<EnvMap> SceneCache::readEnvMap(InputStream& stream, ref<Device> pDevice)
     {
         auto path = stream.read<std::filesystem::path>();
-        auto pEnvMap = EnvMap::createFromFile(pDevice, path);
+        auto maxResolution = stream.read<uint32_t>();
+        auto pEnvMap = EnvMap::createFromFile(pDevice, path, maxResolution);
         if (!pEnvMap) FALCOR_THROW("Failed to load environment map");
         stream.read(pEnvMap->mData);
         stream.read(pEnvMap->mRotation);
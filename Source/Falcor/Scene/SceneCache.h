@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "Scene.h"
+#include "SceneBuilder.h"
 #include "Animation/Animation.h"
 #include "Camera/Camera.h"
 #include "Lights/EnvMap.h"
@@ -78,11 +79,48 @@ namespace Falcor
         */
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
+        /** Compute the mesh cache key from everything SceneBuilder::processMesh() depends on: the source data of the mesh,
+            its per-mesh processing options, the texture transform of its material and the build flags that affect the processing.
+            \param[in] mesh Mesh source data. The texture transform is the identity if the mesh has no material.
+            \param[in] buildFlags Scene build flags.
+            \param[in] processingVersion Version of the mesh processing. Changing it invalidates all cached meshes.
+            \return Returns the mesh cache key.
+        */
+        static Key computeMeshCacheKey(const SceneBuilder::Mesh& mesh, SceneBuilder::Flags buildFlags, uint32_t processingVersion);
+
+        /** Read a processed mesh from the mesh cache.
+            Only the processed index and vertex data is cached, the other fields of the mesh are left unchanged.
+            \param[in] key Mesh cache key, computed from the source data of the mesh and the processing flags.
+            \param[out] mesh Processed mesh.
+            \return Returns true if the mesh was found in the cache, false otherwise (including if the cache file is invalid).
+        */
+        static bool readProcessedMesh(const Key& key, SceneBuilder::ProcessedMesh& mesh);
+
+        /** Write a processed mesh to the mesh cache.
+            Failing to write the mesh is not an error and only logs a warning.
+            \param[in] key Mesh cache key.
+            \param[in] mesh Processed mesh.
+        */
+        static void writeProcessedMesh(const Key& key, const SceneBuilder::ProcessedMesh& mesh);
+
+        /** Remove the least recently used meshes from the mesh cache until its total size is within the size limit.
+            Must not be called while meshes are being written to the cache.
+        */
+        static void pruneMeshCache();
+
+        /** Remove the least recently used files from a mesh cache directory until its total size is within a size limit.
+            Leftover temporary files are removed as well.
+            \param[in] meshDirectory Mesh cache directory.
+            \param[in] maxSize Maximum total size of the files in bytes.
+        */
+        static void pruneMeshCache(const std::filesystem::path& meshDirectory, uintmax_t maxSize);
+
     private:
         class OutputStream;
         class InputStream;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getMeshCachePath(const Key& key);
 
         static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
         static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
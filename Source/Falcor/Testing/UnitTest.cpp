@@ -54,6 +54,9 @@ namespace Falcor
 namespace unittest
 {
 
+/// Tags of tests that only run when the tag is explicitly included by the tag filter, such as timing-only benchmarks.
+const std::set<std::string> kOptInTags = {"benchmark"};
+
 struct TestDesc
 {
     std::filesystem::path path;
@@ -609,6 +612,8 @@ std::vector<Test> filterTests(
         {
             include |= includeTags.count(tag) == 1;
             exclude |= excludeTags.count(tag) == 1;
+            // Tests with an opt-in tag only run when the tag is explicitly included.
+            exclude |= kOptInTags.count(tag) == 1 && includeTags.count(tag) == 0;
         }
 
         return include && !exclude;
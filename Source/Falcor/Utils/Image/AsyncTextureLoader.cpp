@@ -27,23 +27,157 @@
  **************************************************************************/
 #include "AsyncTextureLoader.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
 #include "Utils/Threading.h"
+#include <chrono>
 
 namespace Falcor
 {
 namespace
 {
-constexpr size_t kUploadsPerFlush = 16; ///< Number of texture uploads before issuing a flush (to keep upload heap from growing).
+constexpr bool kTopDown = true;          ///< Memory layout when loading from file.
+constexpr uint64_t kMaxDecodedBudgets = 4; ///< Number of upload budgets of decoded data waiting for upload before decoding pauses.
+constexpr std::chrono::microseconds kHelpInterval(200); ///< Time between attempts to run pending tasks while waiting for decoding.
+
+/// Append the data of a bitmap as the next mip level.
+void appendMip(ImageIO::TextureData& data, const Bitmap& bitmap)
+{
+    data.imageData.insert(data.imageData.end(), bitmap.getData(), bitmap.getData() + bitmap.getSize());
+    data.mipLevels++;
+}
+
+/**
+ * Decode a texture from a single file. This does not use the GPU, so it runs on the decode tasks.
+ * @return True if the mip levels other than the first one must be generated on the GPU.
+ */
+bool decodeFromFile(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB, Bitmap::ImportFlags importFlags, ImageIO::TextureData& data)
+{
+    if (!std::filesystem::exists(path))
+    {
+        logWarning("Error when loading image file. File '{}' does not exist.", path);
+        return false;
+    }
+
+    if (hasExtension(path, "dds"))
+    {
+        try
+        {
+            data = ImageIO::loadTextureDataFromDDS(path, loadAsSRGB);
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Error loading '{}': {}", path, e.what());
+            data = {};
+        }
+        return false;
+    }
+
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown, importFlags);
+    if (!pBitmap)
+        return false;
+
+    data.format = loadAsSRGB ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+    data.width = pBitmap->getWidth();
+    data.height = pBitmap->getHeight();
+    data.mipLevels = 0;
+
+    const bool generateMipsOnCpu = generateMipLevels && Bitmap::isMipGenerationSupported(pBitmap->getFormat());
+    size_t imageSize = pBitmap->getSize();
+    if (generateMipsOnCpu)
+        imageSize = imageSize * 4 / 3 + getFormatBytesPerBlock(pBitmap->getFormat());
+    data.imageData.reserve(imageSize);
+    appendMip(data, *pBitmap);
+
+    // Generate the full mip chain, down to 1x1.
+    while (generateMipsOnCpu && (pBitmap->getWidth() > 1 || pBitmap->getHeight() > 1))
+    {
+        pBitmap = Bitmap::createMip(*pBitmap, loadAsSRGB);
+        appendMip(data, *pBitmap);
+    }
+
+    return generateMipLevels && !generateMipsOnCpu;
+}
+
+/// Analyze the first mip level of decoded data on the CPU, while it's still in cache.
+std::optional<TextureAnalyzer::Result> analyzeDecodedData(const ImageIO::TextureData& data)
+{
+    if (data.imageData.empty() || data.type != Resource::Type::Texture2D || data.arraySize != 1 ||
+        !TextureAnalyzer::isCpuAnalysisSupported(data.format))
+        return std::nullopt;
+
+    return TextureAnalyzer::analyzeCpu(data.imageData.data(), data.width, data.height, getFormatRowPitch(data.format, data.width), data.format);
 }
 
-AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount) : mpDevice(pDevice)
+/// Decode a texture with mips specified explicitly from individual files.
+void decodeMippedFromFiles(fstd::span<const std::filesystem::path> paths, bool loadAsSRGB, Bitmap::ImportFlags importFlags, ImageIO::TextureData& data)
 {
-    runWorkers(threadCount);
+    data.mipLevels = 0;
+    Bitmap::UniqueConstPtr pPrevMip;
+    for (const auto& path : paths)
+    {
+        Bitmap::UniqueConstPtr pBitmap = hasExtension(path, "dds") ? ImageIO::loadBitmapFromDDS(path) : Bitmap::createFromFile(path, kTopDown, importFlags);
+        if (!pBitmap)
+        {
+            logWarning("Error loading mip {}. Loading failed for image file '{}'.", data.mipLevels, path);
+            break;
+        }
+
+        if (pPrevMip)
+        {
+            if (pPrevMip->getFormat() != pBitmap->getFormat())
+            {
+                logWarning("Error loading mip {} from file {}. Texture format of all mip levels must match.", data.mipLevels, path);
+                break;
+            }
+            if (std::max(pPrevMip->getWidth() / 2, 1u) != pBitmap->getWidth() || std::max(pPrevMip->getHeight() / 2, 1u) != pBitmap->getHeight())
+            {
+                logWarning(
+                    "Error loading mip {} from file {}. Image resolution must decrease by half. ({}, {}) != ({}, {})/2",
+                    data.mipLevels,
+                    path,
+                    pBitmap->getWidth(),
+                    pBitmap->getHeight(),
+                    pPrevMip->getWidth(),
+                    pPrevMip->getHeight()
+                );
+                break;
+            }
+        }
+        else
+        {
+            data.format = loadAsSRGB ? linearToSrgbFormat(pBitmap->getFormat()) : pBitmap->getFormat();
+            data.width = pBitmap->getWidth();
+            data.height = pBitmap->getHeight();
+        }
+
+        appendMip(data, *pBitmap);
+        pPrevMip = std::move(pBitmap);
+    }
 }
+} // namespace
+
+AsyncTextureLoader::AsyncTextureLoader(ref<Device> pDevice, size_t threadCount, uint64_t uploadBudget)
+    : mpDevice(pDevice)
+    , mMaxDecodeTaskCount(std::max<size_t>(1, threadCount))
+    , mUploadBudget(uploadBudget)
+    , mMaxDecodedByteSize(kMaxDecodedBudgets * uploadBudget)
+{}
 
 AsyncTextureLoader::~AsyncTextureLoader()
 {
-    terminateWorkers();
+    waitForAllUploads();
+
+    // Decode tasks may still be finishing after the last texture was queued for upload.
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (mDecodeTaskCount > 0)
+    {
+        lock.unlock();
+        const bool ranTask = Threading::runPendingTask();
+        lock.lock();
+        if (!ranTask)
+            mCondition.wait_for(lock, kHelpInterval, [&]() { return mDecodeTaskCount == 0; });
+    }
 
     mpDevice->wait();
 }
@@ -56,10 +190,10 @@ std::future<ref<Texture>> AsyncTextureLoader::loadMippedFromFiles(
     LoadCallback callback
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    LoadRequest request{{paths.begin(), paths.end()}, false, loadAsSrgb, bindFlags, importFlags, callback};
+    auto future = request.promise.get_future();
+    enqueue(std::move(request));
+    return future;
 }
 
 std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
@@ -71,111 +205,177 @@ std::future<ref<Texture>> AsyncTextureLoader::loadFromFile(
     LoadCallback callback
 )
 {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mLoadRequestQueue.push(LoadRequest{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback});
-    mCondition.notify_one();
-    return mLoadRequestQueue.back().promise.get_future();
+    LoadRequest request{{path}, generateMipLevels, loadAsSrgb, bindFlags, importFlags, callback};
+    auto future = request.promise.get_future();
+    enqueue(std::move(request));
+    return future;
 }
 
-void AsyncTextureLoader::runWorkers(size_t threadCount)
+size_t AsyncTextureLoader::processUploads(bool wait)
 {
-    // Create a barrier to synchronize worker threads before issuing a global flush.
-    mFlushBarrier = std::make_shared<Barrier>(
-        threadCount,
-        [&]()
+    std::lock_guard<std::mutex> uploadLock(mUploadMutex);
+
+    size_t uploadCount = 0;
+    while (true)
+    {
+        DecodedTexture decoded;
         {
-            mpDevice->wait();
-            mFlushPending = false;
-            mUploadCounter = 0;
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (wait && uploadCount == 0)
+            {
+                // Help the scheduler while waiting, as the decode tasks may be queued behind the calling thread if it is a worker.
+                while (mUploadQueue.empty() && mLoadsInProgress > 0)
+                {
+                    lock.unlock();
+                    const bool ranTask = Threading::runPendingTask();
+                    lock.lock();
+                    if (!ranTask)
+                        mCondition.wait_for(lock, kHelpInterval, [&]() { return !mUploadQueue.empty() || mLoadsInProgress == 0; });
+                }
+            }
+
+            if (mUploadQueue.empty())
+                break;
+
+            decoded = std::move(mUploadQueue.front());
+            mUploadQueue.pop();
+            mDecodedByteSize -= decoded.data.imageData.size();
+
+            // Resume decoding if it was paused because too much data was waiting for upload.
+            dispatchDecodeTasks();
         }
-    );
 
-    for (size_t i = 0; i < threadCount; ++i)
-    {
-        mThreads.emplace_back(&AsyncTextureLoader::runWorker, this);
-    }
-}
+        ref<Texture> pTexture = upload(decoded);
 
-void AsyncTextureLoader::runWorker()
-{
-    // This function is the entry point for worker threads.
-    // The workers wait on the load request queue and load a texture when woken up.
-    // To avoid the upload heap growing too large, we synchronize the threads and
-    // issue a global GPU flush at regular intervals.
+        decoded.request.promise.set_value(pTexture);
 
-    while (true)
-    {
-        // Wait on condition until more work is ready.
-        std::unique_lock<std::mutex> lock(mMutex);
-        mCondition.wait(lock, [&]() { return mTerminate || !mLoadRequestQueue.empty() || mFlushPending; });
+        if (decoded.request.callback)
+        {
+            decoded.request.callback(pTexture, pTexture ? decoded.analysis : std::nullopt);
+        }
 
-        // Sync thread if a flush is pending.
-        if (mFlushPending)
         {
-            lock.unlock();
-            mFlushBarrier->wait();
-            mCondition.notify_one();
-            continue;
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mLoadsInProgress;
         }
+        mCondition.notify_all();
+        ++uploadCount;
+    }
 
-        // Terminate thread unless there is more work to do.
-        if (mTerminate && mLoadRequestQueue.empty() && !mFlushPending)
-            break;
+    return uploadCount;
+}
 
-        // Go back waiting if queue is currently empty.
-        if (mLoadRequestQueue.empty())
-            continue;
+void AsyncTextureLoader::waitForAllUploads()
+{
+    while (processUploads(true) > 0)
+        ;
+}
+
+void AsyncTextureLoader::enqueue(LoadRequest&& request)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLoadRequestQueue.push(std::move(request));
+    ++mLoadsInProgress;
+    dispatchDecodeTasks();
+}
 
+void AsyncTextureLoader::dispatchDecodeTasks()
+{
+    // Decode tasks drain the queue, so only dispatch new ones while below the concurrency limit.
+    // No task is dispatched while the decoded data waiting for upload is above the limit.
+    // This function must be called with the mutex held.
+    size_t taskCount = std::min(mLoadRequestQueue.size(), mMaxDecodeTaskCount);
+    while (mDecodeTaskCount < taskCount && mDecodedByteSize < mMaxDecodedByteSize)
+    {
+        ++mDecodeTaskCount;
+        Threading::dispatchTask([this]() { runDecodeTask(); });
+    }
+}
+
+void AsyncTextureLoader::runDecodeTask()
+{
+    // This function runs on the scheduler until the load request queue is empty or too much decoded data is waiting for upload.
+    // It never blocks, as the uploads happen on another thread that may be waiting for the scheduler.
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mLoadRequestQueue.empty() && mDecodedByteSize < mMaxDecodedByteSize)
+    {
         // Pop next load request from queue.
-        auto request = std::move(mLoadRequestQueue.front());
+        DecodedTexture decoded;
+        decoded.request = std::move(mLoadRequestQueue.front());
         mLoadRequestQueue.pop();
 
         lock.unlock();
 
-        // Load the textures (this part is running in parallel).
-        ref<Texture> pTexture;
+        // Decode the texture (this part is running in parallel).
+        const LoadRequest& request = decoded.request;
         if (request.paths.size() == 1)
         {
-            pTexture = Texture::createFromFile(
-                mpDevice, request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.bindFlags, request.importFlags
-            );
+            decoded.generateMipsOnGpu =
+                decodeFromFile(request.paths[0], request.generateMipLevels, request.loadAsSRGB, request.importFlags, decoded.data);
         }
         else
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, request.paths, request.loadAsSRGB, request.bindFlags, request.importFlags);
-        }
-
-        request.promise.set_value(pTexture);
-
-        if (request.callback)
-        {
-            request.callback(pTexture);
+            decodeMippedFromFiles(request.paths, request.loadAsSRGB, request.importFlags, decoded.data);
         }
+        decoded.analysis = analyzeDecodedData(decoded.data);
 
         lock.lock();
-
-        // Issue a global flush if necessary.
-        // TODO: It would be better to check the size of the upload heap instead.
-        if (!mTerminate && pTexture != nullptr && ++mUploadCounter >= kUploadsPerFlush)
-        {
-            mFlushPending = true;
-            mCondition.notify_all();
-        }
-
-        mCondition.notify_one();
+        mDecodedByteSize += decoded.data.imageData.size();
+        mUploadQueue.push(std::move(decoded));
+        mCondition.notify_all();
     }
+
+    --mDecodeTaskCount;
+    mCondition.notify_all();
 }
 
-void AsyncTextureLoader::terminateWorkers()
+ref<Texture> AsyncTextureLoader::upload(const DecodedTexture& decoded)
 {
+    const LoadRequest& request = decoded.request;
+    const ImageIO::TextureData& data = decoded.data;
+    if (data.imageData.empty())
+        return nullptr;
+
+    ref<Texture> pTexture;
+    if (decoded.generateMipsOnGpu)
+    {
+        pTexture = mpDevice->createTexture2D(
+            data.width, data.height, data.format, 1, Texture::kMaxPossible, data.imageData.data(), request.bindFlags
+        );
+    }
+    else
     {
-        std::lock_guard<std::mutex> lock(mMutex);
-        mTerminate = true;
+        pTexture = ImageIO::createTexture(mpDevice, data, request.bindFlags);
     }
 
-    mCondition.notify_all();
+    if (pTexture == nullptr)
+    {
+        logWarning("Error when loading image file '{}'. Unsupported texture type.", request.paths[0]);
+        return nullptr;
+    }
+
+    pTexture->setSourcePath(request.paths[0]);
+    pTexture->setImportFlags(request.importFlags);
+
+    logDebug(
+        "Loaded texture: size={}x{} mips={} format={} path={}",
+        pTexture->getWidth(),
+        pTexture->getHeight(),
+        pTexture->getMipCount(),
+        to_string(pTexture->getFormat()),
+        request.paths[0]
+    );
+
+    // Flush the GPU once the upload budget is used, to release the upload heap.
+    mUploadedByteSize += data.imageData.size();
+    if (mUploadedByteSize >= mUploadBudget)
+    {
+        std::lock_guard<std::mutex> lock(mpDevice->getGlobalGfxMutex());
+        mpDevice->wait();
+        mUploadedByteSize = 0;
+    }
 
-    for (auto& thread : mThreads)
-        thread.join();
+    return pTexture;
 }
 } // namespace Falcor
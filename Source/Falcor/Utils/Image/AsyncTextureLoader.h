@@ -26,6 +26,8 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #pragma once
+#include "ImageIO.h"
+#include "TextureAnalyzer.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -35,6 +37,7 @@
 #include <functional>
 #include <future>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <thread>
 #include <vector>
@@ -42,25 +45,34 @@
 
 namespace Falcor
 {
-class Barrier;
-
 /**
- * Utility class to load textures asynchronously using multiple worker threads.
+ * Utility class to load textures asynchronously.
+ *
+ * Loading is split in two stages. Tasks on the Threading scheduler decode the image files and generate the mip chains on the CPU.
+ * The textures are then created and uploaded by processUploads(), on the thread calling it. As GPU work can't be submitted from
+ * several threads, this should be the thread owning the loader. The GPU is flushed every time a byte budget has been uploaded, to
+ * keep the upload heap from growing.
  */
 class FALCOR_API AsyncTextureLoader
 {
 public:
-    using LoadCallback = std::function<void(ref<Texture> pTexture)>;
+    /// Callback invoked when a texture is loaded. The analysis is computed on the decode tasks when the format allows it.
+    using LoadCallback = std::function<void(ref<Texture> pTexture, const std::optional<TextureAnalyzer::Result>& analysis)>;
+
+    /// Default number of bytes uploaded between GPU flushes.
+    static constexpr uint64_t kDefaultUploadBudget = 256ull << 20;
 
     /**
      * Constructor.
-     * @param[in] threadCount Number of worker threads.
+     * @param[in] threadCount Maximum number of textures decoded concurrently.
+     * @param[in] uploadBudget Number of bytes uploaded between GPU flushes. Up to 4 times this size of decoded data is kept waiting
+     * for upload, after which decoding pauses.
      */
-    AsyncTextureLoader(ref<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency());
+    AsyncTextureLoader(ref<Device> pDevice, size_t threadCount = std::thread::hardware_concurrency(), uint64_t uploadBudget = kDefaultUploadBudget);
 
     /**
      * Destructor.
-     * Blocks until all threads have terminated.
+     * Blocks until all requested textures are loaded.
      */
     ~AsyncTextureLoader();
 
@@ -70,8 +82,8 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
-     * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] callback Function called by processUploads() after the texture load has finished.
+     * @return A future to a new texture, or nullptr if the texture failed to load. It is ready after the texture is uploaded by processUploads().
      */
     std::future<ref<Texture>> loadMippedFromFiles(
         fstd::span<const std::filesystem::path> paths,
@@ -88,8 +100,8 @@ public:
      * @param[in] loadAsSRGB Load the texture as sRGB format if supported, otherwise linear color.
      * @param[in] bindFlags The bind flags for the texture resource.
      * @param[in] importFlags Optional flags for the file import.
-     * @param[in] callback Function called after the texture load has finished.
-     * @return A future to a new texture, or nullptr if the texture failed to load.
+     * @param[in] callback Function called by processUploads() after the texture load has finished.
+     * @return A future to a new texture, or nullptr if the texture failed to load. It is ready after the texture is uploaded by processUploads().
      */
     std::future<ref<Texture>> loadFromFile(
         const std::filesystem::path& path,
@@ -100,11 +112,22 @@ public:
         LoadCallback callback = {}
     );
 
-private:
-    void runWorkers(size_t threadCount);
-    void runWorker();
-    void terminateWorkers();
+    /**
+     * Create and upload the textures decoded so far, and call their load callbacks.
+     * Only one thread uploads at a time, other callers block until it is done.
+     * While waiting, the calling thread runs pending scheduler tasks, so this can be called from a worker thread, but not from a task
+     * that another processUploads() call may end up running.
+     * @param[in] wait If no decoded texture is ready, block until one is, unless no load is in progress.
+     * @return Number of textures uploaded.
+     */
+    size_t processUploads(bool wait = false);
+
+    /**
+     * Process the uploads until all requested textures are loaded.
+     */
+    void waitForAllUploads();
 
+private:
     struct LoadRequest
     {
         std::vector<std::filesystem::path> paths;
@@ -116,18 +139,39 @@ private:
         std::promise<ref<Texture>> promise;
     };
 
+    /// Output of the decode stage.
+    struct DecodedTexture
+    {
+        LoadRequest request;
+        ImageIO::TextureData data;      ///< Texture data, with no image data if decoding failed.
+        bool generateMipsOnGpu = false; ///< True if the data only has the first mip level, as the CPU can't generate the mips of its format.
+        std::optional<TextureAnalyzer::Result> analysis; ///< Analysis of the first mip level, if its format can be analyzed on the CPU.
+    };
+
+    void enqueue(LoadRequest&& request);
+    void dispatchDecodeTasks();
+    void runDecodeTask();
+    ref<Texture> upload(const DecodedTexture& decoded);
+
     ref<Device> mpDevice;
 
-    std::mutex mMutex;                      ///< Mutex for synchronizing access to shared resources.
-    std::condition_variable mCondition;     ///< Condition variable for workers to wait on.
-    std::shared_ptr<Barrier> mFlushBarrier; ///< Barrier for flushing the GPU to upload textures.
-    std::vector<std::thread> mThreads;      ///< Worker threads.
+    size_t mMaxDecodeTaskCount;     ///< Maximum number of decode tasks running on the scheduler.
+    uint64_t mUploadBudget;         ///< Number of bytes uploaded between GPU flushes.
+    uint64_t mMaxDecodedByteSize;   ///< Size of the decoded data waiting for upload above which decoding pauses.
+
+    std::mutex mMutex;                  ///< Mutex for synchronizing access to shared resources.
+    std::condition_variable mCondition; ///< Condition variable to wait on for decoded textures.
+    std::mutex mUploadMutex;            ///< Mutex held while uploading.
 
     // Internal state. Do not access outside of critical section.
     std::queue<LoadRequest> mLoadRequestQueue; ///< Texture loading request queue.
+    std::queue<DecodedTexture> mUploadQueue;   ///< Decoded textures waiting for upload.
+
+    size_t mDecodeTaskCount = 0;      ///< Number of decode tasks dispatched to the scheduler.
+    size_t mLoadsInProgress = 0;      ///< Number of requested textures not yet uploaded.
+    uint64_t mDecodedByteSize = 0;    ///< Size of the decoded data waiting for upload.
 
-    bool mTerminate = false;     ///< Flag to terminate worker threads.
-    bool mFlushPending = false;  ///< Flag to indicate a GPU flush is pending.
-    uint32_t mUploadCounter = 0; ///< Counter to issue a flush every few uploads.
+    // Upload state. Only accessed while holding the upload mutex.
+    uint64_t mUploadedByteSize = 0; ///< Number of bytes uploaded since the last GPU flush.
 };
 } // namespace Falcor
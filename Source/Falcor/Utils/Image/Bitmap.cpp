@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "PixelConversion.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
@@ -34,6 +35,9 @@
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
 
+#include <algorithm>
+#include <type_traits>
+
 #include <ImfIO.h>
 #include <ImfInputFile.h>
 #include <ImfChannelList.h>
@@ -82,6 +86,79 @@ private:
     size_t mOffset = 0;
 };
 
+/// Conversion of the channels of the formats supported by Bitmap::createMip() to linear floats and back.
+template<typename T>
+struct MipChannel;
+
+template<>
+struct MipChannel<uint8_t>
+{
+    static float load(uint8_t value, bool isSrgb) { return isSrgb ? PixelConversion::srgb8ToLinear(value) : value * (1.f / 255.f); }
+    static uint8_t store(float value, bool isSrgb)
+    {
+        if (isSrgb)
+            return PixelConversion::linearToSrgb8(value);
+        return (uint8_t)(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f);
+    }
+};
+
+template<>
+struct MipChannel<uint16_t>
+{
+    static float load(uint16_t value, bool) { return value * (1.f / 65535.f); }
+    static uint16_t store(float value, bool) { return (uint16_t)(std::clamp(value, 0.f, 1.f) * 65535.f + 0.5f); }
+};
+
+template<>
+struct MipChannel<float16_t>
+{
+    static float load(float16_t value, bool) { return float(value); }
+    static float16_t store(float value, bool) { return float16_t(value); }
+};
+
+template<>
+struct MipChannel<float>
+{
+    static float load(float value, bool) { return value; }
+    static float store(float value, bool) { return value; }
+};
+
+/**
+ * Average blocks of 2x2 pixels. For odd sizes, the last output row and column also average the leftover source row and column,
+ * so that every source pixel contributes. The first srgbChannelCount channels are sRGB.
+ */
+template<typename T>
+void downsample(const uint8_t* pSrc, uint32_t srcWidth, uint32_t srcHeight, uint32_t srcRowPitch, uint8_t* pDst, uint32_t dstWidth, uint32_t dstHeight, uint32_t dstRowPitch, uint32_t channelCount, uint32_t srgbChannelCount)
+{
+    FALCOR_ASSERT(channelCount <= 4);
+
+    for (uint32_t y = 0; y < dstHeight; y++)
+    {
+        const uint32_t y0 = std::min(2 * y, srcHeight - 1);
+        const uint32_t y1 = y == dstHeight - 1 ? srcHeight : y0 + 2;
+        T* pDstRow = reinterpret_cast<T*>(pDst + size_t(y) * dstRowPitch);
+
+        for (uint32_t x = 0; x < dstWidth; x++)
+        {
+            const uint32_t x0 = std::min(2 * x, srcWidth - 1);
+            const uint32_t x1 = x == dstWidth - 1 ? srcWidth : x0 + 2;
+
+            float sum[4] = {};
+            for (uint32_t sy = y0; sy < y1; sy++)
+            {
+                const T* pSrcRow = reinterpret_cast<const T*>(pSrc + size_t(sy) * srcRowPitch);
+                for (uint32_t sx = x0; sx < x1; sx++)
+                    for (uint32_t c = 0; c < channelCount; c++)
+                        sum[c] += MipChannel<T>::load(pSrcRow[sx * channelCount + c], c < srgbChannelCount);
+            }
+
+            const float weight = 1.f / float((y1 - y0) * (x1 - x0));
+            for (uint32_t c = 0; c < channelCount; c++)
+                pDstRow[x * channelCount + c] = MipChannel<T>::store(sum[c] * weight, c < srgbChannelCount);
+        }
+    }
+}
+
 bool isFloat16Exr(const MemoryMappedFile& inputFile)
 {
     OpenExrStream stream(inputFile);
@@ -114,44 +191,34 @@ static bool isConvertibleToRGBA32Float(ResourceFormat format)
 }
 
 /**
- * Converts half float image to RGBA float image.
- */
-static std::vector<float> convertHalfToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
-{
-    std::vector<float> newData(width * height * 4u, 0.f);
-    const float16_t* pSrc = reinterpret_cast<const float16_t*>(pData);
-    float* pDst = newData.data();
-
-    for (uint32_t i = 0; i < width * height; ++i)
-    {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++);
-        }
-        pDst += (4 - channelCount);
-    }
-
-    return newData;
-}
-
-/**
- * Converts integer image to RGBA float image.
- * Unsigned integers are normalized to [0,1], signed integers to [-1,1].
+ * Converts half float or integer image to RGBA float image.
+ * Integers are normalized, see PixelConversion::convertIntToFloat32().
  */
 template<typename SrcT>
-static std::vector<float> convertIntToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
+static std::vector<float> convertChannelsToRGBA32Float(uint32_t width, uint32_t height, uint32_t channelCount, const void* pData)
 {
-    std::vector<float> newData(width * height * 4u, 0.f);
+    const size_t pixelCount = size_t(width) * height;
     const SrcT* pSrc = reinterpret_cast<const SrcT*>(pData);
-    float* pDst = newData.data();
 
-    for (uint32_t i = 0; i < width * height; ++i)
+    auto convert = [](const SrcT* pSrc, float* pDst, size_t count)
     {
-        for (uint32_t c = 0; c < channelCount; ++c)
-        {
-            *pDst++ = float(*pSrc++) / float(std::numeric_limits<SrcT>::max());
-        }
-        pDst += (4 - channelCount);
+        if constexpr (std::is_same_v<SrcT, float16_t>)
+            PixelConversion::convertFloat16ToFloat32(pSrc, pDst, count);
+        else
+            PixelConversion::convertIntToFloat32(pSrc, pDst, count);
+    };
+
+    std::vector<float> newData(pixelCount * 4);
+    if (channelCount == 4)
+    {
+        convert(pSrc, newData.data(), pixelCount * 4);
+    }
+    else
+    {
+        // Default alpha channel to 1.
+        std::vector<float> floatData(pixelCount * channelCount);
+        convert(pSrc, floatData.data(), floatData.size());
+        PixelConversion::expandToRGBA32Float(floatData.data(), channelCount, newData.data(), pixelCount, 1.f);
     }
 
     return newData;
@@ -172,36 +239,29 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
 
     if (type == FormatType::Float && channelBits == 16)
     {
-        floatData = convertHalfToRGBA32Float(width, height, channelCount, pData);
+        floatData = convertChannelsToRGBA32Float<float16_t>(width, height, channelCount, pData);
     }
     else if (type == FormatType::Uint && channelBits == 16)
     {
-        floatData = convertIntToRGBA32Float<uint16_t>(width, height, channelCount, pData);
+        floatData = convertChannelsToRGBA32Float<uint16_t>(width, height, channelCount, pData);
     }
     else if (type == FormatType::Uint && channelBits == 32)
     {
-        floatData = convertIntToRGBA32Float<uint32_t>(width, height, channelCount, pData);
+        floatData = convertChannelsToRGBA32Float<uint32_t>(width, height, channelCount, pData);
     }
     else if (type == FormatType::Sint && channelBits == 16)
     {
-        floatData = convertIntToRGBA32Float<int16_t>(width, height, channelCount, pData);
+        floatData = convertChannelsToRGBA32Float<int16_t>(width, height, channelCount, pData);
     }
     else if (type == FormatType::Sint && channelBits == 32)
     {
-        floatData = convertIntToRGBA32Float<int32_t>(width, height, channelCount, pData);
+        floatData = convertChannelsToRGBA32Float<int32_t>(width, height, channelCount, pData);
     }
     else
     {
         FALCOR_UNREACHABLE();
     }
 
-    // Default alpha channel to 1.
-    if (channelCount < 4)
-    {
-        for (uint32_t i = 0; i < width * height; ++i)
-            floatData[i * 4 + 3] = 1.f;
-    }
-
     return floatData;
 }
 
@@ -225,17 +285,8 @@ static FIBITMAP* convertToRGBAF(FIBITMAP* pDib)
 
     for (unsigned y = 0; y < height; y++)
     {
-        const FIRGBF* src_pixel = (FIRGBF*)src_bits;
-        FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
-
-        for (unsigned x = 0; x < width; x++)
-        {
-            // Convert pixels directly, while adding a "dummy" alpha of 1.0
-            dst_pixel[x].red = src_pixel[x].red;
-            dst_pixel[x].green = src_pixel[x].green;
-            dst_pixel[x].blue = src_pixel[x].blue;
-            dst_pixel[x].alpha = 1.0F;
-        }
+        // Convert pixels directly, while adding a "dummy" alpha of 1.0
+        PixelConversion::expandToRGBA32Float((const float*)src_bits, 3, (float*)dst_bits, width, 1.f);
         src_bits += src_pitch;
         dst_bits += dst_pitch;
     }
@@ -265,19 +316,17 @@ static FIBITMAP* convertToRGBA16Float(FIBITMAP* pDib)
     const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
     BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
 
+    // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
+    std::vector<float> rgbaRow(type == FIT_RGBF ? width * 4 : 0);
     for (uint32_t y = 0; y < height; y++)
     {
-        const FIRGBAF* src_pixel = (FIRGBAF*)src_bits;
-        FIRGBA16* dst_pixel = (tagFIRGBA16*)dst_bits;
-
-        for (uint32_t x = 0; x < width; x++)
+        const float* src_pixel = (const float*)src_bits;
+        if (type == FIT_RGBF)
         {
-            // Convert pixels to float16_t directly, while adding a "dummy" alpha of 1.0 if source format doesn't have alpha.
-            dst_pixel[x].red = float16_t(src_pixel[x].red).toBits();
-            dst_pixel[x].green = float16_t(src_pixel[x].green).toBits();
-            dst_pixel[x].blue = float16_t(src_pixel[x].blue).toBits();
-            dst_pixel[x].alpha = float16_t(type == FIT_RGBAF ? src_pixel[x].alpha : 1.0f).toBits();
+            PixelConversion::expandToRGBA32Float(src_pixel, 3, rgbaRow.data(), width, 1.f);
+            src_pixel = rgbaRow.data();
         }
+        PixelConversion::convertFloat32ToFloat16(src_pixel, (float16_t*)dst_bits, width * 4);
         src_bits += src_pitch;
         dst_bits += dst_pitch;
     }
@@ -288,6 +337,56 @@ Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceF
     return Bitmap::UniqueConstPtr(new Bitmap(width, height, format, pData));
 }
 
+bool Bitmap::isMipGenerationSupported(ResourceFormat format)
+{
+    if (isCompressedFormat(format) || getFormatChannelCount(format) == 0)
+        return false;
+
+    // All channels must have the same size, which rules out packed formats.
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const uint32_t bits = getNumChannelBits(format, 0);
+    if (getFormatBytesPerBlock(format) * 8 != bits * channelCount)
+        return false;
+
+    switch (getFormatType(format))
+    {
+    case FormatType::Unorm:
+    case FormatType::UnormSrgb:
+        return bits == 8 || bits == 16;
+    case FormatType::Float:
+        return bits == 16 || bits == 32;
+    default:
+        return false;
+    }
+}
+
+Bitmap::UniqueConstPtr Bitmap::createMip(const Bitmap& src, bool isSrgb)
+{
+    const ResourceFormat format = src.getFormat();
+    FALCOR_CHECK(isMipGenerationSupported(format), "Mip generation is not supported for format {}.", to_string(format));
+
+    const uint32_t width = std::max(src.getWidth() / 2, 1u);
+    const uint32_t height = std::max(src.getHeight() / 2, 1u);
+    UniquePtr pMip(new Bitmap(width, height, format));
+
+    // Only the color channels of 8-bit formats with 4 channels can be sRGB, as the other formats have no sRGB variant.
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const uint32_t bits = getNumChannelBits(format, 0);
+    const bool hasSrgbChannels = (isSrgb || isSrgbFormat(format)) && bits == 8 && channelCount == 4;
+    const uint32_t srgbChannelCount = hasSrgbChannels ? 3 : 0;
+
+    decltype(&downsample<uint8_t>) downsampleFunc = nullptr;
+    if (getFormatType(format) == FormatType::Float)
+        downsampleFunc = bits == 16 ? &downsample<float16_t> : &downsample<float>;
+    else
+        downsampleFunc = bits == 8 ? &downsample<uint8_t> : &downsample<uint16_t>;
+    downsampleFunc(
+        src.getData(), src.getWidth(), src.getHeight(), src.getRowPitch(), pMip->getData(), width, height, pMip->getRowPitch(), channelCount, srgbChannelCount
+    );
+
+    return pMip;
+}
+
 Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path, bool isTopDown, ImportFlags importFlags)
 {
     if (!std::filesystem::exists(path))
@@ -615,17 +714,8 @@ void Bitmap::saveImage(
     if (resourceFormat == ResourceFormat::RGBA8Unorm || resourceFormat == ResourceFormat::RGBA8Snorm ||
         resourceFormat == ResourceFormat::RGBA8UnormSrgb)
     {
-        for (uint32_t a = 0; a < width * height; a++)
-        {
-            uint32_t* pPixel = (uint32_t*)pData;
-            pPixel += a;
-            uint8_t* ch = (uint8_t*)pPixel;
-            std::swap(ch[0], ch[2]);
-            if (is_set(exportFlags, ExportFlags::ExportAlpha) == false)
-            {
-                ch[3] = 0xff;
-            }
-        }
+        uint32_t* pPixels = (uint32_t*)pData;
+        PixelConversion::swapRedBlue8(pPixels, pPixels, size_t(width) * height, !is_set(exportFlags, ExportFlags::ExportAlpha));
     }
 
     if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
@@ -669,12 +759,7 @@ void Bitmap::saveImage(
             else
             {
                 FALCOR_ASSERT(exportAlpha == false);
-                for (unsigned x = 0; x < width; x++)
-                {
-                    dstBits[x * 3 + 0] = (((float*)head)[x * 4 + 0]);
-                    dstBits[x * 3 + 1] = (((float*)head)[x * 4 + 1]);
-                    dstBits[x * 3 + 2] = (((float*)head)[x * 4 + 2]);
-                }
+                PixelConversion::convertRGBA32FloatToRGB32Float((const float*)head, dstBits, width);
             }
             head += bytesPerPixel * width;
         }
@@ -92,6 +92,21 @@ public:
      */
     static UniqueConstPtr createFromFile(const std::filesystem::path& path, bool isTopDown, ImportFlags importFlags = ImportFlags::None);
 
+    /**
+     * Check if createMip() supports a format.
+     * Uncompressed formats with 8 or 16-bit unorm channels, or 16 or 32-bit float channels are supported.
+     */
+    static bool isMipGenerationSupported(ResourceFormat format);
+
+    /**
+     * Create the next mip level of a bitmap on the CPU, by averaging blocks of 2x2 pixels.
+     * This can be called from any thread.
+     * @param[in] src Source bitmap. Its format must be supported, see isMipGenerationSupported().
+     * @param[in] isSrgb Average the color channels of 8-bit formats in linear space, as they will be read as sRGB.
+     * @return A new bitmap with half the width and height, rounded down to at least 1 pixel.
+     */
+    static UniqueConstPtr createMip(const Bitmap& src, bool isSrgb);
+
     /**
      * Store a memory buffer to a file.
      * @param[in] path Path to write to.
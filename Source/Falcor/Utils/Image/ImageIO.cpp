@@ -26,10 +26,13 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "ImageIO.h"
+#include "PixelConversion.h"
+#include "StreamingImageReader.h"
 #include "Core/Error.h"
 #include "Core/API/Device.h"
 #include "Core/API/CopyContext.h"
 #include "Core/API/NativeFormats.h"
+#include "Core/API/RenderContext.h"
 #include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Math/ScalarMath.h"
 #include "Utils/Logger.h"
@@ -37,12 +40,20 @@
 #include <dds_header/DDSHeader.h>
 #include <nvtt/nvtt.h>
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <type_traits>
 
 namespace Falcor
 {
 namespace
 {
+/// Size of the source rows decoded at once when streaming an image.
+constexpr size_t kStreamingBlockByteSize = 32ull << 20;
+/// Number of bytes uploaded between GPU flushes when streaming an image, to keep the upload heap from growing.
+constexpr size_t kStreamingUploadBudget = 128ull << 20;
+
 struct ImportData
 {
     // Commonly used values converted or casted for cleaner access
@@ -277,6 +288,31 @@ void setImage(
     T* dst = (T*)modified.data();
     for (uint32_t h = 0; h < image.height; ++h)
     {
+        // Convert whole rows with the vectorized kernels when possible.
+        const T* srcRow = src + size_t(h) * srcWidth * channelCount;
+        T* dstRow = dst + size_t(h) * image.width * 4;
+        if (channelCount == 4 && !reverseRB)
+        {
+            std::memcpy(dstRow, srcRow, image.width * 4 * sizeof(T));
+            continue;
+        }
+        if constexpr (sizeof(T) == 1)
+        {
+            if (channelCount == 4)
+            {
+                PixelConversion::swapRedBlue8((const uint32_t*)srcRow, (uint32_t*)dstRow, image.width, false);
+                continue;
+            }
+        }
+        if constexpr (std::is_same_v<T, float>)
+        {
+            if (channelCount == 2 || channelCount == 3)
+            {
+                PixelConversion::expandToRGBA32Float(srcRow, channelCount, dstRow, image.width, 0.f);
+                continue;
+            }
+        }
+
         for (uint32_t w = 0; w < image.width; ++w)
         {
             uint32_t i = h * srcWidth + w;    // Source data index
@@ -577,12 +613,49 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
     return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
 }
 
+ImageIO::TextureData ImageIO::loadTextureDataFromDDS(const std::filesystem::path& path, bool loadAsSrgb)
+{
+    ImportData importData;
+    loadDDS(path, loadAsSrgb, importData);
+
+    TextureData data;
+    data.type = importData.type;
+    data.format = importData.format;
+    data.width = importData.width;
+    data.height = importData.height;
+    data.depth = importData.depth;
+    data.arraySize = importData.arraySize;
+    data.mipLevels = importData.mipLevels;
+    data.imageData = std::move(importData.imageData);
+    return data;
+}
+
+ref<Texture> ImageIO::createTexture(ref<Device> pDevice, const TextureData& data, ResourceBindFlags bindFlags)
+{
+    // TODO: Automatic mip generation
+    switch (data.type)
+    {
+    case Resource::Type::Texture1D:
+        return pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
+    case Resource::Type::Texture2D:
+        return pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data(), bindFlags);
+    case Resource::Type::TextureCube:
+        return pDevice->createTextureCube(
+            data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data(), bindFlags
+        );
+    case Resource::Type::Texture3D:
+        return pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data(), bindFlags);
+    default:
+        return nullptr;
+    }
+}
+
 ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
 {
-    ImportData data;
+    TextureData data;
     try
     {
-        loadDDS(path, loadAsSrgb, data);
+        data = loadTextureDataFromDDS(path, loadAsSrgb);
     }
     catch (const RuntimeError& e)
     {
@@ -590,32 +663,130 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
         return nullptr;
     }
 
-    ref<Texture> pTex;
-    // TODO: Automatic mip generation
-    switch (data.type)
+    ref<Texture> pTex = createTexture(pDevice, data);
+    if (pTex == nullptr)
     {
-    case Resource::Type::Texture1D:
-        pTex = pDevice->createTexture1D(data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-        break;
-    case Resource::Type::Texture2D:
-        pTex = pDevice->createTexture2D(data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-        break;
-    case Resource::Type::TextureCube:
-        pTex = pDevice->createTextureCube(data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
-        break;
-    case Resource::Type::Texture3D:
-        pTex = pDevice->createTexture3D(data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
-        break;
-    default:
         logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
         return nullptr;
     }
 
-    if (pTex != nullptr)
+    pTex->setSourcePath(path);
+    return pTex;
+}
+
+ref<Texture> ImageIO::loadTextureStreaming(
+    ref<Device> pDevice,
+    const std::filesystem::path& path,
+    bool generateMipLevels,
+    uint32_t maxResolution,
+    ResourceBindFlags bindFlags,
+    Bitmap::ImportFlags importFlags
+)
+{
+    std::unique_ptr<StreamingImageReader> pReader = StreamingImageReader::open(path);
+    if (!pReader)
+        return nullptr;
+
+    const uint32_t srcWidth = pReader->getWidth();
+    const uint32_t srcHeight = pReader->getHeight();
+
+    // Drop the top mip levels until the texture fits. Each texel of the first kept level is the average of a factor x factor
+    // block of source pixels. The last row and column also average the source pixels left over when the size isn't a multiple of
+    // the factor.
+    uint32_t dropCount = 0;
+    while (maxResolution > 0 && std::max(srcWidth >> dropCount, srcHeight >> dropCount) > maxResolution)
+        dropCount++;
+    const uint64_t factor = 1ull << dropCount;
+    const uint32_t width = std::max(srcWidth >> dropCount, 1u);
+    const uint32_t height = std::max(srcHeight >> dropCount, 1u);
+
+    const bool useFloat16 = pReader->isFloat16() || is_set(importFlags, Bitmap::ImportFlags::ConvertToFloat16);
+    const ResourceFormat format = useFloat16 ? ResourceFormat::RGBA16Float : ResourceFormat::RGBA32Float;
+    if (generateMipLevels)
+        bindFlags |= ResourceBindFlags::RenderTarget;
+    ref<Texture> pTex = pDevice->createTexture2D(width, height, format, 1, generateMipLevels ? Texture::kMaxPossible : 1, nullptr, bindFlags);
+
+    // Blocks are made of whole texture rows, and hold at least one of them.
+    const size_t srcRowSize = size_t(srcWidth) * 4;
+    const uint32_t rowsPerBlock =
+        (uint32_t)std::clamp<uint64_t>(kStreamingBlockByteSize / (srcRowSize * sizeof(float) * factor), 1, height);
+    std::vector<float> srcRows(srcRowSize * std::min<uint64_t>(rowsPerBlock * factor + factor - 1, srcHeight));
+    std::vector<float> dstRows(dropCount > 0 ? size_t(width) * 4 * rowsPerBlock : 0);
+    std::vector<float16_t> dstHalfRows(useFloat16 ? size_t(width) * 4 * rowsPerBlock : 0);
+
+    RenderContext* pRenderContext = pDevice->getRenderContext();
+    size_t uploadedByteSize = 0;
+    try
+    {
+        for (uint32_t y = 0; y < height; y += rowsPerBlock)
+        {
+            const uint32_t rowCount = std::min(rowsPerBlock, height - y);
+            const uint32_t srcRowCount = y + rowCount == height ? srcHeight - pReader->getRowsRead() : uint32_t(rowCount * factor);
+            if (pReader->readRows(srcRows.data(), srcRowCount) != srcRowCount)
+                FALCOR_THROW("Unexpected end of image.");
+
+            const float* pRows = srcRows.data();
+            if (dropCount > 0)
+            {
+                std::fill(dstRows.begin(), dstRows.end(), 0.f);
+                for (uint32_t row = 0; row < rowCount; row++)
+                {
+                    const uint32_t srcRowBegin = uint32_t(row * factor);
+                    const uint32_t srcRowEnd = row + 1 == rowCount ? srcRowCount : uint32_t(srcRowBegin + factor);
+                    float* pDstRow = &dstRows[size_t(row) * width * 4];
+                    for (uint32_t srcY = srcRowBegin; srcY < srcRowEnd; srcY++)
+                    {
+                        const float* pSrcRow = &srcRows[srcY * srcRowSize];
+                        for (uint32_t x = 0; x < srcWidth; x++)
+                        {
+                            const uint32_t dstX = std::min(x >> dropCount, width - 1);
+                            for (uint32_t c = 0; c < 4; c++)
+                                pDstRow[dstX * 4 + c] += pSrcRow[x * 4 + c];
+                        }
+                    }
+                    for (uint32_t x = 0; x < width; x++)
+                    {
+                        const uint64_t columnCount = x + 1 == width ? srcWidth - x * factor : factor;
+                        const float weight = 1.f / float((srcRowEnd - srcRowBegin) * columnCount);
+                        for (uint32_t c = 0; c < 4; c++)
+                            pDstRow[x * 4 + c] *= weight;
+                    }
+                }
+                pRows = dstRows.data();
+            }
+
+            const void* pData = pRows;
+            if (useFloat16)
+            {
+                PixelConversion::convertFloat32ToFloat16(pRows, dstHalfRows.data(), size_t(width) * 4 * rowCount);
+                pData = dstHalfRows.data();
+            }
+
+            // The upload copies the rows to the upload heap, which is released when flushing the GPU.
+            std::lock_guard<std::mutex> lock(pDevice->getGlobalGfxMutex());
+            pRenderContext->updateSubresourceData(pTex.get(), 0, pData, uint3(0, y, 0), uint3(width, rowCount, 1));
+            uploadedByteSize += size_t(width) * rowCount * getFormatBytesPerBlock(format);
+            if (uploadedByteSize >= kStreamingUploadBudget)
+            {
+                pDevice->wait();
+                uploadedByteSize = 0;
+            }
+        }
+    }
+    catch (const RuntimeError& e)
+    {
+        logWarning("Failed to stream image from '{}': {}", path, e.what());
+        return nullptr;
+    }
+
+    if (generateMipLevels)
     {
-        pTex->setSourcePath(path);
+        std::lock_guard<std::mutex> lock(pDevice->getGlobalGfxMutex());
+        pTex->generateMips(pRenderContext);
     }
 
+    pTex->setSourcePath(path);
+    pTex->setImportFlags(importFlags);
     return pTex;
 }
 
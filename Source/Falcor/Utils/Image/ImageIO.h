@@ -72,6 +72,43 @@ public:
         None
     };
 
+    /**
+     * Texture data on the CPU, with all array slices and mip levels packed in the order expected by the texture creation functions.
+     */
+    struct TextureData
+    {
+        Resource::Type type = Resource::Type::Texture2D;
+        ResourceFormat format = ResourceFormat::Unknown;
+        uint32_t width = 0;
+        uint32_t height = 1;
+        uint32_t depth = 1;
+        uint32_t arraySize = 1; ///< Number of array slices. For cube maps, this is 6 times the number of cubes.
+        uint32_t mipLevels = 1;
+        std::vector<uint8_t> imageData;
+    };
+
+    /**
+     * Load a DDS file without creating the texture. This can be called from any thread.
+     * Throws an exception if the DDS file is malformed.
+     * @param[in] path Path of file to load.
+     * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not
+     * changed.
+     * @return Texture data.
+     */
+    static TextureData loadTextureDataFromDDS(const std::filesystem::path& path, bool loadAsSrgb);
+
+    /**
+     * Create a texture from data loaded on the CPU.
+     * @param[in] data Texture data.
+     * @param[in] bindFlags The bind flags for the texture resource.
+     * @return Texture object, or nullptr if the texture type is not supported.
+     */
+    static ref<Texture> createTexture(
+        ref<Device> pDevice,
+        const TextureData& data,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource
+    );
+
     /**
      * Load a DDS file to a Bitmap. If the file contains an image array and/or mips, only the first image will be loaded.
      * Throws an exception if the DDS file is malformed.
@@ -90,6 +127,27 @@ public:
      */
     static ref<Texture> loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb);
 
+    /**
+     * Load an OpenEXR or Radiance HDR file to a Texture without decoding the whole image first.
+     * The rows are decoded, converted and uploaded in blocks, so the host memory used doesn't grow with the image size.
+     * The texture format is RGBA16Float if the file stores 16-bit floats or importFlags requests it, and RGBA32Float otherwise.
+     * @param[in] path Path of file to load.
+     * @param[in] generateMipLevels Whether the mip-chain should be generated.
+     * @param[in] maxResolution If non-zero, the top mip levels are dropped until the width and height are at most this size.
+     * The dropped levels are never created, the image is box filtered to the first kept level while streaming.
+     * @param[in] bindFlags The bind flags for the texture resource.
+     * @param[in] importFlags Flags for the file import.
+     * @return Texture object, or nullptr if the file can't be streamed. See StreamingImageReader for the supported files.
+     */
+    static ref<Texture> loadTextureStreaming(
+        ref<Device> pDevice,
+        const std::filesystem::path& path,
+        bool generateMipLevels,
+        uint32_t maxResolution = 0,
+        ResourceBindFlags bindFlags = ResourceBindFlags::ShaderResource,
+        Bitmap::ImportFlags importFlags = Bitmap::ImportFlags::None
+    );
+
     /**
      * Saves a bitmap to a DDS file.
      * Throws an exception if path is invalid or the image cannot be saved.
@@ -0,0 +1,524 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PixelConversion.h"
+#include "Core/Error.h"
+#include "Utils/Color/ColorHelpers.slang"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <immintrin.h>
+
+#if FALCOR_MSVC
+#include <intrin.h>
+#endif
+
+namespace Falcor
+{
+namespace PixelConversion
+{
+namespace
+{
+bool isAVX2Supported()
+{
+#if FALCOR_MSVC
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // F16C, AVX and OS support for saving the YMM registers.
+    __cpuid(info, 1);
+    const bool hasF16C = (info[2] & (1 << 29)) != 0;
+    const bool hasAVX = (info[2] & (1 << 28)) != 0;
+    const bool hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+    if (!hasF16C || !hasAVX || !hasOSXSAVE || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+#endif
+}
+
+/// Tables for encoding linear values to 8-bit sRGB with the same result as the exact formula.
+struct SrgbEncodeTable
+{
+    /// Piecewise linear approximation of the encoding, in segments of 1/8th of a power of two from 2^-13 to 1.
+    /// Smaller values are all encoded to 0.
+    static constexpr uint32_t kMinBits = 0x39000000; ///< 2^-13.
+    static constexpr uint32_t kMaxBits = 0x3f800000; ///< 1.
+    static constexpr uint32_t kSegmentShift = 20;
+    static constexpr uint32_t kSegmentCount = (kMaxBits - kMinBits) >> kSegmentShift;
+
+    /// thresholds[i] is the smallest value encoded to i, for i in [1,255]. The first and last entries are -inf and +inf.
+    std::array<float, 257> thresholds;
+    std::array<float, kSegmentCount> segmentBias;  ///< Approximate encoded value at the start of each segment, plus 0.5.
+    std::array<float, kSegmentCount> segmentScale; ///< Approximate slope of the encoded value along each segment.
+
+    SrgbEncodeTable()
+    {
+        // Exact formula, which is monotonic on [0,1].
+        auto encode = [](float value) { return (uint32_t)(std::clamp(linearToSRGB(value), 0.f, 1.f) * 255.f + 0.5f); };
+
+        // Find the thresholds by bisection on the bit patterns, which are ordered like the positive floats.
+        thresholds[0] = -std::numeric_limits<float>::infinity();
+        for (uint32_t i = 1; i < 256; i++)
+        {
+            uint32_t lo = 0;          // encode(lo) < i
+            uint32_t hi = kMaxBits;   // encode(hi) >= i, 1 is encoded to 255.
+            while (hi - lo > 1)
+            {
+                uint32_t mid = lo + (hi - lo) / 2;
+                (encode(bitsToFloat(mid)) >= i ? hi : lo) = mid;
+            }
+            thresholds[i] = bitsToFloat(hi);
+        }
+        thresholds[256] = std::numeric_limits<float>::infinity();
+
+        // Interpolate the encoding between the segment ends.
+        for (uint32_t i = 0; i < kSegmentCount; i++)
+        {
+            double start = 255.0 * linearToSRGB(bitsToFloat(kMinBits + (i << kSegmentShift)));
+            double end = 255.0 * linearToSRGB(bitsToFloat(kMinBits + ((i + 1) << kSegmentShift)));
+            segmentBias[i] = float(start + 0.5);
+            segmentScale[i] = float(end - start);
+        }
+    }
+
+    static float bitsToFloat(uint32_t bits)
+    {
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    uint8_t encode(float value) const
+    {
+        // Branchless binary search for the number of thresholds less or equal to value. NaNs compare false and give 0.
+        uint32_t index = 0;
+        for (uint32_t step = 128; step > 0; step /= 2)
+            index += thresholds[index + step] <= value ? step : 0;
+        return (uint8_t)index;
+    }
+};
+
+const SrgbEncodeTable& getSrgbEncodeTable()
+{
+    static const SrgbEncodeTable table;
+    return table;
+}
+
+const std::array<float, 256>& getSrgbDecodeTable()
+{
+    static const std::array<float, 256> table = []()
+    {
+        std::array<float, 256> t;
+        for (uint32_t i = 0; i < 256; i++)
+            t[i] = sRGBToLinear(i / 255.f);
+        return t;
+    }();
+    return table;
+}
+
+// Scalar kernels.
+
+void convertFloat16ToFloat32Scalar(const float16_t* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = float(pSrc[i]);
+}
+
+void convertFloat32ToFloat16Scalar(const float* pSrc, float16_t* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = float16_t(pSrc[i]);
+}
+
+template<typename T>
+void convertIntToFloat32Scalar(const T* pSrc, float* pDst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = float(pSrc[i]) / float(std::numeric_limits<T>::max());
+}
+
+void expandToRGBA32FloatScalar(const float* pSrc, uint32_t channelCount, float* pDst, size_t pixelCount, float alpha)
+{
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        for (uint32_t c = 0; c < 4; c++)
+            pDst[4 * i + c] = c < channelCount ? pSrc[channelCount * i + c] : (c == 3 ? alpha : 0.f);
+    }
+}
+
+void convertRGBA32FloatToRGB32FloatScalar(const float* pSrc, float* pDst, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        pDst[3 * i + 0] = pSrc[4 * i + 0];
+        pDst[3 * i + 1] = pSrc[4 * i + 1];
+        pDst[3 * i + 2] = pSrc[4 * i + 2];
+    }
+}
+
+void swapRedBlue8Scalar(const uint32_t* pSrc, uint32_t* pDst, size_t pixelCount, bool opaqueAlpha)
+{
+    const uint32_t alphaMask = opaqueAlpha ? 0xff000000 : 0;
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        const uint32_t p = pSrc[i];
+        pDst[i] = (p & 0xff00ff00) | ((p >> 16) & 0xff) | ((p & 0xff) << 16) | alphaMask;
+    }
+}
+
+void convertSrgb8ToLinear32FloatScalar(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const auto& table = getSrgbDecodeTable();
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = table[pSrc[i]];
+}
+
+void convertLinear32FloatToSrgb8Scalar(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    const auto& table = getSrgbEncodeTable();
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = table.encode(pSrc[i]);
+}
+
+// AVX2 kernels. They process 8 values at a time and finish with the scalar kernels.
+
+FALCOR_TARGET_AVX2 void convertFloat16ToFloat32AVX2(const float16_t* pSrc, float* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        _mm256_storeu_ps(pDst + i, _mm256_cvtph_ps(h));
+    }
+    convertFloat16ToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+FALCOR_TARGET_AVX2 void convertFloat32ToFloat16AVX2(const float* pSrc, float16_t* pDst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(pSrc + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), h);
+    }
+    // Use the hardware conversion for the remainder too, so that all values are rounded the same way.
+    for (; i < count; i++)
+    {
+        __m128i h = _mm_cvtps_ph(_mm_set_ss(pSrc[i]), _MM_FROUND_TO_NEAREST_INT);
+        pDst[i] = float16_t::fromBits((uint16_t)_mm_cvtsi128_si32(h));
+    }
+}
+
+template<typename T>
+FALCOR_TARGET_AVX2 __m256 loadIntAsFloat32AVX2(const T* pSrc)
+{
+    if constexpr (std::is_same_v<T, uint16_t>)
+        return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc))));
+    else if constexpr (std::is_same_v<T, int16_t>)
+        return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc))));
+    else if constexpr (std::is_same_v<T, int32_t>)
+        return _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc)));
+    else
+    {
+        // There is no unsigned conversion. Convert the high and low 16 bits separately: both conversions and the product are
+        // exact, so the sum is rounded once like the scalar conversion.
+        static_assert(std::is_same_v<T, uint32_t>);
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc));
+        __m256 hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16)), _mm256_set1_ps(65536.f));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(v, _mm256_set1_epi32(0xffff)));
+        return _mm256_add_ps(hi, lo);
+    }
+}
+
+template<typename T>
+FALCOR_TARGET_AVX2 void convertIntToFloat32AVX2(const T* pSrc, float* pDst, size_t count)
+{
+    // Divide rather than multiply by the reciprocal to match the scalar kernel.
+    const __m256 scale = _mm256_set1_ps(float(std::numeric_limits<T>::max()));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(pDst + i, _mm256_div_ps(loadIntAsFloat32AVX2(pSrc + i), scale));
+    convertIntToFloat32Scalar(pSrc + i, pDst + i, count - i);
+}
+
+FALCOR_TARGET_AVX2 void expandToRGBA32FloatAVX2(const float* pSrc, uint32_t channelCount, float* pDst, size_t pixelCount, float alpha)
+{
+    if (channelCount == 4)
+    {
+        std::memcpy(pDst, pSrc, pixelCount * 4 * sizeof(float));
+        return;
+    }
+
+    // Load each pixel in the low lanes with zeros above, then insert alpha.
+    const __m128 alphaVec = _mm_set1_ps(alpha);
+    size_t i = 0;
+    switch (channelCount)
+    {
+    case 1:
+        for (; i < pixelCount; i++)
+            _mm_storeu_ps(pDst + 4 * i, _mm_blend_ps(_mm_load_ss(pSrc + i), alphaVec, 0x8));
+        break;
+    case 2:
+        for (; i < pixelCount; i++)
+        {
+            __m128 v = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(pSrc + 2 * i)));
+            _mm_storeu_ps(pDst + 4 * i, _mm_blend_ps(v, alphaVec, 0x8));
+        }
+        break;
+    case 3:
+        // Load 4 floats and replace the 4th, except for the last pixel to not read past the end.
+        for (; i + 1 < pixelCount; i++)
+            _mm_storeu_ps(pDst + 4 * i, _mm_blend_ps(_mm_loadu_ps(pSrc + 3 * i), alphaVec, 0x8));
+        break;
+    }
+    expandToRGBA32FloatScalar(pSrc + channelCount * i, channelCount, pDst + 4 * i, pixelCount - i, alpha);
+}
+
+FALCOR_TARGET_AVX2 void convertRGBA32FloatToRGB32FloatAVX2(const float* pSrc, float* pDst, size_t pixelCount)
+{
+    // Store 4 floats per pixel, the 4th is overwritten by the next pixel. The last pixel is stored separately to not write past the end.
+    size_t i = 0;
+    for (; i + 1 < pixelCount; i++)
+        _mm_storeu_ps(pDst + 3 * i, _mm_loadu_ps(pSrc + 4 * i));
+    convertRGBA32FloatToRGB32FloatScalar(pSrc + 4 * i, pDst + 3 * i, pixelCount - i);
+}
+
+FALCOR_TARGET_AVX2 void swapRedBlue8AVX2(const uint32_t* pSrc, uint32_t* pDst, size_t pixelCount, bool opaqueAlpha)
+{
+    const __m256i shuffle = _mm256_setr_epi8(
+        2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15
+    );
+    const __m256i alphaMask = _mm256_set1_epi32(opaqueAlpha ? (int)0xff000000 : 0);
+    size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i));
+        v = _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alphaMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), v);
+    }
+    swapRedBlue8Scalar(pSrc + i, pDst + i, pixelCount - i, opaqueAlpha);
+}
+
+FALCOR_TARGET_AVX2 void convertSrgb8ToLinear32FloatAVX2(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    const float* pTable = getSrgbDecodeTable().data();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + i)));
+        _mm256_storeu_ps(pDst + i, _mm256_i32gather_ps(pTable, index, 4));
+    }
+    convertSrgb8ToLinear32FloatScalar(pSrc + i, pDst + i, count - i);
+}
+
+FALCOR_TARGET_AVX2 void convertLinear32FloatToSrgb8AVX2(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    using Table = SrgbEncodeTable;
+    const Table& table = getSrgbEncodeTable();
+    const __m256 minValue = _mm256_castsi256_ps(_mm256_set1_epi32(Table::kMinBits));
+    const __m256 maxValue = _mm256_castsi256_ps(_mm256_set1_epi32(Table::kMaxBits - 1));
+    const __m256i one = _mm256_set1_epi32(1);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 value = _mm256_loadu_ps(pSrc + i);
+
+        // Guess the encoded value from the piecewise linear approximation. NaNs are clamped to the first segment.
+        __m256i bits = _mm256_castps_si256(_mm256_min_ps(_mm256_max_ps(value, minValue), maxValue));
+        bits = _mm256_sub_epi32(bits, _mm256_set1_epi32(Table::kMinBits));
+        __m256i segment = _mm256_srli_epi32(bits, Table::kSegmentShift);
+        __m256 t = _mm256_mul_ps(
+            _mm256_cvtepi32_ps(_mm256_and_si256(bits, _mm256_set1_epi32((1 << Table::kSegmentShift) - 1))),
+            _mm256_set1_ps(1.f / (1 << Table::kSegmentShift))
+        );
+        __m256 bias = _mm256_i32gather_ps(table.segmentBias.data(), segment, 4);
+        __m256 scale = _mm256_i32gather_ps(table.segmentScale.data(), segment, 4);
+        __m256i index = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(t, scale), bias));
+        index = _mm256_min_epi32(_mm256_max_epi32(index, _mm256_setzero_si256()), _mm256_set1_epi32(255));
+
+        // The guess is off by at most one, correct it with the thresholds.
+        __m256 upper = _mm256_i32gather_ps(table.thresholds.data(), _mm256_add_epi32(index, one), 4);
+        __m256 lower = _mm256_i32gather_ps(table.thresholds.data(), index, 4);
+        index = _mm256_sub_epi32(index, _mm256_castps_si256(_mm256_cmp_ps(upper, value, _CMP_LE_OQ))); // +1 if value >= upper.
+        index = _mm256_add_epi32(index, _mm256_castps_si256(_mm256_cmp_ps(lower, value, _CMP_GT_OQ)));  // -1 if value < lower.
+        index = _mm256_and_si256(index, _mm256_castps_si256(_mm256_cmp_ps(value, value, _CMP_ORD_Q)));  // 0 for NaNs.
+
+        // Pack the 32-bit indices to bytes.
+        __m128i index16 = _mm_packus_epi32(_mm256_castsi256_si128(index), _mm256_extracti128_si256(index, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(index16, index16));
+    }
+    convertLinear32FloatToSrgb8Scalar(pSrc + i, pDst + i, count - i);
+}
+
+struct Kernels
+{
+    Isa isa;
+    void (*convertFloat16ToFloat32)(const float16_t*, float*, size_t);
+    void (*convertFloat32ToFloat16)(const float*, float16_t*, size_t);
+    void (*convertUint16ToFloat32)(const uint16_t*, float*, size_t);
+    void (*convertInt16ToFloat32)(const int16_t*, float*, size_t);
+    void (*convertUint32ToFloat32)(const uint32_t*, float*, size_t);
+    void (*convertInt32ToFloat32)(const int32_t*, float*, size_t);
+    void (*expandToRGBA32Float)(const float*, uint32_t, float*, size_t, float);
+    void (*convertRGBA32FloatToRGB32Float)(const float*, float*, size_t);
+    void (*swapRedBlue8)(const uint32_t*, uint32_t*, size_t, bool);
+    void (*convertSrgb8ToLinear32Float)(const uint8_t*, float*, size_t);
+    void (*convertLinear32FloatToSrgb8)(const float*, uint8_t*, size_t);
+};
+
+const Kernels kScalarKernels = {
+    Isa::Scalar,
+    convertFloat16ToFloat32Scalar,
+    convertFloat32ToFloat16Scalar,
+    convertIntToFloat32Scalar<uint16_t>,
+    convertIntToFloat32Scalar<int16_t>,
+    convertIntToFloat32Scalar<uint32_t>,
+    convertIntToFloat32Scalar<int32_t>,
+    expandToRGBA32FloatScalar,
+    convertRGBA32FloatToRGB32FloatScalar,
+    swapRedBlue8Scalar,
+    convertSrgb8ToLinear32FloatScalar,
+    convertLinear32FloatToSrgb8Scalar,
+};
+
+const Kernels kAVX2Kernels = {
+    Isa::AVX2,
+    convertFloat16ToFloat32AVX2,
+    convertFloat32ToFloat16AVX2,
+    convertIntToFloat32AVX2<uint16_t>,
+    convertIntToFloat32AVX2<int16_t>,
+    convertIntToFloat32AVX2<uint32_t>,
+    convertIntToFloat32AVX2<int32_t>,
+    expandToRGBA32FloatAVX2,
+    convertRGBA32FloatToRGB32FloatAVX2,
+    swapRedBlue8AVX2,
+    convertSrgb8ToLinear32FloatAVX2,
+    convertLinear32FloatToSrgb8AVX2,
+};
+
+std::atomic<const Kernels*>& getKernelsPtr()
+{
+    static std::atomic<const Kernels*> pKernels{isAVX2Supported() ? &kAVX2Kernels : &kScalarKernels};
+    return pKernels;
+}
+
+const Kernels& getKernels()
+{
+    return *getKernelsPtr().load(std::memory_order_relaxed);
+}
+} // namespace
+
+Isa getIsa()
+{
+    return getKernels().isa;
+}
+
+Isa setIsa(Isa isa)
+{
+    const Kernels* pKernels = isa == Isa::AVX2 && isAVX2Supported() ? &kAVX2Kernels : &kScalarKernels;
+    getKernelsPtr().store(pKernels);
+    return pKernels->isa;
+}
+
+void convertFloat16ToFloat32(const float16_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().convertFloat16ToFloat32(pSrc, pDst, count);
+}
+
+void convertFloat32ToFloat16(const float* pSrc, float16_t* pDst, size_t count)
+{
+    getKernels().convertFloat32ToFloat16(pSrc, pDst, count);
+}
+
+void convertIntToFloat32(const uint16_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().convertUint16ToFloat32(pSrc, pDst, count);
+}
+
+void convertIntToFloat32(const int16_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().convertInt16ToFloat32(pSrc, pDst, count);
+}
+
+void convertIntToFloat32(const uint32_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().convertUint32ToFloat32(pSrc, pDst, count);
+}
+
+void convertIntToFloat32(const int32_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().convertInt32ToFloat32(pSrc, pDst, count);
+}
+
+void expandToRGBA32Float(const float* pSrc, uint32_t channelCount, float* pDst, size_t pixelCount, float alpha)
+{
+    FALCOR_ASSERT(channelCount >= 1 && channelCount <= 4);
+    getKernels().expandToRGBA32Float(pSrc, channelCount, pDst, pixelCount, alpha);
+}
+
+void convertRGBA32FloatToRGB32Float(const float* pSrc, float* pDst, size_t pixelCount)
+{
+    getKernels().convertRGBA32FloatToRGB32Float(pSrc, pDst, pixelCount);
+}
+
+void swapRedBlue8(const uint32_t* pSrc, uint32_t* pDst, size_t pixelCount, bool opaqueAlpha)
+{
+    getKernels().swapRedBlue8(pSrc, pDst, pixelCount, opaqueAlpha);
+}
+
+void convertSrgb8ToLinear32Float(const uint8_t* pSrc, float* pDst, size_t count)
+{
+    getKernels().convertSrgb8ToLinear32Float(pSrc, pDst, count);
+}
+
+void convertLinear32FloatToSrgb8(const float* pSrc, uint8_t* pDst, size_t count)
+{
+    getKernels().convertLinear32FloatToSrgb8(pSrc, pDst, count);
+}
+
+float srgb8ToLinear(uint8_t value)
+{
+    return getSrgbDecodeTable()[value];
+}
+
+uint8_t linearToSrgb8(float value)
+{
+    return getSrgbEncodeTable().encode(value);
+}
+} // namespace PixelConversion
+} // namespace Falcor
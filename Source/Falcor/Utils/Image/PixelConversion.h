@@ -0,0 +1,128 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Utils/Math/ScalarTypes.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Conversion kernels between the pixel formats handled by Bitmap and ImageIO.
+ *
+ * The kernels process arrays of values or pixels. They have an AVX2/F16C implementation that is selected at runtime if the CPU
+ * supports it, and a scalar implementation used otherwise. Both give the same results, except for the float to half conversion,
+ * see convertFloat32ToFloat16(). Unless noted otherwise, the source and destination must not overlap.
+ */
+namespace PixelConversion
+{
+/// Instruction set used by the kernels.
+enum class Isa
+{
+    Scalar,
+    AVX2,
+};
+
+/**
+ * Get the instruction set used by the kernels.
+ */
+FALCOR_API Isa getIsa();
+
+/**
+ * Set the instruction set used by the kernels. This is meant for testing and benchmarking.
+ * @param[in] isa Instruction set. If it isn't supported by the CPU, the scalar implementation is used.
+ * @return The instruction set used from now on.
+ */
+FALCOR_API Isa setIsa(Isa isa);
+
+/**
+ * Convert half floats to floats. The conversion is exact.
+ */
+FALCOR_API void convertFloat16ToFloat32(const float16_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Convert floats to half floats.
+ * The AVX2 implementation rounds to nearest even, while the scalar implementation rounds ties away from zero, so results can
+ * differ by one ulp for values exactly halfway between two half floats.
+ */
+FALCOR_API void convertFloat32ToFloat16(const float* pSrc, float16_t* pDst, size_t count);
+
+/**
+ * Convert integers to floats, dividing them by the largest value of their type.
+ * Unsigned integers are normalized to [0,1], signed integers to [-1,1] (the smallest value maps slightly below -1).
+ */
+FALCOR_API void convertIntToFloat32(const uint16_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const int16_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const uint32_t* pSrc, float* pDst, size_t count);
+FALCOR_API void convertIntToFloat32(const int32_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Expand float pixels with 1 to 4 channels to RGBA. Missing color channels are set to 0.
+ * @param[in] pSrc Source pixels.
+ * @param[in] channelCount Number of channels of the source pixels.
+ * @param[out] pDst Destination RGBA pixels.
+ * @param[in] pixelCount Number of pixels.
+ * @param[in] alpha Alpha value used if the source pixels have less than 4 channels.
+ */
+FALCOR_API void expandToRGBA32Float(const float* pSrc, uint32_t channelCount, float* pDst, size_t pixelCount, float alpha);
+
+/**
+ * Drop the alpha channel of RGBA float pixels.
+ */
+FALCOR_API void convertRGBA32FloatToRGB32Float(const float* pSrc, float* pDst, size_t pixelCount);
+
+/**
+ * Swap the red and blue channels of 8-bit RGBA pixels, converting RGBA to BGRA or BGRA to RGBA.
+ * The source and destination may be the same array.
+ * @param[in] opaqueAlpha Set the alpha channel to 255 instead of copying it.
+ */
+FALCOR_API void swapRedBlue8(const uint32_t* pSrc, uint32_t* pDst, size_t pixelCount, bool opaqueAlpha);
+
+/**
+ * Decode 8-bit sRGB values to linear floats.
+ */
+FALCOR_API void convertSrgb8ToLinear32Float(const uint8_t* pSrc, float* pDst, size_t count);
+
+/**
+ * Encode linear floats to 8-bit sRGB values, rounded to nearest. Values are clamped to [0,1], NaNs are encoded as 0.
+ */
+FALCOR_API void convertLinear32FloatToSrgb8(const float* pSrc, uint8_t* pDst, size_t count);
+
+/**
+ * Decode a single 8-bit sRGB value to a linear float.
+ */
+FALCOR_API float srgb8ToLinear(uint8_t value);
+
+/**
+ * Encode a single linear float to an 8-bit sRGB value. This gives the same result as convertLinear32FloatToSrgb8().
+ */
+FALCOR_API uint8_t linearToSrgb8(float value);
+} // namespace PixelConversion
+} // namespace Falcor
@@ -0,0 +1,331 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "StreamingImageReader.h"
+#include "Core/Error.h"
+#include "Core/Platform/OS.h"
+#include "Utils/Logger.h"
+
+#include <ImfInputFile.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Reads OpenEXR files. Tiled files are handled by Imf::InputFile, which decodes the tiles overlapping the requested rows.
+class ExrReader : public StreamingImageReader
+{
+public:
+    static std::unique_ptr<StreamingImageReader> open(const std::filesystem::path& path)
+    {
+        auto pFile = std::make_unique<Imf::InputFile>(path.string().c_str());
+        const Imf::Header& header = pFile->header();
+        const Imath::Box2i& dataWindow = header.dataWindow();
+
+        bool isFloat16 = true;
+        bool hasColor = false;
+        bool isLuminance = false;
+        const Imf::ChannelList& channels = header.channels();
+        for (auto it = channels.begin(); it != channels.end(); ++it)
+        {
+            const std::string name = it.name();
+            if (name != "R" && name != "G" && name != "B" && name != "A" && name != "Y")
+                continue;
+            if (it.channel().xSampling != 1 || it.channel().ySampling != 1)
+            {
+                logWarning("Can't stream '{}'. Subsampled channels are not supported.", path);
+                return nullptr;
+            }
+            if (it.channel().type != Imf::HALF)
+                isFloat16 = false;
+            if (name == "Y")
+                isLuminance = true;
+            else if (name != "A")
+                hasColor = true;
+        }
+        if (!hasColor && !isLuminance)
+        {
+            logWarning("Can't stream '{}'. The image has no color channels.", path);
+            return nullptr;
+        }
+
+        return std::unique_ptr<StreamingImageReader>(new ExrReader(std::move(pFile), dataWindow, isFloat16, isLuminance && !hasColor));
+    }
+
+protected:
+    void decodeRows(float* pDst, uint32_t y, uint32_t rowCount) override
+    {
+        const size_t xStride = 4 * sizeof(float);
+        const size_t yStride = xStride * getWidth();
+        const int firstY = mDataWindow.min.y + (int)y;
+
+        // Imf addresses the pixels with data window coordinates, offset the base pointer so that they land in pDst.
+        char* pBase = reinterpret_cast<char*>(pDst) - mDataWindow.min.x * xStride - firstY * yStride;
+        Imf::FrameBuffer frameBuffer;
+        if (mIsLuminance)
+        {
+            frameBuffer.insert("Y", Imf::Slice(Imf::FLOAT, pBase, xStride, yStride, 1, 1, 0.0));
+        }
+        else
+        {
+            frameBuffer.insert("R", Imf::Slice(Imf::FLOAT, pBase, xStride, yStride, 1, 1, 0.0));
+            frameBuffer.insert("G", Imf::Slice(Imf::FLOAT, pBase + sizeof(float), xStride, yStride, 1, 1, 0.0));
+            frameBuffer.insert("B", Imf::Slice(Imf::FLOAT, pBase + 2 * sizeof(float), xStride, yStride, 1, 1, 0.0));
+        }
+        frameBuffer.insert("A", Imf::Slice(Imf::FLOAT, pBase + 3 * sizeof(float), xStride, yStride, 1, 1, 1.0));
+
+        try
+        {
+            mpFile->setFrameBuffer(frameBuffer);
+            mpFile->readPixels(firstY, firstY + (int)rowCount - 1);
+        }
+        catch (const std::exception& e)
+        {
+            FALCOR_THROW("Failed to read OpenEXR rows {} to {}: {}", y, y + rowCount - 1, e.what());
+        }
+
+        if (mIsLuminance)
+        {
+            const size_t pixelCount = size_t(rowCount) * getWidth();
+            for (size_t i = 0; i < pixelCount; i++)
+                pDst[i * 4 + 1] = pDst[i * 4 + 2] = pDst[i * 4];
+        }
+    }
+
+private:
+    ExrReader(std::unique_ptr<Imf::InputFile> pFile, const Imath::Box2i& dataWindow, bool isFloat16, bool isLuminance)
+        : StreamingImageReader(
+              uint32_t(dataWindow.max.x - dataWindow.min.x + 1),
+              uint32_t(dataWindow.max.y - dataWindow.min.y + 1),
+              isFloat16
+          )
+        , mpFile(std::move(pFile))
+        , mDataWindow(dataWindow)
+        , mIsLuminance(isLuminance)
+    {}
+
+    std::unique_ptr<Imf::InputFile> mpFile;
+    Imath::Box2i mDataWindow;
+    bool mIsLuminance;
+};
+
+/// Reads Radiance HDR (RGBE) files, flat or run-length encoded. Only the standard top to bottom orientation is supported.
+class HdrReader : public StreamingImageReader
+{
+public:
+    static std::unique_ptr<StreamingImageReader> open(const std::filesystem::path& path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+        {
+            logWarning("Can't open '{}'.", path);
+            return nullptr;
+        }
+
+        std::string line;
+        if (!std::getline(stream, line) || line.compare(0, 2, "#?") != 0)
+        {
+            logWarning("Can't stream '{}'. Invalid Radiance HDR header.", path);
+            return nullptr;
+        }
+        while (std::getline(stream, line) && !line.empty())
+        {
+            if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe")
+            {
+                logWarning("Can't stream '{}'. Unsupported format '{}'.", path, line.substr(7));
+                return nullptr;
+            }
+        }
+
+        // The resolution string gives the orientation, "-Y height +X width" stores the rows top to bottom.
+        char yAxis[3] = {}, xAxis[3] = {};
+        uint32_t width = 0, height = 0;
+        if (!std::getline(stream, line) || std::sscanf(line.c_str(), "%2s %u %2s %u", yAxis, &height, xAxis, &width) != 4)
+        {
+            logWarning("Can't stream '{}'. Invalid Radiance HDR resolution string.", path);
+            return nullptr;
+        }
+        if (std::string(yAxis) != "-Y" || std::string(xAxis) != "+X" || width == 0 || height == 0)
+        {
+            logWarning("Can't stream '{}'. Unsupported image orientation '{}'.", path, line);
+            return nullptr;
+        }
+
+        return std::unique_ptr<StreamingImageReader>(new HdrReader(std::move(stream), width, height));
+    }
+
+protected:
+    void decodeRows(float* pDst, uint32_t y, uint32_t rowCount) override
+    {
+        const uint32_t width = getWidth();
+        for (uint32_t row = 0; row < rowCount; row++)
+        {
+            readScanline();
+            float* pDstRow = pDst + size_t(row) * width * 4;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* pRgbe = &mScanline[x * 4];
+                // Same decoding as FreeImage, so that both loaders return the same values.
+                const float scale = pRgbe[3] == 0 ? 0.f : std::ldexp(1.f, int(pRgbe[3]) - (128 + 8));
+                pDstRow[x * 4 + 0] = pRgbe[0] * scale;
+                pDstRow[x * 4 + 1] = pRgbe[1] * scale;
+                pDstRow[x * 4 + 2] = pRgbe[2] * scale;
+                pDstRow[x * 4 + 3] = 1.f;
+            }
+        }
+    }
+
+private:
+    HdrReader(std::ifstream stream, uint32_t width, uint32_t height)
+        : StreamingImageReader(width, height, false), mStream(std::move(stream)), mScanline(size_t(width) * 4)
+    {}
+
+    uint8_t readByte()
+    {
+        int c = mStream.get();
+        if (c == std::char_traits<char>::eof())
+            FALCOR_THROW("Unexpected end of Radiance HDR file.");
+        return uint8_t(c);
+    }
+
+    void readBytes(uint8_t* pDst, size_t count)
+    {
+        if (!mStream.read(reinterpret_cast<char*>(pDst), count))
+            FALCOR_THROW("Unexpected end of Radiance HDR file.");
+    }
+
+    void readScanline()
+    {
+        const uint32_t width = getWidth();
+        uint8_t header[4];
+        readBytes(header, 4);
+
+        // Scanlines encoded with the new run-length encoding store each component separately.
+        const bool isRunLengthEncoded = width >= 8 && width < 32768 && header[0] == 2 && header[1] == 2 && (header[2] & 0x80) == 0;
+        if (isRunLengthEncoded)
+        {
+            if ((uint32_t(header[2]) << 8 | header[3]) != width)
+                FALCOR_THROW("Invalid Radiance HDR scanline length.");
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                uint32_t x = 0;
+                while (x < width)
+                {
+                    uint32_t count = readByte();
+                    const bool isRun = count > 128;
+                    if (isRun)
+                        count -= 128;
+                    if (count == 0 || x + count > width)
+                        FALCOR_THROW("Invalid Radiance HDR run length.");
+                    if (isRun)
+                    {
+                        const uint8_t value = readByte();
+                        for (uint32_t i = 0; i < count; i++)
+                            mScanline[(x + i) * 4 + c] = value;
+                    }
+                    else
+                    {
+                        for (uint32_t i = 0; i < count; i++)
+                            mScanline[(x + i) * 4 + c] = readByte();
+                    }
+                    x += count;
+                }
+            }
+            return;
+        }
+
+        // Flat pixels, possibly using the old run-length encoding where a (1, 1, 1, n) pixel repeats the previous one.
+        std::copy(header, header + 4, mScanline.begin());
+        uint32_t x = 1;
+        uint32_t shift = 0;
+        while (x < width)
+        {
+            uint8_t* pPixel = &mScanline[x * 4];
+            readBytes(pPixel, 4);
+            if (pPixel[0] == 1 && pPixel[1] == 1 && pPixel[2] == 1)
+            {
+                const uint32_t count = uint32_t(pPixel[3]) << shift;
+                if (x + count > width)
+                    FALCOR_THROW("Invalid Radiance HDR run length.");
+                for (uint32_t i = 0; i < count; i++)
+                    std::copy_n(&mScanline[(x - 1) * 4], 4, &mScanline[(x + i) * 4]);
+                x += count;
+                shift += 8;
+            }
+            else
+            {
+                x++;
+                shift = 0;
+            }
+        }
+    }
+
+    std::ifstream mStream;
+    std::vector<uint8_t> mScanline; ///< RGBE bytes of the current scanline.
+};
+} // namespace
+
+bool StreamingImageReader::isSupported(const std::filesystem::path& path)
+{
+    return hasExtension(path, "exr") || hasExtension(path, "hdr");
+}
+
+std::unique_ptr<StreamingImageReader> StreamingImageReader::open(const std::filesystem::path& path)
+{
+    try
+    {
+        if (hasExtension(path, "exr"))
+            return ExrReader::open(path);
+        if (hasExtension(path, "hdr"))
+            return HdrReader::open(path);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Can't open '{}': {}", path, e.what());
+    }
+    return nullptr;
+}
+
+uint32_t StreamingImageReader::readRows(float* pDst, uint32_t rowCount)
+{
+    rowCount = std::min(rowCount, mHeight - mRowsRead);
+    if (rowCount > 0)
+        decodeRows(pDst, mRowsRead, rowCount);
+    mRowsRead += rowCount;
+    return rowCount;
+}
+} // namespace Falcor
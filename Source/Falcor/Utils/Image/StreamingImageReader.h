@@ -0,0 +1,96 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <filesystem>
+#include <memory>
+
+namespace Falcor
+{
+/**
+ * Reader decoding HDR images in blocks of rows.
+ *
+ * Bitmap::createFromFile() decodes the whole image before converting it, which needs several full-size copies of large
+ * environment maps. This reader instead decodes the rows on demand, so the caller only needs to hold the rows it is processing.
+ *
+ * OpenEXR files (scanline and tiled) and Radiance HDR files (stored top to bottom) are supported.
+ * Rows are returned top to bottom as RGBA32Float pixels. Missing color channels are set to zero and missing alpha to one.
+ * Luminance-only OpenEXR files are returned as grayscale RGB.
+ */
+class FALCOR_API StreamingImageReader
+{
+public:
+    virtual ~StreamingImageReader() = default;
+
+    /**
+     * Check if a file can be read by this class, based on its extension.
+     */
+    static bool isSupported(const std::filesystem::path& path);
+
+    /**
+     * Open an image file.
+     * @param[in] path File path.
+     * @return A new reader, or nullptr if the file can't be opened or its layout isn't supported.
+     */
+    static std::unique_ptr<StreamingImageReader> open(const std::filesystem::path& path);
+
+    uint32_t getWidth() const { return mWidth; }
+    uint32_t getHeight() const { return mHeight; }
+
+    /**
+     * Check if all channels are stored as 16-bit floats.
+     */
+    bool isFloat16() const { return mIsFloat16; }
+
+    /**
+     * Get the number of rows read so far.
+     */
+    uint32_t getRowsRead() const { return mRowsRead; }
+
+    /**
+     * Read the next rows.
+     * Throws an exception if the file is corrupt.
+     * @param[out] pDst Destination buffer, must hold rowCount * getWidth() RGBA32Float pixels.
+     * @param[in] rowCount Number of rows to read.
+     * @return Number of rows read, which is less than rowCount at the end of the image.
+     */
+    uint32_t readRows(float* pDst, uint32_t rowCount);
+
+protected:
+    StreamingImageReader(uint32_t width, uint32_t height, bool isFloat16) : mWidth(width), mHeight(height), mIsFloat16(isFloat16) {}
+
+    /// Decode rows [y, y + rowCount).
+    virtual void decodeRows(float* pDst, uint32_t y, uint32_t rowCount) = 0;
+
+private:
+    uint32_t mWidth;
+    uint32_t mHeight;
+    bool mIsFloat16;
+    uint32_t mRowsRead = 0;
+};
+} // namespace Falcor
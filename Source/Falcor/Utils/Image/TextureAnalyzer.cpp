@@ -26,8 +26,18 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureAnalyzer.h"
+#include "Bitmap.h"
+#include "PixelConversion.h"
 #include "Core/API/RenderContext.h"
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <immintrin.h>
+
 namespace Falcor
 {
 namespace
@@ -39,6 +49,256 @@ static_assert((uint32_t)TextureChannelFlags::Blue == 0x4);
 static_assert((uint32_t)TextureChannelFlags::Alpha == 0x8);
 
 const char kShaderFilename[] = "Utils/Image/TextureAnalyzer.cs.slang";
+
+/**
+ * Statistics of the channels of an image, as stored in memory.
+ * Unorm channels are analyzed on their integer values, as the conversion to float preserves order and equality.
+ */
+template<typename T>
+struct ChannelStats
+{
+    T ref[4] = {};               ///< First pixel.
+    T minValue[4];               ///< Minimum value, ignoring NaNs.
+    T maxValue[4];               ///< Maximum value, ignoring NaNs.
+    uint32_t varyingMask = 0;    ///< Bit i is set if channel i differs from the first pixel.
+    uint32_t rangeFlags[4] = {}; ///< TextureAnalyzer::Result::RangeFlags of each channel. Only computed for floats.
+
+    ChannelStats()
+    {
+        std::fill_n(minValue, 4, std::numeric_limits<T>::max());
+        std::fill_n(maxValue, 4, std::numeric_limits<T>::lowest());
+    }
+};
+
+/// Accumulate the statistics of interleaved values. The count must be a multiple of the channel count.
+template<typename T>
+void accumulateStatsScalar(const T* pValues, size_t count, uint32_t channelCount, ChannelStats<T>& stats)
+{
+    for (size_t i = 0; i < count; i += channelCount)
+    {
+        for (uint32_t c = 0; c < channelCount; c++)
+        {
+            const T value = pValues[i + c];
+            if (value != stats.ref[c])
+                stats.varyingMask |= 1u << c;
+            // Comparisons with NaN are false, so NaNs don't change the minimum and maximum, as for the GPU analysis.
+            if (value < stats.minValue[c])
+                stats.minValue[c] = value;
+            if (value > stats.maxValue[c])
+                stats.maxValue[c] = value;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                using RangeFlags = TextureAnalyzer::Result::RangeFlags;
+                uint32_t flags = 0;
+                flags |= value > 0.f ? (uint32_t)RangeFlags::Pos : 0;
+                flags |= value < 0.f ? (uint32_t)RangeFlags::Neg : 0;
+                flags |= std::isinf(value) ? (uint32_t)RangeFlags::Inf : 0;
+                flags |= std::isnan(value) ? (uint32_t)RangeFlags::NaN : 0;
+                stats.rangeFlags[c] |= flags;
+            }
+        }
+    }
+}
+
+/// Merge per-lane accumulators of the vectorized kernels, where lane i holds channel i % channelCount.
+template<typename T, size_t N>
+void mergeLanes(const T (&minLanes)[N], const T (&maxLanes)[N], const T (&equalLanes)[N], uint32_t channelCount, ChannelStats<T>& stats)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        const uint32_t c = uint32_t(i % channelCount);
+        stats.minValue[c] = std::min(stats.minValue[c], minLanes[i]);
+        stats.maxValue[c] = std::max(stats.maxValue[c], maxLanes[i]);
+        if (equalLanes[i] == 0)
+            stats.varyingMask |= 1u << c;
+    }
+}
+
+/// Accumulate the statistics of interleaved unorm values with AVX2. The channel count must divide the number of lanes.
+/// Returns the number of values processed, the remaining ones are left to the scalar kernel.
+template<typename T>
+FALCOR_TARGET_AVX2 size_t accumulateUnormStatsAVX2(const T* pValues, size_t count, uint32_t channelCount, ChannelStats<T>& stats)
+{
+    constexpr size_t kLanes = 32 / sizeof(T);
+    alignas(32) T ref[kLanes];
+    for (size_t i = 0; i < kLanes; i++)
+        ref[i] = stats.ref[i % channelCount];
+
+    const __m256i refValues = _mm256_load_si256((const __m256i*)ref);
+    __m256i minValues = _mm256_set1_epi8(-1);
+    __m256i maxValues = _mm256_setzero_si256();
+    __m256i equal = _mm256_set1_epi8(-1);
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes)
+    {
+        const __m256i values = _mm256_loadu_si256((const __m256i*)(pValues + i));
+        if constexpr (sizeof(T) == 1)
+        {
+            minValues = _mm256_min_epu8(minValues, values);
+            maxValues = _mm256_max_epu8(maxValues, values);
+            equal = _mm256_and_si256(equal, _mm256_cmpeq_epi8(values, refValues));
+        }
+        else
+        {
+            minValues = _mm256_min_epu16(minValues, values);
+            maxValues = _mm256_max_epu16(maxValues, values);
+            equal = _mm256_and_si256(equal, _mm256_cmpeq_epi16(values, refValues));
+        }
+    }
+
+    alignas(32) T minLanes[kLanes], maxLanes[kLanes], equalLanes[kLanes];
+    _mm256_store_si256((__m256i*)minLanes, minValues);
+    _mm256_store_si256((__m256i*)maxLanes, maxValues);
+    _mm256_store_si256((__m256i*)equalLanes, equal);
+    mergeLanes(minLanes, maxLanes, equalLanes, channelCount, stats);
+    return i;
+}
+
+/// Accumulate the statistics of interleaved float values with AVX2. The channel count must divide the number of lanes.
+/// Returns the number of values processed, the remaining ones are left to the scalar kernel.
+FALCOR_TARGET_AVX2 size_t accumulateFloatStatsAVX2(const float* pValues, size_t count, uint32_t channelCount, ChannelStats<float>& stats)
+{
+    constexpr size_t kLanes = 8;
+    alignas(32) float ref[kLanes];
+    for (size_t i = 0; i < kLanes; i++)
+        ref[i] = stats.ref[i % channelCount];
+
+    const __m256 refValues = _mm256_load_ps(ref);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 minValues = _mm256_set1_ps(FLT_MAX);
+    __m256 maxValues = _mm256_set1_ps(-FLT_MAX);
+    __m256 notEqual = zero, pos = zero, neg = zero, isInf = zero, isNaN = zero;
+    size_t i = 0;
+    for (; i + kLanes <= count; i += kLanes)
+    {
+        const __m256 values = _mm256_loadu_ps(pValues + i);
+        // min/max return the second operand if either is NaN, so NaNs are ignored.
+        minValues = _mm256_min_ps(values, minValues);
+        maxValues = _mm256_max_ps(values, maxValues);
+        notEqual = _mm256_or_ps(notEqual, _mm256_cmp_ps(values, refValues, _CMP_NEQ_UQ));
+        pos = _mm256_or_ps(pos, _mm256_cmp_ps(values, zero, _CMP_GT_OQ));
+        neg = _mm256_or_ps(neg, _mm256_cmp_ps(values, zero, _CMP_LT_OQ));
+        isInf = _mm256_or_ps(isInf, _mm256_cmp_ps(_mm256_and_ps(values, absMask), inf, _CMP_EQ_OQ));
+        isNaN = _mm256_or_ps(isNaN, _mm256_cmp_ps(values, values, _CMP_UNORD_Q));
+    }
+
+    alignas(32) float minLanes[kLanes], maxLanes[kLanes], equalLanes[kLanes];
+    _mm256_store_ps(minLanes, minValues);
+    _mm256_store_ps(maxLanes, maxValues);
+    _mm256_store_ps(equalLanes, _mm256_cmp_ps(notEqual, zero, _CMP_EQ_OQ));
+    mergeLanes(minLanes, maxLanes, equalLanes, channelCount, stats);
+
+    // Gather the range flags of each lane as 4 bit masks, one bit per flag.
+    using RangeFlags = TextureAnalyzer::Result::RangeFlags;
+    const uint32_t laneMasks[4] = {
+        (uint32_t)_mm256_movemask_ps(pos),
+        (uint32_t)_mm256_movemask_ps(neg),
+        (uint32_t)_mm256_movemask_ps(isInf),
+        (uint32_t)_mm256_movemask_ps(isNaN),
+    };
+    const uint32_t flags[4] = {(uint32_t)RangeFlags::Pos, (uint32_t)RangeFlags::Neg, (uint32_t)RangeFlags::Inf, (uint32_t)RangeFlags::NaN};
+    for (size_t lane = 0; lane < kLanes; lane++)
+        for (size_t j = 0; j < 4; j++)
+            if (laneMasks[j] & (1u << lane))
+                stats.rangeFlags[lane % channelCount] |= flags[j];
+    return i;
+}
+
+template<typename T>
+void accumulateStats(const T* pValues, size_t count, uint32_t channelCount, ChannelStats<T>& stats)
+{
+    size_t i = 0;
+    if (PixelConversion::getIsa() == PixelConversion::Isa::AVX2 && 32 / sizeof(T) % channelCount == 0)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            i = accumulateFloatStatsAVX2(pValues, count, channelCount, stats);
+        else
+            i = accumulateUnormStatsAVX2(pValues, count, channelCount, stats);
+    }
+    accumulateStatsScalar(pValues + i, count - i, channelCount, stats);
+}
+
+/// Compute the statistics of an image, converting the rows with the given function first if it isn't null.
+template<typename T, typename SrcT = T, typename ConvertFunc = std::nullptr_t>
+ChannelStats<T> computeStats(
+    const uint8_t* pData,
+    uint32_t width,
+    uint32_t height,
+    uint32_t rowPitch,
+    uint32_t channelCount,
+    ConvertFunc convert = nullptr
+)
+{
+    ChannelStats<T> stats;
+    const size_t rowValueCount = size_t(width) * channelCount;
+    std::vector<T> row(std::is_same_v<ConvertFunc, std::nullptr_t> ? 0 : rowValueCount);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const T* pValues = reinterpret_cast<const T*>(pData + size_t(y) * rowPitch);
+        if constexpr (!std::is_same_v<ConvertFunc, std::nullptr_t>)
+        {
+            convert(reinterpret_cast<const SrcT*>(pData + size_t(y) * rowPitch), row.data(), rowValueCount);
+            pValues = row.data();
+        }
+        if (y == 0)
+            std::copy_n(pValues, channelCount, stats.ref);
+        accumulateStats(pValues, rowValueCount, channelCount, stats);
+    }
+    return stats;
+}
+
+/// Convert channel statistics to the analysis result.
+template<typename T>
+TextureAnalyzer::Result makeResult(const ChannelStats<T>& stats, ResourceFormat format)
+{
+    using RangeFlags = TextureAnalyzer::Result::RangeFlags;
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const bool isBGR = format == ResourceFormat::BGRA8Unorm || format == ResourceFormat::BGRA8UnormSrgb ||
+                       format == ResourceFormat::BGRX8Unorm || format == ResourceFormat::BGRX8UnormSrgb;
+    const bool hasAlpha = doesFormatHaveAlpha(format);
+    const bool isSrgb = isSrgbFormat(format);
+
+    auto toFloat = [&](T value, uint32_t c) -> float
+    {
+        if constexpr (std::is_same_v<T, uint8_t>)
+            return isSrgb && c < 3 ? PixelConversion::srgb8ToLinear(value) : value / 255.f;
+        else if constexpr (std::is_same_v<T, uint16_t>)
+            return value / 65535.f;
+        else
+            return value;
+    };
+
+    TextureAnalyzer::Result result = {};
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        float value, minValue, maxValue;
+        uint32_t range;
+        if (c < channelCount && (c < 3 || hasAlpha))
+        {
+            const uint32_t channel = isBGR && c != 3 ? 2 - c : c;
+            if (stats.varyingMask & (1u << channel))
+                result.mask |= 1u << c;
+            value = toFloat(stats.ref[channel], c);
+            minValue = toFloat(stats.minValue[channel], c);
+            maxValue = toFloat(stats.maxValue[channel], c);
+            range = std::is_same_v<T, float> ? stats.rangeFlags[channel] : (maxValue > 0.f ? (uint32_t)RangeFlags::Pos : 0);
+        }
+        else
+        {
+            // Missing channels are read as constant zero for color and one for alpha.
+            value = minValue = maxValue = c == 3 ? 1.f : 0.f;
+            range = c == 3 ? (uint32_t)RangeFlags::Pos : 0;
+        }
+        result.mask |= range << (4 + 4 * c);
+        result.value[c] = value;
+        // The GPU analysis clamps to zero, as it uses integer atomics.
+        result.minValue[c] = std::max(minValue, 0.f);
+        result.maxValue[c] = std::max(maxValue, 0.f);
+    }
+    return result;
+}
 } // namespace
 
 // Verify that the result struct matches the size expected by the shader.
@@ -49,6 +309,40 @@ size_t TextureAnalyzer::getResultSize()
     return sizeof(TextureAnalyzer::Result);
 }
 
+bool TextureAnalyzer::isCpuAnalysisSupported(ResourceFormat format)
+{
+    // Same formats as the CPU mip generation, where all channels have the same size.
+    return Bitmap::isMipGenerationSupported(format);
+}
+
+TextureAnalyzer::Result TextureAnalyzer::analyzeCpu(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format)
+{
+    FALCOR_CHECK(isCpuAnalysisSupported(format), "Format {} is not supported by the CPU analysis", to_string(format));
+    FALCOR_CHECK(pData && width > 0 && height > 0, "Invalid image");
+
+    const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+    const uint32_t channelCount = getFormatChannelCount(format);
+    const uint32_t bits = getNumChannelBits(format, 0);
+    if (getFormatType(format) == FormatType::Float)
+    {
+        if (bits == 16)
+        {
+            auto convert = [](const float16_t* pSrc, float* pDst, size_t count) { PixelConversion::convertFloat16ToFloat32(pSrc, pDst, count); };
+            return makeResult(computeStats<float, float16_t>(pBytes, width, height, rowPitch, channelCount, convert), format);
+        }
+        return makeResult(computeStats<float>(pBytes, width, height, rowPitch, channelCount), format);
+    }
+    if (bits == 8)
+        return makeResult(computeStats<uint8_t>(pBytes, width, height, rowPitch, channelCount), format);
+    return makeResult(computeStats<uint16_t>(pBytes, width, height, rowPitch, channelCount), format);
+}
+
+TextureAnalyzer::Result TextureAnalyzer::analyzeCpu(const Bitmap& bitmap, bool loadAsSrgb)
+{
+    const ResourceFormat format = loadAsSrgb ? linearToSrgbFormat(bitmap.getFormat()) : bitmap.getFormat();
+    return analyzeCpu(bitmap.getData(), bitmap.getWidth(), bitmap.getHeight(), bitmap.getRowPitch(), format);
+}
+
 TextureAnalyzer::TextureAnalyzer(ref<Device> pDevice) : mpDevice(pDevice)
 {
     mpClearPass = ComputePass::create(mpDevice, kShaderFilename, "clear");
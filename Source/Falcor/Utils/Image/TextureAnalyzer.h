@@ -37,10 +37,13 @@
 
 namespace Falcor
 {
+class Bitmap;
 class RenderContext;
 
 /**
  * A class for analyzing texture contents.
+ *
+ * Textures can be analyzed on the GPU with analyze(), or images in CPU memory with analyzeCpu(). Both give the same result.
  */
 class FALCOR_API TextureAnalyzer
 {
@@ -145,6 +148,33 @@ public:
      */
     static size_t getResultSize();
 
+    /**
+     * Check if analyzeCpu() supports a format.
+     * Uncompressed formats with 8 or 16-bit unorm channels, or 16 or 32-bit float channels are supported.
+     */
+    static bool isCpuAnalysisSupported(ResourceFormat format);
+
+    /**
+     * Analyze an image on the CPU. This doesn't need a device, and gives the same result as analyze() for a texture holding the image.
+     * Channels missing from the format are read as in shaders, with zero for color and one for alpha.
+     * Throws an exception if the format is not supported.
+     * @param[in] pData Image data, with the rows stored top to bottom.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[in] rowPitch Size of a row in bytes.
+     * @param[in] format Image format. The color channels of sRGB formats are analyzed as linear values.
+     * @return Analysis result.
+     */
+    static Result analyzeCpu(const void* pData, uint32_t width, uint32_t height, uint32_t rowPitch, ResourceFormat format);
+
+    /**
+     * Analyze a bitmap on the CPU. See analyzeCpu() above.
+     * @param[in] bitmap Bitmap.
+     * @param[in] loadAsSrgb Analyze the color channels as sRGB values, as for a texture loaded as sRGB.
+     * @return Analysis result.
+     */
+    static Result analyzeCpu(const Bitmap& bitmap, bool loadAsSrgb = false);
+
 private:
     void checkFormatSupport(const ref<Texture> pInput, uint32_t mipLevel, uint32_t arraySlice) const;
 
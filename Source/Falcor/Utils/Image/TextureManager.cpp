@@ -29,13 +29,7 @@
 #include "Core/AssetResolver.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
-#include "Utils/NumericRange.h"
-
-#include <execution>
-
-// Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
-// Until then `TextureManager` should only called from the main thread.
-#define DISABLE_ASYNC_TEXTURE_LOADER
+#include "Utils/Threading.h"
 
 namespace Falcor
 {
@@ -283,7 +277,6 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
             return handle;
         }
 
-#ifndef DISABLE_ASYNC_TEXTURE_LOADER
         mLoadRequestsInProgress++;
 
         // Texture is not already managed. Add new texture desc.
@@ -294,8 +287,8 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         mKeyToHandle[textureKey] = handle;
 
         // Function called by the async texture loader when loading finishes.
-        // It's called by a worker thread so needs to acquire the mutex before changing any state.
-        auto callback = [=](ref<Texture> pTexture)
+        // It's called by the thread processing the uploads so needs to acquire the mutex before changing any state.
+        auto callback = [=](ref<Texture> pTexture, const std::optional<TextureAnalyzer::Result>& analysis)
         {
             std::unique_lock<std::mutex> lock(mMutex);
 
@@ -303,6 +296,7 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
             auto& desc = getDesc(handle);
             desc.state = TextureState::Loaded;
             desc.pTexture = pTexture;
+            desc.analysis = analysis;
 
             // Add to texture-to-handle map.
             if (pTexture)
@@ -321,39 +315,18 @@ TextureManager::CpuTextureHandle TextureManager::loadTexture(
         {
             mAsyncTextureLoader.loadFromFile(paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags, callback);
         }
-#else
-        // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
-        {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags, importFlags);
-        }
-        else
-        {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags, importFlags);
-        }
-
-        // Add new texture desc.
-        TextureDesc desc = {TextureState::Loaded, pTexture};
-        handle = addDesc(desc);
-
-        // Add to key-to-handle map.
-        mKeyToHandle[textureKey] = handle;
-
-        // Add to texture-to-handle map.
-        if (pTexture)
-            mTextureToHandle[pTexture.get()] = handle;
-
-        mCondition.notify_all();
-#endif
     }
 
     registerOwner(handle, owner);
     lock.unlock();
 
-    if (!mUseDeferredLoading && !async)
+    if (!mUseDeferredLoading)
     {
-        waitForTextureLoading(handle);
+        // Upload the textures decoded so far. The other ones are uploaded by later calls or when waiting for them.
+        if (async)
+            mAsyncTextureLoader.processUploads();
+        else
+            waitForTextureLoading(handle);
     }
 
     return handle;
@@ -364,16 +337,26 @@ void TextureManager::waitForTextureLoading(const CpuTextureHandle& handle)
     if (!handle)
         return;
 
-    // Acquire mutex and wait for texture state to change.
-    std::unique_lock<std::mutex> lock(mMutex);
-    mCondition.wait(lock, [&]() { return getDesc(handle).state == TextureState::Loaded; });
+    // Upload decoded textures until this one is loaded.
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (getDesc(handle).state != TextureState::Referenced)
+                break;
+        }
+        if (mAsyncTextureLoader.processUploads(true) == 0)
+            break;
+    }
 
     mpDevice->wait();
 }
 
 void TextureManager::waitForAllTexturesLoading()
 {
-    // Acquire mutex and wait for all in-progress requests to finish.
+    // Upload all decoded textures, then wait for all in-progress requests to finish.
+    mAsyncTextureLoader.waitForAllUploads();
+
     std::unique_lock<std::mutex> lock(mMutex);
     mCondition.wait(lock, [&]() { return mLoadRequestsInProgress == 0; });
 
@@ -407,47 +390,40 @@ void TextureManager::endDeferredLoading()
     if (jobs.empty())
         return;
 
-    // Load textures in parallel.
-    std::atomic<size_t> texturesLoaded;
-    NumericRange<size_t> jobRange(0, jobs.size());
-    std::for_each(
-        std::execution::par_unseq,
-        jobRange.begin(),
-        jobRange.end(),
-        [&](size_t i)
-        {
-            const auto& job = jobs[i];
-            auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
-            {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
-            }
-            else
-            {
-                desc.pTexture =
-                    Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
-            }
-            if (texturesLoaded.fetch_add(1) % 10 == 9)
-            {
-                logDebug("Flush");
-                std::lock_guard<std::mutex> lock(mpDevice->getGlobalGfxMutex());
-                mpDevice->wait();
-            }
-        }
-    );
-    mpDevice->wait();
-
-    // Mark loaded textures and add them to lookup table.
+    // Decode textures in parallel and upload them from this thread.
+    mLoadRequestsInProgress += jobs.size();
     for (const auto& job : jobs)
     {
-        auto& desc = getDesc(job.handle);
-        desc.state = desc.pTexture ? TextureState::Loaded : TextureState::Invalid;
-        mTextureToHandle[desc.pTexture.get()] = job.handle;
+        auto callback = [this, handle = job.handle](ref<Texture> pTexture, const std::optional<TextureAnalyzer::Result>& analysis)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            // Mark texture as loaded and add it to lookup table.
+            auto& desc = getDesc(handle);
+            desc.state = pTexture ? TextureState::Loaded : TextureState::Invalid;
+            desc.pTexture = pTexture;
+            desc.analysis = analysis;
+            if (pTexture)
+                mTextureToHandle[pTexture.get()] = handle;
+
+            mLoadRequestsInProgress--;
+            mCondition.notify_all();
+        };
+
+        logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
+        if (job.key.fullPaths.size() == 1)
+        {
+            mAsyncTextureLoader.loadFromFile(
+                job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags, callback
+            );
+        }
+        else
+        {
+            mAsyncTextureLoader.loadMippedFromFiles(job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags, job.key.importFlags, callback);
+        }
     }
+
+    waitForAllTexturesLoading();
 }
 
 void TextureManager::removeTexture(const CpuTextureHandle& handle)
@@ -550,6 +526,15 @@ TextureManager::TextureDesc TextureManager::getTextureDesc(const CpuTextureHandl
     return mTextureDescs[handle.getID()];
 }
 
+std::optional<TextureAnalyzer::Result> TextureManager::getTextureAnalysis(const Texture* pTexture) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mTextureToHandle.find(pTexture);
+    if (it == mTextureToHandle.end())
+        return std::nullopt;
+    return mTextureDescs[it->second.getID()].analysis;
+}
+
 size_t TextureManager::getTextureDescCount() const
 {
     std::lock_guard<std::mutex> lock(mMutex);
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureAnalyzer.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -36,6 +37,7 @@
 #include <condition_variable>
 #include <limits>
 #include <map>
+#include <optional>
 #include <set>
 #include <memory>
 #include <mutex>
@@ -50,6 +52,9 @@ class AssetResolver;
  *
  * This class manages a collection of textures and implements
  * asynchronous texture loading. All operations are thread-safe.
+ * Texture files are decoded on worker threads, but the textures are created and
+ * uploaded by the thread calling loadTexture() and the wait functions, which should
+ * be the thread owning the device.
  *
  * Each managed texture is assigned a unique handle upon loading.
  * This handle is used in shader code to reference the given texture
@@ -134,6 +139,7 @@ public:
     {
         TextureState state = TextureState::Invalid; ///< Current state of the texture.
         ref<Texture> pTexture;                      ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        std::optional<TextureAnalyzer::Result> analysis; ///< Analysis computed while decoding, if the texture format allowed it.
 
         bool isValid() const { return state != TextureState::Invalid; }
     };
@@ -160,6 +166,7 @@ public:
      * Requst loading a texture from file.
      * This will add the texture to the set of managed textures. The function returns a handle immediately.
      * If asynchronous loading is requested, the texture data will not be available until loading completes.
+     * The textures decoded so far are uploaded by each call, the remaining ones by the wait functions.
      * The returned handle is valid for the entire lifetime of the texture, until removeTexture() is called.
      * @param[in] path File path of the texture. This can be a full path or a relative path from a data directory.
      * @param[in] generateMipLevels Whether the full mip-chain should be generated.
@@ -185,7 +192,7 @@ public:
 
     /**
      * Wait for a requested texture to load.
-     * If the handle is valid, the call blocks until the texture is loaded (or failed to load).
+     * If the handle is valid, the call uploads decoded textures until the texture is loaded (or failed to load).
      * @param[in] handle Texture handle.
      */
     void waitForTextureLoading(const CpuTextureHandle& handle);
@@ -249,6 +256,13 @@ public:
      */
     std::vector<uint32_t> getUdimIDs(const CpuTextureHandle& handle) const;
 
+    /**
+     * Get the analysis of a managed texture computed on the CPU while it was decoded.
+     * @param[in] pTexture Texture.
+     * @return Analysis result, or nothing if the texture is not managed or its format couldn't be analyzed on the CPU.
+     */
+    std::optional<TextureAnalyzer::Result> getTextureAnalysis(const Texture* pTexture) const;
+
     /**
      * Get texture desc count.
      * @return Number of texture descs.
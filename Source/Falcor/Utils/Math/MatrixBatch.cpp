@@ -0,0 +1,171 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MatrixBatch.h"
+
+#include <algorithm>
+#include <xmmintrin.h>
+
+namespace Falcor
+{
+namespace math
+{
+
+namespace
+{
+/// Batch of kMatrixBatchSize matrices in structure of arrays layout: e[r][c] holds the element (r, c) of each matrix.
+struct MatrixBatch
+{
+    __m128 e[4][4];
+};
+
+MatrixBatch load(const float4x4* const* m, size_t count)
+{
+    // Pad the batch with the last matrix.
+    const float4x4* p[kMatrixBatchSize];
+    for (size_t k = 0; k < kMatrixBatchSize; ++k)
+        p[k] = m[k < count ? k : count - 1];
+
+    MatrixBatch b;
+    for (int r = 0; r < 4; ++r)
+    {
+        __m128 r0 = _mm_loadu_ps(&(*p[0])[r][0]);
+        __m128 r1 = _mm_loadu_ps(&(*p[1])[r][0]);
+        __m128 r2 = _mm_loadu_ps(&(*p[2])[r][0]);
+        __m128 r3 = _mm_loadu_ps(&(*p[3])[r][0]);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        b.e[r][0] = r0;
+        b.e[r][1] = r1;
+        b.e[r][2] = r2;
+        b.e[r][3] = r3;
+    }
+    return b;
+}
+
+void store(const MatrixBatch& b, float4x4* const* m, size_t count)
+{
+    for (int r = 0; r < 4; ++r)
+    {
+        __m128 r0 = b.e[r][0];
+        __m128 r1 = b.e[r][1];
+        __m128 r2 = b.e[r][2];
+        __m128 r3 = b.e[r][3];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        const __m128 rows[kMatrixBatchSize] = {r0, r1, r2, r3};
+        for (size_t k = 0; k < count; ++k)
+            _mm_storeu_ps(&(*m[k])[r][0], rows[k]);
+    }
+}
+
+MatrixBatch mul(const MatrixBatch& a, const MatrixBatch& b)
+{
+    MatrixBatch c;
+    for (int r = 0; r < 4; ++r)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            __m128 sum = _mm_mul_ps(a.e[r][0], b.e[0][col]);
+            sum = _mm_add_ps(sum, _mm_mul_ps(a.e[r][1], b.e[1][col]));
+            sum = _mm_add_ps(sum, _mm_mul_ps(a.e[r][2], b.e[2][col]));
+            sum = _mm_add_ps(sum, _mm_mul_ps(a.e[r][3], b.e[3][col]));
+            c.e[r][col] = sum;
+        }
+    }
+    return c;
+}
+
+/// Transposed inverse of affine matrices. For M = [A t; 0 1], this is [C / det(A) 0; -(C^T t)^T / det(A) 1], where C is the cofactor matrix of A.
+MatrixBatch inverseTransposeAffine(const MatrixBatch& m)
+{
+    const auto& a = m.e;
+    auto diffOfProducts = [](__m128 x, __m128 y, __m128 z, __m128 w) { return _mm_sub_ps(_mm_mul_ps(x, y), _mm_mul_ps(z, w)); };
+
+    __m128 c[3][3];
+    c[0][0] = diffOfProducts(a[1][1], a[2][2], a[1][2], a[2][1]);
+    c[0][1] = diffOfProducts(a[1][2], a[2][0], a[1][0], a[2][2]);
+    c[0][2] = diffOfProducts(a[1][0], a[2][1], a[1][1], a[2][0]);
+    c[1][0] = diffOfProducts(a[0][2], a[2][1], a[0][1], a[2][2]);
+    c[1][1] = diffOfProducts(a[0][0], a[2][2], a[0][2], a[2][0]);
+    c[1][2] = diffOfProducts(a[0][1], a[2][0], a[0][0], a[2][1]);
+    c[2][0] = diffOfProducts(a[0][1], a[1][2], a[0][2], a[1][1]);
+    c[2][1] = diffOfProducts(a[0][2], a[1][0], a[0][0], a[1][2]);
+    c[2][2] = diffOfProducts(a[0][0], a[1][1], a[0][1], a[1][0]);
+
+    const __m128 det =
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0][0], c[0][0]), _mm_mul_ps(a[0][1], c[0][1])), _mm_mul_ps(a[0][2], c[0][2]));
+    const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.f), det);
+    const __m128 negInvDet = _mm_sub_ps(_mm_setzero_ps(), invDet);
+
+    MatrixBatch r;
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            r.e[i][j] = _mm_mul_ps(c[i][j], invDet);
+        r.e[i][3] = _mm_setzero_ps();
+    }
+    for (int j = 0; j < 3; ++j)
+    {
+        const __m128 dot =
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0][j], a[0][3]), _mm_mul_ps(c[1][j], a[1][3])), _mm_mul_ps(c[2][j], a[2][3]));
+        r.e[3][j] = _mm_mul_ps(dot, negInvDet);
+    }
+    r.e[3][3] = _mm_set1_ps(1.f);
+    return r;
+}
+
+bool isAffine(const float4x4& m)
+{
+    return m[3][0] == 0.f && m[3][1] == 0.f && m[3][2] == 0.f && m[3][3] == 1.f;
+}
+} // namespace
+
+void mulBatch(size_t count, const float4x4* const* lhs, const float4x4* const* rhs, float4x4* const* result)
+{
+    for (size_t i = 0; i < count; i += kMatrixBatchSize)
+    {
+        const size_t batchCount = std::min(count - i, kMatrixBatchSize);
+        store(mul(load(lhs + i, batchCount), load(rhs + i, batchCount)), result + i, batchCount);
+    }
+}
+
+void inverseTransposeAffineBatch(size_t count, const float4x4* const* m, float4x4* const* result)
+{
+    for (size_t i = 0; i < count; i += kMatrixBatchSize)
+    {
+        const size_t batchCount = std::min(count - i, kMatrixBatchSize);
+        store(inverseTransposeAffine(load(m + i, batchCount)), result + i, batchCount);
+
+        for (size_t k = i; k < i + batchCount; ++k)
+        {
+            if (!isAffine(*m[k]))
+                *result[k] = transpose(inverse(*m[k]));
+        }
+    }
+}
+
+} // namespace math
+} // namespace Falcor
@@ -0,0 +1,60 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+
+#include "Matrix.h"
+#include "Core/Macros.h"
+
+#include <cstddef>
+
+namespace Falcor
+{
+namespace math
+{
+
+/// Number of matrices processed together by the batched kernels.
+inline constexpr size_t kMatrixBatchSize = 4;
+
+/**
+ * Multiply pairs of matrices: result[i] = mul(*lhs[i], *rhs[i]).
+ * The matrices are accessed through pointers so that they can be gathered from and scattered to arbitrary locations.
+ * They are transposed to a structure of arrays layout and multiplied kMatrixBatchSize at a time with SSE.
+ * The results may not alias the operands.
+ */
+FALCOR_API void mulBatch(size_t count, const float4x4* const* lhs, const float4x4* const* rhs, float4x4* const* result);
+
+/**
+ * Compute the transposed inverse of matrices: result[i] = transpose(inverse(*m[i])).
+ * Affine matrices (last row equal to (0, 0, 0, 1)) are inverted kMatrixBatchSize at a time with SSE, from the cofactors of
+ * their upper 3x3 part. Other matrices fall back to the generic inverse.
+ * The results may not alias the operands.
+ */
+FALCOR_API void inverseTransposeAffineBatch(size_t count, const float4x4* const* m, float4x4* const* result);
+
+} // namespace math
+} // namespace Falcor
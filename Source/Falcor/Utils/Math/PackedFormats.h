@@ -28,6 +28,8 @@
 #pragma once
 #include "Vector.h"
 #include "FormatConversion.h"
+#include "MathConstants.slangh"
+#include <algorithm>
 #include <cmath>
 
 /**
@@ -92,4 +94,53 @@ inline float3 decodeNormal2x16(uint32_t packedNormal)
     float2 octNormal = unpackSnorm2x16(packedNormal);
     return oct_to_ndir_snorm(octNormal);
 }
+
+/**
+ * Decode the normal of a normal/tangent pair packed by encodeNormalTangent2x11x10() and build the frame the tangent angle is measured in.
+ * The hemisphere of the frame is selected from the integer octahedral coordinates so that the host and the GPU build the same frame.
+ */
+inline float3 decodeNormalFrame2x11(uint32_t packedNormalTangent, float3& b1, float3& b2)
+{
+    int x = (int)(packedNormalTangent & 0x7ff) - 1023;
+    int y = (int)((packedNormalTangent >> 11) & 0x7ff) - 1023;
+    float3 n = oct_to_ndir_snorm(float2((float)x, (float)y) / 1023.f);
+
+    // Same as branchlessONB() but with the sign taken from the quantized coordinates.
+    float s = std::abs(x) + std::abs(y) <= 1023 ? 1.f : -1.f;
+    const float a = -1.f / (s + n.z);
+    const float b = n.x * n.y * a;
+    b1 = float3(1.f + s * n.x * n.x * a, s * b, -s * n.x);
+    b2 = float3(b, s + n.y * n.y * a, -n.y);
+    return n;
+}
+
+/**
+ * Encode a normal and a tangent in 32 bits.
+ * The normal is stored as 2x 11-bit snorms in the octahedral mapping. The tangent is stored as a 10-bit angle
+ * around the decoded normal, so only its projection on the tangent plane is preserved.
+ */
+inline uint32_t encodeNormalTangent2x11x10(float3 normal, float3 tangent)
+{
+    float2 octNormal = ndir_to_oct_snorm(normal);
+    int x = (int)std::round(std::clamp(octNormal.x, -1.f, 1.f) * 1023.f);
+    int y = (int)std::round(std::clamp(octNormal.y, -1.f, 1.f) * 1023.f);
+    uint32_t packed = (uint32_t)(x + 1023) | ((uint32_t)(y + 1023) << 11);
+
+    float3 b1, b2;
+    decodeNormalFrame2x11(packed, b1, b2);
+    float angle = std::atan2(dot(tangent, b2), dot(tangent, b1)) * (float)M_1_2PI;
+    uint32_t angleBits = (uint32_t)std::round((angle < 0.f ? angle + 1.f : angle) * 1024.f) & 0x3ff;
+    return packed | (angleBits << 22);
+}
+
+/**
+ * Decode a normal and a tangent packed by encodeNormalTangent2x11x10().
+ */
+inline void decodeNormalTangent2x11x10(uint32_t packedNormalTangent, float3& normal, float3& tangent)
+{
+    float3 b1, b2;
+    normal = decodeNormalFrame2x11(packedNormalTangent, b1, b2);
+    float angle = (float)(packedNormalTangent >> 22) * (float)(M_2PI / 1024.0);
+    tangent = std::cos(angle) * b1 + std::sin(angle) * b2;
+}
 } // namespace Falcor
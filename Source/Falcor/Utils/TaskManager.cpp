@@ -26,21 +26,18 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TaskManager.h"
+#include "Threading.h"
 
 namespace Falcor
 {
 
-TaskManager::TaskManager(bool startPaused)
-{
-    if (startPaused)
-        mThreadPool.pause();
-}
+TaskManager::TaskManager(bool startPaused) : mPaused(startPaused) {}
 
 void TaskManager::addTask(CpuTask&& task)
 {
     std::lock_guard<std::mutex> l(mTaskMutex);
     ++mCurrentlyScheduled;
-    mThreadPool.push_task(
+    scheduleCpuTask(
         [task = std::move(task), this]() mutable
         {
             ++mCurrentlyRunning;
@@ -64,7 +61,14 @@ void TaskManager::addTask(GpuTask&& task)
 
 void TaskManager::finish(RenderContext* renderContext)
 {
-    mThreadPool.unpause();
+    {
+        std::lock_guard<std::mutex> l(mTaskMutex);
+        mPaused = false;
+        for (auto& task : mPausedCpuTasks)
+            Threading::dispatchTask(std::move(task));
+        mPausedCpuTasks.clear();
+    }
+
     while (true)
     {
         while (true)
@@ -100,6 +104,14 @@ void TaskManager::finish(RenderContext* renderContext)
     rethrowException();
 }
 
+void TaskManager::scheduleCpuTask(CpuTask&& task)
+{
+    if (mPaused)
+        mPausedCpuTasks.push_back(std::move(task));
+    else
+        Threading::dispatchTask(std::move(task));
+}
+
 void TaskManager::storeException()
 {
     std::lock_guard<std::mutex> l(mExceptionMutex);
@@ -29,8 +29,6 @@
 
 #include "Core/Macros.h"
 
-#include <BS_thread_pool/BS_thread_pool.hpp>
-
 #include <functional>
 #include <mutex>
 #include <condition_variable>
@@ -41,6 +39,10 @@
 namespace Falcor
 {
 class RenderContext;
+
+/**
+ * Runs CPU tasks on the global Threading scheduler and GPU tasks sequentially on the thread calling finish().
+ */
 class FALCOR_API TaskManager
 {
 public:
@@ -67,9 +69,12 @@ private:
     void rethrowException();
     /// CPU task execution wrapped so it stores exception if the task throws
     void executeCpuTask(CpuTask&& task);
+    /// Dispatches a CPU task to the scheduler, or defers it until finish() if paused. Must be called with mTaskMutex locked.
+    void scheduleCpuTask(CpuTask&& task);
 
 private:
-    BS::thread_pool mThreadPool;
+    bool mPaused = false;
+    std::vector<CpuTask> mPausedCpuTasks; ///< CPU tasks added while paused, dispatched by finish().
     std::atomic_size_t mCurrentlyRunning{0};
     std::atomic_size_t mCurrentlyScheduled{0};
 
@@ -27,29 +27,273 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Error.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <vector>
 
 namespace Falcor
 {
+struct Threading::TaskState
+{
+    std::function<void()> func;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool finished = false;
+    std::exception_ptr exception;
+    std::vector<std::shared_ptr<TaskState>> continuations; ///< Tasks to schedule once this one has finished.
+};
+
 namespace
 {
-struct ThreadingData
+using TaskStatePtr = std::shared_ptr<Threading::TaskState>;
+
+/// Waiting threads wake up at this interval to check for new tasks to execute.
+constexpr std::chrono::microseconds kHelpInterval(200);
+
+/// Work queue of a thread. The owning worker pushes and pops at the back, other threads steal from the front.
+struct WorkQueue
 {
-    bool initialized = false;
-    std::vector<std::thread> threads;
-    uint32_t current;
-} gData; // TODO: REMOVEGLOBAL
-} // namespace
+    std::mutex mutex;
+    std::deque<TaskStatePtr> tasks;
+
+    void push(TaskStatePtr pTask)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(pTask));
+    }
+
+    bool popBack(TaskStatePtr& pTask)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty())
+            return false;
+        pTask = std::move(tasks.back());
+        tasks.pop_back();
+        return true;
+    }
+
+    bool popFront(TaskStatePtr& pTask)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty())
+            return false;
+        pTask = std::move(tasks.front());
+        tasks.pop_front();
+        return true;
+    }
+};
+
+/// Index of the work queue of the calling worker thread, -1 on other threads.
+thread_local int32_t tWorkerIndex = -1;
+
+class Scheduler
+{
+public:
+    ~Scheduler() { stopWorkers(); }
+
+    bool isStarted() const { return mStarted.load(std::memory_order_acquire); }
+    uint32_t getThreadCount() const { return (uint32_t)mWorkers.size(); }
+
+    void startWorkers(uint32_t threadCount)
+    {
+        FALCOR_ASSERT(!isStarted() && threadCount > 0);
+
+        mQueues.resize(threadCount);
+        for (auto& pQueue : mQueues)
+            pQueue = std::make_unique<WorkQueue>();
+
+        for (uint32_t i = 0; i < threadCount; ++i)
+            mWorkers.emplace_back(&Scheduler::runWorker, this, (int32_t)i);
+
+        mStarted.store(true, std::memory_order_release);
+    }
+
+    void stopWorkers()
+    {
+        if (!isStarted())
+            return;
+
+        waitIdle();
+
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mStop = true;
+        }
+        mSleepCondition.notify_all();
+
+        for (auto& thread : mWorkers)
+            thread.join();
+
+        mWorkers.clear();
+        mQueues.clear();
+        mStop = false;
+        mStarted.store(false, std::memory_order_release);
+    }
+
+    void push(TaskStatePtr pTask)
+    {
+        ++mPendingCount;
+
+        if (tWorkerIndex >= 0)
+            mQueues[tWorkerIndex]->push(std::move(pTask));
+        else
+            mSharedQueue.push(std::move(pTask));
 
-static std::mutex sThreadingInitMutex;
-static uint32_t sThreadingInitCount = 0;
+        // Taking the lock orders the increment with the predicate check of the sleeping workers.
+        ++mQueuedCount;
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+        }
+        mSleepCondition.notify_one();
+    }
+
+    bool runPendingTask()
+    {
+        TaskStatePtr pTask;
+        if (!popTask(pTask))
+            return false;
+        execute(std::move(pTask));
+        return true;
+    }
+
+    void waitIdle()
+    {
+        FALCOR_CHECK(tWorkerIndex < 0, "Waiting for all tasks from a task would never return.");
+
+        while (mPendingCount.load() > 0)
+        {
+            if (runPendingTask())
+                continue;
+
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mIdleCondition.wait_for(lock, kHelpInterval, [&]() { return mPendingCount.load() == 0; });
+        }
+    }
+
+private:
+    bool popTask(TaskStatePtr& pTask)
+    {
+        if (mQueuedCount.load() == 0)
+            return false;
+
+        bool found = tWorkerIndex >= 0 && mQueues[tWorkerIndex]->popBack(pTask);
+        if (!found)
+            found = mSharedQueue.popFront(pTask);
+
+        // Steal the oldest task of another worker, starting with the next one to spread the thieves.
+        const size_t queueCount = mQueues.size();
+        const size_t firstVictim = tWorkerIndex >= 0 ? (size_t)tWorkerIndex + 1 : 0;
+        for (size_t i = 0; !found && i < queueCount; ++i)
+        {
+            const size_t victim = (firstVictim + i) % queueCount;
+            if ((int32_t)victim != tWorkerIndex)
+                found = mQueues[victim]->popFront(pTask);
+        }
+
+        if (found)
+            --mQueuedCount;
+        return found;
+    }
+
+    void execute(TaskStatePtr pTask)
+    {
+        std::exception_ptr exception;
+        try
+        {
+            pTask->func();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+        // Release the captures before signaling the waiters.
+        pTask->func = nullptr;
+
+        std::vector<TaskStatePtr> continuations;
+        {
+            std::lock_guard<std::mutex> lock(pTask->mutex);
+            pTask->finished = true;
+            pTask->exception = exception;
+            continuations.swap(pTask->continuations);
+        }
+        pTask->condition.notify_all();
+
+        for (auto& pContinuation : continuations)
+            push(std::move(pContinuation));
+
+        // Continuations are pushed first so that the pending count never drops to zero while work remains.
+        if (--mPendingCount == 0)
+        {
+            std::lock_guard<std::mutex> lock(mSleepMutex);
+            mIdleCondition.notify_all();
+        }
+    }
+
+    void runWorker(int32_t index)
+    {
+        tWorkerIndex = index;
+
+        while (true)
+        {
+            if (runPendingTask())
+                continue;
+
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mSleepCondition.wait(lock, [&]() { return mStop || mQueuedCount.load() > 0; });
+            if (mStop && mQueuedCount.load() == 0)
+                break;
+        }
+
+        tWorkerIndex = -1;
+    }
+
+    std::atomic<bool> mStarted{false};
+    std::vector<std::thread> mWorkers;
+    std::vector<std::unique_ptr<WorkQueue>> mQueues; ///< One queue per worker.
+    WorkQueue mSharedQueue;                          ///< Tasks dispatched from non-worker threads.
+
+    std::atomic<size_t> mQueuedCount{0};  ///< Number of tasks waiting in the queues.
+    std::atomic<size_t> mPendingCount{0}; ///< Number of tasks queued or executing.
+
+    std::mutex mSleepMutex;
+    std::condition_variable mSleepCondition; ///< Idle workers wait on this for new tasks.
+    std::condition_variable mIdleCondition;  ///< Threading::finish() waits on this for the pending count to drop to zero.
+    bool mStop = false;
+} gScheduler; // TODO: REMOVEGLOBAL
+
+std::mutex sThreadingInitMutex;
+uint32_t sThreadingInitCount = 0;
+
+uint32_t resolveThreadCount(uint32_t threadCount)
+{
+    return threadCount == Threading::kDefaultThreadCount ? std::max(1u, Threading::getLogicalThreadCount()) : threadCount;
+}
+
+void ensureStarted()
+{
+    if (gScheduler.isStarted())
+        return;
+
+    std::lock_guard<std::mutex> lock(sThreadingInitMutex);
+    if (!gScheduler.isStarted())
+        gScheduler.startWorkers(resolveThreadCount(Threading::kDefaultThreadCount));
+}
+} // namespace
 
 void Threading::start(uint32_t threadCount)
 {
     std::lock_guard<std::mutex> lock(sThreadingInitMutex);
     if (sThreadingInitCount++ == 0)
     {
-        gData.threads.resize(threadCount);
-        gData.initialized = true;
+        // The pool may have been started on demand by an earlier dispatch.
+        threadCount = resolveThreadCount(threadCount);
+        if (gScheduler.isStarted() && gScheduler.getThreadCount() != threadCount)
+            gScheduler.stopWorkers();
+        if (!gScheduler.isStarted())
+            gScheduler.startWorkers(threadCount);
     }
 }
 
@@ -59,46 +303,206 @@ void Threading::shutdown()
     uint32_t count = sThreadingInitCount--;
     if (count == 1)
     {
-        for (auto& t : gData.threads)
-            if (t.joinable())
-                t.join();
-        gData.initialized = false;
+        gScheduler.stopWorkers();
     }
     else if (count == 0)
-        FALCOR_THROW("Threading::stop() called more times than Threading::start().");
+    {
+        sThreadingInitCount = 0;
+        FALCOR_THROW("Threading::shutdown() called more times than Threading::start().");
+    }
 }
 
-Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+void Threading::finish()
 {
-    FALCOR_ASSERT(gData.initialized);
+    if (gScheduler.isStarted())
+        gScheduler.waitIdle();
+}
+
+uint32_t Threading::getThreadCount()
+{
+    return gScheduler.isStarted() ? gScheduler.getThreadCount() : resolveThreadCount(kDefaultThreadCount);
+}
 
-    std::thread& t = gData.threads[gData.current];
-    if (t.joinable())
-        t.join();
-    t = std::thread(func);
-    gData.current = (gData.current + 1) % gData.threads.size();
+void Threading::setThreadCount(uint32_t threadCount)
+{
+    FALCOR_CHECK(!isWorkerThread(), "Threading::setThreadCount() must not be called from a task.");
 
-    return Task();
+    std::lock_guard<std::mutex> lock(sThreadingInitMutex);
+    threadCount = resolveThreadCount(threadCount);
+    if (gScheduler.isStarted() && gScheduler.getThreadCount() == threadCount)
+        return;
+    gScheduler.stopWorkers();
+    gScheduler.startWorkers(threadCount);
 }
 
-void Threading::finish()
+bool Threading::isWorkerThread()
+{
+    return tWorkerIndex >= 0;
+}
+
+Threading::Task Threading::dispatchTask(std::function<void(void)> func)
 {
-    for (auto& t : gData.threads)
+    ensureStarted();
+
+    auto pState = std::make_shared<TaskState>();
+    pState->func = std::move(func);
+    gScheduler.push(pState);
+    return Task(std::move(pState));
+}
+
+void Threading::parallelForRange(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize)
+{
+    if (end <= begin)
+        return;
+
+    // A few chunks per thread so that stealing can even out chunks of uneven cost.
+    const size_t count = end - begin;
+    if (grainSize == 0)
+        grainSize = std::max<size_t>(1, count / (4 * (size_t)getThreadCount()));
+
+    const size_t chunkCount = (count + grainSize - 1) / grainSize;
+    if (chunkCount == 1)
     {
-        if (t.joinable())
-            t.join();
+        func(begin, end);
+        return;
     }
+
+    TaskGroup group;
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk)
+    {
+        const size_t chunkBegin = begin + chunk * grainSize;
+        const size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+        group.run([&func, chunkBegin, chunkEnd]() { func(chunkBegin, chunkEnd); });
+    }
+
+    // The calling thread takes the first chunk, then helps with the others.
+    func(begin, begin + grainSize);
+    group.wait();
 }
 
-Threading::Task::Task() {}
+bool Threading::runPendingTask()
+{
+    return gScheduler.isStarted() && gScheduler.runPendingTask();
+}
 
-bool Threading::Task::isRunning()
+bool Threading::Task::isRunning() const
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return false;
+    std::lock_guard<std::mutex> lock(mpState->mutex);
+    return !mpState->finished;
 }
 
 void Threading::Task::finish()
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return;
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mpState->mutex);
+            if (mpState->finished)
+                break;
+        }
+
+        if (runPendingTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(mpState->mutex);
+        mpState->condition.wait_for(lock, kHelpInterval, [&]() { return mpState->finished; });
+    }
+
+    if (mpState->exception)
+        std::rethrow_exception(mpState->exception);
+}
+
+Threading::Task Threading::Task::then(std::function<void()> func)
+{
+    FALCOR_CHECK(mpState, "Cannot add a continuation to an invalid task.");
+
+    auto pContinuation = std::make_shared<TaskState>();
+    pContinuation->func = std::move(func);
+    {
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        if (!mpState->finished)
+        {
+            mpState->continuations.push_back(pContinuation);
+            return Task(std::move(pContinuation));
+        }
+    }
+
+    ensureStarted();
+    gScheduler.push(pContinuation);
+    return Task(std::move(pContinuation));
+}
+
+struct TaskGroup::State
+{
+    std::atomic<size_t> pendingCount{0};
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::exception_ptr exception; ///< First exception thrown by a task of the group.
+};
+
+TaskGroup::TaskGroup() : mpState(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup()
+{
+    try
+    {
+        wait();
+    }
+    catch (...)
+    {
+        // Exceptions are only reported by an explicit wait().
+    }
+}
+
+void TaskGroup::run(std::function<void()> func)
+{
+    ++mpState->pendingCount;
+    Threading::dispatchTask(
+        [pState = mpState, func = std::move(func)]()
+        {
+            try
+            {
+                func();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(pState->mutex);
+                if (!pState->exception)
+                    pState->exception = std::current_exception();
+            }
+
+            if (--pState->pendingCount == 0)
+            {
+                std::lock_guard<std::mutex> lock(pState->mutex);
+                pState->condition.notify_all();
+            }
+        }
+    );
+}
+
+void TaskGroup::wait()
+{
+    while (mpState->pendingCount.load() > 0)
+    {
+        if (Threading::runPendingTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(mpState->mutex);
+        mpState->condition.wait_for(lock, kHelpInterval, [&]() { return mpState->pendingCount.load() == 0; });
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        std::swap(exception, mpState->exception);
+    }
+    if (exception)
+        std::rethrow_exception(exception);
 }
 } // namespace Falcor
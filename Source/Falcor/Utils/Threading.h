@@ -28,50 +28,82 @@
 #pragma once
 #include "Core/Macros.h"
 #include <condition_variable>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <cstdint>
 
 namespace Falcor
 {
+/**
+ * Global work-stealing task scheduler.
+ *
+ * Every worker thread owns a deque of tasks. Tasks dispatched from a worker are pushed to and popped from the back of its own
+ * deque, idle workers steal from the front of the other deques. Tasks dispatched from other threads go to a shared queue.
+ * Threads waiting on a task, a task group or a parallel loop execute pending tasks instead of blocking, so nested parallelism
+ * neither deadlocks nor spawns more threads than the configured thread count.
+ *
+ * All CPU parallel work in Falcor should go through the scheduler to avoid oversubscribing the cores.
+ */
 class FALCOR_API Threading
 {
 public:
-    const static uint32_t kDefaultThreadCount = 16;
+    /// Use the number of logical threads reported by the hardware.
+    const static uint32_t kDefaultThreadCount = 0;
+
+    struct TaskState;
 
     /**
-     * Handle to a dispatched task
-     *
-     * TODO: Implementation
+     * Handle to a dispatched task.
+     * Handles are cheap to copy, the task keeps running if all handles are released.
      */
-    class Task
+    class FALCOR_API Task
     {
     public:
-        ///  Check if task is still executing
-        bool isRunning();
+        Task() = default;
+
+        /// Check if the handle refers to a task.
+        bool isValid() const { return mpState != nullptr; }
+
+        /// Check if task is still executing (or waiting to be executed).
+        bool isRunning() const;
 
-        /// Wait for task to finish executing
+        /**
+         * Wait for task to finish executing. The calling thread executes other pending tasks while waiting.
+         * Rethrows the exception thrown by the task, if any.
+         */
         void finish();
 
+        /**
+         * Schedules a continuation that runs once this task has finished, whether it threw or not.
+         * @param[in] func Function to execute.
+         * @return Handle to the continuation.
+         */
+        Task then(std::function<void()> func);
+
     private:
-        Task();
+        Task(std::shared_ptr<TaskState> pState) : mpState(std::move(pState)) {}
+
+        std::shared_ptr<TaskState> mpState;
         friend class Threading;
     };
 
     /**
-     * Initializes the global thread pool
-     * @param[in] threadCount Number of threads in the pool
+     * Initializes the global thread pool.
+     * Calls are reference counted, only the first call creates the worker threads.
+     * @param[in] threadCount Number of threads in the pool, kDefaultThreadCount to use the logical thread count.
      */
     static void start(uint32_t threadCount = kDefaultThreadCount);
 
     /**
-     * Waits for all currently executing threads to finish
+     * Waits for all dispatched tasks to finish.
      */
     static void finish();
 
     /**
-     * Waits for all currently executing threads to finish and shuts down the thread pool
+     * Waits for all dispatched tasks to finish and shuts down the thread pool
      */
     static void shutdown();
 
@@ -80,11 +112,93 @@ public:
      */
     static uint32_t getLogicalThreadCount() { return std::thread::hardware_concurrency(); }
 
+    /**
+     * Returns the number of worker threads of the pool.
+     */
+    static uint32_t getThreadCount();
+
+    /**
+     * Changes the number of worker threads. Waits for all dispatched tasks to finish before recreating the workers.
+     * Must not be called from a task.
+     * @param[in] threadCount Number of threads in the pool, kDefaultThreadCount to use the logical thread count.
+     */
+    static void setThreadCount(uint32_t threadCount);
+
+    /**
+     * Returns true if the calling thread is one of the worker threads.
+     */
+    static bool isWorkerThread();
+
+    /**
+     * Executes one pending task on the calling thread. Code that blocks on work done by tasks calls this while waiting, so that it
+     * can't deadlock when it runs on a worker thread.
+     * @return False if there was no pending task.
+     */
+    static bool runPendingTask();
+
     /**
      * Starts a task on an available thread.
+     * The thread pool is started with the default thread count if it is not running yet.
      * @return Handle to the task
      */
-    static Task dispatchTask(const std::function<void(void)>& func);
+    static Task dispatchTask(std::function<void(void)> func);
+
+    /**
+     * Executes func on sub-ranges of [begin, end) in parallel, including on the calling thread, and waits for all of them.
+     * @param[in] begin First index.
+     * @param[in] end One past the last index.
+     * @param[in] func Function called with the [begin, end) bounds of each sub-range.
+     * @param[in] grainSize Minimum number of indices per sub-range, 0 to split the range into a few chunks per thread.
+     */
+    static void parallelForRange(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize = 0);
+
+    /**
+     * Executes func for each index in [begin, end) in parallel and waits for all of them.
+     * Rethrows the first exception thrown by func, if any.
+     */
+    template<typename IndexType, typename Func>
+    static void parallelFor(IndexType begin, IndexType end, Func&& func, size_t grainSize = 0)
+    {
+        if (end <= begin)
+            return;
+        parallelForRange(
+            0,
+            (size_t)(end - begin),
+            [&](size_t rangeBegin, size_t rangeEnd)
+            {
+                for (size_t i = rangeBegin; i < rangeEnd; ++i)
+                    func((IndexType)(begin + (IndexType)i));
+            },
+            grainSize
+        );
+    }
+};
+
+/**
+ * Set of tasks that are waited on together.
+ * The destructor waits for the tasks still running.
+ */
+class FALCOR_API TaskGroup
+{
+public:
+    TaskGroup();
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /// Dispatches a task in the group.
+    void run(std::function<void()> func);
+
+    /**
+     * Waits for all the tasks of the group. The calling thread executes pending tasks while waiting.
+     * Rethrows the first exception thrown by a task of the group, if any.
+     */
+    void wait();
+
+private:
+    struct State;
+    std::shared_ptr<State> mpState;
 };
 
 /**
@@ -845,6 +845,7 @@ int runMain(int argc, char** argv)
     args::Flag fullscreenFlag(parser, "", "Start in fullscreen mode instead of windowed.", {"fullscreen"});
     args::ValueFlag<uint32_t> widthFlag(parser, "pixels", "Initial window width.", {"width"});
     args::ValueFlag<uint32_t> heightFlag(parser, "pixels", "Initial window height.", {"height"});
+    args::ValueFlag<uint32_t> threadsFlag(parser, "count", "Number of CPU worker threads (0 to use all logical threads).", {"threads"});
     args::Flag useSceneCacheFlag(parser, "", "Use scene cache to improve scene load times.", {'c', "use-cache"});
     args::Flag rebuildSceneCacheFlag(parser, "", "Rebuild the scene cache.", {"rebuild-cache"});
     args::Flag generateShaderDebugInfoFlag(parser, "", "Generate shader debug info.", {"debug-shaders"});
@@ -948,6 +949,8 @@ int runMain(int argc, char** argv)
         config.windowDesc.width = args::get(widthFlag);
     if (heightFlag)
         config.windowDesc.height = args::get(heightFlag);
+    if (threadsFlag)
+        config.threadCount = args::get(threadsFlag);
     if (fullscreenFlag)
         config.windowDesc.mode = Window::WindowMode::Fullscreen;
     if (silentFlag)
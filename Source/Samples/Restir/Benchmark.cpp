@@ -0,0 +1,174 @@
+#include "Benchmark.h"
+
+#include <fstream>
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+uint32_t parseUint(const std::string& value)
+{
+    size_t end = 0;
+    const unsigned long result = std::stoul(value, &end);
+    if (end != value.size())
+        FALCOR_THROW("'{}' is not an unsigned integer.", value);
+    return (uint32_t)result;
+}
+
+float parseFloat(const std::string& value)
+{
+    size_t end = 0;
+    const float result = std::stof(value, &end);
+    if (end != value.size())
+        FALCOR_THROW("'{}' is not a float.", value);
+    return result;
+}
+
+bool parseBool(const std::string& value)
+{
+    if (value == "1" || value == "true")
+        return true;
+    if (value == "0" || value == "false")
+        return false;
+    FALCOR_THROW("'{}' is not a boolean.", value);
+}
+
+// Linear interpolation between the closest ranks. sortedValues must not be empty.
+float computePercentile(const std::vector<float>& sortedValues, float percentile)
+{
+    const float rank = percentile / 100.0f * (float)(sortedValues.size() - 1);
+    const size_t lower = (size_t)rank;
+    const size_t upper = std::min(lower + 1, sortedValues.size() - 1);
+    return sortedValues[lower] + (sortedValues[upper] - sortedValues[lower]) * (rank - (float)lower);
+}
+} // namespace
+
+std::vector<CameraPathKey> loadCameraPath(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file)
+        FALCOR_THROW("Failed to open camera path '{}'.", path);
+
+    std::vector<CameraPathKey> keys;
+    CameraPathKey key;
+    while (file >> key.mPosition.x >> key.mPosition.y >> key.mPosition.z >> key.mTarget.x >> key.mTarget.y >> key.mTarget.z >>
+           key.mUp.x >> key.mUp.y >> key.mUp.z)
+        keys.push_back(key);
+
+    if (keys.empty())
+        FALCOR_THROW("Camera path '{}' is empty.", path);
+
+    return keys;
+}
+
+void saveCameraPath(const std::filesystem::path& path, const std::vector<CameraPathKey>& keys)
+{
+    std::ofstream file(path);
+    if (!file)
+        FALCOR_THROW("Failed to create camera path '{}'.", path);
+
+    for (const CameraPathKey& key : keys)
+    {
+        file << fmt::format(
+            "{} {} {} {} {} {} {} {} {}\n",
+            key.mPosition.x,
+            key.mPosition.y,
+            key.mPosition.z,
+            key.mTarget.x,
+            key.mTarget.y,
+            key.mTarget.z,
+            key.mUp.x,
+            key.mUp.y,
+            key.mUp.z
+        );
+    }
+}
+
+void applySceneSettingsOverride(SceneSettings& settings, const std::string& settingsOverride)
+{
+    const size_t separator = settingsOverride.find('=');
+    if (separator == std::string::npos)
+        FALCOR_THROW("Scene settings override '{}' is not of the form name=value.", settingsOverride);
+
+    const std::string name = settingsOverride.substr(0, separator);
+    const std::string value = settingsOverride.substr(separator + 1);
+
+    if (name == "RISSamplesCount")
+        settings.RISSamplesCount = parseUint(value);
+    else if (name == "nbReservoirPerPixel")
+        settings.nbReservoirPerPixel = parseUint(value);
+    else if (name == "temporalWsRadiusThreshold")
+        settings.temporalWsRadiusThreshold = parseFloat(value);
+    else if (name == "temporalNormalThreshold")
+        settings.temporalNormalThreshold = parseFloat(value);
+    else if (name == "temporalUseMotionVectors")
+        settings.temporalUseMotionVectors = parseBool(value);
+    else if (name == "temporalDepthThreshold")
+        settings.temporalDepthThreshold = parseFloat(value);
+    else if (name == "temporalMCap")
+        settings.temporalMCap = parseUint(value);
+    else if (name == "temporalConfidenceWeighting")
+        settings.temporalConfidenceWeighting = parseBool(value);
+    else if (name == "temporalMCapEveryFrame")
+        settings.temporalMCapEveryFrame = parseBool(value);
+    else if (name == "shadingLightExponent")
+        settings.shadingLightExponent = parseFloat(value);
+    else if (name == "useLightBVH")
+        settings.useLightBVH = parseBool(value);
+    else if (name == "fuseRISAndVisibility")
+        settings.fuseRISAndVisibility = parseBool(value);
+    else if (name == "spatialNeighborCount")
+        settings.spatialNeighborCount = parseUint(value);
+    else if (name == "spatialRadius")
+        settings.spatialRadius = parseFloat(value);
+    else if (name == "spatialNormalThreshold")
+        settings.spatialNormalThreshold = parseFloat(value);
+    else if (name == "spatialDepthThreshold")
+        settings.spatialDepthThreshold = parseFloat(value);
+    else if (name == "spatialBiasCorrection")
+        settings.spatialBiasCorrection = parseBool(value);
+    else if (name == "denoiser")
+        settings.denoiser = parseDenoiserType(value);
+    else
+        FALCOR_THROW("Unknown scene setting '{}'.", name);
+}
+
+void writeBenchmarkReport(const Profiler::Capture& capture, const std::filesystem::path& path)
+{
+    std::filesystem::path jsonPath = path;
+    capture.writeToFile(jsonPath.replace_extension(".json"));
+
+    std::filesystem::path csvPath = path;
+    std::ofstream csv(csvPath.replace_extension(".csv"));
+    if (!csv)
+        FALCOR_THROW("Failed to create benchmark report '{}'.", csvPath);
+
+    csv << "event,frames,mean_ms,std_dev_ms,min_ms,p50_ms,p90_ms,p95_ms,p99_ms,max_ms\n";
+    for (const Profiler::Capture::Lane& lane : capture.getLanes())
+    {
+        if (lane.records.empty())
+            continue;
+
+        std::vector<float> sorted = lane.records;
+        std::sort(sorted.begin(), sorted.end());
+
+        csv << fmt::format(
+            "{},{},{},{},{},{},{},{},{},{}\n",
+            lane.name,
+            sorted.size(),
+            lane.stats.mean,
+            lane.stats.stdDev,
+            sorted.front(),
+            computePercentile(sorted, 50.0f),
+            computePercentile(sorted, 90.0f),
+            computePercentile(sorted, 95.0f),
+            computePercentile(sorted, 99.0f),
+            sorted.back()
+        );
+    }
+
+    logInfo("Benchmark report written to '{}' and '{}'.", jsonPath, csvPath);
+}
+} // namespace Restir
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "SceneSettings.h"
+#include "Utils/Timing/Profiler.h"
+
+#include <filesystem>
+
+namespace Restir
+{
+struct CameraPathKey
+{
+    Falcor::float3 mPosition;
+    Falcor::float3 mTarget;
+    Falcor::float3 mUp;
+};
+
+// One camera per line: position, target and up vector, 9 floats separated by spaces.
+std::vector<CameraPathKey> loadCameraPath(const std::filesystem::path& path);
+void saveCameraPath(const std::filesystem::path& path, const std::vector<CameraPathKey>& keys);
+
+// Applies a "name=value" override, where name is a SceneSettings member (for example "RISSamplesCount=8").
+void applySceneSettingsOverride(SceneSettings& settings, const std::string& settingsOverride);
+
+struct BenchmarkOptions
+{
+    std::filesystem::path mOutputPath; // Empty if the benchmark mode is disabled. Gets the .json and .csv extensions.
+    uint32_t mWarmupFrameCount = 16u;
+    uint32_t mFrameCount = 300u;
+    std::filesystem::path mCameraPath; // Empty to keep the scene camera.
+};
+
+// Writes the raw capture to <path>.json and, for every profiler event, the mean and percentiles to <path>.csv.
+void writeBenchmarkReport(const Falcor::Profiler::Capture& capture, const std::filesystem::path& path);
+} // namespace Restir
@@ -0,0 +1,91 @@
+#include "CpuCapture.h"
+#include "Utils/BinaryFileStream.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+const uint32_t kCaptureMagic = 0x50414352; // "RCAP"
+const uint32_t kCaptureVersion = 1u;
+
+template<typename T>
+void writeVector(BinaryFileStream& stream, const std::vector<T>& v)
+{
+    stream << (uint64_t)v.size();
+    stream.write(v.data(), v.size() * sizeof(T));
+}
+
+template<typename T>
+void readVector(BinaryFileStream& stream, std::vector<T>& v)
+{
+    uint64_t size = 0u;
+    stream >> size;
+    v.resize(size);
+    stream.read(v.data(), v.size() * sizeof(T));
+}
+} // namespace
+
+void saveCpuCapture(const std::filesystem::path& path, const CpuCapture& capture)
+{
+    BinaryFileStream stream(path, BinaryFileStream::Mode::Write);
+    if (!stream.isGood())
+        FALCOR_THROW("Failed to open '{}' for writing.", path);
+
+    stream << kCaptureMagic << kCaptureVersion;
+    stream << (uint32_t)sizeof(SceneSettings) << (uint32_t)sizeof(Light);
+
+    stream << capture.mGBuffer.mWidth << capture.mGBuffer.mHeight;
+    writeVector(stream, capture.mGBuffer.mPositionWs);
+    writeVector(stream, capture.mGBuffer.mNormalWs);
+    writeVector(stream, capture.mGBuffer.mAlbedo);
+    writeVector(stream, capture.mGBuffer.mSpecular);
+
+    stream << capture.mCameraPositionWs << capture.mViewProjMat << capture.mSettings;
+
+    writeVector(stream, capture.mLights);
+    writeVector(stream, capture.mLightProbabilities);
+    writeVector(stream, capture.mTriangleVertices);
+
+    if (stream.isFail())
+        FALCOR_THROW("Failed to write capture to '{}'.", path);
+}
+
+CpuCapture loadCpuCapture(const std::filesystem::path& path)
+{
+    BinaryFileStream stream(path, BinaryFileStream::Mode::Read);
+    if (!stream.isGood())
+        FALCOR_THROW("Failed to open capture '{}'.", path);
+
+    uint32_t magic = 0u, version = 0u, settingsSize = 0u, lightSize = 0u;
+    stream >> magic >> version >> settingsSize >> lightSize;
+    if (magic != kCaptureMagic || version != kCaptureVersion)
+        FALCOR_THROW("'{}' is not a Restir capture or has an unsupported version.", path);
+    if (settingsSize != sizeof(SceneSettings) || lightSize != sizeof(Light))
+        FALCOR_THROW("'{}' was written by an incompatible build of the Restir sample.", path);
+
+    CpuCapture capture;
+    stream >> capture.mGBuffer.mWidth >> capture.mGBuffer.mHeight;
+    readVector(stream, capture.mGBuffer.mPositionWs);
+    readVector(stream, capture.mGBuffer.mNormalWs);
+    readVector(stream, capture.mGBuffer.mAlbedo);
+    readVector(stream, capture.mGBuffer.mSpecular);
+
+    stream >> capture.mCameraPositionWs >> capture.mViewProjMat >> capture.mSettings;
+
+    readVector(stream, capture.mLights);
+    readVector(stream, capture.mLightProbabilities);
+    readVector(stream, capture.mTriangleVertices);
+
+    if (stream.isFail())
+        FALCOR_THROW("Capture '{}' is truncated.", path);
+
+    const size_t nbPixels = (size_t)capture.mGBuffer.mWidth * capture.mGBuffer.mHeight;
+    if (capture.mGBuffer.mPositionWs.size() != nbPixels || capture.mGBuffer.mNormalWs.size() != nbPixels ||
+        capture.mGBuffer.mAlbedo.size() != nbPixels || capture.mGBuffer.mSpecular.size() != nbPixels)
+        FALCOR_THROW("Capture '{}' has inconsistent G-buffer sizes.", path);
+
+    return capture;
+}
+} // namespace Restir
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "LightManager.h"
+#include "SceneSettings.h"
+
+#include <filesystem>
+
+namespace Restir
+{
+// G-buffer read back from the GPU. Same content and layout as the GBuffer textures.
+struct CpuGBuffer
+{
+    uint32_t mWidth = 0u;
+    uint32_t mHeight = 0u;
+
+    std::vector<Falcor::float4> mPositionWs;
+    std::vector<Falcor::float4> mNormalWs;
+    std::vector<Falcor::float4> mAlbedo;
+    std::vector<Falcor::float4> mSpecular;
+};
+
+// Everything the CPU reference needs to run the Restir pipeline without a device.
+struct CpuCapture
+{
+    CpuGBuffer mGBuffer;
+
+    Falcor::float3 mCameraPositionWs = Falcor::float3(0.0f);
+    Falcor::float4x4 mViewProjMat;
+
+    SceneSettings mSettings;
+
+    std::vector<Light> mLights;
+    std::vector<float> mLightProbabilities;
+
+    // World space triangle soup used for the shadow rays. 3 vertices per triangle.
+    std::vector<Falcor::float3> mTriangleVertices;
+};
+
+void saveCpuCapture(const std::filesystem::path& path, const CpuCapture& capture);
+CpuCapture loadCpuCapture(const std::filesystem::path& path);
+} // namespace Restir
@@ -0,0 +1,202 @@
+#include "CpuDenoiser.h"
+#include "GBuffer.h"
+#include "ReservoirManager.h"
+#include "ResourcePool.h"
+#include "SceneSettings.h"
+#include "Utils/Threading.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+// B3 spline, for the offsets 0, 1 and 2.
+const float kKernel[3] = {3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+
+float luma(float3 v)
+{
+    return 0.2126f * v.r + 0.7152f * v.g + 0.0722f * v.b;
+}
+} // namespace
+
+void CpuAtrousFilter::filter(
+    uint32_t width,
+    uint32_t height,
+    const CpuDenoiserGeometry* pGeometry,
+    uint32_t* pRadiance,
+    const Settings& settings
+)
+{
+    const uint32_t pixelCount = width * height;
+    mPing.resize(pixelCount);
+    mPong.resize(pixelCount);
+    mNormals.resize(pixelCount);
+
+    auto forEachRow = [height](auto&& func) { Threading::parallelFor(0u, height, func); };
+
+    forEachRow(
+        [&](uint32_t y)
+        {
+            for (uint32_t i = y * width; i < (y + 1u) * width; ++i)
+            {
+                mPing[i] = unpackRGB9E5(pRadiance[i]);
+                mNormals[i] = decodeNormal2x16(pGeometry[i].mNormal);
+            }
+        }
+    );
+
+    for (uint32_t iteration = 0u; iteration < settings.mIterationCount; ++iteration)
+    {
+        const int step = 1 << iteration;
+
+        forEachRow(
+            [&](uint32_t y)
+            {
+                for (uint32_t x = 0u; x < width; ++x)
+                {
+                    const uint32_t p = y * width + x;
+                    const float depthP = pGeometry[p].mDepth;
+                    if (depthP == 0.0f)
+                    {
+                        mPong[p] = mPing[p];
+                        continue;
+                    }
+
+                    const float3 normalP = mNormals[p];
+                    const float lumaP = luma(mPing[p]);
+
+                    float3 sum(0.0f);
+                    float weightSum = 0.0f;
+                    for (int dy = -2; dy <= 2; ++dy)
+                    {
+                        const int qy = (int)y + dy * step;
+                        if (qy < 0 || qy >= (int)height)
+                            continue;
+
+                        for (int dx = -2; dx <= 2; ++dx)
+                        {
+                            const int qx = (int)x + dx * step;
+                            if (qx < 0 || qx >= (int)width)
+                                continue;
+
+                            const uint32_t q = (uint32_t)qy * width + (uint32_t)qx;
+                            const float depthQ = pGeometry[q].mDepth;
+                            if (depthQ == 0.0f)
+                                continue;
+
+                            const float pixelDistance = (float)step * std::sqrt((float)(dx * dx + dy * dy));
+                            const float lumaQ = luma(mPing[q]);
+
+                            const float normalWeight = std::pow(std::max(0.0f, dot(normalP, mNormals[q])), settings.mNormalPhi);
+                            const float depthWeight =
+                                std::exp(-std::abs(depthP - depthQ) / (settings.mDepthPhi * depthP * pixelDistance + 1e-6f));
+                            const float lumaWeight =
+                                std::exp(-std::abs(lumaP - lumaQ) / (settings.mLuminancePhi * std::max(lumaP, lumaQ) + 1e-6f));
+
+                            const float weight = kKernel[std::abs(dx)] * kKernel[std::abs(dy)] * normalWeight * depthWeight * lumaWeight;
+                            sum += mPing[q] * weight;
+                            weightSum += weight;
+                        }
+                    }
+
+                    // The center always has a non zero weight.
+                    mPong[p] = sum / weightSum;
+                }
+            }
+        );
+
+        std::swap(mPing, mPong);
+    }
+
+    forEachRow(
+        [&](uint32_t y)
+        {
+            for (uint32_t i = y * width; i < (y + 1u) * width; ++i)
+            {
+                if (pGeometry[i].mDepth != 0.0f)
+                    pRadiance[i] = packRGB9E5(mPing[i]);
+            }
+        }
+    );
+}
+
+CpuDenoiser::CpuDenoiser(ref<Device> pDevice, ref<Scene> pScene, uint32_t width, uint32_t height) : mpDevice(pDevice), mpScene(pScene)
+{
+    mpPackPass = ComputePass::create(pDevice, "Samples/Restir/CpuDenoiser.slang", "PackCpuDenoiser");
+    mpUnpackPass = ComputePass::create(pDevice, "Samples/Restir/CpuDenoiser.slang", "UnpackCpuDenoiser");
+
+    resize(width, height);
+}
+
+void CpuDenoiser::resize(uint32_t width, uint32_t height)
+{
+    mWidth = width;
+    mHeight = height;
+
+    const uint32_t pixelCount = width * height;
+    const uint32_t nbReservoirPerPixel = SceneSettingsSingleton::instance()->nbReservoirPerPixel;
+
+    ResourcePool* pPool = ResourcePoolSingleton::instance();
+    pPool->release(mpGeometryBuffer);
+    pPool->release(mpRadianceBuffer);
+    mpGeometryBuffer = pPool->acquireStructuredBuffer(sizeof(CpuDenoiserGeometry), pixelCount);
+    mpRadianceBuffer = pPool->acquireStructuredBuffer(sizeof(uint32_t), pixelCount * nbReservoirPerPixel);
+
+    mGeometry.resize(pixelCount);
+    mRadiance.resize(pixelCount * nbReservoirPerPixel);
+}
+
+void CpuDenoiser::render(RenderContext* pRenderContext)
+{
+    FALCOR_PROFILE(pRenderContext, "CpuDenoiser::render");
+
+    const uint32_t pixelCount = mWidth * mHeight;
+    const uint32_t nbReservoirPerPixel = SceneSettingsSingleton::instance()->nbReservoirPerPixel;
+
+    // Pack.
+    {
+        auto var = mpPackPass->getRootVar();
+
+        var["PerFrameCB"]["viewportDims"] = uint2(mWidth, mHeight);
+        var["PerFrameCB"]["cameraPositionWs"] = mpScene->getCamera()->getPosition();
+        var["PerFrameCB"]["nbReservoirPerPixel"] = nbReservoirPerPixel;
+
+        var["gReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
+        var["gGeometry"] = mpGeometryBuffer;
+        var["gRadiance"] = mpRadianceBuffer;
+
+        var["gPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
+        var["gNormalWs"] = GBufferSingleton::instance()->getCurrentNormalWsTexture();
+
+        mpPackPass->execute(pRenderContext, mWidth, mHeight);
+    }
+
+    // Read back, filter every reservoir index and upload. getBlob waits for the GPU.
+    {
+        FALCOR_PROFILE(pRenderContext, "CpuDenoiser::filter");
+
+        mpGeometryBuffer->getBlob(mGeometry.data(), 0, mGeometry.size() * sizeof(CpuDenoiserGeometry));
+        mpRadianceBuffer->getBlob(mRadiance.data(), 0, mRadiance.size() * sizeof(uint32_t));
+
+        for (uint32_t i = 0u; i < nbReservoirPerPixel; ++i)
+            mFilter.filter(mWidth, mHeight, mGeometry.data(), mRadiance.data() + (size_t)i * pixelCount, mSettings);
+
+        mpRadianceBuffer->setBlob(mRadiance.data(), 0, mRadiance.size() * sizeof(uint32_t));
+    }
+
+    // Unpack.
+    {
+        auto var = mpUnpackPass->getRootVar();
+
+        var["PerFrameCB"]["viewportDims"] = uint2(mWidth, mHeight);
+        var["PerFrameCB"]["nbReservoirPerPixel"] = nbReservoirPerPixel;
+
+        var["gReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
+        var["gRadiance"] = mpRadianceBuffer;
+        var["gPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
+
+        mpUnpackPass->execute(pRenderContext, mWidth, mHeight);
+    }
+}
+} // namespace Restir
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Denoiser.h"
+
+namespace Restir
+{
+// Must match CpuDenoiserGeometry in CpuDenoiser.slang.
+struct CpuDenoiserGeometry
+{
+    uint32_t mNormal = 0u; // Octahedral, 2x16 bits snorm.
+    float mDepth = 0.0f;   // Distance to the camera, 0 for the background.
+};
+
+static_assert(sizeof(CpuDenoiserGeometry) == 8);
+
+// Edge-avoiding a-trous wavelet filter (Dammertz et al. 2010), the spatial part of SVGF, without the variance estimate. Each iteration
+// applies the 5x5 B3 spline kernel with holes, weighted by the normal, depth and luminance differences. The rows are split across the
+// Threading scheduler.
+class CpuAtrousFilter
+{
+public:
+    struct Settings
+    {
+        uint32_t mIterationCount = 5u; // Kernel footprint of 2^(iterations + 2) pixels.
+        float mNormalPhi = 128.0f;     // Exponent of the normal cosine.
+        float mDepthPhi = 0.05f;       // Relative depth difference for a weight of 1/e, per pixel of step.
+        float mLuminancePhi = 0.5f;    // Relative luminance difference for a weight of 1/e.
+    };
+
+    // Filters in place the RGB9E5 radiance of a width x height image. The background pixels are left untouched.
+    void filter(uint32_t width, uint32_t height, const CpuDenoiserGeometry* pGeometry, uint32_t* pRadiance, const Settings& settings);
+
+private:
+    std::vector<Falcor::float3> mPing;
+    std::vector<Falcor::float3> mPong;
+    std::vector<Falcor::float3> mNormals;
+};
+
+// Portable denoiser: the radiance of the reservoirs and the normal and depth of the G-buffer are packed on the GPU, read back, filtered
+// with CpuAtrousFilter and uploaded back into the reservoirs. Mostly meant to compare the denoiser cost and quality, and to run the whole
+// pipeline without NRD.
+class CpuDenoiser : public Denoiser
+{
+public:
+    CpuDenoiser(Falcor::ref<Falcor::Device> pDevice, Falcor::ref<Falcor::Scene> pScene, uint32_t width, uint32_t height);
+
+    void resize(uint32_t width, uint32_t height) override;
+
+    void render(Falcor::RenderContext* pRenderContext) override;
+
+    inline CpuAtrousFilter::Settings& getSettings() { return mSettings; }
+
+private:
+    Falcor::ref<Falcor::Device> mpDevice;
+    Falcor::ref<Falcor::Scene> mpScene;
+
+    uint32_t mWidth;
+    uint32_t mHeight;
+
+    Falcor::ref<Falcor::ComputePass> mpPackPass;
+    Falcor::ref<Falcor::ComputePass> mpUnpackPass;
+
+    Falcor::ref<Falcor::Buffer> mpGeometryBuffer;
+    Falcor::ref<Falcor::Buffer> mpRadianceBuffer;
+
+    std::vector<CpuDenoiserGeometry> mGeometry;
+    std::vector<uint32_t> mRadiance; // One image per reservoir index.
+
+    CpuAtrousFilter mFilter;
+    CpuAtrousFilter::Settings mSettings;
+};
+} // namespace Restir
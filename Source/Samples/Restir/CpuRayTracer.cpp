@@ -0,0 +1,172 @@
+#include "CpuRayTracer.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+const uint32_t kMaxLeafSize = 4u;
+const uint32_t kStackSize = 64u;
+
+bool intersectTriangle(
+    const float3& origin,
+    const float3& direction,
+    const float3& v0,
+    const float3& v1,
+    const float3& v2,
+    float tMin,
+    float tMax
+)
+{
+    // Moller-Trumbore. Double sided, as the shadow rays are traced without culling.
+    const float3 e1 = v1 - v0;
+    const float3 e2 = v2 - v0;
+    const float3 p = cross(direction, e2);
+    const float det = dot(e1, p);
+    if (std::abs(det) < 1e-12f)
+        return false;
+
+    const float invDet = 1.0f / det;
+    const float3 s = origin - v0;
+    const float u = dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    const float3 q = cross(s, e1);
+    const float v = dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    const float t = dot(e2, q) * invDet;
+    return t > tMin && t < tMax;
+}
+
+bool intersectBox(const float3& origin, const float3& invDirection, const float3& boxMin, const float3& boxMax, float tMin, float tMax)
+{
+    const float3 t0 = (boxMin - origin) * invDirection;
+    const float3 t1 = (boxMax - origin) * invDirection;
+    const float3 tNear = min(t0, t1);
+    const float3 tFar = max(t0, t1);
+
+    const float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+    const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit;
+}
+} // namespace
+
+CpuRayTracer::CpuRayTracer(const std::vector<float3>& triangleVertices) : mTriangleVertices(triangleVertices)
+{
+    FALCOR_CHECK(mTriangleVertices.size() % 3 == 0, "Triangle soup must contain 3 vertices per triangle.");
+
+    const uint32_t triangleCount = getTriangleCount();
+
+    std::vector<float3> centroids(triangleCount);
+    mTriangleIndices.resize(triangleCount);
+    for (uint32_t i = 0u; i < triangleCount; ++i)
+    {
+        mTriangleIndices[i] = i;
+        centroids[i] = (mTriangleVertices[3 * i] + mTriangleVertices[3 * i + 1] + mTriangleVertices[3 * i + 2]) / 3.0f;
+    }
+
+    mNodes.reserve(triangleCount > 0u ? 2u * triangleCount : 1u);
+    if (triangleCount > 0u)
+        build(0u, triangleCount, centroids);
+}
+
+uint32_t CpuRayTracer::build(uint32_t begin, uint32_t end, std::vector<float3>& centroids)
+{
+    const uint32_t nodeIndex = (uint32_t)mNodes.size();
+    mNodes.emplace_back();
+
+    float3 boxMin(std::numeric_limits<float>::max());
+    float3 boxMax(-std::numeric_limits<float>::max());
+    float3 centroidMin(std::numeric_limits<float>::max());
+    float3 centroidMax(-std::numeric_limits<float>::max());
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const uint32_t triangle = mTriangleIndices[i];
+        for (uint32_t v = 0u; v < 3u; ++v)
+        {
+            boxMin = min(boxMin, mTriangleVertices[3 * triangle + v]);
+            boxMax = max(boxMax, mTriangleVertices[3 * triangle + v]);
+        }
+        centroidMin = min(centroidMin, centroids[triangle]);
+        centroidMax = max(centroidMax, centroids[triangle]);
+    }
+
+    mNodes[nodeIndex].mMin = boxMin;
+    mNodes[nodeIndex].mMax = boxMax;
+
+    const uint32_t count = end - begin;
+    if (count <= kMaxLeafSize)
+    {
+        mNodes[nodeIndex].mFirst = begin;
+        mNodes[nodeIndex].mCount = count;
+        return nodeIndex;
+    }
+
+    // Median split along the largest centroid extent.
+    const float3 extent = centroidMax - centroidMin;
+    const int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+    const uint32_t middle = begin + count / 2u;
+    std::nth_element(
+        mTriangleIndices.begin() + begin,
+        mTriangleIndices.begin() + middle,
+        mTriangleIndices.begin() + end,
+        [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; }
+    );
+
+    build(begin, middle, centroids);
+    const uint32_t right = build(middle, end, centroids);
+
+    mNodes[nodeIndex].mFirst = right;
+    mNodes[nodeIndex].mCount = 0u;
+    return nodeIndex;
+}
+
+bool CpuRayTracer::isOccluded(const float3& origin, const float3& direction, float tMin, float tMax) const
+{
+    if (mNodes.empty())
+        return false;
+
+    const float3 invDirection = 1.0f / direction;
+
+    uint32_t stack[kStackSize];
+    uint32_t stackSize = 0u;
+    stack[stackSize++] = 0u;
+
+    while (stackSize > 0u)
+    {
+        const Node& node = mNodes[stack[--stackSize]];
+        if (!intersectBox(origin, invDirection, node.mMin, node.mMax, tMin, tMax))
+            continue;
+
+        if (node.mCount > 0u)
+        {
+            for (uint32_t i = node.mFirst; i < node.mFirst + node.mCount; ++i)
+            {
+                const uint32_t triangle = mTriangleIndices[i];
+                if (intersectTriangle(
+                        origin,
+                        direction,
+                        mTriangleVertices[3 * triangle],
+                        mTriangleVertices[3 * triangle + 1],
+                        mTriangleVertices[3 * triangle + 2],
+                        tMin,
+                        tMax
+                    ))
+                    return true;
+            }
+        }
+        else
+        {
+            FALCOR_ASSERT(stackSize + 2u <= kStackSize);
+            stack[stackSize++] = node.mFirst;
+            stack[stackSize++] = (uint32_t)(&node - mNodes.data()) + 1u;
+        }
+    }
+
+    return false;
+}
+} // namespace Restir
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Falcor.h"
+
+namespace Restir
+{
+// Minimal CPU BVH over a world space triangle soup. Only answers occlusion queries, which is all the visibility step needs.
+class CpuRayTracer
+{
+public:
+    CpuRayTracer(const std::vector<Falcor::float3>& triangleVertices);
+
+    // Returns true if any triangle is hit in ]tMin, tMax[. Thread safe.
+    bool isOccluded(const Falcor::float3& origin, const Falcor::float3& direction, float tMin, float tMax) const;
+
+    inline uint32_t getTriangleCount() const { return (uint32_t)mTriangleVertices.size() / 3u; }
+
+private:
+    struct Node
+    {
+        Falcor::float3 mMin;
+        uint32_t mFirst = 0u; // First triangle for leaves, right child for inner nodes (left child is always next).
+        Falcor::float3 mMax;
+        uint32_t mCount = 0u; // Number of triangles, 0 for inner nodes.
+    };
+
+    uint32_t build(uint32_t begin, uint32_t end, std::vector<Falcor::float3>& centroids);
+
+    std::vector<Falcor::float3> mTriangleVertices;
+    std::vector<uint32_t> mTriangleIndices;
+    std::vector<Node> mNodes;
+};
+} // namespace Restir
@@ -0,0 +1,626 @@
+#include "CpuReference.h"
+#include "Utils/Threading.h"
+#include "Utils/Timing/CpuTimer.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+const uint32_t kTileSize = 16u;
+const uint32_t kMaxNeighborCount = 16u; // Same as SpatialReusePass.
+
+// Bit exact port of Utils.Sampling.TinyUniformSampleGenerator, so the CPU and GPU draw the same random numbers.
+struct TinyUniformSampleGenerator
+{
+    TinyUniformSampleGenerator(uint2 pixel, uint32_t sampleNumber)
+    {
+        uint32_t v0 = interleave32(pixel);
+        uint32_t v1 = sampleNumber;
+        uint32_t sum = 0u;
+        const uint32_t delta = 0x9e3779b9;
+        const uint32_t k[4] = {0xa341316c, 0xc8013ea4, 0xad90777d, 0x7e95761e};
+        for (uint32_t i = 0u; i < 16u; ++i)
+        {
+            sum += delta;
+            v0 += ((v1 << 4) + k[0]) ^ (v1 + sum) ^ ((v1 >> 5) + k[1]);
+            v1 += ((v0 << 4) + k[2]) ^ (v0 + sum) ^ ((v0 >> 5) + k[3]);
+        }
+        mState = v0;
+    }
+
+    float next1D()
+    {
+        mState = 1664525u * mState + 1013904223u;
+        return (float)(mState >> 8) * 0x1p-24f;
+    }
+
+private:
+    static uint32_t interleave32(uint2 v)
+    {
+        uint32_t x = v.x & 0x0000ffff;
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+
+        uint32_t y = v.y & 0x0000ffff;
+        y = (y | (y << 8)) & 0x00FF00FF;
+        y = (y | (y << 4)) & 0x0F0F0F0F;
+        y = (y | (y << 2)) & 0x33333333;
+        y = (y | (y << 1)) & 0x55555555;
+
+        return x | (y << 1);
+    }
+
+    uint32_t mState;
+};
+
+// Port of the Falcor::AliasTable construction (Vose 1991) used by LightManager. The construction is deterministic, so
+// the CPU picks the same lights as RISPass for the same random numbers.
+class CpuAliasTable
+{
+public:
+    CpuAliasTable(std::vector<float> weights) : mWeights(weights), mItems(weights.size())
+    {
+        const uint32_t count = (uint32_t)weights.size();
+        const uint32_t invalid = 0xFFFFFFFFu;
+        std::vector<uint32_t> lowIdx(count, invalid);
+        std::vector<uint32_t> highIdx(count, invalid);
+
+        for (float w : weights)
+            mWeightSum += w;
+        const float avgWeight = float(mWeightSum / double(count));
+
+        uint32_t lowCount = 0u;
+        uint32_t highCount = 0u;
+        for (uint32_t i = 0u; i < count; ++i)
+        {
+            if (weights[i] < avgWeight)
+                lowIdx[lowCount++] = i;
+            else
+                highIdx[highCount++] = i;
+        }
+
+        for (uint32_t i = 0u; i < count; ++i)
+        {
+            if (lowIdx[i] != invalid && highIdx[i] != invalid)
+            {
+                mItems[i] = {weights[lowIdx[i]] / avgWeight, highIdx[i], lowIdx[i]};
+
+                const float updatedWeight = (weights[lowIdx[i]] + weights[highIdx[i]]) - avgWeight;
+                weights[highIdx[i]] = updatedWeight;
+                if (updatedWeight < avgWeight)
+                    lowIdx[lowCount++] = highIdx[i];
+                else
+                    highIdx[highCount++] = highIdx[i];
+            }
+            else if (highIdx[i] != invalid)
+            {
+                mItems[i] = {1.0f, highIdx[i], highIdx[i]};
+            }
+            else
+            {
+                FALCOR_ASSERT(lowIdx[i] != invalid);
+                mItems[i] = {1.0f, lowIdx[i], lowIdx[i]};
+            }
+        }
+    }
+
+    // Same as AliasTable::sample(float2) in Utils/Sampling/AliasTable.slang.
+    uint32_t sample(float2 rnd) const
+    {
+        const uint32_t index = std::min((uint32_t)mItems.size() - 1u, (uint32_t)(rnd.x * (float)mItems.size()));
+        const Item& item = mItems[index];
+        return rnd.y >= item.threshold ? item.indexA : item.indexB;
+    }
+
+    float getProbability(uint32_t index) const { return mWeights[index] / (float)mWeightSum; }
+
+private:
+    struct Item
+    {
+        float threshold;
+        uint32_t indexA;
+        uint32_t indexB;
+    };
+
+    std::vector<float> mWeights;
+    std::vector<Item> mItems;
+    double mWeightSum = 0.0;
+};
+
+struct SampleToLight
+{
+    float3 L;
+    float length;
+    float intensityMultiplier;
+    float3 lightSampleDir;
+};
+
+// Shading inputs of one G-buffer pixel.
+struct SurfaceData
+{
+    float3 P;
+    float3 N;
+    float3 V;
+    float3 diffuse;
+    float3 specular;
+    float roughness;
+};
+
+float luma(float3 v)
+{
+    return 0.2126f * v.r + 0.7152f * v.g + 0.0722f * v.b;
+}
+
+// Same as BRDF.slangh.
+float3 evaluateBRDF(const SurfaceData& s, float3 L)
+{
+    return s.diffuse / 3.141592653f;
+}
+
+float3 uniformSphericalSample(float r1, float r2)
+{
+    const float sinTheta = std::sqrt(1.0f - r1 * r1);
+    const float phi = 6.28318530f * r2;
+    return float3(sinTheta * std::cos(phi), r1, sinTheta * std::sin(phi));
+}
+
+SampleToLight generateSampleTolight(float3 P, const Light& light, TinyUniformSampleGenerator& rng)
+{
+    const float3 lightToP = P - light.mWsPosition;
+    const float distToLight = length(lightToP);
+
+    const float r1 = rng.next1D() * 2.0f - 1.0f;
+    const float r2 = rng.next1D();
+
+    float3 lightToSample = uniformSphericalSample(r1, r2);
+    if (dot(lightToP, lightToSample) / distToLight < 0.0f)
+    {
+        // Sample is on the back hemisphere. Take the opposite one.
+        lightToSample *= -1.0f;
+    }
+
+    SampleToLight sample;
+    sample.L = -lightToP + (lightToSample * light.mRadius);
+    sample.length = length(sample.L);
+    sample.L /= sample.length;
+
+    sample.intensityMultiplier = light.mfallOff / (sample.length * sample.length);
+    sample.intensityMultiplier = std::min(sample.intensityMultiplier, 1.0f);
+    sample.lightSampleDir = lightToSample;
+
+    return sample;
+}
+
+float evaluateTargetPdf(const SurfaceData& s, const RestirSample& y)
+{
+    const float3 L = normalize(y.mLightSamplePosition - s.P);
+    const float3 sampledBrdf = evaluateBRDF(s, L);
+    return luma(y.mIncomingRadiance * sampledBrdf * std::max(0.0f, dot(L, s.N)));
+}
+
+void initReservoir(RestirReservoir& r)
+{
+    r.mY = RestirSample();
+    r.mWsum = 0.0f;
+    r.mM = 0u;
+    r.mW = 0.0f;
+    r.mHitDistance = kNoHitDistance;
+}
+
+bool updateReservoir(RestirReservoir& r, TinyUniformSampleGenerator& rng, const RestirSample& xi, float wi)
+{
+    r.mWsum += wi;
+    ++r.mM;
+
+    if (r.mWsum > 0.0f && rng.next1D() < wi / r.mWsum)
+    {
+        r.mY = xi;
+        return true;
+    }
+
+    return false;
+}
+
+void finalizeReservoir(RestirReservoir& r, const SurfaceData& s)
+{
+    const float ppx = evaluateTargetPdf(s, r.mY);
+    r.mW = ppx != 0.0f ? r.mWsum / ((float)r.mM * ppx) : 0.0f;
+}
+
+SurfaceData loadSurfaceData(const CpuGBuffer& gBuffer, uint32_t pixelIndex, float3 cameraPositionWs)
+{
+    SurfaceData s;
+    s.P = gBuffer.mPositionWs[pixelIndex].xyz();
+    s.N = gBuffer.mNormalWs[pixelIndex].xyz();
+    s.V = normalize(s.P - cameraPositionWs);
+    s.diffuse = gBuffer.mAlbedo[pixelIndex].xyz();
+    s.specular = gBuffer.mSpecular[pixelIndex].xyz();
+    s.roughness = gBuffer.mSpecular[pixelIndex].w;
+    return s;
+}
+} // namespace
+
+CpuReference::CpuReference(const CpuCapture& capture, const SceneSettings& settings)
+    : mCapture(capture)
+    , mSettings(settings)
+    , mRayTracer(capture.mTriangleVertices)
+    , mWidth(capture.mGBuffer.mWidth)
+    , mHeight(capture.mGBuffer.mHeight)
+{
+    FALCOR_CHECK(!mCapture.mLights.empty(), "The CPU reference needs at least one light.");
+    FALCOR_CHECK(mCapture.mLights.size() == mCapture.mLightProbabilities.size(), "Light probabilities do not match the lights.");
+
+    const size_t nbReservoirs = (size_t)mWidth * mHeight * mSettings.nbReservoirPerPixel;
+    mCurrentFrameReservoirs.resize(nbReservoirs);
+    mPreviousFrameReservoirs.resize(nbReservoirs);
+    mSpatialReuseReservoirs.resize(nbReservoirs);
+    mOutput.resize((size_t)mWidth * mHeight);
+
+    mLightBVH.build(mCapture.mLights);
+}
+
+template<typename Func>
+void CpuReference::forEachTile(const Func& func) const
+{
+    const uint32_t tilesX = (mWidth + kTileSize - 1u) / kTileSize;
+    const uint32_t tilesY = (mHeight + kTileSize - 1u) / kTileSize;
+
+    Threading::parallelFor(
+        0u,
+        tilesX * tilesY,
+        [&](uint32_t tileIndex)
+        {
+            const uint32_t x0 = (tileIndex % tilesX) * kTileSize;
+            const uint32_t y0 = (tileIndex / tilesX) * kTileSize;
+            const uint32_t x1 = std::min(x0 + kTileSize, mWidth);
+            const uint32_t y1 = std::min(y0 + kTileSize, mHeight);
+
+            for (uint32_t y = y0; y < y1; ++y)
+                for (uint32_t x = x0; x < x1; ++x)
+                    func(uint2(x, y));
+        }
+    );
+}
+
+void CpuReference::render()
+{
+    ++mSampleIndex;
+
+    auto measure = [](auto&& pass)
+    {
+        const auto start = CpuTimer::getCurrentTimePoint();
+        pass();
+        return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    };
+
+    std::swap(mCurrentFrameReservoirs, mPreviousFrameReservoirs);
+
+    mLastFrameTimings.mRISMs = measure([this]() { renderRIS(); });
+    mLastFrameTimings.mVisibilityMs = measure([this]() { renderVisibility(); });
+    mLastFrameTimings.mTemporalFilteringMs = measure([this]() { renderTemporalFiltering(); });
+    mLastFrameTimings.mSpatialReuseMs = measure([this]() { renderSpatialReuse(); });
+    mLastFrameTimings.mShadingMs = measure([this]() { renderShading(); });
+}
+
+void CpuReference::renderRIS()
+{
+    const CpuGBuffer& gBuffer = mCapture.mGBuffer;
+    const CpuAliasTable lightAliasTable(mCapture.mLightProbabilities);
+
+    forEachTile(
+        [&](uint2 pixel)
+        {
+            const uint32_t pixelLinearIndex = pixel.y * mWidth + pixel.x;
+            if (gBuffer.mPositionWs[pixelLinearIndex].w == 0.0f)
+                return;
+
+            const SurfaceData s = loadSurfaceData(gBuffer, pixelLinearIndex, mCapture.mCameraPositionWs);
+            TinyUniformSampleGenerator rng(pixel, mSampleIndex);
+
+            for (uint32_t reservoirIdx = 0u; reservoirIdx < mSettings.nbReservoirPerPixel; ++reservoirIdx)
+            {
+                RestirReservoir r;
+                initReservoir(r);
+
+                for (uint32_t i = 0u; i < mSettings.RISSamplesCount; ++i)
+                {
+                    // First select a light, proportionally to its estimated contribution or to its luminance.
+                    uint32_t lightIndex;
+                    float px;
+                    if (mSettings.useLightBVH)
+                    {
+                        if (!mLightBVH.sample(s.P, s.N, rng.next1D(), lightIndex, px))
+                        {
+                            // No light can light this point. Still count the candidate.
+                            ++r.mM;
+                            continue;
+                        }
+                    }
+                    else
+                    {
+                        const float rand0 = rng.next1D();
+                        const float rand1 = rng.next1D();
+                        lightIndex = lightAliasTable.sample(float2(rand0, rand1));
+                        px = lightAliasTable.getProbability(lightIndex);
+                    }
+
+                    const Light& light = mCapture.mLights[lightIndex];
+
+                    // Generate a random sample to light.
+                    const SampleToLight sampleToLight = generateSampleTolight(s.P, light, rng);
+
+                    // Sample probability: BRDF * Le * G(x).
+                    float3 ppxSpectrum = light.mColor * sampleToLight.intensityMultiplier;
+                    ppxSpectrum *= evaluateBRDF(s, sampleToLight.L) * std::max(0.0f, dot(sampleToLight.L, s.N));
+                    const float ppx = luma(ppxSpectrum);
+
+                    RestirSample xi;
+                    xi.mGeometryPos = s.P;
+                    xi.mLightSamplePosition = xi.mGeometryPos + (sampleToLight.L * sampleToLight.length);
+                    xi.mIncomingRadiance = light.mColor;
+                    xi.mLightIndex = lightIndex;
+                    xi.mLightSampleDir = sampleToLight.lightSampleDir;
+
+                    updateReservoir(r, rng, xi, ppx / px);
+                }
+
+                finalizeReservoir(r, s);
+                mCurrentFrameReservoirs[pixelLinearIndex * mSettings.nbReservoirPerPixel + reservoirIdx] = r;
+            }
+        }
+    );
+}
+
+void CpuReference::renderVisibility()
+{
+    const CpuGBuffer& gBuffer = mCapture.mGBuffer;
+
+    forEachTile(
+        [&](uint2 pixel)
+        {
+            const uint32_t pixelLinearIndex = pixel.y * mWidth + pixel.x;
+            if (gBuffer.mPositionWs[pixelLinearIndex].w == 0.0f)
+                return;
+
+            for (uint32_t i = 0u; i < mSettings.nbReservoirPerPixel; ++i)
+            {
+                RestirReservoir& r = mCurrentFrameReservoirs[pixelLinearIndex * mSettings.nbReservoirPerPixel + i];
+
+                float3 L = r.mY.mLightSamplePosition - r.mY.mGeometryPos;
+                const float Llen = length(L);
+                L /= Llen;
+
+                if (mRayTracer.isOccluded(r.mY.mGeometryPos, L, 0.001f, Llen))
+                {
+                    r.mW = 0.0f;
+                    r.mHitDistance = Llen;
+                }
+                else
+                {
+                    r.mHitDistance = kNoHitDistance;
+                }
+            }
+        }
+    );
+}
+
+void CpuReference::renderTemporalFiltering()
+{
+    // Nothing to reuse on the first frame.
+    if (mSampleIndex == 1u)
+        return;
+
+    const CpuGBuffer& gBuffer = mCapture.mGBuffer;
+
+    forEachTile(
+        [&](uint2 pixel)
+        {
+            const uint32_t pixelLinearIndex = pixel.y * mWidth + pixel.x;
+            if (gBuffer.mPositionWs[pixelLinearIndex].w == 0.0f)
+                return;
+
+            const SurfaceData s = loadSurfaceData(gBuffer, pixelLinearIndex, mCapture.mCameraPositionWs);
+
+            // Reproject. The capture is a still frame, so the previous G-buffer is the current one.
+            float4 ndc = mul(mCapture.mViewProjMat, float4(s.P, 1.0f));
+            ndc = ndc / ndc.w;
+            float2 screen = (ndc.xy() + float2(1.0f)) * 0.5f;
+            screen.y = 1.0f - screen.y;
+            const int2 previousPixel = int2(screen * float2((float)mWidth, (float)mHeight));
+            if (previousPixel.x < 0 || previousPixel.x >= (int)mWidth || previousPixel.y < 0 || previousPixel.y >= (int)mHeight)
+                return;
+
+            const uint32_t previousPixelLinearIndex = previousPixel.y * mWidth + previousPixel.x;
+            if (gBuffer.mPositionWs[previousPixelLinearIndex].w == 0.0f)
+                return;
+            if (length(gBuffer.mPositionWs[previousPixelLinearIndex].xyz() - s.P) > mSettings.temporalWsRadiusThreshold)
+                return;
+            const float normalError = length(gBuffer.mNormalWs[previousPixelLinearIndex].xyz() - s.N);
+            if (normalError > mSettings.temporalNormalThreshold)
+                return;
+
+            // Same as computeConfidence in TemporalFilteringPass.slang. The capture has no motion vectors, so only the normal counts.
+            float confidence = 1.0f;
+            if (mSettings.temporalConfidenceWeighting)
+            {
+                const float x = normalError / std::max(mSettings.temporalNormalThreshold, 1e-6f);
+                confidence = std::clamp(1.0f - x * x, 0.0f, 1.0f);
+            }
+
+            TinyUniformSampleGenerator rng(pixel, mSampleIndex);
+
+            for (uint32_t i = 0u; i < mSettings.nbReservoirPerPixel; ++i)
+            {
+                RestirReservoir& current = mCurrentFrameReservoirs[pixelLinearIndex * mSettings.nbReservoirPerPixel + i];
+                RestirReservoir previous = mPreviousFrameReservoirs[previousPixelLinearIndex * mSettings.nbReservoirPerPixel + i];
+                // The capture is a still frame, so the camera never moves.
+                if (mSettings.temporalMCap > 0u && mSettings.temporalMCapEveryFrame)
+                    previous.mM = std::min(mSettings.temporalMCap * current.mM, previous.mM);
+                previous.mM = (uint32_t)std::round((float)previous.mM * confidence);
+
+                RestirReservoir combined;
+                initReservoir(combined);
+                updateReservoir(combined, rng, current.mY, evaluateTargetPdf(s, current.mY) * current.mW * (float)current.mM);
+                updateReservoir(combined, rng, previous.mY, evaluateTargetPdf(s, previous.mY) * previous.mW * (float)previous.mM);
+                combined.mM = current.mM + previous.mM;
+
+                finalizeReservoir(combined, s);
+                current = combined;
+            }
+        }
+    );
+}
+
+void CpuReference::renderSpatialReuse()
+{
+    if (mSettings.spatialNeighborCount == 0u)
+        return;
+
+    const CpuGBuffer& gBuffer = mCapture.mGBuffer;
+    const uint32_t neighborCount = std::min(mSettings.spatialNeighborCount, kMaxNeighborCount);
+    const uint32_t nbReservoirPerPixel = mSettings.nbReservoirPerPixel;
+
+    forEachTile(
+        [&](uint2 pixel)
+        {
+            const uint32_t pixelLinearIndex = pixel.y * mWidth + pixel.x;
+            if (gBuffer.mPositionWs[pixelLinearIndex].w == 0.0f)
+            {
+                // Write empty reservoirs like the GPU pass, so that no stale reservoir is left after the swap.
+                for (uint32_t i = 0u; i < nbReservoirPerPixel; ++i)
+                    initReservoir(mSpatialReuseReservoirs[pixelLinearIndex * nbReservoirPerPixel + i]);
+                return;
+            }
+
+            const SurfaceData center = loadSurfaceData(gBuffer, pixelLinearIndex, mCapture.mCameraPositionWs);
+            const float centerDepth = length(center.P - mCapture.mCameraPositionWs);
+
+            TinyUniformSampleGenerator rng(pixel, mSampleIndex + 0x8000000u);
+
+            // Pick the neighbours once and share them across the reservoirs of the pixel.
+            uint32_t neighbors[kMaxNeighborCount];
+            uint32_t validNeighborCount = 0u;
+            for (uint32_t n = 0u; n < neighborCount; ++n)
+            {
+                const float r = mSettings.spatialRadius * std::sqrt(rng.next1D());
+                const float phi = 6.28318530717958647693f * rng.next1D();
+                const int2 neighbor = int2(pixel) + int2((int)std::round(std::cos(phi) * r), (int)std::round(std::sin(phi) * r));
+
+                if (neighbor.x < 0 || neighbor.y < 0 || neighbor.x >= (int)mWidth || neighbor.y >= (int)mHeight)
+                    continue;
+                if (neighbor.x == (int)pixel.x && neighbor.y == (int)pixel.y)
+                    continue;
+
+                const uint32_t neighborLinearIndex = neighbor.y * mWidth + neighbor.x;
+                const float4& neighborP = gBuffer.mPositionWs[neighborLinearIndex];
+                if (neighborP.w == 0.0f)
+                    continue;
+                if (dot(gBuffer.mNormalWs[neighborLinearIndex].xyz(), center.N) < mSettings.spatialNormalThreshold)
+                    continue;
+                const float neighborDepth = length(neighborP.xyz() - mCapture.mCameraPositionWs);
+                if (std::abs(neighborDepth - centerDepth) > mSettings.spatialDepthThreshold * centerDepth)
+                    continue;
+
+                neighbors[validNeighborCount++] = neighborLinearIndex;
+            }
+
+            for (uint32_t i = 0u; i < nbReservoirPerPixel; ++i)
+            {
+                const RestirReservoir& centerReservoir = mCurrentFrameReservoirs[pixelLinearIndex * nbReservoirPerPixel + i];
+
+                RestirReservoir s;
+                initReservoir(s);
+                const float centerWeight = evaluateTargetPdf(center, centerReservoir.mY) * centerReservoir.mW * (float)centerReservoir.mM;
+                updateReservoir(s, rng, centerReservoir.mY, centerWeight);
+                s.mHitDistance = centerReservoir.mHitDistance;
+                uint32_t M = centerReservoir.mM;
+
+                for (uint32_t n = 0u; n < validNeighborCount; ++n)
+                {
+                    const RestirReservoir& neighborReservoir = mCurrentFrameReservoirs[neighbors[n] * nbReservoirPerPixel + i];
+                    const float weight =
+                        evaluateTargetPdf(center, neighborReservoir.mY) * neighborReservoir.mW * (float)neighborReservoir.mM;
+                    // The neighbour's hit distance was measured from its own shading point, it is unknown for the center.
+                    if (updateReservoir(s, rng, neighborReservoir.mY, weight))
+                        s.mHitDistance = kNoHitDistance;
+
+                    M += neighborReservoir.mM;
+                }
+
+                s.mM = M;
+                s.mY.mGeometryPos = center.P;
+
+                const float ppx = evaluateTargetPdf(center, s.mY);
+                if (ppx == 0.0f)
+                {
+                    s.mW = 0.0f;
+                }
+                else if (mSettings.spatialBiasCorrection)
+                {
+                    // Only count the reservoirs that could have produced the selected sample.
+                    uint32_t Z = centerReservoir.mM;
+                    for (uint32_t n = 0u; n < validNeighborCount; ++n)
+                    {
+                        const SurfaceData neighbor = loadSurfaceData(gBuffer, neighbors[n], mCapture.mCameraPositionWs);
+                        if (evaluateTargetPdf(neighbor, s.mY) > 0.0f)
+                            Z += mCurrentFrameReservoirs[neighbors[n] * nbReservoirPerPixel + i].mM;
+                    }
+                    s.mW = Z > 0u ? s.mWsum / ((float)Z * ppx) : 0.0f;
+                }
+                else
+                {
+                    s.mW = s.mWsum / ((float)s.mM * ppx);
+                }
+
+                mSpatialReuseReservoirs[pixelLinearIndex * nbReservoirPerPixel + i] = s;
+            }
+        }
+    );
+
+    std::swap(mCurrentFrameReservoirs, mSpatialReuseReservoirs);
+}
+
+void CpuReference::renderShading()
+{
+    const CpuGBuffer& gBuffer = mCapture.mGBuffer;
+
+    forEachTile(
+        [&](uint2 pixel)
+        {
+            const uint32_t pixelLinearIndex = pixel.y * mWidth + pixel.x;
+            if (gBuffer.mPositionWs[pixelLinearIndex].w == 0.0f)
+            {
+                mOutput[pixelLinearIndex] = float4(1.0f, 1.0f, 1.0f, kNoHitDistance);
+                return;
+            }
+
+            const SurfaceData s = loadSurfaceData(gBuffer, pixelLinearIndex, mCapture.mCameraPositionWs);
+
+            float3 outColor(0.0f);
+            for (uint32_t i = 0u; i < mSettings.nbReservoirPerPixel; ++i)
+            {
+                const RestirReservoir& r = mCurrentFrameReservoirs[pixelLinearIndex * mSettings.nbReservoirPerPixel + i];
+
+                float3 L = r.mY.mLightSamplePosition - s.P;
+                const float Llen = length(L);
+                L /= Llen;
+
+                float3 shading = evaluateBRDF(s, L) * std::max(0.0f, dot(L, s.N));
+                shading *= r.mY.mIncomingRadiance;
+                shading *= r.mW;
+                shading /= Llen * Llen;
+                shading /= std::pow(Llen, mSettings.shadingLightExponent);
+
+                outColor += shading;
+            }
+
+            outColor /= (float)mSettings.nbReservoirPerPixel;
+            mOutput[pixelLinearIndex] = float4(outColor, 1.0f);
+        }
+    );
+}
+} // namespace Restir
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CpuCapture.h"
+#include "CpuRayTracer.h"
+#include "LightBVH.h"
+#include "ReservoirManager.h"
+
+namespace Restir
+{
+// CPU port of the per-frame Restir pipeline: RISPass, VisibilityPass, TemporalFilteringPass, SpatialReusePass and ShadingPass.
+// Runs over a CpuCapture, tiled across all cores, so it can be used as a golden reference and on machines without a DXR device.
+class CpuReference
+{
+public:
+    struct Timings
+    {
+        double mRISMs = 0.0;
+        double mVisibilityMs = 0.0;
+        double mTemporalFilteringMs = 0.0;
+        double mSpatialReuseMs = 0.0;
+        double mShadingMs = 0.0;
+
+        inline double getTotalMs() const { return mRISMs + mVisibilityMs + mTemporalFilteringMs + mSpatialReuseMs + mShadingMs; }
+    };
+
+    CpuReference(const CpuCapture& capture, const SceneSettings& settings);
+
+    // Render one frame. The G-buffer is static, so consecutive frames accumulate temporal reuse like a still camera on the GPU.
+    void render();
+
+    inline const std::vector<Falcor::float4>& getOutput() const { return mOutput; }
+    inline const Timings& getLastFrameTimings() const { return mLastFrameTimings; }
+    inline uint32_t getFrameCount() const { return mSampleIndex; }
+
+private:
+    template<typename Func>
+    void forEachTile(const Func& func) const;
+
+    void renderRIS();
+    void renderVisibility();
+    void renderTemporalFiltering();
+    void renderSpatialReuse();
+    void renderShading();
+
+    const CpuCapture& mCapture;
+    SceneSettings mSettings;
+    CpuRayTracer mRayTracer;
+    LightBVH mLightBVH;
+
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mSampleIndex = 0u;
+
+    std::vector<RestirReservoir> mCurrentFrameReservoirs;
+    std::vector<RestirReservoir> mPreviousFrameReservoirs;
+    std::vector<RestirReservoir> mSpatialReuseReservoirs;
+    std::vector<Falcor::float4> mOutput;
+
+    Timings mLastFrameTimings;
+};
+} // namespace Restir
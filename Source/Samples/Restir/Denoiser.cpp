@@ -0,0 +1,30 @@
+#include "Denoiser.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+const char* getDenoiserTypeName(DenoiserType type)
+{
+    switch (type)
+    {
+    case DenoiserType::None:
+        return "none";
+    case DenoiserType::NRD:
+        return "nrd";
+    case DenoiserType::CpuAtrous:
+        return "cpu";
+    }
+    FALCOR_UNREACHABLE();
+}
+
+DenoiserType parseDenoiserType(const std::string& name)
+{
+    for (DenoiserType type : {DenoiserType::None, DenoiserType::NRD, DenoiserType::CpuAtrous})
+    {
+        if (name == getDenoiserTypeName(type))
+            return type;
+    }
+    FALCOR_THROW("Unknown denoiser '{}', expected none, nrd or cpu.", name);
+}
+} // namespace Restir
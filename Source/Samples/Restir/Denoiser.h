@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Falcor.h"
+
+namespace Restir
+{
+enum class DenoiserType : uint32_t
+{
+    None,
+    NRD,       // RELAX diffuse from NVIDIA NRD. Requires D3D12.
+    CpuAtrous, // CpuDenoiser. Runs everywhere, but reads the frame back to the CPU.
+};
+
+// Name used by the "denoiser" scene setting.
+const char* getDenoiserTypeName(DenoiserType type);
+DenoiserType parseDenoiserType(const std::string& name);
+
+// Denoises in place the incoming radiance of the current frame reservoirs, between the spatial reuse and the shading.
+class Denoiser
+{
+public:
+    virtual ~Denoiser() = default;
+
+    virtual void resize(uint32_t width, uint32_t height) = 0;
+
+    virtual void render(Falcor::RenderContext* pRenderContext) = 0;
+};
+} // namespace Restir
@@ -1,7 +1,9 @@
 #include "DenoisingPass.h"
+#include "CpuDenoiser.h"
 #include "GBuffer.h"
 #include "Core/API/NativeHandleTraits.h"
 #include "ReservoirManager.h"
+#include "ResourcePool.h"
 #include "SceneSettings.h"
 
 #include <slang-gfx.h>
@@ -162,33 +164,56 @@ static void copyMatrix(float* dstMatrix, const float4x4& srcMatrix)
 
 void NRDPass::createFalcorTextures(Falcor::ref<Falcor::Device> pDevice)
 {
-    mViewZTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::R32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
+    ResourcePool* pPool = ResourcePoolSingleton::instance();
+
+    // Release the previous textures first so that the pool can hand them back when going back to a previous size.
+    pPool->release(mViewZTexture);
+    pPool->release(mMotionVectorTexture);
+    pPool->release(mNormalLinearRoughnessTexture);
+    pPool->release(mInputTexture);
+    pPool->release(mOuputTexture);
+
+    mViewZTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::R32Float);
     mViewZTexture->setName("NRD_ViewZ");
 
-    mMotionVectorTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RG32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
+    mMotionVectorTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RG32Float);
     mMotionVectorTexture->setName("NRD_MotionVectorTexture");
 
-    mNormalLinearRoughnessTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
+    mNormalLinearRoughnessTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
     mNormalLinearRoughnessTexture->setName("NRD_NormalLinearRoughness");
 
-    mInputTexture = pDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource
-    );
+    mInputTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
     mInputTexture->setName("NRD_InputTexture");
 
-    mOuputTexture = pDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource
-    );
+    mOuputTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
     mOuputTexture->setName("NRD_OutputTexture");
 }
 
 void NRDPass::initNRD()
+{
+    createDenoiser();
+    createSamplers();
+    createResources();
+    createPipelines();
+}
+
+void NRDPass::resize(uint32_t width, uint32_t height)
+{
+    mWidth = width;
+    mHeight = height;
+
+    createFalcorTextures(mpDevice);
+
+    // The NRD pool depends on the resolution, but the samplers and pipelines only depend on the denoising method.
+    nrd::DestroyDenoiser(*mpDenoiser);
+    createDenoiser();
+    createResources();
+
+    // Restart the accumulation.
+    mFrameIndex = 0u;
+}
+
+void NRDPass::createDenoiser()
 {
     mpDenoiser = nullptr;
 
@@ -207,9 +232,6 @@ void NRDPass::initNRD()
 
     if (res != nrd::Result::SUCCESS)
         FALCOR_THROW("NRDPass: Failed to create NRD denoiser");
-
-    createResources();
-    createPipelines();
 }
 
 void NRDPass::createPipelines()
@@ -306,15 +328,11 @@ void NRDPass::createPipelines()
     }
 }
 
-void NRDPass::createResources()
+void NRDPass::createSamplers()
 {
-    // Destroy previously created resources.
     mpSamplers.clear();
-    mpPermanentTextures.clear();
-    mpTransientTextures.clear();
 
     const nrd::DenoiserDesc& denoiserDesc = nrd::GetDenoiserDesc(*mpDenoiser);
-    const uint32_t poolSize = denoiserDesc.permanentPoolSize + denoiserDesc.transientPoolSize;
 
     // Create samplers.
     for (uint32_t i = 0; i < denoiserDesc.staticSamplerNum; i++)
@@ -343,6 +361,21 @@ void NRDPass::createResources()
 
         mpSamplers.push_back(mpDevice->createSampler(samplerDesc));
     }
+}
+
+void NRDPass::createResources()
+{
+    // Release previously created resources.
+    ResourcePool* pPool = ResourcePoolSingleton::instance();
+    for (ref<Texture>& pTexture : mpPermanentTextures)
+        pPool->release(pTexture);
+    for (ref<Texture>& pTexture : mpTransientTextures)
+        pPool->release(pTexture);
+    mpPermanentTextures.clear();
+    mpTransientTextures.clear();
+
+    const nrd::DenoiserDesc& denoiserDesc = nrd::GetDenoiserDesc(*mpDenoiser);
+    const uint32_t poolSize = denoiserDesc.permanentPoolSize + denoiserDesc.transientPoolSize;
 
     // Texture pool.
     for (uint32_t i = 0; i < poolSize; i++)
@@ -355,14 +388,8 @@ void NRDPass::createResources()
 
         // Create texture.
         ResourceFormat textureFormat = getFalcorFormat(nrdTextureDesc.format);
-        ref<Texture> pTexture = mpDevice->createTexture2D(
-            nrdTextureDesc.width,
-            nrdTextureDesc.height,
-            textureFormat,
-            1u,
-            nrdTextureDesc.mipNum,
-            nullptr,
-            ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+        ref<Texture> pTexture = pPool->acquireTexture2D(
+            nrdTextureDesc.width, nrdTextureDesc.height, textureFormat, nrdTextureDesc.mipNum
         );
 
         if (isPermanent)
@@ -633,7 +660,7 @@ void NRDPass::dispatch(RenderContext* pRenderContext, const nrd::DispatchDesc& d
     mpDevice->getUploadHeap()->release(cbAllocation);
 }
 
-DenoisingPass::DenoisingPass(
+NRDDenoiser::NRDDenoiser(
     Falcor::ref<Falcor::Device> pDevice,
     Falcor::RenderContext* pRenderContext,
     Falcor::ref<Falcor::Scene> pScene,
@@ -644,14 +671,74 @@ DenoisingPass::DenoisingPass(
     mNRDPass = new NRDPass(pDevice, pRenderContext, pScene, width, height);
 }
 
-DenoisingPass::~DenoisingPass()
+NRDDenoiser::~NRDDenoiser()
 {
     delete mNRDPass;
 }
 
-void DenoisingPass::render(Falcor::RenderContext* pRenderContext)
+void NRDDenoiser::resize(uint32_t width, uint32_t height)
+{
+    mNRDPass->resize(width, height);
+}
+
+void NRDDenoiser::render(Falcor::RenderContext* pRenderContext)
 {
     for (uint32_t i = 0u; i < SceneSettingsSingleton::instance()->nbReservoirPerPixel; ++i)
         mNRDPass->render(pRenderContext, i);
 }
+
+DenoisingPass::DenoisingPass(
+    Falcor::ref<Falcor::Device> pDevice,
+    Falcor::RenderContext* pRenderContext,
+    Falcor::ref<Falcor::Scene> pScene,
+    uint32_t width,
+    uint32_t height
+)
+    : mpDevice(pDevice), mpRenderContext(pRenderContext), mpScene(pScene), mWidth(width), mHeight(height)
+{
+    createDenoiser(SceneSettingsSingleton::instance()->denoiser);
+}
+
+void DenoisingPass::createDenoiser(DenoiserType type)
+{
+    mRequestedType = type;
+    mpDenoiser = nullptr;
+
+    if (type == DenoiserType::NRD && mpDevice->getType() != Device::Type::D3D12)
+    {
+        logWarning("NRD requires D3D12, falling back to the CPU denoiser.");
+        type = DenoiserType::CpuAtrous;
+    }
+
+    switch (type)
+    {
+    case DenoiserType::None:
+        break;
+    case DenoiserType::NRD:
+        mpDenoiser = std::make_unique<NRDDenoiser>(mpDevice, mpRenderContext, mpScene, mWidth, mHeight);
+        break;
+    case DenoiserType::CpuAtrous:
+        mpDenoiser = std::make_unique<CpuDenoiser>(mpDevice, mpScene, mWidth, mHeight);
+        break;
+    }
+    mType = type;
+}
+
+void DenoisingPass::resize(uint32_t width, uint32_t height)
+{
+    mWidth = width;
+    mHeight = height;
+
+    if (mpDenoiser)
+        mpDenoiser->resize(width, height);
+}
+
+void DenoisingPass::render(Falcor::RenderContext* pRenderContext)
+{
+    if (SceneSettingsSingleton::instance()->denoiser != mRequestedType)
+        createDenoiser(SceneSettingsSingleton::instance()->denoiser);
+
+    if (mpDenoiser)
+        mpDenoiser->render(pRenderContext);
+}
 } // namespace Restir
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Falcor.h"
+#include "Denoiser.h"
 
 #include "Core/Enum.h"
 #include "Core/API/Shared/D3D12DescriptorSet.h"
@@ -27,8 +28,13 @@ struct NRDPass
 
     void render(Falcor::RenderContext* pRenderContext, uint32_t ReservoirIdx);
 
+    // Recreates the resolution dependent resources. The pipelines are kept.
+    void resize(uint32_t width, uint32_t height);
+
     void initNRD();
+    void createDenoiser();
     void createPipelines();
+    void createSamplers();
     void createResources();
 
     void createFalcorTextures(Falcor::ref<Falcor::Device> pDevice);
@@ -78,6 +84,27 @@ struct NRDPass
     ref<D3D12ConstantBufferView> mpCBV;
 };
 
+class NRDDenoiser : public Denoiser
+{
+public:
+    NRDDenoiser(
+        Falcor::ref<Falcor::Device> pDevice,
+        Falcor::RenderContext* pRenderContext,
+        Falcor::ref<Falcor::Scene> pScene,
+        uint32_t width,
+        uint32_t height
+    );
+    ~NRDDenoiser() override;
+
+    void resize(uint32_t width, uint32_t height) override;
+
+    void render(Falcor::RenderContext* pRenderContext) override;
+
+private:
+    NRDPass* mNRDPass;
+};
+
+// Runs the denoiser selected by SceneSettings::denoiser. The denoiser is recreated when the setting changes.
 class DenoisingPass
 {
 public:
@@ -88,11 +115,26 @@ public:
         uint32_t width,
         uint32_t height
     );
-    ~DenoisingPass();
+
+    void resize(uint32_t width, uint32_t height);
 
     void render(Falcor::RenderContext* pRenderContext);
 
+    // May differ from the setting if the selected denoiser is not supported by the device.
+    inline DenoiserType getType() const { return mType; }
+
 private:
-    NRDPass* mNRDPass;
+    void createDenoiser(DenoiserType type);
+
+    Falcor::ref<Falcor::Device> mpDevice;
+    Falcor::RenderContext* mpRenderContext;
+    Falcor::ref<Falcor::Scene> mpScene;
+
+    uint32_t mWidth;
+    uint32_t mHeight;
+
+    DenoiserType mRequestedType = DenoiserType::None;
+    DenoiserType mType = DenoiserType::None;
+    std::unique_ptr<Denoiser> mpDenoiser;
 };
 } // namespace Restir
@@ -1,4 +1,5 @@
 #include "GBuffer.h"
+#include "ResourcePool.h"
 
 namespace Restir
 {
@@ -17,31 +18,39 @@ void GBuffer::init(ref<Device> pDevice, ref<Scene> pScene, uint32_t width, uint3
     compilePrograms();
 }
 
-void GBuffer::createTextures()
+void GBuffer::resize(uint32_t width, uint32_t height)
 {
-    mCurrentPositionWsTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
-
-    mPreviousPositionWsTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
-
-    mCurrentNormalWsTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
-
-    mPreviousNormalWsTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
+    mWidth = width;
+    mHeight = height;
 
-    mAlbedoTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
+    createTextures();
+}
 
-    mSpecularTexture = mpDevice->createTexture2D(
-        mWidth, mHeight, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
-    );
+void GBuffer::createTextures()
+{
+    ResourcePool* pPool = ResourcePoolSingleton::instance();
+
+    // Release the previous textures first so that the pool can hand them back when going back to a previous size.
+    pPool->release(mCurrentPositionWsTexture);
+    pPool->release(mPreviousPositionWsTexture);
+    pPool->release(mCurrentNormalWsTexture);
+    pPool->release(mPreviousNormalWsTexture);
+    pPool->release(mAlbedoTexture);
+    pPool->release(mSpecularTexture);
+    pPool->release(mMotionVectorTexture);
+
+    mCurrentPositionWsTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+    mPreviousPositionWsTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+    mCurrentNormalWsTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+    mPreviousNormalWsTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+    mAlbedoTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+    mSpecularTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+    mMotionVectorTexture = pPool->acquireTexture2D(mWidth, mHeight, ResourceFormat::RGBA32Float);
+
+    // The previous frame is read by the temporal filtering before being rendered. A zero w marks the background.
+    RenderContext* pRenderContext = mpDevice->getRenderContext();
+    pRenderContext->clearUAV(mPreviousPositionWsTexture->getUAV().get(), float4(0.0f));
+    pRenderContext->clearUAV(mPreviousNormalWsTexture->getUAV().get(), float4(0.0f));
 }
 
 void GBuffer::compilePrograms()
@@ -83,6 +92,7 @@ void GBuffer::render(RenderContext* pRenderContext)
     var["gNormalWs"] = mCurrentNormalWsTexture;
     var["gAlbedo"] = mAlbedoTexture;
     var["gSpecular"] = mSpecularTexture;
+    var["gMotionVector"] = mMotionVectorTexture;
 
     mpScene->raytrace(pRenderContext, mpRaytraceProgram.get(), mpRtVars, uint3(mWidth, mHeight, 1));
 }
@@ -11,6 +11,9 @@ public:
 
     void init(Falcor::ref<Falcor::Device> pDevice, Falcor::ref<Falcor::Scene> pScene, uint32_t width, uint32_t height);
 
+    // Gets the textures from the resource pool. The previous frame is cleared to the background.
+    void resize(uint32_t width, uint32_t height);
+
     void render(Falcor::RenderContext* pRenderContext);
 
     inline const Falcor::ref<Falcor::Texture>& getCurrentPositionWsTexture() const { return mCurrentPositionWsTexture; }
@@ -22,6 +25,9 @@ public:
     inline const Falcor::ref<Falcor::Texture>& getAlbedoTexture() const { return mAlbedoTexture; }
     inline const Falcor::ref<Falcor::Texture>& getSpecularTexture() const { return mSpecularTexture; }
 
+    // xy: offset in pixels to the previous frame position of the hit, z: distance of that position to the previous camera, w: 1 if valid.
+    inline const Falcor::ref<Falcor::Texture>& getMotionVectorTexture() const { return mMotionVectorTexture; }
+
     inline void setNextFrame()
     {
         std::swap(mCurrentNormalWsTexture, mPreviousNormalWsTexture);
@@ -43,6 +49,7 @@ private:
 
     Falcor::ref<Falcor::Texture> mAlbedoTexture;
     Falcor::ref<Falcor::Texture> mSpecularTexture;
+    Falcor::ref<Falcor::Texture> mMotionVectorTexture;
 
     Falcor::ref<Falcor::Texture> mCurrentNormalWsTexture;
     Falcor::ref<Falcor::Texture> mPreviousNormalWsTexture;
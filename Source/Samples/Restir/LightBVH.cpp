@@ -0,0 +1,210 @@
+#include "LightBVH.h"
+#include "LightManager.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+const uint32_t kBinCount = 16u;
+
+float luma(float3 v)
+{
+    return 0.2126f * v.r + 0.7152f * v.g + 0.0722f * v.b;
+}
+
+float surfaceArea(const float3& boxMin, const float3& boxMax)
+{
+    const float3 d = max(boxMax - boxMin, float3(0.0f));
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+// Same as computeImportance in LightBVH.slangh.
+float computeImportance(const LightBVHNode& node, const float3& P, const float3& N)
+{
+    // Nothing in the box is above the tangent plane.
+    const float3 toOrigin = node.mOrigin - P;
+    if (dot(toOrigin, N) + dot(node.mExtent, abs(N)) <= 0.0f)
+        return 0.0f;
+
+    // Clamp the distance by the half size of the box, as the center is not representative of the lights at short distances.
+    const float halfRadius = std::max(node.mExtent.x, std::max(node.mExtent.y, node.mExtent.z));
+    const float distanceSquared = std::max(dot(toOrigin, toOrigin), halfRadius * halfRadius);
+    return node.mFlux / distanceSquared;
+}
+} // namespace
+
+void LightBVH::build(const std::vector<Light>& lights)
+{
+    FALCOR_CHECK(lights.size() < kLeafFlag, "Too many lights for the light BVH.");
+
+    mNodes.clear();
+    if (lights.empty())
+        return;
+
+    std::vector<uint32_t> lightIndices(lights.size());
+    for (uint32_t i = 0u; i < (uint32_t)lights.size(); ++i)
+        lightIndices[i] = i;
+
+    mNodes.reserve(2 * lights.size() - 1);
+    build(lights, lightIndices, 0u, (uint32_t)lights.size());
+}
+
+uint32_t LightBVH::build(const std::vector<Light>& lights, std::vector<uint32_t>& lightIndices, uint32_t begin, uint32_t end)
+{
+    const uint32_t nodeIndex = (uint32_t)mNodes.size();
+    mNodes.emplace_back();
+
+    float3 boxMin(std::numeric_limits<float>::max());
+    float3 boxMax(-std::numeric_limits<float>::max());
+    float3 centroidMin(std::numeric_limits<float>::max());
+    float3 centroidMax(-std::numeric_limits<float>::max());
+    float flux = 0.0f;
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const Light& light = lights[lightIndices[i]];
+        boxMin = min(boxMin, light.mWsPosition - float3(light.mRadius));
+        boxMax = max(boxMax, light.mWsPosition + float3(light.mRadius));
+        centroidMin = min(centroidMin, light.mWsPosition);
+        centroidMax = max(centroidMax, light.mWsPosition);
+        flux += luma(light.mColor);
+    }
+
+    mNodes[nodeIndex].mOrigin = (boxMin + boxMax) * 0.5f;
+    mNodes[nodeIndex].mExtent = (boxMax - boxMin) * 0.5f;
+    mNodes[nodeIndex].mFlux = flux;
+
+    if (end - begin == 1u)
+    {
+        mNodes[nodeIndex].mRightChildOrLight = lightIndices[begin] | kLeafFlag;
+        return nodeIndex;
+    }
+
+    // Find the binned split with the lowest flux weighted surface area.
+    struct Bin
+    {
+        float3 mMin = float3(std::numeric_limits<float>::max());
+        float3 mMax = float3(-std::numeric_limits<float>::max());
+        float mFlux = 0.0f;
+        uint32_t mCount = 0u;
+    };
+
+    const float3 centroidExtent = centroidMax - centroidMin;
+    auto getBin = [&](const Light& light, int axis)
+    {
+        const float t = (light.mWsPosition[axis] - centroidMin[axis]) / centroidExtent[axis];
+        return std::min((uint32_t)(t * (float)kBinCount), kBinCount - 1u);
+    };
+
+    int bestAxis = -1;
+    uint32_t bestSplit = 0u;
+    float bestCost = std::numeric_limits<float>::max();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (centroidExtent[axis] <= 0.0f)
+            continue;
+
+        Bin bins[kBinCount];
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const Light& light = lights[lightIndices[i]];
+            Bin& bin = bins[getBin(light, axis)];
+            bin.mMin = min(bin.mMin, light.mWsPosition - float3(light.mRadius));
+            bin.mMax = max(bin.mMax, light.mWsPosition + float3(light.mRadius));
+            bin.mFlux += luma(light.mColor);
+            ++bin.mCount;
+        }
+
+        // Right side costs, swept from the last bin.
+        float rightCosts[kBinCount];
+        Bin right;
+        for (uint32_t i = kBinCount - 1u; i > 0u; --i)
+        {
+            right.mMin = min(right.mMin, bins[i].mMin);
+            right.mMax = max(right.mMax, bins[i].mMax);
+            right.mFlux += bins[i].mFlux;
+            right.mCount += bins[i].mCount;
+            rightCosts[i] = right.mCount > 0u ? right.mFlux * surfaceArea(right.mMin, right.mMax) : -1.0f;
+        }
+
+        Bin left;
+        for (uint32_t split = 1u; split < kBinCount; ++split)
+        {
+            left.mMin = min(left.mMin, bins[split - 1u].mMin);
+            left.mMax = max(left.mMax, bins[split - 1u].mMax);
+            left.mFlux += bins[split - 1u].mFlux;
+            left.mCount += bins[split - 1u].mCount;
+
+            if (left.mCount == 0u || rightCosts[split] < 0.0f)
+                continue;
+
+            const float cost = left.mFlux * surfaceArea(left.mMin, left.mMax) + rightCosts[split];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    uint32_t middle;
+    if (bestAxis >= 0)
+    {
+        auto it = std::partition(
+            lightIndices.begin() + begin,
+            lightIndices.begin() + end,
+            [&](uint32_t lightIndex) { return getBin(lights[lightIndex], bestAxis) < bestSplit; }
+        );
+        middle = (uint32_t)(it - lightIndices.begin());
+    }
+    else
+    {
+        // All the lights are at the same position.
+        middle = begin + (end - begin) / 2u;
+    }
+
+    build(lights, lightIndices, begin, middle);
+    mNodes[nodeIndex].mRightChildOrLight = build(lights, lightIndices, middle, end);
+    return nodeIndex;
+}
+
+bool LightBVH::sample(const float3& P, const float3& N, float u, uint32_t& lightIndex, float& pdf) const
+{
+    pdf = 1.0f;
+    lightIndex = 0u;
+    if (mNodes.empty())
+        return false;
+
+    uint32_t nodeIndex = 0u;
+    while ((mNodes[nodeIndex].mRightChildOrLight & kLeafFlag) == 0u)
+    {
+        const uint32_t leftNodeIndex = nodeIndex + 1u;
+        const uint32_t rightNodeIndex = mNodes[nodeIndex].mRightChildOrLight;
+
+        const float leftImportance = computeImportance(mNodes[leftNodeIndex], P, N);
+        const float rightImportance = computeImportance(mNodes[rightNodeIndex], P, N);
+        const float totalImportance = leftImportance + rightImportance;
+        if (totalImportance == 0.0f)
+            return false;
+
+        const float pLeft = leftImportance / totalImportance;
+        if (u < pLeft)
+        {
+            u = u / pLeft;
+            pdf *= pLeft;
+            nodeIndex = leftNodeIndex;
+        }
+        else
+        {
+            u = (u - pLeft) / (1.0f - pLeft);
+            pdf *= 1.0f - pLeft;
+            nodeIndex = rightNodeIndex;
+        }
+    }
+
+    lightIndex = mNodes[nodeIndex].mRightChildOrLight & ~kLeafFlag;
+    return true;
+}
+} // namespace Restir
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Falcor.h"
+
+namespace Restir
+{
+struct Light;
+
+// Must match RestirLightBVHNode in LightBVH.slangh.
+struct LightBVHNode
+{
+    Falcor::float3 mOrigin;
+    uint32_t mRightChildOrLight = 0u; // Right child for inner nodes (left child is always next), light index | kLeafFlag for leaves.
+    Falcor::float3 mExtent;           // Half size of the bounding box.
+    float mFlux = 0.0f;               // Sum of the luminance of the lights below the node.
+};
+
+// Binary BVH over the Restir lights, one light per leaf. The RIS candidates are drawn by walking down the tree and picking each child
+// with a probability proportional to its estimated contribution at the shading point, like Rendering/Lights/LightBVHSampler.
+class LightBVH
+{
+public:
+    static constexpr uint32_t kLeafFlag = 0x80000000u;
+
+    // Binned SAH split weighted by the flux of each side, like the SAOH heuristic of LightBVHBuilder without the orientation term.
+    void build(const std::vector<Light>& lights);
+
+    inline const std::vector<LightBVHNode>& getNodes() const { return mNodes; }
+
+    // Same as sampleLightBVH in LightBVH.slangh. Returns false if no light can light the shading point.
+    bool sample(const Falcor::float3& P, const Falcor::float3& N, float u, uint32_t& lightIndex, float& pdf) const;
+
+private:
+    uint32_t build(const std::vector<Light>& lights, std::vector<uint32_t>& lightIndices, uint32_t begin, uint32_t end);
+
+    std::vector<LightBVHNode> mNodes;
+};
+} // namespace Restir
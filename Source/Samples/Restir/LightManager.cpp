@@ -55,15 +55,25 @@ void LightManager::init(Falcor::ref<Falcor::Device> pDevice, Falcor::ref<Falcor:
     );
 
     //------------------------------------------------------------------------------------------------------------
-    //	Create light probalities gpu buffer
+    //	Create light alias table
     //------------------------------------------------------------------------------------------------------------
 
-    mGpuLightProbabilityBuffer = pDevice->createStructuredBuffer(
-        sizeof(float),
-        mLightProbabilities.size(),
+    // Fixed seed so that the table, and thus the RIS candidates, are the same from one run to the other.
+    std::mt19937 aliasTableRng(555);
+    mpLightAliasTable = std::make_unique<Falcor::AliasTable>(pDevice, mLightProbabilities, aliasTableRng);
+
+    //------------------------------------------------------------------------------------------------------------
+    //	Create light BVH
+    //------------------------------------------------------------------------------------------------------------
+
+    mLightBVH.build(mLights);
+
+    mGpuLightBVHBuffer = pDevice->createStructuredBuffer(
+        sizeof(LightBVHNode),
+        mLightBVH.getNodes().size(),
         Falcor::ResourceBindFlags::ShaderResource,
         Falcor::MemoryType::DeviceLocal,
-        mLightProbabilities.data(),
+        mLightBVH.getNodes().data(),
         false
     );
 }
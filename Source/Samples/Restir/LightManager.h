@@ -3,6 +3,8 @@
 #include "SceneName.h"
 #include "Singleton.h"
 #include "FloatRandomNumberGenerator.h"
+#include "LightBVH.h"
+#include "Utils/Sampling/AliasTable.h"
 
 namespace Restir
 {
@@ -23,7 +25,13 @@ struct LightManager
     inline const Falcor::ref<Falcor::Buffer>& getLightGpuBuffer() const { return mGpuLightBuffer; }
 
     inline const std::vector<float>& getLightProbabilities() const { return mLightProbabilities; }
-    inline const Falcor::ref<Falcor::Buffer>& getLightProbabilitiesGpuBuffer() const { return mGpuLightProbabilityBuffer; }
+
+    // Samples the lights proportionally to mLightProbabilities in O(1).
+    inline const Falcor::AliasTable& getLightAliasTable() const { return *mpLightAliasTable; }
+
+    // Samples the lights proportionally to their estimated contribution at a shading point.
+    inline const LightBVH& getLightBVH() const { return mLightBVH; }
+    inline const Falcor::ref<Falcor::Buffer>& getLightBVHGpuBuffer() const { return mGpuLightBVHBuffer; }
 
 private:
     void createArcadeSceneLights(Falcor::ref<Falcor::Scene> pScene);
@@ -40,7 +48,11 @@ private:
     Falcor::ref<Falcor::Buffer> mGpuLightBuffer;
 
     std::vector<float> mLightProbabilities;
-    Falcor::ref<Falcor::Buffer> mGpuLightProbabilityBuffer;
+
+    std::unique_ptr<Falcor::AliasTable> mpLightAliasTable;
+
+    LightBVH mLightBVH;
+    Falcor::ref<Falcor::Buffer> mGpuLightBVHBuffer;
 };
 
 using LightManagerSingleton = Singleton<LightManager>;
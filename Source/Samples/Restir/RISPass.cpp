@@ -8,9 +8,33 @@ namespace Restir
 {
 using namespace Falcor;
 
-RISPass::RISPass(ref<Device> pDevice, uint32_t width, uint32_t height) : mWidth(width), mHeight(height)
+RISPass::RISPass(ref<Device> pDevice, ref<Scene> pScene, uint32_t width, uint32_t height, bool fuseVisibility)
+    : mpScene(pScene), mWidth(width), mHeight(height)
 {
-    mpRISPass = ComputePass::create(pDevice, "Samples/Restir/RISPass.slang", "EntryPoint");
+    if (fuseVisibility)
+    {
+        mFusedVisibility = pDevice->isShaderModelSupported(ShaderModel::SM6_5) &&
+                           pDevice->isFeatureSupported(Device::SupportedFeatures::RaytracingTier1_1);
+        if (!mFusedVisibility)
+            logWarning("Inline ray tracing is not supported, falling back to a separate visibility pass.");
+    }
+
+    if (mFusedVisibility)
+    {
+        ProgramDesc desc;
+        desc.addShaderModules(mpScene->getShaderModules());
+        desc.addShaderLibrary("Samples/Restir/RISPass.slang").csEntry("EntryPoint");
+        desc.addTypeConformances(mpScene->getTypeConformances());
+        desc.setShaderModel(ShaderModel::SM6_5);
+
+        DefineList defines = mpScene->getSceneDefines();
+        defines.add("FUSED_VISIBILITY", "1");
+        mpRISPass = ComputePass::create(pDevice, desc, defines);
+    }
+    else
+    {
+        mpRISPass = ComputePass::create(pDevice, "Samples/Restir/RISPass.slang", "EntryPoint", DefineList{{"FUSED_VISIBILITY", "0"}});
+    }
 }
 
 void RISPass::render(Falcor::RenderContext* pRenderContext, ref<Camera> pCamera)
@@ -23,18 +47,22 @@ void RISPass::render(Falcor::RenderContext* pRenderContext, ref<Camera> pCamera)
     var["PerFrameCB"]["cameraPositionWs"] = pCamera->getPosition();
     var["PerFrameCB"]["sampleIndex"] = ++mSampleIndex;
     var["PerFrameCB"]["nbReservoirPerPixel"] = SceneSettingsSingleton::instance()->nbReservoirPerPixel;
-    var["PerFrameCB"]["lightCount"] = (uint32_t)LightManagerSingleton::instance()->getLights().size();
     var["PerFrameCB"]["RISSamplesCount"] = SceneSettingsSingleton::instance()->RISSamplesCount;
+    var["PerFrameCB"]["useLightBVH"] = (uint)SceneSettingsSingleton::instance()->useLightBVH;
 
     var["gReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
     var["gLights"] = LightManagerSingleton::instance()->getLightGpuBuffer();
-    var["gLightProbabilities"] = LightManagerSingleton::instance()->getLightProbabilitiesGpuBuffer();
+    LightManagerSingleton::instance()->getLightAliasTable().bindShaderData(var["gLightAliasTable"]);
+    var["gLightBVH"] = LightManagerSingleton::instance()->getLightBVHGpuBuffer();
 
     var["gPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
     var["gNormalWs"] = GBufferSingleton::instance()->getCurrentNormalWsTexture();
     var["gAlbedo"] = GBufferSingleton::instance()->getAlbedoTexture();
     var["gSpecular"] = GBufferSingleton::instance()->getSpecularTexture();
 
+    if (mFusedVisibility)
+        mpScene->bindShaderDataForRaytracing(pRenderContext, var["gScene"]);
+
     mpRISPass->execute(pRenderContext, mWidth, mHeight);
 }
 } // namespace Restir
@@ -6,15 +6,28 @@ namespace Restir
 class RISPass
 {
 public:
-    RISPass(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height);
+    // When fuseVisibility is set and the device supports inline ray tracing, the shadow rays are traced with TraceRayInline in the same
+    // dispatch and VisibilityPass must be skipped. See isVisibilityFused().
+    RISPass(Falcor::ref<Falcor::Device> pDevice, Falcor::ref<Falcor::Scene> pScene, uint32_t width, uint32_t height, bool fuseVisibility);
+
+    inline void resize(uint32_t width, uint32_t height)
+    {
+        mWidth = width;
+        mHeight = height;
+    }
 
     void render(Falcor::RenderContext* pRenderContext, Falcor::ref<Falcor::Camera> pCamera);
 
+    inline bool isVisibilityFused() const { return mFusedVisibility; }
+
 private:
+    Falcor::ref<Falcor::Scene> mpScene;
+
     uint32_t mWidth;
     uint32_t mHeight;
 
     uint32_t mSampleIndex = 0u;
+    bool mFusedVisibility = false;
 
     Falcor::ref<Falcor::ComputePass> mpRISPass;
 };
@@ -0,0 +1,110 @@
+#pragma once
+
+// CPU side of the reservoirs and of their packed GPU layout in Reservoir.slangh.
+// Only depends on Falcor's math utilities, so that it can be used without the rest of the sample.
+
+#include "Utils/Math/Float16.h"
+#include "Utils/Math/PackedFormats.h"
+#include "Utils/Math/Vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Restir
+{
+static constexpr float kNoHitDistance = 1e8f;
+static constexpr float kMaxPackedHitDistance = 65504.0f; // Largest fp16.
+static constexpr uint32_t kMaxPackedM = 0xffffu;
+
+struct RestirSample
+{
+    Falcor::float3 mGeometryPos = Falcor::float3(0.0f);
+    Falcor::float3 mLightSamplePosition = Falcor::float3(0.0f);
+    Falcor::float3 mIncomingRadiance = Falcor::float3(0.0f);
+    uint32_t mLightIndex = 0u;
+    Falcor::float3 mLightSampleDir = Falcor::float3(0.0f, 1.0f, 0.0f); // Unit offset of the light sample from the light center.
+};
+
+struct RestirReservoir
+{
+    RestirSample mY;
+    float mWsum = 0.0f;
+    uint32_t mM = 0;
+    float mW = 0.0f;
+    float mHitDistance = kNoHitDistance;
+};
+
+// Layout of the GPU reservoir buffers. Must match PackedRestirReservoir in Reservoir.slangh.
+struct PackedRestirReservoir
+{
+    uint32_t mLightIndex = 0u;
+    uint32_t mLightSampleDir = 0u;     // Octahedral, 2x16 bits snorm.
+    uint32_t mIncomingRadiance = 0u;   // RGB9E5.
+    float mW = 0.0f;
+    uint32_t mPackedMHitDistance = 0u; // M saturated to 16 bits in the low bits, fp16 hit distance in the high bits.
+};
+
+static_assert(sizeof(PackedRestirReservoir) == 20);
+
+// Same as packRGB9E5 and unpackRGB9E5 in Reservoir.slangh.
+inline uint32_t packRGB9E5(Falcor::float3 v)
+{
+    const float kMaxValue = 65408.0f; // (2^9 - 1) / 2^9 * 2^16
+    v = Falcor::math::clamp(v, Falcor::float3(0.0f), Falcor::float3(kMaxValue));
+
+    const float maxChannel = std::max(v.r, std::max(v.g, v.b));
+    if (!(maxChannel > 0.0f)) // Black or NaN, log2 would be -inf or NaN.
+        return 0u;
+
+    int exponent = std::max(-16, (int)std::floor(std::log2(maxChannel))) + 16;
+    float scale = std::exp2((float)(exponent - 24));
+    if ((uint32_t)std::floor(maxChannel / scale + 0.5f) == 512u)
+    {
+        scale *= 2.0f;
+        ++exponent;
+    }
+
+    const uint32_t r = (uint32_t)std::floor(v.r / scale + 0.5f);
+    const uint32_t g = (uint32_t)std::floor(v.g / scale + 0.5f);
+    const uint32_t b = (uint32_t)std::floor(v.b / scale + 0.5f);
+    return r | (g << 9) | (b << 18) | ((uint32_t)exponent << 27);
+}
+
+inline Falcor::float3 unpackRGB9E5(uint32_t packed)
+{
+    const float scale = std::exp2((float)((int)(packed >> 27) - 24));
+    return Falcor::float3((float)(packed & 0x1ff), (float)((packed >> 9) & 0x1ff), (float)((packed >> 18) & 0x1ff)) * scale;
+}
+
+inline PackedRestirReservoir packReservoir(const RestirReservoir& r)
+{
+    PackedRestirReservoir p;
+    p.mLightIndex = r.mY.mLightIndex;
+    p.mLightSampleDir = Falcor::encodeNormal2x16(r.mY.mLightSampleDir);
+    p.mIncomingRadiance = packRGB9E5(r.mY.mIncomingRadiance);
+    p.mW = r.mW;
+    p.mPackedMHitDistance = std::min(r.mM, kMaxPackedM) |
+                            ((uint32_t)Falcor::math::float32ToFloat16(std::min(r.mHitDistance, kMaxPackedHitDistance)) << 16);
+    return p;
+}
+
+// geometryPos is the G-buffer position of the pixel that reads the reservoir, lightPosition and lightRadius are those of the
+// sampled light. mWsum is not stored and comes back as 0.
+inline RestirReservoir unpackReservoir(const PackedRestirReservoir& p, Falcor::float3 geometryPos, Falcor::float3 lightPosition, float lightRadius)
+{
+    RestirReservoir r;
+    r.mY.mGeometryPos = geometryPos;
+    r.mY.mLightIndex = p.mLightIndex;
+    r.mY.mLightSampleDir = Falcor::decodeNormal2x16(p.mLightSampleDir);
+    r.mY.mLightSamplePosition = lightPosition + r.mY.mLightSampleDir * lightRadius;
+    r.mY.mIncomingRadiance = unpackRGB9E5(p.mIncomingRadiance);
+    r.mWsum = 0.0f;
+    r.mM = p.mPackedMHitDistance & 0xffffu;
+    r.mW = p.mW;
+
+    const float hitDistance = Falcor::math::float16ToFloat32((uint16_t)(p.mPackedMHitDistance >> 16));
+    r.mHitDistance = hitDistance >= kMaxPackedHitDistance ? kNoHitDistance : hitDistance;
+    return r;
+}
+} // namespace Restir
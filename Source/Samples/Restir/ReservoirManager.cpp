@@ -1,4 +1,5 @@
 #include "ReservoirManager.h"
+#include "ResourcePool.h"
 #include "SceneSettings.h"
 
 namespace Restir
@@ -7,35 +8,37 @@ namespace Restir
 ReservoirManager::ReservoirManager() {}
 
 void ReservoirManager::init(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height)
+{
+    resize(pDevice->getRenderContext(), width, height);
+}
+
+void ReservoirManager::resize(Falcor::RenderContext* pRenderContext, uint32_t width, uint32_t height)
 {
     //------------------------------------------------------------------------------------------------------------
-    //	Init reservoirs
+    //	Get GPU reservoirs
     //------------------------------------------------------------------------------------------------------------
     const uint32_t nbPixels = width * height;
     const uint32_t nbReservoirs = nbPixels * SceneSettingsSingleton::instance()->nbReservoirPerPixel;
-    std::vector<RestirReservoir> reservoirs(nbReservoirs);
+
+    ResourcePool* pPool = ResourcePoolSingleton::instance();
+
+    // Release the previous buffers first so that the pool can hand them back if the bucket did not change.
+    pPool->release(mCurrentFrameReservoir);
+    pPool->release(mPreviousFrameReservoir);
+    pPool->release(mSpatialReuseReservoir);
+
+    mCurrentFrameReservoir = pPool->acquireStructuredBuffer(sizeof(PackedRestirReservoir), nbReservoirs);
+    mPreviousFrameReservoir = pPool->acquireStructuredBuffer(sizeof(PackedRestirReservoir), nbReservoirs);
+    mSpatialReuseReservoir = pPool->acquireStructuredBuffer(sizeof(PackedRestirReservoir), nbReservoirs);
 
     //------------------------------------------------------------------------------------------------------------
-    //	Create GPU reservoirs
+    //	Clear reservoirs
     //------------------------------------------------------------------------------------------------------------
 
-    mCurrentFrameReservoir = pDevice->createStructuredBuffer(
-        sizeof(RestirReservoir),
-        reservoirs.size(),
-        Falcor::ResourceBindFlags::ShaderResource | Falcor::ResourceBindFlags::UnorderedAccess,
-        Falcor::MemoryType::DeviceLocal,
-        reservoirs.data(),
-        false
-    );
-
-    mPreviousFrameReservoir = pDevice->createStructuredBuffer(
-        sizeof(RestirReservoir),
-        reservoirs.size(),
-        Falcor::ResourceBindFlags::ShaderResource | Falcor::ResourceBindFlags::UnorderedAccess,
-        Falcor::MemoryType::DeviceLocal,
-        reservoirs.data(),
-        false
-    );
+    // A zeroed PackedRestirReservoir is the default one: no sample, M = 0 and W = 0.
+    pRenderContext->clearUAV(mCurrentFrameReservoir->getUAV().get(), Falcor::uint4(0));
+    pRenderContext->clearUAV(mPreviousFrameReservoir->getUAV().get(), Falcor::uint4(0));
+    pRenderContext->clearUAV(mSpatialReuseReservoir->getUAV().get(), Falcor::uint4(0));
 }
 
 } // namespace Restir
@@ -1,39 +1,33 @@
 #pragma once
 
+#include "LightManager.h"
+#include "Reservoir.h"
 #include "Singleton.h"
 
 namespace Restir
 {
-struct RestirSample
-{
-    Falcor::float3 mGeometryPos;
-    Falcor::float3 mLightSamplePosition;
-    Falcor::float3 mIncomingRadiance;
-};
-
-struct RestirReservoir
-{
-    RestirSample mY;
-    float mWsum = 0.0f;
-    uint32_t mM = 0;
-    float mW = 0.0f;
-    float mHitDistance = 1e8f;
-};
-
 struct ReservoirManager
 {
     ReservoirManager();
 
     void init(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height);
 
+    // Gets the reservoir buffers from the resource pool and clears them on the GPU.
+    void resize(Falcor::RenderContext* pRenderContext, uint32_t width, uint32_t height);
+
     inline const Falcor::ref<Falcor::Buffer>& getCurrentFrameReservoirBuffer() const { return mCurrentFrameReservoir; }
     inline const Falcor::ref<Falcor::Buffer>& getPreviousFrameReservoirBuffer() const { return mPreviousFrameReservoir; }
+    inline const Falcor::ref<Falcor::Buffer>& getSpatialReuseReservoirBuffer() const { return mSpatialReuseReservoir; }
+
+    // The spatial reuse output becomes the current frame reservoirs.
+    inline void setSpatialReuseDone() { std::swap(mCurrentFrameReservoir, mSpatialReuseReservoir); }
 
     inline void setNextFrame() { std::swap(mCurrentFrameReservoir, mPreviousFrameReservoir); }
 
 private:
     Falcor::ref<Falcor::Buffer> mCurrentFrameReservoir;
     Falcor::ref<Falcor::Buffer> mPreviousFrameReservoir;
+    Falcor::ref<Falcor::Buffer> mSpatialReuseReservoir;
 };
 
 using ReservoirManagerSingleton = Singleton<ReservoirManager>;
@@ -0,0 +1,117 @@
+#include "ResourcePool.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+namespace
+{
+const uint64_t kBufferType = 0u;
+const uint64_t kTextureType = 1u;
+
+// Number of mantissa bits kept by the buckets. 3 bits wastes at most 1/8 of a buffer.
+const uint32_t kBucketMantissaBits = 3u;
+} // namespace
+
+ResourcePool::ResourcePool() {}
+
+void ResourcePool::init(ref<Device> pDevice)
+{
+    mpDevice = pDevice;
+}
+
+uint32_t ResourcePool::getBucketElementCount(uint32_t elementCount)
+{
+    if (elementCount <= (1u << kBucketMantissaBits))
+        return elementCount;
+
+    const uint32_t shift = bitScanReverse(elementCount) - kBucketMantissaBits;
+    const uint64_t bucket = (((uint64_t)elementCount + (1ull << shift) - 1ull) >> shift) << shift;
+    return (uint32_t)std::min<uint64_t>(bucket, std::numeric_limits<uint32_t>::max());
+}
+
+Resource* ResourcePool::acquireFreeResource(const Key& key)
+{
+    for (Entry& entry : mEntries)
+    {
+        if (entry.mKey == key && !entry.mInUse)
+        {
+            entry.mLastAcquireIndex = ++mAcquireIndex;
+            entry.mInUse = true;
+            return entry.mpResource.get();
+        }
+    }
+    return nullptr;
+}
+
+void ResourcePool::releaseResource(Resource* pResource)
+{
+    auto it = std::find_if(mEntries.begin(), mEntries.end(), [pResource](const Entry& entry) { return entry.mpResource.get() == pResource; });
+    FALCOR_CHECK(it != mEntries.end(), "The resource was not acquired from the pool.");
+    FALCOR_CHECK(it->mInUse, "The resource was already released.");
+    it->mInUse = false;
+}
+
+ref<Buffer> ResourcePool::acquireStructuredBuffer(uint32_t structSize, uint32_t elementCount)
+{
+    const uint32_t bucketElementCount = getBucketElementCount(elementCount);
+    const Key key = {kBufferType, structSize, bucketElementCount};
+
+    if (Resource* pResource = acquireFreeResource(key))
+        return ref<Buffer>(static_cast<Buffer*>(pResource));
+
+    ref<Buffer> pBuffer = mpDevice->createStructuredBuffer(structSize, bucketElementCount);
+    mEntries.push_back({pBuffer, key, (uint64_t)structSize * bucketElementCount, ++mAcquireIndex, true});
+    return pBuffer;
+}
+
+ref<Texture> ResourcePool::acquireTexture2D(uint32_t width, uint32_t height, ResourceFormat format, uint32_t mipCount)
+{
+    const Key key = {kTextureType, (uint64_t)width | ((uint64_t)height << 32), (uint64_t)format | ((uint64_t)mipCount << 32)};
+
+    if (Resource* pResource = acquireFreeResource(key))
+        return ref<Texture>(static_cast<Texture*>(pResource));
+
+    ref<Texture> pTexture = mpDevice->createTexture2D(
+        width, height, format, 1, mipCount, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+    );
+
+    // The mips add at most a third of the top level.
+    uint64_t byteSize = (uint64_t)width * height * getFormatBytesPerBlock(format);
+    if (mipCount > 1u)
+        byteSize += byteSize / 3u;
+
+    mEntries.push_back({pTexture, key, byteSize, ++mAcquireIndex, true});
+    return pTexture;
+}
+
+void ResourcePool::trim(uint64_t maxFreeBytes)
+{
+    std::vector<Entry*> freeEntries;
+    uint64_t freeBytes = 0u;
+    for (Entry& entry : mEntries)
+    {
+        if (!entry.mInUse)
+        {
+            freeEntries.push_back(&entry);
+            freeBytes += entry.mByteSize;
+        }
+    }
+
+    std::sort(
+        freeEntries.begin(), freeEntries.end(), [](const Entry* a, const Entry* b) { return a->mLastAcquireIndex < b->mLastAcquireIndex; }
+    );
+
+    for (Entry* pEntry : freeEntries)
+    {
+        if (freeBytes <= maxFreeBytes)
+            break;
+        freeBytes -= pEntry->mByteSize;
+        pEntry->mpResource = nullptr;
+    }
+
+    mEntries.erase(
+        std::remove_if(mEntries.begin(), mEntries.end(), [](const Entry& entry) { return !entry.mpResource; }), mEntries.end()
+    );
+}
+} // namespace Restir
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Singleton.h"
+
+#include <array>
+
+namespace Restir
+{
+// Keeps the GPU buffers and textures of the Restir passes alive after they are released, so that resizing the window, or going back to a
+// previous resolution, reuses them instead of allocating new ones. A resource is checked out by acquire*() until it is handed back with
+// release(), however many references to it are around.
+class ResourcePool
+{
+public:
+    ResourcePool();
+
+    void init(Falcor::ref<Falcor::Device> pDevice);
+
+    // Returns a structured buffer with at least elementCount elements, shader resource and unordered access. The element counts are
+    // rounded up to buckets 1/8 of a power of two apart, so that close sizes share buffers. The content is undefined.
+    Falcor::ref<Falcor::Buffer> acquireStructuredBuffer(uint32_t structSize, uint32_t elementCount);
+
+    // Returns a texture of exactly this size, shader resource and unordered access. The content is undefined.
+    Falcor::ref<Falcor::Texture> acquireTexture2D(uint32_t width, uint32_t height, Falcor::ResourceFormat format, uint32_t mipCount = 1u);
+
+    // Hands a resource acquired from the pool back to it and clears the reference. The pool can hand it out again from then on, so other
+    // references to it must not be used anymore. Does nothing for a null reference.
+    template<typename T>
+    void release(Falcor::ref<T>& pResource)
+    {
+        if (pResource)
+            releaseResource(pResource.get());
+        pResource = nullptr;
+    }
+
+    // Drops the released resources, least recently acquired first, until they take at most maxFreeBytes.
+    void trim(uint64_t maxFreeBytes);
+
+    static uint32_t getBucketElementCount(uint32_t elementCount);
+
+private:
+    // Resource type, then struct size and bucket element count for buffers, or size and format and mip count for textures.
+    using Key = std::array<uint64_t, 3>;
+
+    struct Entry
+    {
+        Falcor::ref<Falcor::Resource> mpResource;
+        Key mKey;
+        uint64_t mByteSize;
+        uint64_t mLastAcquireIndex;
+        bool mInUse;
+    };
+
+    Falcor::Resource* acquireFreeResource(const Key& key);
+    void releaseResource(Falcor::Resource* pResource);
+
+    Falcor::ref<Falcor::Device> mpDevice;
+
+    std::vector<Entry> mEntries;
+    uint64_t mAcquireIndex = 0u;
+};
+
+using ResourcePoolSingleton = Singleton<ResourcePool>;
+} // namespace Restir
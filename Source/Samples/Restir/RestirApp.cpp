@@ -1,43 +1,61 @@
 
 #include "RestirApp.h"
+#include "CpuCapture.h"
 #include "LightManager.h"
 #include "ReservoirManager.h"
+#include "ResourcePool.h"
 #include "SceneSettings.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/UI/TextRenderer.h"
+
+#include <args.hxx>
+
 #include <sstream>
-#include <windows.h>
 #include <iostream>
 
 FALCOR_EXPORT_D3D12_AGILITY_SDK
 
-// THE SCENE WE USE.
-#define SCENE_NAME 0
-
-#if SCENE_NAME == 0
-static const std::string kScenePath = "Arcade/Arcade.pyscene";
-static const Restir::SceneName kSceneName = Restir::SceneName::Arcade;
-#elif SCENE_NAME == 1
-// To work model is required. READ TestScenes\DragonBuddha\README.txt
-static const std::string kScenePath = "../../../../TestScenes/DragonBuddha/dragonbuddha.pyscene";
-static const Restir::SceneName kSceneName = Restir::SceneName::DragonBuddha;
+namespace
+{
+struct SceneDesc
+{
+    const char* mName;
+    Restir::SceneName mSceneName;
+    const char* mPath;
+    bool mRelativeToExecutable; // Otherwise found through the Falcor media directories.
+};
+
+const SceneDesc kScenes[] = {
+    {"arcade", Restir::SceneName::Arcade, "Arcade/Arcade.pyscene", false},
+    // To work model is required. READ TestScenes\DragonBuddha\README.txt
+    {"dragonbuddha", Restir::SceneName::DragonBuddha, "../../../../TestScenes/DragonBuddha/dragonbuddha.pyscene", true},
+    // To work model is required. READ TestScenes\SanMiguel\README.txt
+    {"sanmiguel", Restir::SceneName::SanMiguel, "../../../../TestScenes/SanMiguel/sanmiguel.pyscene", true},
+};
+
+const SceneDesc& getSceneDesc(Restir::SceneName sceneName)
+{
+    for (const SceneDesc& desc : kScenes)
+    {
+        if (desc.mSceneName == sceneName)
+            return desc;
+    }
+    FALCOR_UNREACHABLE();
+}
 
-#else // To work model is required. READ TestScenes\SanMiguel\README.txt
-static const std::string kScenePath = "../../../../TestScenes/SanMiguel/sanmiguel.pyscene";
-static const Restir::SceneName kSceneName = Restir::SceneName::SanMiguel;
+const std::string kCameraPathFilename = "RestirCameraPath.txt";
 
-#endif
+const Gui::DropdownList kDenoiserList = {
+    {(uint32_t)Restir::DenoiserType::None, "None"},
+    {(uint32_t)Restir::DenoiserType::NRD, "NRD"},
+    {(uint32_t)Restir::DenoiserType::CpuAtrous, "CPU a-trous"},
+};
 
-// https://stackoverflow.com/questions/4804298/how-to-convert-wstring-into-string
-std::wstring ExePath()
-{
-    TCHAR buffer[MAX_PATH] = {0};
-    GetModuleFileName(NULL, buffer, MAX_PATH);
-    std::wstring::size_type pos = std::wstring(buffer).find_last_of(L"\\/");
-    return std::wstring(buffer).substr(0, pos);
-}
+// Resources kept by the pool after a resize, for going back to a previous resolution.
+const uint64_t kMaxFreePoolBytes = 1024ull * 1024ull * 1024ull;
+} // namespace
 
-RestirApp::RestirApp(const SampleAppConfig& config) : SampleApp(config) {}
+RestirApp::RestirApp(const SampleAppConfig& config, const RestirAppOptions& options) : SampleApp(config), mOptions(options) {}
 
 RestirApp::~RestirApp() {}
 
@@ -48,16 +66,20 @@ void RestirApp::onLoad(RenderContext* pRenderContext)
         FALCOR_THROW("Device does not support raytracing!");
     }
 
-    if (kSceneName == Restir::SceneName::SanMiguel || kSceneName == Restir::SceneName::DragonBuddha)
-    {
-        std::wstring exePath = ExePath();
-        std::string str(exePath.begin(), exePath.end());
-        str += "/" + kScenePath;
-        loadScene(str, getTargetFbo().get(), pRenderContext);
-    }
+    const SceneDesc& sceneDesc = getSceneDesc(mOptions.mSceneName);
+    if (sceneDesc.mRelativeToExecutable)
+        loadScene((getExecutableDirectory() / sceneDesc.mPath).string(), getTargetFbo().get(), pRenderContext);
     else
+        loadScene(sceneDesc.mPath, getTargetFbo().get(), pRenderContext);
+
+    if (!mOptions.mBenchmark.mOutputPath.empty())
     {
-        loadScene(kScenePath, getTargetFbo().get(), pRenderContext);
+        if (!mOptions.mBenchmark.mCameraPath.empty())
+            mBenchmarkCameraPath = Restir::loadCameraPath(mOptions.mBenchmark.mCameraPath);
+
+        // Fixed time step so that animations, and thus the rendered frames, are the same from one run to the other.
+        getGlobalClock().setFramerate(60);
+        getDevice()->getProfiler()->setEnabled(true);
     }
 }
 
@@ -71,6 +93,22 @@ void RestirApp::onResize(uint32_t width, uint32_t height)
         float aspectRatio = (w / h);
         mpCamera->setAspectRatio(aspectRatio);
     }
+
+    if (mpScene)
+    {
+        Restir::GBufferSingleton::instance()->resize(width, height);
+        Restir::ReservoirManagerSingleton::instance()->resize(getRenderContext(), width, height);
+
+        mpRISPass->resize(width, height);
+        mpVisibilityPass->resize(width, height);
+        mpTemporalFilteringPass->resize(width, height);
+        mpSpatialReusePass->resize(width, height);
+        mpDenoisingPass->resize(width, height);
+        mpShadingPass->resize(width, height);
+
+        // The program vars keep the trimmed resources alive until the passes rebind them on the next frame.
+        Restir::ResourcePoolSingleton::instance()->trim(kMaxFreePoolBytes);
+    }
 }
 
 void RestirApp::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo)
@@ -83,13 +121,38 @@ void RestirApp::onFrameRender(RenderContext* pRenderContext, const ref<Fbo>& pTa
         if (is_set(updates, IScene::UpdateFlags::RecompileNeeded))
             FALCOR_THROW("This sample does not support scene changes that require shader recompilation.");
 
+        if (!mBenchmarkCameraPath.empty())
+        {
+            const Restir::CameraPathKey& key = mBenchmarkCameraPath[mBenchmarkFrameIndex % mBenchmarkCameraPath.size()];
+            mpCamera->setPosition(key.mPosition);
+            mpCamera->setTarget(key.mTarget);
+            mpCamera->setUpVector(key.mUp);
+        }
+
+        if (mRecordingCameraPath)
+            mRecordedCameraPath.push_back({mpCamera->getPosition(), mpCamera->getTarget(), mpCamera->getUpVector()});
+
         render(pRenderContext, pTargetFbo);
+
+        if (!mOptions.mBenchmark.mOutputPath.empty())
+            updateBenchmark(pRenderContext);
     }
 
     getTextRenderer().render(pRenderContext, getFrameRate().getMsg(), pTargetFbo, {20, 20});
 }
 
-void RestirApp::onGuiRender(Gui* pGui) {}
+void RestirApp::onGuiRender(Gui* pGui)
+{
+    if (!mpScene)
+        return;
+
+    // The denoising pass picks up the new setting on the next frame.
+    Gui::Window w(pGui, "Restir", {300, 100}, {10, 10});
+    Restir::SceneSettings* pSettings = Restir::SceneSettingsSingleton::instance();
+    uint32_t denoiser = (uint32_t)pSettings->denoiser;
+    if (w.dropdown("Denoiser", kDenoiserList, denoiser))
+        pSettings->denoiser = static_cast<Restir::DenoiserType>(denoiser);
+}
 
 bool RestirApp::onKeyEvent(const KeyboardEvent& keyEvent)
 {
@@ -99,6 +162,30 @@ bool RestirApp::onKeyEvent(const KeyboardEvent& keyEvent)
         return true;
     }
 
+    // Dump the inputs of the CPU reference (see RestirCpuReference) at the end of the G-buffer pass of the next frame.
+    if (keyEvent.key == Input::Key::C && keyEvent.type == KeyboardEvent::Type::KeyPressed)
+    {
+        mCaptureRequested = true;
+        return true;
+    }
+
+    // Record the camera of every frame until R is pressed again, for the benchmark mode.
+    if (keyEvent.key == Input::Key::R && keyEvent.type == KeyboardEvent::Type::KeyPressed)
+    {
+        mRecordingCameraPath = !mRecordingCameraPath;
+        if (mRecordingCameraPath)
+        {
+            mRecordedCameraPath.clear();
+            logInfo("Recording camera path.");
+        }
+        else
+        {
+            Restir::saveCameraPath(kCameraPathFilename, mRecordedCameraPath);
+            logInfo("Camera path of {} frames written to '{}'.", mRecordedCameraPath.size(), kCameraPathFilename);
+        }
+        return true;
+    }
+
     if (mpScene && mpScene->onKeyEvent(keyEvent))
         return true;
 
@@ -125,7 +212,7 @@ void RestirApp::loadScene(const std::string& path, const Fbo* pTargetFbo, Render
 
     // Create scene settings singleton.
     Restir::SceneSettingsSingleton::create();
-    switch (kSceneName)
+    switch (mOptions.mSceneName)
     {
     case Restir::SceneName::Arcade:
         Restir::SceneSettingsSingleton::instance()->RISSamplesCount = 4;
@@ -141,25 +228,37 @@ void RestirApp::loadScene(const std::string& path, const Fbo* pTargetFbo, Render
     case Restir::SceneName::SanMiguel:
         Restir::SceneSettingsSingleton::instance()->temporalWsRadiusThreshold = mpScene->getSceneBounds().radius() / 1000.0f;
         Restir::SceneSettingsSingleton::instance()->shadingLightExponent = 3.0f;
-        ;
         break;
     }
 
+    for (const std::string& settingsOverride : mOptions.mSceneSettingsOverrides)
+        Restir::applySceneSettingsOverride(*Restir::SceneSettingsSingleton::instance(), settingsOverride);
+
     // Create the remaining singletons.
+    Restir::ResourcePoolSingleton::create();
+    Restir::ResourcePoolSingleton::instance()->init(getDevice());
+
     Restir::GBufferSingleton::create();
     Restir::GBufferSingleton::instance()->init(getDevice(), mpScene, pTargetFbo->getWidth(), pTargetFbo->getHeight());
 
     Restir::LightManagerSingleton::create();
-    Restir::LightManagerSingleton::instance()->init(getDevice(), mpScene, kSceneName);
+    Restir::LightManagerSingleton::instance()->init(getDevice(), mpScene, mOptions.mSceneName);
 
     Restir::ReservoirManagerSingleton::create();
     Restir::ReservoirManagerSingleton::instance()->init(getDevice(), pTargetFbo->getWidth(), pTargetFbo->getHeight());
 
     // Create the render passes.
-    mpRISPass = new Restir::RISPass(getDevice(), pTargetFbo->getWidth(), pTargetFbo->getHeight());
+    mpRISPass = new Restir::RISPass(
+        getDevice(),
+        mpScene,
+        pTargetFbo->getWidth(),
+        pTargetFbo->getHeight(),
+        Restir::SceneSettingsSingleton::instance()->fuseRISAndVisibility
+    );
     mpVisibilityPass = new Restir::VisibilityPass(getDevice(), mpScene, pTargetFbo->getWidth(), pTargetFbo->getHeight());
     mpTemporalFilteringPass =
-        new Restir::TemporalFilteringPass(getDevice(), mpScene, kSceneName, pTargetFbo->getWidth(), pTargetFbo->getHeight());
+        new Restir::TemporalFilteringPass(getDevice(), mpScene, mOptions.mSceneName, pTargetFbo->getWidth(), pTargetFbo->getHeight());
+    mpSpatialReusePass = new Restir::SpatialReusePass(getDevice(), pTargetFbo->getWidth(), pTargetFbo->getHeight());
 
     mpDenoisingPass = new Restir::DenoisingPass(getDevice(), pRenderContext, mpScene, pTargetFbo->getWidth(), pTargetFbo->getHeight());
     mpShadingPass = new Restir::ShadingPass(getDevice(), pTargetFbo->getWidth(), pTargetFbo->getHeight());
@@ -178,9 +277,18 @@ void RestirApp::render(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo
     std::cout << "-------------------------------------------------------------------------------------------------" << std::endl;
     */
     Restir::GBufferSingleton::instance()->render(pRenderContext);
+
+    if (mCaptureRequested)
+    {
+        captureCpuReferenceInput(pRenderContext, "RestirCapture.rcap");
+        mCaptureRequested = false;
+    }
+
     mpRISPass->render(pRenderContext, mpCamera);
-    mpVisibilityPass->render(pRenderContext);
+    if (!mpRISPass->isVisibilityFused())
+        mpVisibilityPass->render(pRenderContext);
     mpTemporalFilteringPass->render(pRenderContext, mpCamera);
+    mpSpatialReusePass->render(pRenderContext, mpCamera);
     mpDenoisingPass->render(pRenderContext);
     mpShadingPass->render(pRenderContext, mpCamera);
 
@@ -190,13 +298,153 @@ void RestirApp::render(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo
     Restir::ReservoirManagerSingleton::instance()->setNextFrame();
 }
 
+void RestirApp::captureCpuReferenceInput(RenderContext* pRenderContext, const std::filesystem::path& path)
+{
+    Restir::CpuCapture capture;
+
+    // G-buffer.
+    {
+        const Restir::GBuffer* pGBuffer = Restir::GBufferSingleton::instance();
+
+        auto readTexture = [pRenderContext](const ref<Texture>& pTexture)
+        {
+            const std::vector<uint8_t> data = pRenderContext->readTextureSubresource(pTexture.get(), 0);
+            std::vector<float4> texels(data.size() / sizeof(float4));
+            std::memcpy(texels.data(), data.data(), texels.size() * sizeof(float4));
+            return texels;
+        };
+
+        capture.mGBuffer.mWidth = pGBuffer->getCurrentPositionWsTexture()->getWidth();
+        capture.mGBuffer.mHeight = pGBuffer->getCurrentPositionWsTexture()->getHeight();
+        capture.mGBuffer.mPositionWs = readTexture(pGBuffer->getCurrentPositionWsTexture());
+        capture.mGBuffer.mNormalWs = readTexture(pGBuffer->getCurrentNormalWsTexture());
+        capture.mGBuffer.mAlbedo = readTexture(pGBuffer->getAlbedoTexture());
+        capture.mGBuffer.mSpecular = readTexture(pGBuffer->getSpecularTexture());
+    }
+
+    capture.mCameraPositionWs = mpCamera->getPosition();
+    capture.mViewProjMat = mpCamera->getViewProjMatrix();
+    capture.mSettings = *Restir::SceneSettingsSingleton::instance();
+    capture.mLights = Restir::LightManagerSingleton::instance()->getLights();
+    capture.mLightProbabilities = Restir::LightManagerSingleton::instance()->getLightProbabilities();
+
+    // World space triangles for the CPU shadow rays.
+    const std::vector<float4x4>& globalMatrices = mpScene->getAnimationController()->getGlobalMatrices();
+    for (uint32_t instanceID = 0; instanceID < mpScene->getGeometryInstanceCount(); ++instanceID)
+    {
+        const GeometryInstanceData& instance = mpScene->getGeometryInstance(instanceID);
+        if (instance.getType() != Scene::GeometryType::TriangleMesh)
+            continue;
+
+        const MeshID meshID{instance.geometryID};
+        const MeshDesc& meshDesc = mpScene->getMesh(meshID);
+        const uint32_t triangleCount = meshDesc.getTriangleCount();
+
+        std::map<std::string, ref<Buffer>> buffers;
+        buffers["triangleIndices"] = getDevice()->createStructuredBuffer(sizeof(uint3), triangleCount);
+        buffers["positions"] = getDevice()->createStructuredBuffer(sizeof(float3), meshDesc.vertexCount);
+        buffers["texcrds"] = getDevice()->createStructuredBuffer(sizeof(float3), meshDesc.vertexCount);
+        mpScene->getMeshVerticesAndIndices(meshID, buffers);
+
+        const std::vector<uint3> indices = buffers["triangleIndices"]->getElements<uint3>();
+        const std::vector<float3> positions = buffers["positions"]->getElements<float3>();
+        const float4x4& worldMat = globalMatrices[instance.globalMatrixID];
+
+        for (const uint3& triangle : indices)
+        {
+            capture.mTriangleVertices.push_back(transformPoint(worldMat, positions[triangle.x]));
+            capture.mTriangleVertices.push_back(transformPoint(worldMat, positions[triangle.y]));
+            capture.mTriangleVertices.push_back(transformPoint(worldMat, positions[triangle.z]));
+        }
+    }
+
+    Restir::saveCpuCapture(path, capture);
+    logInfo("Restir capture written to '{}'.", path);
+}
+
+void RestirApp::updateBenchmark(RenderContext* pRenderContext)
+{
+    const Restir::BenchmarkOptions& benchmark = mOptions.mBenchmark;
+    Profiler* pProfiler = getDevice()->getProfiler();
+
+    ++mBenchmarkFrameIndex;
+
+    if (mBenchmarkFrameIndex == benchmark.mWarmupFrameCount)
+    {
+        pProfiler->startCapture(benchmark.mFrameCount);
+    }
+    else if (mBenchmarkFrameIndex == benchmark.mWarmupFrameCount + benchmark.mFrameCount)
+    {
+        const std::shared_ptr<Profiler::Capture> pCapture = pProfiler->endCapture();
+        Restir::writeBenchmarkReport(*pCapture, benchmark.mOutputPath);
+        shutdown();
+    }
+}
+
 int runMain(int argc, char** argv)
 {
+    args::ArgumentParser parser("Restir sample.");
+    parser.helpParams.programName = "Restir";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<std::string> sceneFlag(parser, "arcade|dragonbuddha|sanmiguel", "Scene to load.", {'S', "scene"}, "arcade");
+    args::ValueFlagList<std::string> setFlag(parser, "name=value", "Override a SceneSettings member.", {"set"});
+    args::Flag headlessFlag(parser, "", "Start without opening a window and handling user input.", {"headless"});
+    args::ValueFlag<uint32_t> widthFlag(parser, "pixels", "Initial window width.", {"width"});
+    args::ValueFlag<uint32_t> heightFlag(parser, "pixels", "Initial window height.", {"height"});
+    args::ValueFlag<std::string> benchmarkFlag(
+        parser, "path", "Run the benchmark and write the per pass timings to <path>.json and <path>.csv, then exit.", {"benchmark"}
+    );
+    args::ValueFlag<uint32_t> framesFlag(parser, "count", "Number of benchmarked frames.", {"frames"}, 300u);
+    args::ValueFlag<uint32_t> warmupFlag(parser, "count", "Number of frames rendered before the benchmark starts.", {"warmup"}, 16u);
+    args::ValueFlag<std::string> cameraPathFlag(parser, "path", "Camera path recorded with R to play during the benchmark.", {"camera-path"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::Error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    RestirAppOptions options;
+
+    const std::string sceneName = args::get(sceneFlag);
+    auto it = std::find_if(std::begin(kScenes), std::end(kScenes), [&](const SceneDesc& desc) { return sceneName == desc.mName; });
+    if (it == std::end(kScenes))
+    {
+        std::cerr << fmt::format("Unknown scene '{}'.", sceneName) << std::endl;
+        return 1;
+    }
+    options.mSceneName = it->mSceneName;
+    options.mSceneSettingsOverrides = args::get(setFlag);
+
+    if (benchmarkFlag)
+    {
+        options.mBenchmark.mOutputPath = args::get(benchmarkFlag);
+        options.mBenchmark.mFrameCount = std::max(args::get(framesFlag), 1u);
+        options.mBenchmark.mWarmupFrameCount = std::max(args::get(warmupFlag), 1u);
+        if (cameraPathFlag)
+            options.mBenchmark.mCameraPath = args::get(cameraPathFlag);
+    }
+
     SampleAppConfig config;
     config.windowDesc.title = "HelloRestir";
     config.windowDesc.resizableWindow = true;
+    config.headless = headlessFlag;
+    if (widthFlag)
+        config.windowDesc.width = args::get(widthFlag);
+    if (heightFlag)
+        config.windowDesc.height = args::get(heightFlag);
 
-    RestirApp helloRestir(config);
+    RestirApp helloRestir(config, options);
     return helloRestir.run();
 }
 
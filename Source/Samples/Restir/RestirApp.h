@@ -1,20 +1,29 @@
 #pragma once
 
 #include "Falcor.h"
+#include "Benchmark.h"
 #include "DenoisingPass.h"
 #include "GBuffer.h"
 #include "RISPass.h"
 #include "ShadingPass.h"
+#include "SpatialReusePass.h"
 #include "TemporalFilteringPass.h"
 #include "VisibilityPass.h"
 #include "Core/SampleApp.h"
 
 using namespace Falcor;
 
+struct RestirAppOptions
+{
+    Restir::SceneName mSceneName = Restir::SceneName::Arcade;
+    std::vector<std::string> mSceneSettingsOverrides; // "name=value", applied after the per scene settings.
+    Restir::BenchmarkOptions mBenchmark;
+};
+
 class RestirApp : public SampleApp
 {
 public:
-    RestirApp(const SampleAppConfig& config);
+    RestirApp(const SampleAppConfig& config, const RestirAppOptions& options);
     ~RestirApp();
 
     void onLoad(RenderContext* pRenderContext) override;
@@ -27,6 +36,10 @@ public:
 private:
     void loadScene(const std::string& path, const Fbo* pTargetFbo, RenderContext* pRenderContext);
     void render(RenderContext* pRenderContext, const ref<Fbo>& pTargetFbo);
+    void captureCpuReferenceInput(RenderContext* pRenderContext, const std::filesystem::path& path);
+    void updateBenchmark(RenderContext* pRenderContext);
+
+    RestirAppOptions mOptions;
 
     ref<Scene> mpScene;
     ref<Camera> mpCamera;
@@ -36,4 +49,14 @@ private:
     Restir::ShadingPass* mpShadingPass = nullptr;
     Restir::DenoisingPass* mpDenoisingPass = nullptr;
     Restir::TemporalFilteringPass* mpTemporalFilteringPass = nullptr;
+    Restir::SpatialReusePass* mpSpatialReusePass = nullptr;
+
+    bool mCaptureRequested = false;
+
+    // Camera path recording, toggled with R. Saved to RestirCameraPath.txt for the benchmark mode.
+    bool mRecordingCameraPath = false;
+    std::vector<Restir::CameraPathKey> mRecordedCameraPath;
+
+    std::vector<Restir::CameraPathKey> mBenchmarkCameraPath;
+    uint32_t mBenchmarkFrameIndex = 0u;
 };
@@ -0,0 +1,138 @@
+#include "CpuReference.h"
+#include "Utils/Image/Bitmap.h"
+
+#include <args.hxx>
+
+#include <iostream>
+
+using namespace Falcor;
+
+namespace
+{
+// Mean squared error over RGB against a reference image. Background pixels are included, like ImageCompare.
+double computeMSE(const std::vector<float4>& image, const Bitmap& reference)
+{
+    const float* pReference = reinterpret_cast<const float*>(reference.getData());
+
+    double sum = 0.0;
+    for (size_t i = 0; i < image.size(); ++i)
+    {
+        for (uint32_t c = 0u; c < 3u; ++c)
+        {
+            const double delta = (double)image[i][c] - (double)pReference[4 * i + c];
+            sum += delta * delta;
+        }
+    }
+
+    return sum / (3.0 * image.size());
+}
+
+int runMain(int argc, char** argv)
+{
+    args::ArgumentParser parser("Headless CPU reference of the Restir sample pipeline.");
+    parser.helpParams.programName = "RestirCpuReference";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<std::string> outputFlag(parser, "path", "Output EXR image.", {'o', "output"});
+    args::ValueFlag<uint32_t> framesFlag(parser, "count", "Number of frames to render.", {'f', "frames"}, 1u);
+    args::ValueFlag<uint32_t> risSamplesFlag(parser, "count", "Override the number of RIS candidates.", {"ris-samples"});
+    args::ValueFlag<uint32_t> reservoirsFlag(parser, "count", "Override the number of reservoirs per pixel.", {"reservoirs"});
+    args::ValueFlag<std::string> referenceFlag(parser, "path", "Reference EXR image to compute the MSE against.", {'r', "reference"});
+    args::Positional<std::string> captureArg(parser, "capture", "Capture written by the Restir sample.", args::Options::Required);
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::Error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    const Restir::CpuCapture capture = Restir::loadCpuCapture(args::get(captureArg));
+
+    Restir::SceneSettings settings = capture.mSettings;
+    if (risSamplesFlag)
+        settings.RISSamplesCount = args::get(risSamplesFlag);
+    if (reservoirsFlag)
+        settings.nbReservoirPerPixel = args::get(reservoirsFlag);
+
+    std::cout << fmt::format(
+                     "{}x{}, {} lights, {} triangles, {} RIS candidates, {} reservoirs per pixel.",
+                     capture.mGBuffer.mWidth,
+                     capture.mGBuffer.mHeight,
+                     capture.mLights.size(),
+                     capture.mTriangleVertices.size() / 3,
+                     settings.RISSamplesCount,
+                     settings.nbReservoirPerPixel
+                 )
+              << std::endl;
+
+    Restir::CpuReference reference(capture, settings);
+
+    Restir::CpuReference::Timings total;
+    const uint32_t frameCount = std::max(args::get(framesFlag), 1u);
+    for (uint32_t i = 0u; i < frameCount; ++i)
+    {
+        reference.render();
+
+        const Restir::CpuReference::Timings& timings = reference.getLastFrameTimings();
+        total.mRISMs += timings.mRISMs;
+        total.mVisibilityMs += timings.mVisibilityMs;
+        total.mTemporalFilteringMs += timings.mTemporalFilteringMs;
+        total.mSpatialReuseMs += timings.mSpatialReuseMs;
+        total.mShadingMs += timings.mShadingMs;
+    }
+
+    std::cout << fmt::format(
+                     "Average per frame: RIS {:.3f} ms, visibility {:.3f} ms, temporal {:.3f} ms, spatial {:.3f} ms, shading {:.3f} ms, "
+                     "total {:.3f} ms.",
+                     total.mRISMs / frameCount,
+                     total.mVisibilityMs / frameCount,
+                     total.mTemporalFilteringMs / frameCount,
+                     total.mSpatialReuseMs / frameCount,
+                     total.mShadingMs / frameCount,
+                     total.getTotalMs() / frameCount
+                 )
+              << std::endl;
+
+    if (referenceFlag)
+    {
+        auto pReference = Bitmap::createFromFile(args::get(referenceFlag), true);
+        if (!pReference)
+            FALCOR_THROW("Failed to load reference image '{}'.", args::get(referenceFlag));
+        if (pReference->getFormat() != ResourceFormat::RGBA32Float || pReference->getWidth() != capture.mGBuffer.mWidth ||
+            pReference->getHeight() != capture.mGBuffer.mHeight)
+            FALCOR_THROW("Reference image must be an RGBA32Float image with the capture resolution.");
+
+        std::cout << fmt::format("MSE: {}", computeMSE(reference.getOutput(), *pReference)) << std::endl;
+    }
+
+    if (outputFlag)
+    {
+        Bitmap::saveImage(
+            args::get(outputFlag),
+            capture.mGBuffer.mWidth,
+            capture.mGBuffer.mHeight,
+            Bitmap::FileFormat::ExrFile,
+            Bitmap::ExportFlags::None,
+            ResourceFormat::RGBA32Float,
+            true,
+            (void*)reference.getOutput().data()
+        );
+    }
+
+    return 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    return catchAndReportAllExceptions([&]() { return runMain(argc, argv); });
+}
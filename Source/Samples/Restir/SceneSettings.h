@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Denoiser.h"
 #include "Singleton.h"
 
 namespace Restir
@@ -8,9 +9,42 @@ struct SceneSettings
 {
     uint32_t RISSamplesCount = 32u;
     uint32_t nbReservoirPerPixel = 4u;
-    float temporalWsRadiusThreshold = 999999999.0f;
+    float temporalWsRadiusThreshold = 999999999.0f; // Only used without motion vectors.
     float temporalNormalThreshold = 0.12f;
+
+    // Reproject with the G-buffer motion vectors, which follow animated geometry, and validate with the distance to the camera.
+    // Otherwise the current position is reprojected with the previous camera and validated with temporalWsRadiusThreshold.
+    bool temporalUseMotionVectors = false;
+    float temporalDepthThreshold = 0.1f; // Maximum relative difference of the distances to the previous camera.
+
+    // While the camera moves, the previous reservoir M is clamped to temporalMCap times the current one, so that stale samples fade
+    // out. 0 disables the cap.
+    uint32_t temporalMCap = 10u;
+
+    // Scale the previous reservoir M by how well the reprojected surface matches, instead of an all or nothing test.
+    bool temporalConfidenceWeighting = false;
+
+    // Clamp M on every frame, which also fades out the history of animated geometry seen by a still camera.
+    bool temporalMCapEveryFrame = false;
     float shadingLightExponent = 1.0f;
+
+    // Draw the RIS candidates with the light BVH, proportionally to their estimated contribution at the shading point, instead of
+    // proportionally to their luminance with the alias table.
+    bool useLightBVH = true;
+
+    // Trace the shadow rays inline at the end of RISPass instead of in VisibilityPass, which saves a round trip of the reservoirs
+    // through memory. Ignored on devices without inline ray tracing.
+    bool fuseRISAndVisibility = true;
+
+    // Spatial reuse. A neighbour count of 0 disables the pass.
+    uint32_t spatialNeighborCount = 5u;
+    float spatialRadius = 30.0f;          // In pixels.
+    float spatialNormalThreshold = 0.9f;  // Minimum cosine between the normals.
+    float spatialDepthThreshold = 0.1f;   // Maximum relative difference of the camera distances.
+    bool spatialBiasCorrection = true;
+
+    // Falls back to DenoiserType::CpuAtrous when NRD is not supported. Can be changed at runtime.
+    DenoiserType denoiser = DenoiserType::NRD;
 };
 
 using SceneSettingsSingleton = Singleton<SceneSettings>;
@@ -2,20 +2,28 @@
 #include "GBuffer.h"
 #include "LightManager.h"
 #include "ReservoirManager.h"
+#include "ResourcePool.h"
 #include "SceneSettings.h"
 
 namespace Restir
 {
 using namespace Falcor;
 
-ShadingPass::ShadingPass(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height) : mWidth(width), mHeight(height)
+ShadingPass::ShadingPass(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height)
 {
     mpShadingPass = ComputePass::create(pDevice, "Samples/Restir/ShadingPass.slang", "ShadingPass");
 
-    mpOuputTexture = pDevice->createTexture2D(
-        width, height, ResourceFormat::RGBA32Float, 1, 1, nullptr, ResourceBindFlags::UnorderedAccess | ResourceBindFlags::ShaderResource
-    );
+    resize(width, height);
+}
+
+void ShadingPass::resize(uint32_t width, uint32_t height)
+{
+    mWidth = width;
+    mHeight = height;
 
+    ResourcePool* pPool = ResourcePoolSingleton::instance();
+    pPool->release(mpOuputTexture);
+    mpOuputTexture = pPool->acquireTexture2D(width, height, ResourceFormat::RGBA32Float);
     mpOuputTexture->setName("ShadingPass ouput texture");
 }
 
@@ -32,6 +40,7 @@ void ShadingPass::render(Falcor::RenderContext* pRenderContext, ref<Camera> pCam
 
     var["gOutput"] = mpOuputTexture;
     var["gReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
+    var["gLights"] = LightManagerSingleton::instance()->getLightGpuBuffer();
 
     var["gPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
     var["gNormalWs"] = GBufferSingleton::instance()->getCurrentNormalWsTexture();
@@ -8,6 +8,8 @@ class ShadingPass
 public:
     ShadingPass(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height);
 
+    void resize(uint32_t width, uint32_t height);
+
     void render(Falcor::RenderContext* pRenderContext, Falcor::ref<Falcor::Camera> pCamera);
 
     inline Falcor::ref<Falcor::Texture>& getOuputTexture() { return mpOuputTexture; };
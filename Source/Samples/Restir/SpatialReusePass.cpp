@@ -0,0 +1,52 @@
+#include "SpatialReusePass.h"
+#include "GBuffer.h"
+#include "LightManager.h"
+#include "ReservoirManager.h"
+#include "SceneSettings.h"
+
+namespace Restir
+{
+using namespace Falcor;
+
+// Must match kMaxNeighborCount in SpatialReusePass.slang.
+static const uint32_t kMaxNeighborCount = 16u;
+
+SpatialReusePass::SpatialReusePass(ref<Device> pDevice, uint32_t width, uint32_t height) : mWidth(width), mHeight(height)
+{
+    mpSpatialReusePass = ComputePass::create(pDevice, "Samples/Restir/SpatialReusePass.slang", "SpatialReusePass");
+}
+
+void SpatialReusePass::render(Falcor::RenderContext* pRenderContext, ref<Camera> pCamera)
+{
+    const SceneSettings* pSettings = SceneSettingsSingleton::instance();
+    if (pSettings->spatialNeighborCount == 0u)
+        return;
+
+    FALCOR_PROFILE(pRenderContext, "SpatialReusePass::render");
+
+    auto var = mpSpatialReusePass->getRootVar();
+
+    var["PerFrameCB"]["viewportDims"] = uint2(mWidth, mHeight);
+    var["PerFrameCB"]["cameraPositionWs"] = pCamera->getPosition();
+    var["PerFrameCB"]["nbReservoirPerPixel"] = pSettings->nbReservoirPerPixel;
+    var["PerFrameCB"]["sampleIndex"] = ++mSampleIndex;
+    var["PerFrameCB"]["neighborCount"] = std::min(pSettings->spatialNeighborCount, kMaxNeighborCount);
+    var["PerFrameCB"]["radius"] = pSettings->spatialRadius;
+    var["PerFrameCB"]["normalThreshold"] = pSettings->spatialNormalThreshold;
+    var["PerFrameCB"]["depthThreshold"] = pSettings->spatialDepthThreshold;
+    var["PerFrameCB"]["biasCorrection"] = (uint)pSettings->spatialBiasCorrection;
+
+    var["gInputReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
+    var["gOutputReservoirs"] = ReservoirManagerSingleton::instance()->getSpatialReuseReservoirBuffer();
+    var["gLights"] = LightManagerSingleton::instance()->getLightGpuBuffer();
+
+    var["gPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
+    var["gNormalWs"] = GBufferSingleton::instance()->getCurrentNormalWsTexture();
+    var["gAlbedo"] = GBufferSingleton::instance()->getAlbedoTexture();
+    var["gSpecular"] = GBufferSingleton::instance()->getSpecularTexture();
+
+    mpSpatialReusePass->execute(pRenderContext, mWidth, mHeight);
+
+    ReservoirManagerSingleton::instance()->setSpatialReuseDone();
+}
+} // namespace Restir
@@ -0,0 +1,27 @@
+#pragma once
+#include "Falcor.h"
+
+namespace Restir
+{
+class SpatialReusePass
+{
+public:
+    SpatialReusePass(Falcor::ref<Falcor::Device> pDevice, uint32_t width, uint32_t height);
+
+    inline void resize(uint32_t width, uint32_t height)
+    {
+        mWidth = width;
+        mHeight = height;
+    }
+
+    void render(Falcor::RenderContext* pRenderContext, Falcor::ref<Falcor::Camera> pCamera);
+
+private:
+    uint32_t mWidth;
+    uint32_t mHeight;
+
+    uint32_t mSampleIndex = 0u;
+
+    Falcor::ref<Falcor::ComputePass> mpSpatialReusePass;
+};
+} // namespace Restir
@@ -1,5 +1,6 @@
 #include "TemporalFilteringPass.h"
 #include "GBuffer.h"
+#include "LightManager.h"
 #include "ReservoirManager.h"
 #include "SceneSettings.h"
 
@@ -27,6 +28,7 @@ void TemporalFilteringPass::render(Falcor::RenderContext* pRenderContext, ref<Ca
 
     var["PerFrameCB"]["viewportDims"] = uint2(mWidth, mHeight);
     var["PerFrameCB"]["cameraPositionWs"] = pCamera->getPosition();
+    var["PerFrameCB"]["previousCameraPositionWs"] = mPreviousCameraPosition;
     var["PerFrameCB"]["previousFrameViewProjMat"] = transpose(mPreviousFrameViewProjMat);
     var["PerFrameCB"]["nbReservoirPerPixel"] = SceneSettingsSingleton::instance()->nbReservoirPerPixel;
     var["PerFrameCB"]["sampleIndex"] = ++mSampleIndex;
@@ -34,9 +36,15 @@ void TemporalFilteringPass::render(Falcor::RenderContext* pRenderContext, ref<Ca
 
     var["PerFrameCB"]["temporalWsRadiusThreshold"] = SceneSettingsSingleton::instance()->temporalWsRadiusThreshold;
     var["PerFrameCB"]["temporalNormalThreshold"] = SceneSettingsSingleton::instance()->temporalNormalThreshold;
+    var["PerFrameCB"]["useMotionVectors"] = (uint)SceneSettingsSingleton::instance()->temporalUseMotionVectors;
+    var["PerFrameCB"]["temporalDepthThreshold"] = SceneSettingsSingleton::instance()->temporalDepthThreshold;
+    var["PerFrameCB"]["MCap"] = SceneSettingsSingleton::instance()->temporalMCap;
+    var["PerFrameCB"]["MCapEveryFrame"] = (uint)SceneSettingsSingleton::instance()->temporalMCapEveryFrame;
+    var["PerFrameCB"]["useConfidenceWeighting"] = (uint)SceneSettingsSingleton::instance()->temporalConfidenceWeighting;
 
     var["gCurrentFrameReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
     var["gPreviousFrameReservoirs"] = ReservoirManagerSingleton::instance()->getPreviousFrameReservoirBuffer();
+    var["gLights"] = LightManagerSingleton::instance()->getLightGpuBuffer();
 
     var["gCurrentPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
     var["gPreviousPositionWs"] = GBufferSingleton::instance()->getPreviousPositionWsTexture();
@@ -45,8 +53,10 @@ void TemporalFilteringPass::render(Falcor::RenderContext* pRenderContext, ref<Ca
     var["gPreviousNormalWs"] = GBufferSingleton::instance()->getPreviousNormalWsTexture();
     var["gAlbedo"] = GBufferSingleton::instance()->getAlbedoTexture();
     var["gSpecular"] = GBufferSingleton::instance()->getSpecularTexture();
+    var["gMotionVector"] = GBufferSingleton::instance()->getMotionVectorTexture();
 
     mpTemporalFilteringPass->execute(pRenderContext, mWidth, mHeight);
     mPreviousFrameViewProjMat = pCamera->getViewProjMatrix();
+    mPreviousCameraPosition = pCamera->getPosition();
 }
 } // namespace Restir
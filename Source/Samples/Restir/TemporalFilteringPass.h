@@ -15,6 +15,12 @@ public:
         uint32_t height
     );
 
+    inline void resize(uint32_t width, uint32_t height)
+    {
+        mWidth = width;
+        mHeight = height;
+    }
+
     void render(Falcor::RenderContext* pRenderContext, Falcor::ref<Falcor::Camera> pCamera);
 
 private:
@@ -23,6 +29,7 @@ private:
     uint32_t mWidth;
     uint32_t mHeight;
     Falcor::float4x4 mPreviousFrameViewProjMat;
+    Falcor::float3 mPreviousCameraPosition = Falcor::float3(0.0f);
     uint32_t mSampleIndex = 0u;
     Falcor::ref<Falcor::ComputePass> mpTemporalFilteringPass;
     SceneName mSceneName;
@@ -1,5 +1,7 @@
 #include "VisibilityPass.h"
 
+#include "GBuffer.h"
+#include "LightManager.h"
 #include "ReservoirManager.h"
 #include "SceneSettings.h"
 
@@ -51,6 +53,8 @@ void VisibilityPass::render(Falcor::RenderContext* pRenderContext)
     var["PerFrameCB"]["nbReservoirPerPixel"] = SceneSettingsSingleton::instance()->nbReservoirPerPixel;
 
     var["gReservoirs"] = ReservoirManagerSingleton::instance()->getCurrentFrameReservoirBuffer();
+    var["gLights"] = LightManagerSingleton::instance()->getLightGpuBuffer();
+    var["gPositionWs"] = GBufferSingleton::instance()->getCurrentPositionWsTexture();
 
     mpScene->raytrace(pRenderContext, mpRaytraceProgram.get(), mpRtVars, uint3(mWidth, mHeight, 1));
 }
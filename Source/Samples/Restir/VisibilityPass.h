@@ -9,6 +9,12 @@ class VisibilityPass
 public:
     VisibilityPass(Falcor::ref<Falcor::Device> pDevice, Falcor::ref<Falcor::Scene> pScene, uint32_t width, uint32_t height);
 
+    inline void resize(uint32_t width, uint32_t height)
+    {
+        mWidth = width;
+        mHeight = height;
+    }
+
     void render(Falcor::RenderContext* pRenderContext);
 
 private:
@@ -0,0 +1,164 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVH.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Light collection holding a fixed list of random emissive triangles.
+class TestLightCollection : public ILightCollection
+{
+public:
+    TestLightCollection(ref<Device> pDevice, uint32_t triangleCount) : mpDevice(pDevice)
+    {
+        std::mt19937 rng(triangleCount);
+        std::uniform_real_distribution<float> u(0.f, 1.f);
+        mTriangles.resize(triangleCount);
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            MeshLightTriangle& tri = mTriangles[i];
+            // Every 8th triangle is placed in a cluster at the same position to exercise degenerate splits.
+            const float3 center = i % 8 == 0 ? float3(0.5f) : float3(u(rng) * 100.f, u(rng) * 10.f, u(rng) * 50.f);
+            for (uint32_t j = 0; j < 3; ++j)
+                tri.vtx[j].pos = center + float3(u(rng), u(rng), u(rng)) * 0.1f;
+            tri.normal = normalize(float3(u(rng), u(rng), u(rng)) - 0.5f);
+            // Some triangles have zero flux so that they are culled with pre-integration.
+            tri.flux = i % 16 == 1 ? 0.f : u(rng);
+            if (tri.flux > 0.f)
+                mActiveTriangleCount++;
+        }
+    }
+
+    uint32_t getActiveTriangleCount() const { return mActiveTriangleCount; }
+
+    const ref<Device>& getDevice() const override { return mpDevice; }
+    bool update(RenderContext* pRenderContext, UpdateStatus* pUpdateStatus) override { return false; }
+    void bindShaderData(const ShaderVar& var) const override {}
+    uint32_t getTotalLightCount() const override { return (uint32_t)mTriangles.size(); }
+    const MeshLightStats& getStats(RenderContext* pRenderContext) const override { return mStats; }
+    const std::vector<MeshLightTriangle>& getMeshLightTriangles(RenderContext* pRenderContext) const override { return mTriangles; }
+    const std::vector<MeshLightData>& getMeshLights() const override { return mMeshLights; }
+    void prepareSyncCPUData(RenderContext* pRenderContext) const override {}
+    uint64_t getMemoryUsageInBytes() const override { return 0; }
+    UpdateFlagsSignal::Interface getUpdateFlagsSignal() override { return mUpdateFlagsSignal.getInterface(); }
+
+private:
+    ref<Device> mpDevice;
+    std::vector<MeshLightTriangle> mTriangles;
+    std::vector<MeshLightData> mMeshLights;
+    MeshLightStats mStats;
+    UpdateFlagsSignal mUpdateFlagsSignal;
+    uint32_t mActiveTriangleCount = 0;
+};
+
+const LightBVHBuilder::SplitHeuristic kSplitHeuristics[] = {
+    LightBVHBuilder::SplitHeuristic::Equal,
+    LightBVHBuilder::SplitHeuristic::BinnedSAH,
+    LightBVHBuilder::SplitHeuristic::BinnedSAOH,
+};
+} // namespace
+
+GPU_TEST(LightBVHBuilder_Build)
+{
+    // Large enough for the top levels to be built in parallel.
+    ref<TestLightCollection> pLightCollection = make_ref<TestLightCollection>(ctx.getDevice(), 50000);
+
+    for (auto heuristic : kSplitHeuristics)
+    {
+        for (bool splitAlongLargest : {false, true})
+        {
+            LightBVHBuilder::Options options;
+            options.splitHeuristicSelection = heuristic;
+            options.splitAlongLargest = splitAlongLargest;
+            LightBVHBuilder builder(options);
+
+            LightBVH bvh(ctx.getDevice(), pLightCollection);
+            builder.build(ctx.getRenderContext(), bvh);
+            ASSERT(bvh.isValid());
+
+            const LightBVH::BVHStats& stats = bvh.getStats();
+            EXPECT_EQ(stats.triangleCount, pLightCollection->getActiveTriangleCount());
+            EXPECT_EQ(stats.internalNodeCount + 1, stats.leafNodeCount);
+
+            // The build is deterministic regardless of how the subtrees are scheduled.
+            LightBVH other(ctx.getDevice(), pLightCollection);
+            builder.build(ctx.getRenderContext(), other);
+            ASSERT(other.isValid());
+            EXPECT(other.getStats().nodeCountPerLevel == stats.nodeCountPerLevel);
+            EXPECT(other.getStats().leafCountPerTriangleCount == stats.leafCountPerTriangleCount);
+
+            // The parallel build produces the same tree as the serial one.
+            options.parallelBuild = false;
+            LightBVHBuilder serialBuilder(options);
+            LightBVH serial(ctx.getDevice(), pLightCollection);
+            serialBuilder.build(ctx.getRenderContext(), serial);
+            ASSERT(serial.isValid());
+
+            const std::vector<PackedNode>& nodes = bvh.getNodes();
+            const std::vector<PackedNode>& serialNodes = serial.getNodes();
+            ASSERT_EQ(nodes.size(), serialNodes.size());
+            EXPECT(std::memcmp(nodes.data(), serialNodes.data(), nodes.size() * sizeof(PackedNode)) == 0)
+                << "heuristic=" << enumToString(heuristic) << " splitAlongLargest=" << splitAlongLargest;
+
+            const uint32_t triangleCount = stats.triangleCount;
+            EXPECT(bvh.getTriangleIndicesBuffer()->getElements<uint32_t>(0, triangleCount) == serial.getTriangleIndicesBuffer()->getElements<uint32_t>(0, triangleCount))
+                << "heuristic=" << enumToString(heuristic) << " splitAlongLargest=" << splitAlongLargest;
+        }
+    }
+}
+
+GPU_TEST(LightBVHBuilder_Benchmark, TAGS("benchmark"))
+{
+    const uint32_t kTriangleCount = 1 << 20;
+    ref<TestLightCollection> pLightCollection = make_ref<TestLightCollection>(ctx.getDevice(), kTriangleCount);
+
+    for (auto heuristic : kSplitHeuristics)
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = heuristic;
+        LightBVHBuilder builder(options);
+
+        LightBVH bvh(ctx.getDevice(), pLightCollection);
+        CpuTimer timer;
+        timer.update();
+        builder.build(ctx.getRenderContext(), bvh);
+        timer.update();
+        ASSERT(bvh.isValid());
+
+        logInfo("LightBVHBuilder: {} triangles with {} took {:.1f} ms.", kTriangleCount, enumToString(heuristic), timer.delta() * 1000.0);
+    }
+}
+} // namespace Falcor
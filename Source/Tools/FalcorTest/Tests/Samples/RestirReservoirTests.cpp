@@ -0,0 +1,116 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Restir/Reservoir.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const float kMaxRGB9E5 = 65408.f; // (2^9 - 1) / 2^9 * 2^16
+} // namespace
+
+CPU_TEST(Restir_RGB9E5)
+{
+    using Restir::packRGB9E5;
+    using Restir::unpackRGB9E5;
+
+    // Black and NaN pack to zero.
+    EXPECT_EQ(packRGB9E5(float3(0.f)), 0u);
+    EXPECT(all(unpackRGB9E5(packRGB9E5(float3(0.f))) == float3(0.f)));
+    EXPECT_EQ(packRGB9E5(float3(std::numeric_limits<float>::quiet_NaN())), 0u);
+    EXPECT_EQ(packRGB9E5(float3(-1.f, -2.f, 0.f)), 0u);
+
+    // The largest value round trips exactly, larger values saturate to it.
+    EXPECT(all(unpackRGB9E5(packRGB9E5(float3(kMaxRGB9E5))) == float3(kMaxRGB9E5)));
+    EXPECT(all(unpackRGB9E5(packRGB9E5(float3(1e9f, kMaxRGB9E5, 0.f))) == float3(kMaxRGB9E5, kMaxRGB9E5, 0.f)));
+
+    // 511.75 rounds to a 512 mantissa, which must carry into the exponent.
+    EXPECT(all(unpackRGB9E5(packRGB9E5(float3(511.75f, 1.f, 0.f))) == float3(512.f, 2.f, 0.f)));
+
+    // Random colors are within half a mantissa step of the largest channel, or of the smallest exponent.
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        const float3 v = float3(u(rng), u(rng), u(rng)) * std::exp2(u(rng) * 30.f - 14.f);
+        const float3 r = unpackRGB9E5(packRGB9E5(v));
+        const float tolerance = std::max(std::max(v.r, std::max(v.g, v.b)) / 512.f, std::exp2(-25.f));
+        for (int c = 0; c < 3; c++)
+            EXPECT_LE(std::abs(r[c] - v[c]), tolerance) << "v = " << to_string(v) << " c = " << c;
+    }
+}
+
+CPU_TEST(Restir_PackReservoir)
+{
+    const float3 lightPosition(1.f, 2.f, 3.f);
+    const float lightRadius = 0.5f;
+
+    Restir::RestirReservoir r;
+    r.mY.mGeometryPos = float3(7.f);
+    r.mY.mLightIndex = 1234567u;
+    r.mY.mLightSampleDir = normalize(float3(0.3f, -0.8f, 0.2f));
+    r.mY.mLightSamplePosition = lightPosition + r.mY.mLightSampleDir * lightRadius;
+    r.mY.mIncomingRadiance = float3(0.25f, 2.f, 0.f);
+    r.mWsum = 3.f;
+    r.mM = 20u;
+    r.mW = 0.125f;
+    r.mHitDistance = 12.5f;
+
+    const float3 geometryPos(4.f, 5.f, 6.f);
+    Restir::RestirReservoir u = Restir::unpackReservoir(Restir::packReservoir(r), geometryPos, lightPosition, lightRadius);
+
+    EXPECT(all(u.mY.mGeometryPos == geometryPos));
+    EXPECT_EQ(u.mY.mLightIndex, r.mY.mLightIndex);
+    for (int c = 0; c < 3; c++)
+    {
+        EXPECT_LE(std::abs(u.mY.mLightSampleDir[c] - r.mY.mLightSampleDir[c]), 1e-3f) << "c = " << c;
+        EXPECT_LE(std::abs(u.mY.mLightSamplePosition[c] - r.mY.mLightSamplePosition[c]), 1e-3f) << "c = " << c;
+    }
+    EXPECT(all(u.mY.mIncomingRadiance == r.mY.mIncomingRadiance));
+    EXPECT_EQ(u.mWsum, 0.f);
+    EXPECT_EQ(u.mM, r.mM);
+    EXPECT_EQ(u.mW, r.mW);
+    EXPECT_EQ(u.mHitDistance, r.mHitDistance);
+
+    // M saturates, and misses and distances beyond the fp16 range come back as no hit.
+    r.mM = 100000u;
+    r.mHitDistance = Restir::kNoHitDistance;
+    u = Restir::unpackReservoir(Restir::packReservoir(r), geometryPos, lightPosition, lightRadius);
+    EXPECT_EQ(u.mM, Restir::kMaxPackedM);
+    EXPECT_EQ(u.mHitDistance, Restir::kNoHitDistance);
+
+    r.mHitDistance = 1e6f;
+    u = Restir::unpackReservoir(Restir::packReservoir(r), geometryPos, lightPosition, lightRadius);
+    EXPECT_EQ(u.mHitDistance, Restir::kNoHitDistance);
+}
+} // namespace Falcor
@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Keyframe translating along x, with x = time * time.
+Animation::Keyframe createKeyframe(double time)
+{
+    Animation::Keyframe keyframe;
+    keyframe.time = time;
+    keyframe.translation = float3(float(time * time), 0.f, 0.f);
+    return keyframe;
+}
+
+/// Reference linear interpolation of the x translation by a linear search.
+float interpolateReference(const std::vector<Animation::Keyframe>& keyframes, double time)
+{
+    size_t i = 0;
+    while (i + 2 < keyframes.size() && keyframes[i + 1].time <= time)
+        ++i;
+    const Animation::Keyframe& k0 = keyframes[i];
+    const Animation::Keyframe& k1 = keyframes[i + 1];
+    const float t = float((time - k0.time) / (k1.time - k0.time));
+    return k0.translation.x + (k1.translation.x - k0.translation.x) * t;
+}
+} // namespace
+
+CPU_TEST(Animation_SetKeyframes)
+{
+    std::vector<Animation::Keyframe> keyframes;
+    for (uint32_t i = 0; i < 100; ++i)
+        keyframes.push_back(createKeyframe(double(i)));
+
+    std::vector<Animation::Keyframe> shuffled = keyframes;
+    std::mt19937 rng(1);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+    // Duplicate times keep the last keyframe, as with addKeyframe().
+    Animation::Keyframe replaced = createKeyframe(10.0);
+    replaced.translation.y = 1.f;
+    shuffled.push_back(replaced);
+
+    ref<Animation> pAdded = Animation::create("added", NodeID{0}, 100.0);
+    for (const auto& keyframe : shuffled)
+        pAdded->addKeyframe(keyframe);
+
+    ref<Animation> pSet = Animation::create("set", NodeID{0}, 100.0);
+    pSet->setKeyframes(shuffled);
+
+    ASSERT_EQ(pAdded->getKeyframes().size(), keyframes.size());
+    ASSERT_EQ(pSet->getKeyframes().size(), keyframes.size());
+    for (size_t i = 0; i < keyframes.size(); ++i)
+    {
+        EXPECT_EQ(pAdded->getKeyframes()[i].time, keyframes[i].time);
+        EXPECT_EQ(pSet->getKeyframes()[i].time, keyframes[i].time);
+        EXPECT_EQ(pSet->getKeyframes()[i].translation.y, pAdded->getKeyframes()[i].translation.y);
+    }
+    EXPECT_EQ(pSet->getKeyframe(10.0).translation.y, 1.f);
+    EXPECT(pSet->doesKeyframeExists(99.0));
+    EXPECT(!pSet->doesKeyframeExists(99.5));
+}
+
+CPU_TEST(Animation_Interpolate)
+{
+    std::vector<Animation::Keyframe> keyframes;
+    for (uint32_t i = 0; i < 50; ++i)
+        keyframes.push_back(createKeyframe(0.1 * i * i));
+
+    ref<Animation> pAnimation = Animation::create("animation", NodeID{0}, keyframes.back().time);
+    pAnimation->setKeyframes(keyframes);
+
+    // Play forward with small steps, which hit the cached segment, then jump around randomly.
+    std::vector<double> times;
+    for (double time = 0.0; time < keyframes.back().time; time += 0.05)
+        times.push_back(time);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> dist(0.0, keyframes.back().time);
+    for (uint32_t i = 0; i < 1000; ++i)
+        times.push_back(dist(rng));
+
+    for (double time : times)
+    {
+        const float4x4 transform = pAnimation->animate(time);
+        const float expected = interpolateReference(keyframes, time);
+        EXPECT_LE(std::abs(transform[0][3] - expected), 1e-3f * std::max(1.f, expected)) << "time = " << time;
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/BlasGroupPlanner.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint64_t kMB = 1ull << 20;
+
+/// Check that every BLAS is in exactly one group and that the buffer ranges of a group don't overlap.
+void validatePlan(CPUUnitTestContext& ctx, const std::vector<BlasGroupPlanner::BlasSizes>& blases, const BlasGroupPlanner::Plan& plan)
+{
+    std::vector<uint32_t> useCount(blases.size(), 0);
+    uint64_t resultByteSize = 0;
+    uint64_t scratchByteSize = 0;
+    for (size_t groupIndex = 0; groupIndex < plan.groups.size(); ++groupIndex)
+    {
+        const auto& group = plan.groups[groupIndex];
+        EXPECT(!group.blasIndices.empty());
+        EXPECT(std::is_sorted(group.blasIndices.begin(), group.blasIndices.end()));
+
+        uint64_t resultByteOffset = 0;
+        uint64_t scratchByteOffset = 0;
+        for (uint32_t blasId : group.blasIndices)
+        {
+            ASSERT_LT(blasId, blases.size());
+            useCount[blasId]++;
+            EXPECT_EQ(plan.blasGroupIndices[blasId], groupIndex);
+            EXPECT_EQ(plan.resultByteOffsets[blasId], resultByteOffset);
+            EXPECT_EQ(plan.scratchByteOffsets[blasId], scratchByteOffset);
+            resultByteOffset += blases[blasId].resultByteSize;
+            scratchByteOffset += blases[blasId].scratchByteSize;
+        }
+        EXPECT_EQ(group.resultByteSize, resultByteOffset);
+        EXPECT_EQ(group.scratchByteSize, scratchByteOffset);
+        resultByteSize = std::max(resultByteSize, group.resultByteSize);
+        scratchByteSize = std::max(scratchByteSize, group.scratchByteSize);
+    }
+
+    for (uint32_t count : useCount)
+        EXPECT_EQ(count, 1u);
+    EXPECT_EQ(plan.resultByteSize, resultByteSize);
+    EXPECT_EQ(plan.scratchByteSize, scratchByteSize);
+}
+} // namespace
+
+CPU_TEST(BlasGroupPlanner_Random)
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint64_t> dist(1, 64 * kMB);
+
+    std::vector<BlasGroupPlanner::BlasSizes> blases(1000);
+    for (auto& blas : blases)
+    {
+        blas.resultByteSize = dist(rng);
+        blas.scratchByteSize = blas.resultByteSize / 2;
+    }
+
+    // Smaller budgets must give more build passes with a lower peak memory.
+    size_t prevGroupCount = 0;
+    for (uint64_t budget : {4096 * kMB, 1024 * kMB, 512 * kMB, 128 * kMB})
+    {
+        BlasGroupPlanner::Plan plan = BlasGroupPlanner::plan(blases, budget);
+        validatePlan(ctx, blases, plan);
+        EXPECT_LE(plan.getPeakMemoryInBytes(), budget);
+        EXPECT_GE(plan.groups.size(), prevGroupCount);
+        prevGroupCount = plan.groups.size();
+    }
+}
+
+CPU_TEST(BlasGroupPlanner_LargeBlas)
+{
+    // Alternating small and large BLASes, which packing in order would put in one group each.
+    std::vector<BlasGroupPlanner::BlasSizes> blases;
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        blases.push_back({100 * kMB, 50 * kMB});
+        blases.push_back({300 * kMB, 100 * kMB});
+    }
+
+    BlasGroupPlanner::Plan plan = BlasGroupPlanner::plan(blases, 512 * kMB);
+    validatePlan(ctx, blases, plan);
+    EXPECT_EQ(plan.groups.size(), 14u);
+    EXPECT_EQ(plan.getPeakMemoryInBytes(), 450 * kMB);
+
+    // A BLAS above the budget gets its own group, and the other groups can use up to its size.
+    blases.push_back({800 * kMB, 200 * kMB});
+    plan = BlasGroupPlanner::plan(blases, 512 * kMB);
+    validatePlan(ctx, blases, plan);
+    EXPECT_EQ(plan.groups[0].blasIndices.size(), 1u);
+    EXPECT_EQ(plan.getPeakMemoryInBytes(), 1000 * kMB);
+    EXPECT_EQ(plan.groups.size(), 9u);
+}
+
+CPU_TEST(BlasGroupPlanner_Empty)
+{
+    BlasGroupPlanner::Plan plan = BlasGroupPlanner::plan({});
+    EXPECT(plan.groups.empty());
+    EXPECT_EQ(plan.getPeakMemoryInBytes(), 0u);
+}
+} // namespace Falcor
@@ -0,0 +1,132 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialTextureCache.h"
+
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+using CompressionMode = ImageIO::CompressionMode;
+
+void writeFile(const std::filesystem::path& path, const std::string& content)
+{
+    std::ofstream(path, std::ios::binary) << content;
+}
+
+uint32_t getCompressionMode(Material::TextureSlot slot, TextureChannelFlags mask, ResourceFormat format)
+{
+    Material::TextureSlotInfo slotInfo;
+    slotInfo.mask = mask;
+    return (uint32_t)MaterialTextureCache::getCompressionMode(slot, slotInfo, format);
+}
+} // namespace
+
+CPU_TEST(MaterialTextureCache_Index)
+{
+    // The index only refers to cached textures in the cache directory. Create a dummy cached texture there, and remove it and the
+    // directory afterwards if the directory didn't exist, so that isAvailable() doesn't change.
+    const auto cacheDirectory = MaterialTextureCache::getDirectory();
+    const bool createdDirectory = std::filesystem::create_directories(cacheDirectory);
+    const auto cachePath = cacheDirectory / "test_material_texture_cache.dds";
+    writeFile(cachePath, "dds");
+
+    const auto sourcePath = getRuntimeDirectory() / "test_material_texture_cache.png";
+    writeFile(sourcePath, "source");
+
+    Material::TextureSlotInfo slotInfo;
+    slotInfo.mask = TextureChannelFlags::RGB;
+    Material::TextureSlotInfo alphaSlotInfo;
+    alphaSlotInfo.mask = TextureChannelFlags::RGBA;
+
+    MaterialTextureCache::Index index;
+    EXPECT_EQ(index.getSize(), 0);
+    EXPECT(index.find(sourcePath, Material::TextureSlot::BaseColor, slotInfo).empty());
+
+    index.add(sourcePath, Material::TextureSlot::BaseColor, slotInfo, cachePath);
+    EXPECT_EQ(index.getSize(), 1);
+    EXPECT(index.find(sourcePath, Material::TextureSlot::BaseColor, slotInfo) == cachePath);
+
+    // Equivalent paths to the source file find the same entry.
+    const auto otherSourcePath = getRuntimeDirectory() / "." / sourcePath.filename();
+    EXPECT(index.find(otherSourcePath, Material::TextureSlot::BaseColor, slotInfo) == cachePath);
+
+    // The texture slot and the channel mask are part of the key.
+    EXPECT(index.find(sourcePath, Material::TextureSlot::Specular, slotInfo).empty());
+    EXPECT(index.find(sourcePath, Material::TextureSlot::BaseColor, alphaSlotInfo).empty());
+
+    // A source file that changed is not found anymore.
+    writeFile(sourcePath, "changed source");
+    EXPECT(index.find(sourcePath, Material::TextureSlot::BaseColor, slotInfo).empty());
+    index.add(sourcePath, Material::TextureSlot::BaseColor, slotInfo, cachePath);
+    EXPECT_EQ(index.getSize(), 1);
+    EXPECT(index.find(sourcePath, Material::TextureSlot::BaseColor, slotInfo) == cachePath);
+
+    // Neither is a cached texture that was removed.
+    std::filesystem::remove(cachePath);
+    EXPECT(index.find(sourcePath, Material::TextureSlot::BaseColor, slotInfo).empty());
+
+    // Source files that don't exist are not added.
+    std::filesystem::remove(sourcePath);
+    index.add(getRuntimeDirectory() / "missing.png", Material::TextureSlot::BaseColor, slotInfo, cachePath);
+    EXPECT_EQ(index.getSize(), 1);
+
+    if (createdDirectory)
+        std::filesystem::remove(cacheDirectory);
+}
+
+CPU_TEST(MaterialTextureCache_CompressionMode)
+{
+    using Slot = Material::TextureSlot;
+
+    EXPECT(!MaterialTextureCache::isSlotCacheable(Slot::Index));
+    EXPECT(MaterialTextureCache::isSlotCacheable(Slot::BaseColor));
+
+    // Index textures and textures that are already compressed are not cached.
+    EXPECT_EQ(getCompressionMode(Slot::Index, TextureChannelFlags::Red, ResourceFormat::R8Unorm), (uint32_t)CompressionMode::None);
+    EXPECT_EQ(getCompressionMode(Slot::BaseColor, TextureChannelFlags::RGB, ResourceFormat::BC1Unorm), (uint32_t)CompressionMode::None);
+
+    // Normal maps and displacement maps are only cached if they are unorm.
+    EXPECT_EQ(getCompressionMode(Slot::Normal, TextureChannelFlags::RGB, ResourceFormat::RGBA8Unorm), (uint32_t)CompressionMode::BC5);
+    EXPECT_EQ(getCompressionMode(Slot::Normal, TextureChannelFlags::RGB, ResourceFormat::RGBA32Float), (uint32_t)CompressionMode::None);
+    EXPECT_EQ(getCompressionMode(Slot::Displacement, TextureChannelFlags::RGB, ResourceFormat::R8Unorm), (uint32_t)CompressionMode::BC4);
+    EXPECT_EQ(getCompressionMode(Slot::Displacement, TextureChannelFlags::RGB, ResourceFormat::RGBA16Float), (uint32_t)CompressionMode::None);
+
+    // HDR textures use BC6, unless they have alpha.
+    EXPECT_EQ(getCompressionMode(Slot::Emissive, TextureChannelFlags::RGB, ResourceFormat::RGBA16Float), (uint32_t)CompressionMode::BC6);
+    EXPECT_EQ(getCompressionMode(Slot::BaseColor, TextureChannelFlags::RGBA, ResourceFormat::RGBA32Float), (uint32_t)CompressionMode::None);
+
+    // Other unorm textures use BC4 if they have a single channel, and BC7 otherwise.
+    EXPECT_EQ(getCompressionMode(Slot::BaseColor, TextureChannelFlags::RGBA, ResourceFormat::RGBA8Unorm), (uint32_t)CompressionMode::BC7);
+    EXPECT_EQ(getCompressionMode(Slot::BaseColor, TextureChannelFlags::RGBA, ResourceFormat::RGBA8UnormSrgb), (uint32_t)CompressionMode::BC7);
+    EXPECT_EQ(getCompressionMode(Slot::Transmission, TextureChannelFlags::Red, ResourceFormat::R8Unorm), (uint32_t)CompressionMode::BC4);
+    EXPECT_EQ(getCompressionMode(Slot::BaseColor, TextureChannelFlags::RGBA, ResourceFormat::R8Uint), (uint32_t)CompressionMode::None);
+}
+} // namespace Falcor
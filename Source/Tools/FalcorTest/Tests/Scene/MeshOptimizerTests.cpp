@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using Triangle = std::array<uint32_t, 3>;
+
+/// Indices of a grid of quads, with the triangles in random order.
+std::vector<uint32_t> createShuffledGrid(uint32_t size)
+{
+    std::vector<Triangle> triangles;
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            const uint32_t v = y * (size + 1) + x;
+            triangles.push_back({v, v + 1, v + size + 1});
+            triangles.push_back({v + 1, v + size + 2, v + size + 1});
+        }
+    }
+
+    std::mt19937 rng(1);
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    std::vector<uint32_t> indices;
+    for (const Triangle& triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    return indices;
+}
+
+/// Sorted list of the triangles, each rotated to start with its smallest index so that the winding is compared too.
+std::vector<Triangle> getSortedTriangles(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& vertices)
+{
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        Triangle triangle = {vertices[indices[i]], vertices[indices[i + 1]], vertices[indices[i + 2]]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+} // namespace
+
+CPU_TEST(MeshOptimizer_CountVertexCacheMisses)
+{
+    // With a FIFO, hits don't refresh the entries.
+    const uint32_t indices[] = {0, 1, 2, 0, 3, 0, 1};
+    EXPECT_EQ(MeshOptimizer::countVertexCacheMisses(indices, 4, 4, 3), 3u);
+    EXPECT_EQ(MeshOptimizer::countVertexCacheMisses(indices, 6, 4, 3), 5u);
+    EXPECT_EQ(MeshOptimizer::countVertexCacheMisses(indices, 7, 4, 3), 6u);
+
+    const uint16_t indices16[] = {0, 1, 2, 2, 1, 3};
+    EXPECT_EQ(MeshOptimizer::countVertexCacheMisses(indices16, 6, 4, 3), 4u);
+}
+
+CPU_TEST(MeshOptimizer_OptimizeGrid)
+{
+    const uint32_t gridSize = 64;
+    const uint32_t vertexCount = (gridSize + 1) * (gridSize + 1);
+    const std::vector<uint32_t> shuffledIndices = createShuffledGrid(gridSize);
+    const size_t triangleCount = shuffledIndices.size() / 3;
+
+    std::vector<uint32_t> vertices(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; ++i)
+        vertices[i] = i;
+    const std::vector<Triangle> triangles = getSortedTriangles(shuffledIndices, vertices);
+
+    std::vector<uint32_t> indices = shuffledIndices;
+    MeshOptimizer::optimizeVertexCache(indices, vertexCount);
+    ASSERT_EQ(indices.size(), shuffledIndices.size());
+    EXPECT(getSortedTriangles(indices, vertices) == triangles);
+
+    // Random order misses almost every vertex, a cache optimized grid should approach 0.5 misses per triangle.
+    const uint64_t shuffledMissCount = MeshOptimizer::countVertexCacheMisses(shuffledIndices.data(), shuffledIndices.size(), vertexCount);
+    const uint64_t optimizedMissCount = MeshOptimizer::countVertexCacheMisses(indices.data(), indices.size(), vertexCount);
+    EXPECT_GT(double(shuffledMissCount) / triangleCount, 2.5);
+    EXPECT_LT(double(optimizedMissCount) / triangleCount, 0.8);
+
+    // The vertices must be numbered in order of first use, without changing the triangles.
+    const std::vector<uint32_t> remap = MeshOptimizer::optimizeVertexFetch(indices, vertexCount);
+    MeshOptimizer::remapVertices(remap, vertices);
+    EXPECT(getSortedTriangles(indices, vertices) == triangles);
+
+    uint32_t nextVertex = 0;
+    for (uint32_t index : indices)
+    {
+        EXPECT_LE(index, nextVertex);
+        nextVertex = std::max(nextVertex, index + 1);
+    }
+    EXPECT_EQ(nextVertex, vertexCount);
+    EXPECT_EQ(MeshOptimizer::countVertexCacheMisses(indices.data(), indices.size(), vertexCount), optimizedMissCount);
+}
+
+CPU_TEST(MeshOptimizer_UnreferencedVertices)
+{
+    // Vertices 0 and 3 are not used and are moved to the end in their original order.
+    std::vector<uint32_t> indices = {4, 2, 1};
+    const std::vector<uint32_t> remap = MeshOptimizer::optimizeVertexFetch(indices, 5);
+    EXPECT(indices == std::vector<uint32_t>({0, 1, 2}));
+    EXPECT(remap == std::vector<uint32_t>({3, 2, 1, 4, 0}));
+}
+} // namespace Falcor
@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+
+#include <cstring>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Source data of a cube with one normal per face, so that the corners are split into 24 vertices when merging duplicates.
+struct CubeData
+{
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+    std::vector<uint32_t> indices;
+
+    CubeData(float3 offset)
+    {
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            const float3 corner = float3(float(i & 1), float((i >> 1) & 1), float((i >> 2) & 1));
+            positions.push_back(offset + corner);
+            texCrds.push_back(corner.xy());
+        }
+
+        // Each face is given by its 4 corners in counter-clockwise order and its normal.
+        const uint32_t faces[6][4] = {{0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+        const float3 faceNormals[6] = {{0, 0, -1}, {0, 0, 1}, {0, -1, 0}, {0, 1, 0}, {-1, 0, 0}, {1, 0, 0}};
+        for (uint32_t f = 0; f < 6; ++f)
+        {
+            for (uint32_t i : {0, 1, 2, 0, 2, 3})
+                indices.push_back(faces[f][i]);
+            normals.push_back(faceNormals[f]);
+            normals.push_back(faceNormals[f]);
+        }
+    }
+
+    SceneBuilder::Mesh getMesh(const ref<Material>& pMaterial) const
+    {
+        SceneBuilder::Mesh mesh;
+        mesh.name = "cube";
+        mesh.faceCount = (uint32_t)indices.size() / 3;
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+        mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {normals.data(), SceneBuilder::Mesh::AttributeFrequency::Uniform};
+        mesh.texCrds = {texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        return mesh;
+    }
+};
+
+template<typename T>
+bool isEqual(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+} // namespace
+
+GPU_TEST(SceneBuilder_AddMeshes)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "cube");
+
+    std::vector<CubeData> cubes;
+    for (uint32_t i = 0; i < 100; ++i)
+        cubes.emplace_back(float3(float(i), 0.f, 0.f));
+
+    std::vector<SceneBuilder::Mesh> meshes;
+    for (const auto& cube : cubes)
+        meshes.push_back(cube.getMesh(pMaterial));
+
+    SceneBuilder builder(pDevice, Settings());
+
+    // The batch must give the same results as processing the meshes one by one.
+    std::vector<SceneBuilder::ProcessedMesh> processedMeshes = builder.processMeshes(meshes);
+    ASSERT_EQ(processedMeshes.size(), meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        SceneBuilder::ProcessedMesh processedMesh = builder.processMesh(meshes[i]);
+        EXPECT_EQ(processedMeshes[i].staticData.size(), 24u);
+        EXPECT_EQ(processedMeshes[i].indexCount, 36u);
+        EXPECT(isEqual(processedMeshes[i].indexData, processedMesh.indexData));
+        EXPECT(isEqual(processedMeshes[i].staticData, processedMesh.staticData));
+    }
+
+    // The meshes must be added in order.
+    std::vector<MeshID> meshIDs = builder.addMeshes(meshes);
+    ASSERT_EQ(meshIDs.size(), meshes.size());
+    for (size_t i = 0; i < meshIDs.size(); ++i)
+        EXPECT_EQ((size_t)meshIDs[i].get(), i);
+}
+} // namespace Falcor
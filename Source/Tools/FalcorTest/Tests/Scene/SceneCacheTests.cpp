@@ -0,0 +1,117 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneCache.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Source data of a single triangle.
+struct TriangleData
+{
+    std::vector<float3> positions = {float3(0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f)};
+    std::vector<uint32_t> indices = {0, 1, 2};
+
+    SceneBuilder::Mesh getMesh() const
+    {
+        SceneBuilder::Mesh mesh;
+        mesh.name = "triangle";
+        mesh.faceCount = 1;
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        return mesh;
+    }
+};
+
+void writeFile(const std::filesystem::path& path, size_t size)
+{
+    std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+}
+} // namespace
+
+CPU_TEST(SceneCache_MeshCacheKey)
+{
+    TriangleData triangle;
+    const SceneBuilder::Flags flags = SceneBuilder::Flags::UseCache;
+    const SceneCache::Key key = SceneCache::computeMeshCacheKey(triangle.getMesh(), flags, 1);
+
+    // The key only depends on the mesh data, the flags that affect the processing and the processing version.
+    EXPECT(SceneCache::computeMeshCacheKey(triangle.getMesh(), flags, 1) == key);
+    EXPECT(SceneCache::computeMeshCacheKey(triangle.getMesh(), flags | SceneBuilder::Flags::DontMergeMaterials, 1) == key);
+    EXPECT(SceneCache::computeMeshCacheKey(triangle.getMesh(), flags | SceneBuilder::Flags::Force32BitIndices, 1) != key);
+
+    // Changing the processing version invalidates the cached meshes.
+    EXPECT(SceneCache::computeMeshCacheKey(triangle.getMesh(), flags, 2) != key);
+
+    SceneBuilder::Mesh mesh = triangle.getMesh();
+    mesh.mergeDuplicateVertices = false;
+    EXPECT(SceneCache::computeMeshCacheKey(mesh, flags, 1) != key);
+
+    triangle.positions[2].z = 1.f;
+    EXPECT(SceneCache::computeMeshCacheKey(triangle.getMesh(), flags, 1) != key);
+}
+
+CPU_TEST(SceneCache_PruneMeshCache)
+{
+    const auto directory = getRuntimeDirectory() / "test_mesh_cache";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // Five files of 100 bytes, used from oldest to newest, and a temporary file left by an interrupted write.
+    const auto now = std::filesystem::file_time_type::clock::now();
+    for (int i = 0; i < 5; i++)
+    {
+        const auto path = directory / std::to_string(i);
+        writeFile(path, 100);
+        std::filesystem::last_write_time(path, now - std::chrono::hours(5 - i));
+    }
+    writeFile(directory / "5.1234.tmp", 100);
+
+    // Within the bound, only the temporary file is removed.
+    SceneCache::pruneMeshCache(directory, 500);
+    EXPECT(!std::filesystem::exists(directory / "5.1234.tmp"));
+    for (int i = 0; i < 5; i++)
+        EXPECT(std::filesystem::exists(directory / std::to_string(i))) << "i=" << i;
+
+    // Beyond the bound, the least recently used files are removed first.
+    SceneCache::pruneMeshCache(directory, 250);
+    for (int i = 0; i < 5; i++)
+        EXPECT_EQ(std::filesystem::exists(directory / std::to_string(i)), i >= 3) << "i=" << i;
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
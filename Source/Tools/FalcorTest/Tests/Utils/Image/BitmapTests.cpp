@@ -74,4 +74,58 @@ GPU_TEST(Bitmap_LinearRamp_PNG)
     // Delete the test file.
     std::filesystem::remove(path);
 }
+
+CPU_TEST(Bitmap_CreateMip)
+{
+    EXPECT(Bitmap::isMipGenerationSupported(ResourceFormat::RGBA8UnormSrgb));
+    EXPECT(Bitmap::isMipGenerationSupported(ResourceFormat::RG16Float));
+    EXPECT(!Bitmap::isMipGenerationSupported(ResourceFormat::BC1Unorm));
+    EXPECT(!Bitmap::isMipGenerationSupported(ResourceFormat::R11G11B10Float));
+    EXPECT(!Bitmap::isMipGenerationSupported(ResourceFormat::RGBA8Uint));
+
+    // Test that odd sizes average the leftover row and column into the last texels.
+    {
+        float data[3 * 3 * 4];
+        for (uint32_t i = 0; i < 3 * 3; i++)
+            for (uint32_t c = 0; c < 4; c++)
+                data[i * 4 + c] = float(i + 10 * c);
+
+        auto bmp = Bitmap::create(3, 3, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(data));
+        auto mip = Bitmap::createMip(*bmp, false);
+        EXPECT_EQ(mip->getWidth(), 1);
+        EXPECT_EQ(mip->getHeight(), 1);
+        EXPECT_EQ((uint32_t)mip->getFormat(), (uint32_t)ResourceFormat::RGBA32Float);
+
+        const float* mipData = reinterpret_cast<const float*>(mip->getData());
+        for (uint32_t c = 0; c < 4; c++)
+            EXPECT_EQ(mipData[c], float(4 + 10 * c)) << "c=" << c;
+    }
+    {
+        const float data[] = {0.f, 1.f, 2.f, 3.f, 7.f};
+        auto bmp = Bitmap::create(5, 1, ResourceFormat::R32Float, reinterpret_cast<const uint8_t*>(data));
+        auto mip = Bitmap::createMip(*bmp, false);
+        EXPECT_EQ(mip->getWidth(), 2);
+        EXPECT_EQ(mip->getHeight(), 1);
+
+        const float* mipData = reinterpret_cast<const float*>(mip->getData());
+        EXPECT_EQ(mipData[0], 0.5f);
+        EXPECT_EQ(mipData[1], 4.f);
+    }
+
+    // Test that sRGB color channels are averaged in linear space, but not alpha.
+    {
+        const uint8_t data[] = {255, 255, 255, 255, 0, 0, 0, 0};
+        auto bmp = Bitmap::create(2, 1, ResourceFormat::RGBA8UnormSrgb, data);
+
+        auto mip = Bitmap::createMip(*bmp, true);
+        EXPECT_EQ(mip->getWidth(), 1);
+        EXPECT_EQ(mip->getHeight(), 1);
+
+        const uint8_t* mipData = mip->getData();
+        EXPECT_EQ(mipData[0], 188);
+        EXPECT_EQ(mipData[1], 188);
+        EXPECT_EQ(mipData[2], 188);
+        EXPECT_EQ(mipData[3], 128);
+    }
+}
 } // namespace Falcor
@@ -0,0 +1,286 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/PixelConversion.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Timing/CpuTimer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+using PixelConversion::Isa;
+
+const Isa kIsas[] = {Isa::Scalar, Isa::AVX2};
+
+/// Restores the instruction set selected at startup when going out of scope.
+struct IsaScope
+{
+    Isa isa = PixelConversion::getIsa();
+    ~IsaScope() { PixelConversion::setIsa(isa); }
+};
+
+// Odd count to exercise the scalar remainder of the vectorized kernels.
+const size_t kCount = 10007;
+
+template<typename T>
+void testIntToFloat32(CPUUnitTestContext& ctx, std::mt19937& rng)
+{
+    std::uniform_int_distribution<int64_t> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    std::vector<T> src(kCount);
+    for (auto& v : src)
+        v = (T)dist(rng);
+    src[0] = std::numeric_limits<T>::min();
+    src[1] = std::numeric_limits<T>::max();
+
+    for (Isa isa : kIsas)
+    {
+        PixelConversion::setIsa(isa);
+        std::vector<float> dst(kCount);
+        PixelConversion::convertIntToFloat32(src.data(), dst.data(), kCount);
+        for (size_t i = 0; i < kCount; i++)
+            EXPECT_EQ(dst[i], float(src[i]) / float(std::numeric_limits<T>::max())) << "i=" << i << " isa=" << (int)isa;
+    }
+}
+} // namespace
+
+CPU_TEST(PixelConversion_Float16)
+{
+    IsaScope scope;
+
+    // All half floats convert exactly.
+    std::vector<float16_t> halfs(65536);
+    for (uint32_t i = 0; i < 65536; i++)
+        halfs[i] = float16_t::fromBits((uint16_t)i);
+
+    for (Isa isa : kIsas)
+    {
+        PixelConversion::setIsa(isa);
+        std::vector<float> floats(halfs.size());
+        PixelConversion::convertFloat16ToFloat32(halfs.data(), floats.data(), halfs.size());
+        for (uint32_t i = 0; i < 65536; i++)
+        {
+            const float expected = float(halfs[i]);
+            if (std::isnan(expected))
+                EXPECT(std::isnan(floats[i])) << "i=" << i;
+            else
+                EXPECT_EQ(floats[i], expected) << "i=" << i << " isa=" << (int)isa;
+        }
+    }
+
+    // Floats round to the nearest half float, ties can round either way.
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-70000.f, 70000.f);
+    std::vector<float> floats(kCount);
+    for (auto& v : floats)
+        v = dist(rng);
+    for (Isa isa : kIsas)
+    {
+        PixelConversion::setIsa(isa);
+        std::vector<float16_t> dst(kCount);
+        PixelConversion::convertFloat32ToFloat16(floats.data(), dst.data(), kCount);
+        for (size_t i = 0; i < kCount; i++)
+            EXPECT_LE(std::abs(int(dst[i].toBits()) - int(float16_t(floats[i]).toBits())), 1) << "i=" << i << " isa=" << (int)isa;
+    }
+}
+
+CPU_TEST(PixelConversion_IntToFloat32)
+{
+    IsaScope scope;
+    std::mt19937 rng;
+    testIntToFloat32<uint16_t>(ctx, rng);
+    testIntToFloat32<int16_t>(ctx, rng);
+    testIntToFloat32<uint32_t>(ctx, rng);
+    testIntToFloat32<int32_t>(ctx, rng);
+}
+
+CPU_TEST(PixelConversion_Channels)
+{
+    IsaScope scope;
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    std::vector<float> src(kCount * 4);
+    for (auto& v : src)
+        v = dist(rng);
+
+    for (Isa isa : kIsas)
+    {
+        PixelConversion::setIsa(isa);
+
+        for (uint32_t channelCount = 1; channelCount <= 4; channelCount++)
+        {
+            std::vector<float> dst(kCount * 4);
+            PixelConversion::expandToRGBA32Float(src.data(), channelCount, dst.data(), kCount, 0.5f);
+            for (size_t i = 0; i < kCount; i++)
+            {
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    float expected = c < channelCount ? src[i * channelCount + c] : (c == 3 ? 0.5f : 0.f);
+                    EXPECT_EQ(dst[i * 4 + c], expected) << "i=" << i << " c=" << c << " channelCount=" << channelCount;
+                }
+            }
+        }
+
+        std::vector<float> rgb(kCount * 3);
+        PixelConversion::convertRGBA32FloatToRGB32Float(src.data(), rgb.data(), kCount);
+        for (size_t i = 0; i < kCount; i++)
+            for (uint32_t c = 0; c < 3; c++)
+                EXPECT_EQ(rgb[i * 3 + c], src[i * 4 + c]) << "i=" << i << " c=" << c;
+
+        for (bool opaqueAlpha : {false, true})
+        {
+            std::vector<uint32_t> pixels(kCount);
+            for (auto& p : pixels)
+                p = rng();
+            std::vector<uint32_t> swapped = pixels;
+            PixelConversion::swapRedBlue8(swapped.data(), swapped.data(), kCount, opaqueAlpha);
+            for (size_t i = 0; i < kCount; i++)
+            {
+                uint32_t p = pixels[i];
+                uint32_t expected = (p & 0x0000ff00) | ((p >> 16) & 0xff) | ((p & 0xff) << 16) | (opaqueAlpha ? 0xff000000 : (p & 0xff000000));
+                EXPECT_EQ(swapped[i], expected) << "i=" << i;
+            }
+        }
+    }
+}
+
+CPU_TEST(PixelConversion_Srgb)
+{
+    IsaScope scope;
+
+    // Decoding and encoding all 8-bit values is lossless.
+    std::vector<uint8_t> values(256);
+    for (uint32_t i = 0; i < 256; i++)
+        values[i] = (uint8_t)i;
+
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(-0.1f, 1.1f);
+    std::vector<float> linear(kCount);
+    for (auto& v : linear)
+        v = dist(rng);
+    linear[0] = std::numeric_limits<float>::quiet_NaN();
+    linear[1] = std::numeric_limits<float>::infinity();
+
+    for (Isa isa : kIsas)
+    {
+        PixelConversion::setIsa(isa);
+
+        std::vector<float> decoded(256);
+        std::vector<uint8_t> encoded(256);
+        PixelConversion::convertSrgb8ToLinear32Float(values.data(), decoded.data(), 256);
+        PixelConversion::convertLinear32FloatToSrgb8(decoded.data(), encoded.data(), 256);
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            EXPECT_EQ(decoded[i], sRGBToLinear(i / 255.f)) << "i=" << i;
+            EXPECT_EQ(encoded[i], i) << "i=" << i;
+        }
+
+        // Encoding matches the exact formula.
+        std::vector<uint8_t> dst(kCount);
+        PixelConversion::convertLinear32FloatToSrgb8(linear.data(), dst.data(), kCount);
+        EXPECT_EQ(dst[0], 0);
+        EXPECT_EQ(dst[1], 255);
+        for (size_t i = 2; i < kCount; i++)
+        {
+            uint32_t expected = (uint32_t)(std::clamp(linearToSRGB(linear[i]), 0.f, 1.f) * 255.f + 0.5f);
+            EXPECT_EQ(dst[i], expected) << "i=" << i << " value=" << linear[i];
+            EXPECT_EQ(PixelConversion::linearToSrgb8(linear[i]), expected) << "i=" << i;
+        }
+    }
+}
+
+CPU_TEST(PixelConversion_Benchmark, TAGS("benchmark"))
+{
+    IsaScope scope;
+
+    // A 2048x2048 RGBA image.
+    const size_t kValueCount = 2048 * 2048 * 4;
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    std::vector<float> floats(kValueCount);
+    for (auto& v : floats)
+        v = dist(rng);
+    std::vector<float16_t> halfs(kValueCount);
+    std::vector<uint16_t> ints(kValueCount);
+    for (auto& v : ints)
+        v = (uint16_t)rng();
+    std::vector<uint8_t> bytes(kValueCount);
+    for (auto& v : bytes)
+        v = (uint8_t)rng();
+    std::vector<uint8_t> dstBytes(kValueCount);
+    std::vector<float> dst(kValueCount);
+
+    // Times the conversion with each instruction set, and checks that they all write the same output as the scalar one.
+    // The output is not checked if pOutput is nullptr.
+    auto run = [&](const char* name, const void* pOutput, size_t outputSize, auto func)
+    {
+        std::vector<uint8_t> scalarOutput;
+        for (Isa isa : kIsas)
+        {
+            if (PixelConversion::setIsa(isa) != isa)
+                continue;
+            CpuTimer timer;
+            timer.update();
+            func();
+            timer.update();
+            logInfo("PixelConversion: {} ({}) took {:.2f} ms.", name, isa == Isa::AVX2 ? "AVX2" : "scalar", timer.delta() * 1000.0);
+
+            const uint8_t* pBytes = static_cast<const uint8_t*>(pOutput);
+            if (!pBytes)
+                continue;
+            if (isa == Isa::Scalar)
+                scalarOutput.assign(pBytes, pBytes + outputSize);
+            else
+                EXPECT(std::equal(scalarOutput.begin(), scalarOutput.end(), pBytes)) << name;
+        }
+    };
+
+    // The scalar implementation is the conversion previously done by Bitmap.
+    // Float16 ties round differently with each instruction set, PixelConversion_Float16 checks the rounding instead.
+    run("float32 to float16", nullptr, 0,
+        [&]() { PixelConversion::convertFloat32ToFloat16(floats.data(), halfs.data(), kValueCount); });
+    run("float16 to float32", dst.data(), kValueCount * sizeof(float),
+        [&]() { PixelConversion::convertFloat16ToFloat32(halfs.data(), dst.data(), kValueCount); });
+    run("uint16 to float32", dst.data(), kValueCount * sizeof(float),
+        [&]() { PixelConversion::convertIntToFloat32(ints.data(), dst.data(), kValueCount); });
+    run("RGB to RGBA float32", dst.data(), kValueCount * sizeof(float),
+        [&]() { PixelConversion::expandToRGBA32Float(floats.data(), 3, dst.data(), kValueCount / 4, 1.f); });
+    run("RGBA to BGRA 8-bit", dstBytes.data(), kValueCount,
+        [&]() { PixelConversion::swapRedBlue8((const uint32_t*)bytes.data(), (uint32_t*)dstBytes.data(), kValueCount / 4, true); });
+    run("linear to sRGB 8-bit", dstBytes.data(), kValueCount,
+        [&]() { PixelConversion::convertLinear32FloatToSrgb8(floats.data(), dstBytes.data(), kValueCount); });
+    run("sRGB 8-bit to linear", dst.data(), kValueCount * sizeof(float),
+        [&]() { PixelConversion::convertSrgb8ToLinear32Float(bytes.data(), dst.data(), kValueCount); });
+}
+} // namespace Falcor
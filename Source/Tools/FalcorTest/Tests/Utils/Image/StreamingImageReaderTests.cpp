@@ -0,0 +1,216 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Image/StreamingImageReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 37;
+const uint32_t kHeight = 23;
+
+std::vector<float> createTestImage()
+{
+    std::vector<float> data(kWidth * kHeight * 4);
+    for (uint32_t y = 0; y < kHeight; y++)
+    {
+        for (uint32_t x = 0; x < kWidth; x++)
+        {
+            float* pPixel = &data[(y * kWidth + x) * 4];
+            pPixel[0] = x * 0.25f;
+            pPixel[1] = y * 2.f;
+            pPixel[2] = (x + y) * 0.125f;
+            pPixel[3] = (x % 4) * 0.25f;
+        }
+    }
+    return data;
+}
+
+/// Save the test image as an uncompressed EXR with 32-bit float or 16-bit float channels.
+/// All values of the test image are exactly representable as 16-bit floats.
+void saveTestImageExr(const std::filesystem::path& path, const std::vector<float>& data, bool float16)
+{
+    Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::Uncompressed;
+    if (float16)
+        exportFlags |= Bitmap::ExportFlags::ExrFloat16;
+    Bitmap::saveImage(
+        path, kWidth, kHeight, Bitmap::FileFormat::ExrFile, exportFlags, ResourceFormat::RGBA32Float, true /* top-down */, data.data()
+    );
+}
+
+/// Read all rows in blocks of a few rows.
+std::vector<float> readAllRows(StreamingImageReader& reader)
+{
+    std::vector<float> data(reader.getWidth() * reader.getHeight() * 4);
+    while (reader.getRowsRead() < reader.getHeight())
+    {
+        if (reader.readRows(&data[reader.getRowsRead() * reader.getWidth() * 4], 5) == 0)
+            break;
+    }
+    return data;
+}
+} // namespace
+
+CPU_TEST(StreamingImageReader_Exr)
+{
+    const auto path = getRuntimeDirectory() / "test_streaming_reader.exr";
+    std::vector<float> data = createTestImage();
+
+    for (bool float16 : {false, true})
+    {
+        saveTestImageExr(path, data, float16);
+
+        auto pReader = StreamingImageReader::open(path);
+        EXPECT(pReader != nullptr) << "float16=" << float16;
+        if (pReader)
+        {
+            EXPECT_EQ(pReader->getWidth(), kWidth);
+            EXPECT_EQ(pReader->getHeight(), kHeight);
+            EXPECT_EQ(pReader->isFloat16(), float16);
+
+            std::vector<float> result = readAllRows(*pReader);
+            EXPECT_EQ(pReader->getRowsRead(), kHeight);
+            for (size_t i = 0; i < data.size(); i++)
+                EXPECT_EQ(result[i], data[i]) << "i=" << i << " float16=" << float16;
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(StreamingImageReader_Hdr)
+{
+    const auto path = getRuntimeDirectory() / "test_streaming_reader.hdr";
+
+    // Write run-length encoded scanlines, with runs of 4 pixels and literals for the exponents.
+    auto getRgbe = [](uint32_t x, uint32_t y, uint32_t c) { return uint8_t(c == 3 ? 128 + (x + y) % 5 : (x / 4) * 7 + y + c); };
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << kHeight << " +X " << kWidth << "\n";
+        for (uint32_t y = 0; y < kHeight; y++)
+        {
+            const char header[4] = {2, 2, char(kWidth >> 8), char(kWidth & 0xff)};
+            stream.write(header, 4);
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                for (uint32_t x = 0; x < kWidth; x += 4)
+                {
+                    stream.put(char(128 + std::min(4u, kWidth - x)));
+                    stream.put(char(getRgbe(x, y, c)));
+                }
+            }
+            stream.put(char(kWidth));
+            for (uint32_t x = 0; x < kWidth; x++)
+                stream.put(char(getRgbe(x, y, 3)));
+        }
+    }
+
+    auto pReader = StreamingImageReader::open(path);
+    EXPECT(pReader != nullptr);
+    if (pReader)
+    {
+        EXPECT_EQ(pReader->getWidth(), kWidth);
+        EXPECT_EQ(pReader->getHeight(), kHeight);
+
+        // The streamed rows match the image decoded by Bitmap.
+        std::vector<float> result = readAllRows(*pReader);
+        auto pBitmap = Bitmap::createFromFile(path, true /* top-down */);
+        EXPECT(pBitmap != nullptr);
+        if (pBitmap)
+        {
+            EXPECT_EQ((uint32_t)pBitmap->getFormat(), (uint32_t)ResourceFormat::RGBA32Float);
+            const float* pBitmapData = reinterpret_cast<const float*>(pBitmap->getData());
+            for (size_t i = 0; i < result.size(); i++)
+            {
+                if (i % 4 != 3)
+                    EXPECT_EQ(result[i], pBitmapData[i]) << "i=" << i;
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+GPU_TEST(ImageIO_LoadTextureStreaming)
+{
+    const auto path = getRuntimeDirectory() / "test_streaming_texture.exr";
+    std::vector<float> data = createTestImage();
+
+    for (bool float16 : {false, true})
+    {
+        saveTestImageExr(path, data, float16);
+
+        // Drop two levels, the last row and column average the source pixels left over.
+        ref<Texture> pTex = ImageIO::loadTextureStreaming(ctx.getDevice(), path, true, 10);
+        EXPECT(pTex != nullptr) << "float16=" << float16;
+        if (!pTex)
+            continue;
+
+        const uint32_t width = kWidth / 4;
+        const uint32_t height = kHeight / 4;
+        EXPECT_EQ(pTex->getWidth(), width);
+        EXPECT_EQ(pTex->getHeight(), height);
+        EXPECT_EQ(pTex->getMipCount(), 4);
+        EXPECT_EQ((uint32_t)pTex->getFormat(), (uint32_t)(float16 ? ResourceFormat::RGBA16Float : ResourceFormat::RGBA32Float));
+
+        std::vector<uint8_t> rawData = ctx.getRenderContext()->readTextureSubresource(pTex.get(), 0);
+        auto getResult = [&](size_t i)
+        { return float16 ? float(reinterpret_cast<const float16_t*>(rawData.data())[i]) : reinterpret_cast<const float*>(rawData.data())[i]; };
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint32_t srcXEnd = x + 1 == width ? kWidth : x * 4 + 4;
+                const uint32_t srcYEnd = y + 1 == height ? kHeight : y * 4 + 4;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    float sum = 0.f;
+                    for (uint32_t srcY = y * 4; srcY < srcYEnd; srcY++)
+                        for (uint32_t srcX = x * 4; srcX < srcXEnd; srcX++)
+                            sum += data[(srcY * kWidth + srcX) * 4 + c];
+                    const float expected = sum / float((srcXEnd - x * 4) * (srcYEnd - y * 4));
+                    // The averages are rounded to the nearest 16-bit float, with a relative error of at most 2^-11.
+                    const float tolerance = float16 ? 1e-4f + std::abs(expected) * 1e-3f : 1e-4f;
+                    EXPECT_LE(std::abs(getResult((y * width + x) * 4 + c) - expected), tolerance)
+                        << "x=" << x << " y=" << y << " c=" << c << " float16=" << float16;
+                }
+            }
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+} // namespace Falcor
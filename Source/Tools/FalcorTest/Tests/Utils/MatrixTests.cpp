@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Math/Matrix.h"
+#include "Utils/Math/MatrixBatch.h"
 #include "Utils/Math/MatrixJson.h"
 
 #include <fmt/format.h>
@@ -282,6 +283,46 @@ CPU_TEST(Matrix_inverse)
     }
 }
 
+CPU_TEST(Matrix_batch)
+{
+    // Use a count that is not a multiple of the batch size, and one projective matrix for the generic inverse fallback.
+    const size_t count = 4 * math::kMatrixBatchSize + 3;
+    std::vector<float4x4> lhs(count), rhs(count), products(count), invTransposes(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float f = float(i);
+        lhs[i] = mul(math::matrixFromTranslation(float3(f, -2.f * f, 0.5f)), math::matrixFromRotationXYZ(0.1f * f, 0.2f, -0.3f * f));
+        lhs[i] = mul(lhs[i], math::matrixFromScaling(float3(1.f + f, 2.f, 0.5f)));
+        rhs[i] = math::matrixFromTranslation(float3(1.f, f, -f));
+    }
+    lhs[5] = math::perspective(1.f, 1.5f, 0.1f, 100.f);
+
+    std::vector<const float4x4*> pLhs(count), pRhs(count), pProducts(count);
+    std::vector<float4x4*> pProductResults(count), pInvTransposes(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        pLhs[i] = &lhs[i];
+        pRhs[i] = &rhs[i];
+        pProducts[i] = &products[i];
+        pProductResults[i] = &products[i];
+        pInvTransposes[i] = &invTransposes[i];
+    }
+
+    math::mulBatch(count, pLhs.data(), pRhs.data(), pProductResults.data());
+    math::inverseTransposeAffineBatch(count, pProducts.data(), pInvTransposes.data());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float4x4 product = mul(lhs[i], rhs[i]);
+        const float4x4 invTranspose = transpose(inverse(product));
+        for (int r = 0; r < 4; ++r)
+        {
+            EXPECT_TRUE(almostEqual(products[i][r], product[r], 1e-4f)) << fmt::format("{} != {}", products[i][r], product[r]);
+            EXPECT_TRUE(almostEqual(invTransposes[i][r], invTranspose[r], 1e-4f)) << fmt::format("{} != {}", invTransposes[i][r], invTranspose[r]);
+        }
+    }
+}
+
 CPU_TEST(Matrix_extractEulerAngleXYZ)
 {
     {
@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Testing/UnitTest.h"
+#include "Utils/Math/PackedFormats.h"
 #include <random>
 
 namespace Falcor
@@ -105,4 +106,47 @@ GPU_TEST(LogLuvHDR)
         EXPECT_LE(result[i].z, expMax(testData[i].z)) << "i = " << i;
     }
 }
+
+GPU_TEST(NormalTangent2x11x10)
+{
+    std::mt19937 rng;
+    auto dist = std::normal_distribution<float>();
+    auto u = [&]() { return dist(rng); };
+
+    // Generate random unit normals with tangents in their tangent plane.
+    // Every 8th normal is on the equator, where the octahedral mapping folds over.
+    const uint32_t n = 1 << 16;
+    std::vector<float3> normals(n);
+    std::vector<float3> tangents(n);
+    std::vector<uint32_t> packed(n);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        normals[i] = normalize(float3(u(), u(), i % 8 == 0 ? 0.f : u()));
+        float3 t = float3(u(), u(), u());
+        tangents[i] = normalize(t - normals[i] * dot(normals[i], t));
+        packed[i] = encodeNormalTangent2x11x10(normals[i], tangents[i]);
+    }
+
+    // Decode on the GPU.
+    ctx.createProgram("Tests/Utils/PackedFormatsTests.cs.slang", "testDecodeNormalTangent2x11x10");
+    ctx.allocateStructuredBuffer("packedNormalTangents", n, packed.data(), packed.size() * sizeof(packed[0]));
+    ctx.allocateStructuredBuffer("normals", n);
+    ctx.allocateStructuredBuffer("tangents", n);
+    ctx.runProgram(n);
+
+    // Verify that the GPU builds the same tangent frame as the host and that the error is within the quantization error.
+    std::vector<float3> resultNormals = ctx.readBuffer<float3>("normals");
+    std::vector<float3> resultTangents = ctx.readBuffer<float3>("tangents");
+    const float cosMaxError = std::cos(0.5f * (float)M_PI / 180.f);
+    for (uint32_t i = 0; i < n; i++)
+    {
+        float3 hostNormal, hostTangent;
+        decodeNormalTangent2x11x10(packed[i], hostNormal, hostTangent);
+
+        EXPECT_GE(dot(resultNormals[i], hostNormal), 0.9999f) << "i = " << i;
+        EXPECT_GE(dot(resultTangents[i], hostTangent), 0.9999f) << "i = " << i;
+        EXPECT_GE(dot(resultNormals[i], normals[i]), cosMaxError) << "i = " << i;
+        EXPECT_GE(dot(resultTangents[i], tangents[i]), cosMaxError) << "i = " << i;
+    }
+}
 } // namespace Falcor
@@ -27,6 +27,8 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/PixelConversion.h"
 
 namespace Falcor
 {
@@ -118,6 +120,44 @@ const TextureAnalyzer::Result kExpectedResult[] = {
         float4(0.f, 0.f, 0.f, 1 / 256.f),
     },
 };
+
+std::filesystem::path getTestTexturePath(size_t i)
+{
+    return getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+}
+
+void verify(UnitTestContext& ctx, const std::vector<TextureAnalyzer::Result>& result)
+{
+    for (size_t i = 0; i < kNumTests; i++)
+    {
+        EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
+
+        uint32_t rangeFlags = 0;
+        for (int c = 0; c < 4; c++)
+        {
+            bool isConstant = (kExpectedResult[i].mask & (1u << c)) == 0;
+            rangeFlags |= kExpectedResult[i].mask >> (4 + 4 * c);
+
+            EXPECT_EQ(result[i].isConstant(1u << c), isConstant) << " c = " << c;
+            EXPECT_EQ(result[i].minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
+            EXPECT_EQ(result[i].maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+
+            if (isConstant)
+            {
+                EXPECT_EQ(result[i].value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
+            }
+        }
+
+        EXPECT_EQ(result[i].isPos(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isNeg(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0)
+            << "i = " << i;
+        EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0)
+            << "i = " << i;
+    }
+}
 } // namespace
 
 GPU_TEST(TextureAnalyzer)
@@ -130,7 +170,7 @@ GPU_TEST(TextureAnalyzer)
     std::vector<ref<Texture>> textures(kNumTests);
     for (size_t i = 0; i < kNumTests; i++)
     {
-        std::filesystem::path path = getRuntimeDirectory() / fmt::format("data/tests/texture{}.{}", i + 1, i < kNumPNGs ? "png" : "exr");
+        std::filesystem::path path = getTestTexturePath(i);
         textures[i] = Texture::createFromFile(pDevice, path, false, false);
         if (!textures[i])
             FALCOR_THROW("Failed to load {}", path);
@@ -146,47 +186,53 @@ GPU_TEST(TextureAnalyzer)
         textureAnalyzer.analyze(ctx.getRenderContext(), textures[i], 0, 0, pResult, i * kResultSize);
     }
 
-    auto verify = [&ctx](ref<Buffer> pResult)
-    {
-        // Verify results.
-        std::vector<TextureAnalyzer::Result> result = pResult->getElements<TextureAnalyzer::Result>();
-        for (size_t i = 0; i < kNumTests; i++)
-        {
-            EXPECT_EQ(result[i].mask, kExpectedResult[i].mask) << "i = " << i;
+    verify(ctx, pResult->getElements<TextureAnalyzer::Result>());
 
-            uint32_t rangeFlags = 0;
-            for (int c = 0; c < 4; c++)
-            {
-                bool isConstant = (kExpectedResult[i].mask & (1u << c)) == 0;
-                rangeFlags |= kExpectedResult[i].mask >> (4 + 4 * c);
+    // Test the array version of the interface.
+    ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
+    textureAnalyzer.analyze(ctx.getRenderContext(), textures, pResult);
 
-                EXPECT_EQ(result[i].isConstant(1u << c), isConstant) << " c = " << c;
-                EXPECT_EQ(result[i].minValue[c], kExpectedResult[i].minValue[c]) << "i = " << i << " c = " << c;
-                EXPECT_EQ(result[i].maxValue[c], kExpectedResult[i].maxValue[c]) << "i = " << i << " c = " << c;
+    verify(ctx, pResult->getElements<TextureAnalyzer::Result>());
+}
 
-                if (isConstant)
-                {
-                    EXPECT_EQ(result[i].value[c], kExpectedResult[i].value[c]) << "i = " << i << " c = " << c;
-                }
-            }
+CPU_TEST(TextureAnalyzer_Cpu)
+{
+    PixelConversion::Isa startupIsa = PixelConversion::getIsa();
 
-            EXPECT_EQ(result[i].isPos(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isNeg(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isInf(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf) != 0)
-                << "i = " << i;
-            EXPECT_EQ(result[i].isNaN(TextureChannelFlags::RGBA), (rangeFlags & (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN) != 0)
-                << "i = " << i;
-        }
-    };
+    std::vector<Bitmap::UniqueConstPtr> bitmaps(kNumTests);
+    for (size_t i = 0; i < kNumTests; i++)
+    {
+        std::filesystem::path path = getTestTexturePath(i);
+        bitmaps[i] = Bitmap::createFromFile(path, true);
+        if (!bitmaps[i])
+            FALCOR_THROW("Failed to load {}", path);
+        EXPECT(TextureAnalyzer::isCpuAnalysisSupported(bitmaps[i]->getFormat())) << "i = " << i;
+    }
 
-    verify(pResult);
+    // Both code paths must match the GPU analysis.
+    for (auto isa : {PixelConversion::Isa::Scalar, PixelConversion::Isa::AVX2})
+    {
+        PixelConversion::setIsa(isa);
+        std::vector<TextureAnalyzer::Result> result(kNumTests);
+        for (size_t i = 0; i < kNumTests; i++)
+            result[i] = TextureAnalyzer::analyzeCpu(*bitmaps[i]);
+        verify(ctx, result);
+    }
 
-    // Test the array version of the interface.
-    ctx.getRenderContext()->clearUAV(pResult->getUAV().get(), uint4(0xbabababa));
-    textureAnalyzer.analyze(ctx.getRenderContext(), textures, pResult);
+    PixelConversion::setIsa(startupIsa);
+}
+
+CPU_TEST(TextureAnalyzer_CpuRowPitch)
+{
+    // 3x2 single channel image with padding bytes between the rows, which must be ignored.
+    const uint8_t data[] = {10, 10, 10, 255, 0, 0, 0, 0, 10, 10, 10, 99, 1, 2, 3, 4};
+    TextureAnalyzer::Result result = TextureAnalyzer::analyzeCpu(data, 3, 2, 8, ResourceFormat::R8Unorm);
+
+    EXPECT(result.isConstant(TextureChannelFlags::RGBA));
+    EXPECT_EQ(result.value.r, 10 / 255.f);
+    EXPECT_EQ(result.value.g, 0.f);
+    EXPECT_EQ(result.value.a, 1.f);
 
-    verify(pResult);
+    EXPECT_THROW(TextureAnalyzer::analyzeCpu(data, 1, 1, 4, ResourceFormat::BC1Unorm));
 }
 } // namespace Falcor
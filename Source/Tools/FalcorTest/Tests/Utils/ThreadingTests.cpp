@@ -0,0 +1,154 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(Threading_ParallelFor)
+{
+    std::vector<uint32_t> values(100000, 0);
+    Threading::parallelFor(size_t(0), values.size(), [&](size_t i) { values[i] += (uint32_t)i; });
+    for (size_t i = 0; i < values.size(); ++i)
+        ASSERT_EQ(values[i], (uint32_t)i);
+
+    // Empty ranges and explicit grain sizes.
+    std::atomic<uint32_t> count{0};
+    Threading::parallelFor(10, 10, [&](int) { ++count; });
+    EXPECT_EQ(count.load(), 0u);
+    Threading::parallelFor(0, 1000, [&](int) { ++count; }, 7);
+    EXPECT_EQ(count.load(), 1000u);
+}
+
+CPU_TEST(Threading_NestedParallelFor)
+{
+    // Waiting threads execute pending tasks, so nesting must not deadlock with any thread count.
+    std::atomic<uint32_t> count{0};
+    Threading::parallelFor(0, 64, [&](int) { Threading::parallelFor(0, 64, [&](int) { ++count; }); });
+    EXPECT_EQ(count.load(), 64u * 64u);
+}
+
+CPU_TEST(Threading_TaskContinuation)
+{
+    std::atomic<uint32_t> order{0};
+    uint32_t first = 0;
+    uint32_t second = 0;
+
+    Threading::Task task = Threading::dispatchTask(
+        [&]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            first = ++order;
+        }
+    );
+    Threading::Task continuation = task.then([&]() { second = ++order; });
+    continuation.finish();
+
+    EXPECT(!task.isRunning());
+    EXPECT(!continuation.isRunning());
+    EXPECT_EQ(first, 1u);
+    EXPECT_EQ(second, 2u);
+
+    // Continuation added after the task has finished.
+    uint32_t third = 0;
+    task.then([&]() { third = ++order; }).finish();
+    EXPECT_EQ(third, 3u);
+}
+
+CPU_TEST(Threading_Exceptions)
+{
+    bool caught = false;
+    try
+    {
+        Threading::dispatchTask([]() { throw std::runtime_error("task"); }).finish();
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+
+    TaskGroup group;
+    std::atomic<uint32_t> count{0};
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        group.run(
+            [&, i]()
+            {
+                ++count;
+                if (i == 50)
+                    throw std::runtime_error("group");
+            }
+        );
+    }
+
+    caught = false;
+    try
+    {
+        group.wait();
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT(caught);
+    // All the tasks have run even though one has thrown.
+    EXPECT_EQ(count.load(), 100u);
+}
+
+CPU_TEST(Threading_TaskGroup)
+{
+    std::vector<uint64_t> sums(32, 0);
+    {
+        TaskGroup group;
+        for (size_t i = 0; i < sums.size(); ++i)
+        {
+            group.run(
+                [&, i]()
+                {
+                    for (uint64_t j = 0; j <= i * 1000; ++j)
+                        sums[i] += j;
+                }
+            );
+        }
+        // The destructor waits for the tasks.
+    }
+
+    for (uint64_t i = 0; i < sums.size(); ++i)
+    {
+        const uint64_t n = i * 1000;
+        EXPECT_EQ(sums[i], n * (n + 1) / 2);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,255 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Core/Error.h"
+#include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
+#include "Core/Plugin.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/MaterialTextureCache.h"
+#include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ImageIO.h"
+#include "Utils/Logger.h"
+
+#include <args.hxx>
+
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Falcor;
+
+FALCOR_EXPORT_D3D12_AGILITY_SDK
+
+namespace
+{
+struct CacheJob
+{
+    std::filesystem::path sourcePath;
+    std::filesystem::path cachePath;
+    Material::TextureSlot slot;
+    Material::TextureSlotInfo slotInfo;
+};
+
+/**
+ * Collect the material textures of a scene.
+ * All of them are added to textures, to be added to the cache index, while only the textures that are not cached yet are added to jobs.
+ */
+void collectJobs(
+    ref<Device> pDevice,
+    const std::filesystem::path& scenePath,
+    bool force,
+    std::set<std::filesystem::path>& cachePaths,
+    std::vector<CacheJob>& textures,
+    std::vector<CacheJob>& jobs
+)
+{
+    // Keep all material textures, including constant ones.
+    SceneBuilder builder(pDevice, scenePath, Settings(), SceneBuilder::Flags::DontOptimizeMaterials);
+    builder.waitForMaterialTextureLoading();
+
+    for (const auto& pMaterial : builder.getMaterials())
+    {
+        for (uint32_t i = 0; i < (uint32_t)Material::TextureSlot::Count; i++)
+        {
+            const auto slot = (Material::TextureSlot)i;
+            if (!pMaterial->hasTextureSlot(slot) || !MaterialTextureCache::isSlotCacheable(slot))
+                continue;
+
+            ref<Texture> pTexture = pMaterial->getTexture(slot);
+            if (!pTexture || pTexture->getSourcePath().empty())
+                continue;
+
+            const auto& sourcePath = pTexture->getSourcePath();
+            const auto& slotInfo = pMaterial->getTextureSlotInfo(slot);
+            std::filesystem::path cachePath = MaterialTextureCache::getCachePath(sourcePath, slot, slotInfo);
+            if (cachePath.empty())
+                continue;
+
+            // Identical textures share the cached file, but each source file gets an index entry.
+            textures.push_back(CacheJob{sourcePath, cachePath, slot, slotInfo});
+            if (!cachePaths.insert(cachePath).second)
+                continue;
+            if (!force && std::filesystem::exists(cachePath))
+                continue;
+
+            jobs.push_back(CacheJob{sourcePath, cachePath, slot, slotInfo});
+        }
+    }
+}
+
+/// Compress a texture and write it to the cache. Returns false if the texture is not cached.
+bool writeCachedTexture(const CacheJob& job)
+{
+    Bitmap::UniqueConstPtr pBitmap =
+        hasExtension(job.sourcePath, "dds") ? ImageIO::loadBitmapFromDDS(job.sourcePath) : Bitmap::createFromFile(job.sourcePath, true);
+    if (!pBitmap)
+        return false;
+
+    ImageIO::CompressionMode mode = MaterialTextureCache::getCompressionMode(job.slot, job.slotInfo, pBitmap->getFormat());
+    if (mode == ImageIO::CompressionMode::None)
+    {
+        logInfo("Skipping '{}' ({} texture in format {}).", job.sourcePath, to_string(job.slot), to_string(pBitmap->getFormat()));
+        return false;
+    }
+
+    // Write to a temporary file and rename it afterwards, so that the loader never sees a partially written file.
+    auto tempPath = job.cachePath;
+    tempPath += ".tmp";
+    ImageIO::saveToDDS(tempPath, *pBitmap, mode, true /* generateMips */);
+    std::filesystem::rename(tempPath, job.cachePath);
+
+    logInfo("Cached '{}' ({} texture) to '{}'.", job.sourcePath, to_string(job.slot), job.cachePath);
+    return true;
+}
+} // namespace
+
+int runMain(int argc, char** argv)
+{
+    args::ArgumentParser parser("Utility to write the block-compressed texture cache of scenes.");
+    parser.helpParams.programName = "TextureCache";
+    args::HelpFlag helpFlag(parser, "help", "Display this help menu.", {'h', "help"});
+    args::ValueFlag<std::string> deviceTypeFlag(parser, "d3d12|vulkan", "Graphics device type.", {'d', "device-type"});
+    args::ValueFlag<uint32_t> gpuFlag(parser, "index", "Select specific GPU to use", {"gpu"});
+    args::Flag forceFlag(parser, "", "Rewrite textures that are already cached.", {'f', "force"});
+    args::Flag clearFlag(parser, "", "Delete the texture cache and exit.", {"clear"});
+    args::PositionalList<std::string> scenesFlag(parser, "scenes", "The scene files.");
+    args::CompletionFlag completionFlag(parser, {"complete"});
+
+    try
+    {
+        parser.ParseCLI(argc, argv);
+    }
+    catch (const args::Completion& e)
+    {
+        std::cout << e.what();
+        return 0;
+    }
+    catch (const args::Help&)
+    {
+        std::cout << parser;
+        return 0;
+    }
+    catch (const args::ParseError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+    catch (const args::RequiredError& e)
+    {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    const std::filesystem::path cacheDirectory = MaterialTextureCache::getDirectory();
+    if (clearFlag)
+    {
+        std::filesystem::remove_all(cacheDirectory);
+        fmt::print("Deleted texture cache '{}'.\n", cacheDirectory);
+        return 0;
+    }
+
+    if (!scenesFlag)
+    {
+        std::cerr << "No scene file specified." << std::endl;
+        std::cerr << parser;
+        return 1;
+    }
+
+    Device::Desc deviceDesc;
+    if (deviceTypeFlag)
+    {
+        if (args::get(deviceTypeFlag) == "d3d12")
+            deviceDesc.type = Device::Type::D3D12;
+        else if (args::get(deviceTypeFlag) == "vulkan")
+            deviceDesc.type = Device::Type::Vulkan;
+        else
+        {
+            std::cerr << "Invalid device type, use 'd3d12' or 'vulkan'" << std::endl;
+            return 1;
+        }
+    }
+    if (gpuFlag)
+        deviceDesc.gpu = args::get(gpuFlag);
+
+    ref<Device> pDevice = make_ref<Device>(deviceDesc);
+    PluginManager::instance().loadAllPlugins();
+
+    std::filesystem::create_directories(cacheDirectory);
+
+    // Collect the textures of all scenes first, so that textures shared between scenes are only cached once.
+    std::set<std::filesystem::path> cachePaths;
+    std::vector<CacheJob> textures;
+    std::vector<CacheJob> jobs;
+    for (const auto& scene : args::get(scenesFlag))
+    {
+        fmt::print("Loading scene '{}'.\n", scene);
+        collectJobs(pDevice, scene, forceFlag, cachePaths, textures, jobs);
+    }
+
+    size_t cachedCount = 0;
+    for (const auto& job : jobs)
+    {
+        try
+        {
+            if (writeCachedTexture(job))
+                cachedCount++;
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Failed to cache '{}': {}", job.sourcePath, e.what());
+        }
+    }
+
+    // Index the cached textures, so that the loader can find them without hashing the source files.
+    // Textures that were skipped have no cached file and are not indexed.
+    MaterialTextureCache::Index index = MaterialTextureCache::Index::load();
+    for (const auto& texture : textures)
+    {
+        if (std::filesystem::exists(texture.cachePath))
+            index.add(texture.sourcePath, texture.slot, texture.slotInfo, texture.cachePath);
+    }
+    index.save();
+
+    fmt::print(
+        "Cached {} of {} textures ({} were already cached) in '{}'.\n",
+        cachedCount,
+        jobs.size(),
+        cachePaths.size() - jobs.size(),
+        cacheDirectory
+    );
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    return catchAndReportAllExceptions([&]() { return runMain(argc, argv); });
+}
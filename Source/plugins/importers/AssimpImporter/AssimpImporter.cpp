@@ -30,7 +30,7 @@
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/StringUtils.h"
-#include "Utils/NumericRange.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Math/FalcorMath.h"
@@ -46,7 +46,6 @@
 
 #include <pybind11/pybind11.h>
 
-#include <execution>
 #include <fstream>
 
 namespace Falcor
@@ -255,6 +254,7 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
 
         uint32_t pos = 0, rot = 0, scale = 0;
         Animation::Keyframe keyframe;
+        std::vector<Animation::Keyframe> keyframes;
         bool done = false;
 
         auto nextKeyTime = [&]()
@@ -281,9 +281,11 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
             done = parseAnimationChannel(pAiNode->mRotationKeys, pAiNode->mNumRotationKeys, time, rot, keyframe.rotation) && done;
             done = parseAnimationChannel(pAiNode->mScalingKeys, pAiNode->mNumScalingKeys, time, scale, keyframe.scaling) && done;
 
-            for (auto pAnimation : animations)
-                pAnimation->addKeyframe(keyframe);
+            keyframes.push_back(keyframe);
         }
+
+        for (auto pAnimation : animations)
+            pAnimation->setKeyframes(keyframes);
     }
 }
 
@@ -588,11 +590,9 @@ void createMeshes(ImporterData& data)
 
     // Pre-process meshes.
     std::vector<SceneBuilder::ProcessedMesh> processedMeshes(meshes.size());
-    auto range = NumericRange<size_t>(0, meshes.size());
-    std::for_each(
-        std::execution::par,
-        range.begin(),
-        range.end(),
+    Threading::parallelFor(
+        size_t(0),
+        meshes.size(),
         [&](size_t i)
         {
             const aiMesh* pAiMesh = meshes[i];
@@ -1843,17 +1843,27 @@ void buildScene(BuilderContext& ctx)
     }
 
     // Process shapes and create meshes.
+    // The shapes are created sequentially, the meshes are then processed in parallel and added in order.
+    std::vector<Falcor::NodeID> shapeNodeIDs;
+    std::vector<Falcor::ref<Falcor::TriangleMesh>> shapeTriangleMeshes;
+    std::vector<Falcor::ref<Falcor::Material>> shapeMaterials;
     for (const auto& entity : ctx.scene.getShapes())
     {
         auto shape = createShape(ctx, entity);
         if (shape.pTriangleMesh)
         {
-            auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            ctx.builder.addMeshInstance(nodeID, meshID);
+            shapeNodeIDs.push_back(ctx.builder.addNode({entity.name, shape.transform}));
+            shapeTriangleMeshes.push_back(shape.pTriangleMesh);
+            shapeMaterials.push_back(shape.pMaterial);
         }
     }
 
+    auto shapeMeshIDs = ctx.builder.addTriangleMeshes(shapeTriangleMeshes, shapeMaterials);
+    for (size_t i = 0; i < shapeMeshIDs.size(); ++i)
+    {
+        ctx.builder.addMeshInstance(shapeNodeIDs[i], shapeMeshIDs[i]);
+    }
+
     // Create curves from curve aggregates assembled during the processing step above.
     for (const auto& [_, curveAggregate] : ctx.curveAggregates)
     {
@@ -1176,10 +1176,7 @@ namespace Falcor
                     if (protoInstance.keyframes.size() > 0)
                     {
                         ref<Animation> pAnimation = Animation::create(protoInstance.name, rootNodeID, protoInstance.keyframes.back().time);
-                        for (const auto& keyframe : protoInstance.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
+                        pAnimation->setKeyframes(protoInstance.keyframes);
                         ctx.builder.addAnimation(pAnimation);
                     }
 
@@ -1213,10 +1210,7 @@ namespace Falcor
                         std::string animationName = protoGeom.nodes[animation.targetNodeID.get()].name;
                         NodeID targetNodeID{ animation.targetNodeID.get() + protoRootID.get() };
                         ref<Animation> pAnimation = Animation::create(animationName, targetNodeID, animation.keyframes.back().time);
-                        for (const auto& keyframe : animation.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
+                        pAnimation->setKeyframes(animation.keyframes);
                         ctx.builder.addAnimation(pAnimation);
                     }
 
@@ -1712,11 +1706,13 @@ namespace Falcor
         // Gather keyframes
         auto pAnimation = Animation::create(xformable.GetPath().GetString(), NodeID::Invalid(), times.back() / timeCodesPerSecond);
 
+        std::vector<Animation::Keyframe> keyframes;
+        keyframes.reserve(times.size());
         for (double t : times)
         {
-            Animation::Keyframe keyframe = createKeyframe(xformAPI, t, timeCodesPerSecond);
-            pAnimation->addKeyframe(keyframe);
+            keyframes.push_back(createKeyframe(xformAPI, t, timeCodesPerSecond));
         }
+        pAnimation->setKeyframes(std::move(keyframes));
 
         NodeID nodeID = builder.addNode(makeNode(xformable.GetPath().GetString(), nodeStack.back()));
         pAnimation->setNodeID(nodeID);
@@ -2352,6 +2348,7 @@ namespace Falcor
             VtArray<GfVec3f> trans;
             VtArray<GfQuatf> rot;
             VtArray<GfVec3h> scales;
+            std::vector<std::vector<Animation::Keyframe>> keyframes(subskeleton.bones.size());
 
             for (double t : times)
             {
@@ -2366,9 +2363,14 @@ namespace Falcor
                     keyframe.rotation = quatf(toFalcor(rot[i].GetImaginary()), rot[i].GetReal());
                     keyframe.scaling = toFalcor(scales[i]);
 
-                    subskeleton.animations[i]->addKeyframe(keyframe);
+                    keyframes[i].push_back(keyframe);
                 }
             }
+
+            for (size_t i = 0; i < subskeleton.bones.size(); i++)
+            {
+                subskeleton.animations[i]->setKeyframes(std::move(keyframes[i]));
+            }
         }
     }
 